@@ -32,6 +32,25 @@
  *                   initialised passing verbose flag.
  *  1.2   Feb-2023   Handled message reading and socket polling timeouts passage
  *                   as init arguments.
+ *  1.3   Oct-2026   Handled CPU device worker threads number passage as constructor
+ *                   argument.
+ *  1.4   Oct-2026   Handled qureg in-place mode passage as constructor argument.
+ *  1.5   Oct-2026   Handled event-driven message loop on blocking qio in-queue pop, with
+ *                   loop timeouts used as idle wake-up only. Released processed messages.
+ *  1.6   Oct-2026   Handled qureg state vector shards number passage as constructor argument.
+ *  1.7   Oct-2026   Handled cluster node passage as constructor argument - instruction messages
+ *                   broadcast by root node loop, and executed by worker nodes loop.
+ *  1.8   Oct-2026   Handled concurrent client sessions, each one with its own qCpu (quregs
+ *                   namespace) and message loop thread - instruction messages broadcast to
+ *                   worker nodes along with their session id, one at a time.
+ *  1.9   Oct-2026   Handled qureg lanes number passage as constructor argument - session
+ *                   instructions scheduled on qCpu lanes, responses pushed on completion.
+ *  1.10  Oct-2026   Released processed instruction messages to qIo for recycling.
+ *  1.11  Oct-2026   Handled CPU device memory policy passage to qCpu handlers.
+ *  1.12  Oct-2026   Handled devices warm-up once at construction (all nodes), not per session.
+ *  1.13  Oct-2026   Handled qCpu lane devices (and CPU worker pools) shared by all sessions,
+ *                   created once at construction - worker threads not multiplied by sessions.
+ *  1.14  Oct-2026   Handled session qCpu responses taken from qIo recycled ones.
  *
  *  --------------------------------------------------------------------------
  */
@@ -44,10 +63,24 @@ using namespace std;
 
 
 // constructor
-qSim::qSim(bool verbose) {
-	// init handlers
+qSim::qSim(bool verbose, int totThreads, bool inPlace, int totShards, qSim_qcpu_node* qNode, int totLanes,
+		   int memPolicy) {
+	// init qIo handler - qCpu handlers created on client sessions opening, on shared lane devices
 	m_qioHandler = new qSim_qio(verbose);
-	m_qcpuHandler = new qSim_qcpu(verbose);
+	m_qioHandler->set_session_callback(this);
+	m_totThreads = totThreads;
+	m_inPlace = inPlace;
+	m_totShards = totShards;
+	m_totLanes = totLanes;
+	m_memPolicy = memPolicy;
+	m_qNode = ((qNode != NULL) && qNode->is_cluster()) ? qNode : NULL;
+	m_running = false;
+
+	// devices warm-up - once on each node, before any session qCpu handler is created
+	qSim_qcpu::devices_warmup(verbose);
+
+	// qCpu lane devices - shared by all sessions qCpu handlers (single lane on cluster)
+	m_qcpuDevices = new qSim_qcpu_devices(totThreads, (m_qNode != NULL) ? 1 : totLanes, memPolicy);
 
 	// set message loop timeout value
 	m_msgTimeout = QSIM_MSG_LOOP_TIMEOUT_MSEC;
@@ -58,9 +91,10 @@ qSim::qSim(bool verbose) {
 
 // destructor
 qSim::~qSim() {
-	// release handlers
+	// release handlers - sessions closed by qIo
+	stopLoop();
 	delete m_qioHandler;
-	delete m_qcpuHandler;
+	delete m_qcpuDevices;
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -84,57 +118,190 @@ void qSim::startLoop() {
 //	if (m_verbose)
 //		cout << "qSim::startLoop..." << endl;
 
-	m_keepRunning.test_and_set();
-	m_thr_id = std::thread(&qSim::doLoop, this);
-	m_thr_id.detach();
+	// start loops of sessions opened so far - next ones started on opening
+	std::lock_guard<std::mutex> lock(m_sessionsMutex);
+	m_running = true;
+	std::map<int, qSim_session*>::iterator it;
+	for (it=m_sessions.begin(); it!=m_sessions.end(); it++)
+		start_session(it->second);
 }
 
 void qSim::stopLoop() {
 	if (m_verbose)
 		cout << "qSim::stopLoop..." << endl;
 
-	m_keepRunning.clear();
-	if (m_thr_id.joinable())
-		m_thr_id.join();
+	std::lock_guard<std::mutex> lock(m_sessionsMutex);
+	m_running = false;
+	std::map<int, qSim_session*>::iterator it;
+	for (it=m_sessions.begin(); it!=m_sessions.end(); it++)
+		stop_session(it->second);
 }
 
 // *********************************************************
 // support methods
 // *********************************************************
 
-// thread loop handling method
-void qSim::doLoop() {
-	cout << "qSim...doLoop...m_msgTimeout:" << m_msgTimeout << endl;
+// client session callbacks from qIo handler
+
+void qSim::session_open_cb(int s_id) {
+	// create session with its own qCpu handler
+	qSim_session* qs = new qSim_session;
+	qs->m_id = s_id;
+	qs->m_qcpuHandler = new qSim_qcpu(m_verbose, m_totThreads, m_inPlace, m_totShards, m_qNode, m_totLanes,
+								 m_memPolicy, m_qcpuDevices);
+	qs->m_qcpuHandler->set_response_alloc([this, s_id]() { return m_qioHandler->alloc_msgOut(s_id); });
+	if (m_verbose)
+		cout << "qSim::session_open_cb - session: " << s_id << endl;
+
+	std::lock_guard<std::mutex> lock(m_sessionsMutex);
+	m_sessions[s_id] = qs;
+	if (m_running)
+		start_session(qs);
+}
+
+void qSim::session_close_cb(int s_id) {
+	// remove session and wait for its loop completion
+	qSim_session* qs = NULL;
+	{
+		std::lock_guard<std::mutex> lock(m_sessionsMutex);
+		std::map<int, qSim_session*>::iterator it = m_sessions.find(s_id);
+		if (it == m_sessions.end())
+			return;
+		qs = it->second;
+		m_sessions.erase(it);
+		stop_session(qs);
+	}
+	if (m_verbose)
+		cout << "qSim::session_close_cb - session: " << s_id << endl;
+
+	// notify worker nodes - empty message for session closing
+	if (m_qNode != NULL) {
+		std::lock_guard<std::mutex> lock(m_nodeMutex);
+		unsigned int len = 0;
+		char c = 0;
+		char* buf = &c;
+		m_qNode->bcast(&s_id, sizeof(int));
+		m_qNode->bcast_message(&len, &buf);
+	}
+
+	// release session quregs - once scheduled instructions completed
+	delete qs->m_qcpuHandler;
+	delete qs;
+}
+
+// session loop thread control
+
+void qSim::start_session(qSim_session* qs) {
+	if (qs->m_thr_id.joinable())
+		return;
+	qs->m_keepRunning.test_and_set();
+	qs->m_thr_id = std::thread(&qSim::doLoop, this, qs);
+}
+
+void qSim::stop_session(qSim_session* qs) {
+	qs->m_keepRunning.clear();
+	if (qs->m_thr_id.joinable())
+		qs->m_thr_id.join();
+}
+
+// thread loop handling method - one for each client session
+void qSim::doLoop(qSim_session* qs) {
+	cout << "qSim...doLoop...session: " << qs->m_id << " m_msgTimeout:" << m_msgTimeout << endl;
 
 	// loop for routing incoming & outcoming messages - this is a performance critical part!
-	while (m_keepRunning.test_and_set()) {
+	while (qs->m_keepRunning.test_and_set()) {
 
-		// check qio input queue for instructions from client
-		if (m_qioHandler->get_msgIn_queue_size() > 0) {
-			// message present - extract first one
-			qSim_qasm_message* msg_in = m_qioHandler->pop_msgIn_queue();
+		// wait on session qio input queue for instructions from client - timeout only bounds the stop check
+		qSim_qasm_message* msg_in = m_qioHandler->pop_msgIn_queue_wait(qs->m_id, m_msgTimeout);
+		if (msg_in != NULL) {
+			// message present - dispatch it
 			if (m_verbose) {
-				cout << "qSim::doLoop - msg found in queue-in" << endl;
+				cout << "qSim::doLoop - msg found in queue-in - session: " << qs->m_id << endl;
 				msg_in->dump();
 				cout << "... sending to qcpu..." << endl;
 			}
 
-			// submit instruction message to CPU
-			qSim_qasm_message* msg_out = m_qcpuHandler->dispatch_instruction(msg_in);
-			if (m_verbose) {
-				cout << "qSim::doLoop - qcpu processing done" << endl;
-				msg_out->dump();
-				cout << "... pushing to queue-out..." << endl;
+			// on cluster, instruction message broadcast to worker nodes first (same execution on
+			// all nodes), and executed one session at a time
+			if (m_qNode != NULL) {
+				std::lock_guard<std::mutex> lock(m_nodeMutex);
+				unsigned int len;
+				char* buf;
+				int s_id = qs->m_id;
+				msg_in->to_char_array(&len, &buf);
+				m_qNode->bcast(&s_id, sizeof(int));
+				m_qNode->bcast_message(&len, &buf);
+				delete[] buf;
+				push_response(qs, msg_in, qs->m_qcpuHandler->dispatch_instruction(msg_in));
+			}
+			else {
+				// submit instruction message to session CPU - response pushed once done (in order)
+				qs->m_qcpuHandler->schedule_instruction(msg_in,
+					[this, qs](qSim_qasm_message* m_in, qSim_qasm_message* m_out) {
+						push_response(qs, m_in, m_out);
+					});
 			}
-
-			// submit CPU response to qio output queue
-			m_qioHandler->push_msgOut_queue(msg_out);
 		}
+	}
 
-		// sleep
-		this_thread::sleep_for(chrono::microseconds(m_msgTimeout));
+	cout << "qSim::doLoop done - session: " << qs->m_id << endl;
+}
+
+// instruction response handling - from session loop or qCpu lanes
+void qSim::push_response(qSim_session* qs, qSim_qasm_message* msg_in, qSim_qasm_message* msg_out) {
+	if (m_verbose) {
+		cout << "qSim::doLoop - qcpu processing done" << endl;
+		msg_out->dump();
+		cout << "... pushing to queue-out..." << endl;
 	}
 
-	cout << "qSim::doLoop done." << endl;
+	// submit CPU response to session qio output queue
+	m_qioHandler->push_msgOut_queue(qs->m_id, msg_out);
+
+	// release processed instruction message - recycled by qIo
+	m_qioHandler->release_msgIn(qs->m_id, msg_in);
 }
 
+// worker node loop handling method
+void qSim::nodeLoop() {
+	cout << "qSim...nodeLoop...node: " << m_qNode->get_rank() << endl;
+
+	// session qCpu handlers - mirroring the root node ones
+	std::map<int, qSim_qcpu*> qcpu_map;
+
+	while (1) {
+		// wait for root node instruction message and its session
+		int s_id;
+		unsigned int len;
+		char* buf = NULL;
+		m_qNode->bcast(&s_id, sizeof(int));
+		m_qNode->bcast_message(&len, &buf);
+		std::map<int, qSim_qcpu*>::iterator it = qcpu_map.find(s_id);
+		if (len == 0) {
+			// session closed - release its quregs
+			delete[] buf;
+			if (it != qcpu_map.end()) {
+				delete it->second;
+				qcpu_map.erase(it);
+			}
+			continue;
+		}
+		if (it == qcpu_map.end())
+			it = qcpu_map.insert(std::make_pair(s_id, new qSim_qcpu(m_verbose, m_totThreads, m_inPlace,
+																	  m_totShards, m_qNode, 1, m_memPolicy,
+																	  m_qcpuDevices))).first;
+
+		qSim_qasm_message* msg_in = new qSim_qasm_message();
+		msg_in->from_char_array(len, buf);
+		delete[] buf;
+		if (m_verbose) {
+			cout << "qSim::nodeLoop - msg received from root node - session: " << s_id << endl;
+			msg_in->dump();
+		}
+
+		// submit instruction message to session CPU - response handled by root node only
+		qSim_qasm_message* msg_out = it->second->dispatch_instruction(msg_in);
+		delete msg_out;
+		delete msg_in;
+	}
+}
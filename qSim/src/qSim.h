@@ -31,6 +31,20 @@
  *                   initialised passing verbose flag.
  *  1.2   Feb-2023   Handled message reading and socket polling timeouts passage
  *                   as init arguments.
+ *  1.3   Oct-2026   Handled CPU device worker threads number passage as constructor
+ *                   argument.
+ *  1.4   Oct-2026   Handled qureg in-place mode passage as constructor argument.
+ *  1.5   Oct-2026   Handled event-driven message loop on blocking qio in-queue pop, with
+ *                   loop timeouts used as idle wake-up only.
+ *  1.6   Oct-2026   Handled qureg state vector shards number passage as constructor argument.
+ *  1.7   Oct-2026   Handled cluster node passage as constructor argument - instruction messages
+ *                   broadcast by root node loop, and executed by worker nodes loop.
+ *  1.8   Oct-2026   Handled concurrent client sessions, each one with its own qCpu (quregs
+ *                   namespace) and message loop thread.
+ *  1.9   Oct-2026   Handled qureg lanes number passage as constructor argument - session
+ *                   instructions scheduled on qCpu lanes, responses pushed on completion.
+ *  1.10  Oct-2026   Handled CPU device memory policy passage as constructor argument.
+ *  1.11  Oct-2026   Handled qCpu lane devices shared by all client sessions.
  *
  *  --------------------------------------------------------------------------
  */
@@ -41,6 +55,9 @@
 
 
 #include <thread>
+#include <atomic>
+#include <map>
+#include <mutex>
 
 #include "qSim_qio.h"
 #include "qSim_qcpu.h"
@@ -49,18 +66,46 @@
 #define QSIM_OK    QBUS_SOCK_OK
 #define QSIM_ERROR QBUS_SOCK_ERROR
 
-// thread loop timeout for message reading
-#define QSIM_MSG_LOOP_TIMEOUT_MSEC 10
+// thread loop timeout for message reading (usec) - idle wake-up only, messages
+// dispatched as soon as queued
+#define QSIM_MSG_LOOP_TIMEOUT_MSEC 100000
 
-// thread loop timeout for socket polling
-#define QSIM_SOCKET_LOOP_TIMEOUT_MSEC 10
+// thread loop timeout for socket polling (usec) - idle wake-up only, socket and
+// outgoing messages handled as soon as available
+#define QSIM_SOCKET_LOOP_TIMEOUT_MSEC 100000
 
+// CPU device worker threads number
+#define QSIM_CPU_DEVICE_TOT_THREADS 1
 
-class qSim {
+// qureg in-place mode (single device register) default setting
+#define QSIM_QREG_IN_PLACE false
+
+// qureg state vector shards number default setting (no sharding)
+#define QSIM_QREG_TOT_SHARDS 1
+
+// qureg lanes number default setting (instructions executed in order by session loop)
+#define QSIM_QCPU_TOT_LANES 1
+
+// CPU device state vectors memory policy default setting (heap allocation)
+#define QSIM_CPU_DEVICE_MEM_POLICY 0
+
+
+// client session - own qCpu (quregs namespace) and message loop thread
+struct qSim_session {
+	int m_id;
+	qSim_qcpu* m_qcpuHandler;
+	std::thread m_thr_id;
+	std::atomic_flag m_keepRunning = ATOMIC_FLAG_INIT;
+};
+
+
+class qSim : public qSim_qio_session_cb {
 
 	public:
 		// constructor and destructor
-		qSim(bool verbose=false);
+		qSim(bool verbose=false, int totThreads=QSIM_CPU_DEVICE_TOT_THREADS, bool inPlace=QSIM_QREG_IN_PLACE,
+			 int totShards=QSIM_QREG_TOT_SHARDS, qSim_qcpu_node* qNode=NULL,
+			 int totLanes=QSIM_QCPU_TOT_LANES, int memPolicy=QSIM_CPU_DEVICE_MEM_POLICY);
 		virtual ~qSim();
 
 		int init(std::string ipAddr, int port,
@@ -70,17 +115,41 @@ class qSim {
 		void startLoop();
 		void stopLoop();
 
+		// worker node loop - root node broadcast messages executed (never returning)
+		void nodeLoop();
+
 	private:
 		// qIo handler
 		qSim_qio* m_qioHandler;
 
-		// qCpu handler
-		qSim_qcpu* m_qcpuHandler;
-
-		// loop thread control
-		void doLoop();
-		std::thread m_thr_id;
-		std::atomic_flag m_keepRunning = ATOMIC_FLAG_INIT;
+		// qCpu settings - a qCpu handler for each client session, all of them on the same lane
+		// devices (one device and CPU worker pool per lane)
+		qSim_qcpu_devices* m_qcpuDevices;
+		int m_totThreads;
+		bool m_inPlace;
+		int m_totShards;
+		int m_totLanes;
+		int m_memPolicy;
+
+		// cluster node - NULL for single node
+		qSim_qcpu_node* m_qNode;
+
+		// cluster node broadcast & execution control - one session message at a time
+		std::mutex m_nodeMutex;
+
+		// client sessions - by qIo session id
+		virtual void session_open_cb(int s_id);
+		virtual void session_close_cb(int s_id);
+
+		std::map<int, qSim_session*> m_sessions;
+		std::mutex m_sessionsMutex;
+		bool m_running;
+
+		// sessions loop threads control
+		void start_session(qSim_session* qs);
+		void stop_session(qSim_session* qs);
+		void doLoop(qSim_session* qs);
+		void push_response(qSim_session* qs, qSim_qasm_message* msg_in, qSim_qasm_message* msg_out);
 		int m_msgTimeout;
 
 		bool m_verbose;
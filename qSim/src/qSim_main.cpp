@@ -32,16 +32,30 @@
  *                   TCP/IP port.
  *  1.2   Feb-2023   Handled message reading and socket polling timeouts passage
  *                   as init arguments.
+ *  1.3   Oct-2026   Handled command line argument for CPU device worker threads number.
+ *  1.4   Oct-2026   Handled command line argument for qureg in-place mode.
+ *  1.5   Oct-2026   Updated loop timeouts usage description (idle wake-up).
+ *  1.6   Oct-2026   Handled command line argument for qureg state vector shards number.
+ *  1.7   Oct-2026   Handled cluster nodes (MPI compiling) - front-end on root node only, worker
+ *                   nodes executing root node instructions.
+ *  1.8   Oct-2026   Handled command line argument for qureg lanes number.
+ *  1.9   Oct-2026   Displayed state values precision (single precision compiling).
+ *  1.10  Oct-2026   Handled command line argument for instruction timeline file.
+ *  1.11  Oct-2026   Handled command line argument for CPU device memory policy.
+ *  1.12  Oct-2026   Handled command line argument for device kernels timing statistics.
  *
  *  --------------------------------------------------------------------------
  */
 
 
 #include <string>
+#include <thread>
+#include <algorithm>
 #include <iostream>
 using namespace std;
 
 #include "qSim.h"
+#include "qSim_qstats.h"
 
 #define QSIM_DEFAULT_IPADDR "127.0.0.1"
 #define QSIM_DEFAULT_PORT 27020
@@ -52,6 +66,18 @@ using namespace std;
 #define QSIM_ARCH "GPU"
 #endif
 
+#ifdef __QSIM_MPI__
+#define QSIM_NODES "MPI"
+#else
+#define QSIM_NODES "single node"
+#endif
+
+#ifdef __QSIM_SP__
+#define QSIM_PRECISION "single"
+#else
+#define QSIM_PRECISION "double"
+#endif
+
 #define QSIM_VERSION "v2.1"
 
 
@@ -66,15 +92,39 @@ void show_usage(std::string cmd) {
 	cout << " -port=<number>, -p=<number>" << endl;
 	cout << "\t to set a specific TCP/IP port" << endl;
 	cout << " -msg_tm=<number>" << endl;
-	cout << "\t to set a specific message loop timeout (usec)" << endl;
+	cout << "\t to set a specific message loop idle wake-up timeout (usec)" << endl;
 	cout << " -sock_tm=<number>" << endl;
-	cout << "\t to set a specific socket loop timeout (usec)" << endl;
+	cout << "\t to set a specific socket loop idle wake-up timeout (usec)" << endl;
+#ifdef __QSIM_CPU__
+	cout << " -threads=<number>, -t=<number>" << endl;
+	cout << "\t to set the CPU device worker threads number (0 for all cores)" << endl;
+	cout << " -inplace, -ip" << endl;
+	cout << "\t to enable in-place qureg transformations (single state vector per qureg)" << endl;
+	cout << " -mem=<option,...>" << endl;
+	cout << "\t to set the CPU device memory policy for large state vectors - huge pages (thp for transparent ones," << endl;
+	cout << "\t 2m or 1g for explicit ones) and NUMA placement (ft for first-touch by worker threads, il for interleaved)" << endl;
+#endif
+	cout << " -shards=<number>, -sh=<number>" << endl;
+	cout << "\t to split large qureg state vectors in shards by high-order qubits, spread on GPU devices (0 for all devices)" << endl;
+	cout << " -lanes=<number>, -l=<number>" << endl;
+	cout << "\t to execute instructions on different quregs concurrently, on the given number of qureg lanes" << endl;
+	cout << " -trace=<file>" << endl;
+	cout << "\t to record the instruction timeline, dumped to the given file on statistics request (Chrome trace format)" << endl;
+	cout << " -dev_stats" << endl;
+	cout << "\t to collect device kernels timing statistics (enabled with the instruction timeline too)" << endl;
 	cout << endl;
 }
 
 // main function entry point
 int main(int argc, char *argv[]) {
 
+	// join cluster nodes first - single node if not MPI compiled
+	qSim_qcpu_node qnode;
+	if (qnode.init(&argc, &argv) != QNODE_RES_OK) {
+		cerr << "ERROR!! cluster node initialisation failed" << endl;
+		return 0;
+	}
+
 	cout << "***********************" << endl;
 	cout << "*** qSim "<< QSIM_ARCH << " - " << QSIM_VERSION << " ***" << endl;
 	cout << "***********************" << endl;
@@ -85,6 +135,13 @@ int main(int argc, char *argv[]) {
 	int port = QSIM_DEFAULT_PORT;
 	int msg_tm = QSIM_MSG_LOOP_TIMEOUT_MSEC;
 	int sock_tm = QSIM_SOCKET_LOOP_TIMEOUT_MSEC;
+	int tot_thr = QSIM_CPU_DEVICE_TOT_THREADS;
+	bool in_place = QSIM_QREG_IN_PLACE;
+	int tot_sh = QSIM_QREG_TOT_SHARDS;
+	int tot_ln = QSIM_QCPU_TOT_LANES;
+	int mem_pol = QSIM_CPU_DEVICE_MEM_POLICY;
+	std::string trace_file = "";
+	bool dev_stats = false;
 	for (int i=1; i<argc; i++) {
 		std::string arg = std::string(argv[i]);
 		if ((arg.compare("-v") == 0) || (arg.compare("-verbose") == 0)) {
@@ -133,6 +190,82 @@ int main(int argc, char *argv[]) {
 				return 0;
 			}
 		}
+#ifdef __QSIM_CPU__
+		else if ((arg.find("-t=") != std::string::npos) || (arg.find("-threads=") != std::string::npos)) {
+			// threads tag found - check for correct syntax (-threads=<value>) and read threads number
+			int sep_index = arg.find("=");
+			std::string thr_str = arg.substr(sep_index+1, arg.length()-sep_index-1);
+			if (thr_str.length() > 0) {
+				tot_thr = std::stoi(thr_str);
+				if (tot_thr <= 0)
+					tot_thr = std::max(1u, std::thread::hardware_concurrency());
+			}
+			else {
+				// wrong syntax
+				cerr << "ERROR!! wrong threads number syntax [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+		else if ((arg.compare("-ip") == 0) || (arg.compare("-inplace") == 0)) {
+			// set in-place mode flag
+			in_place = true;
+		}
+		else if (arg.find("-mem=") == 0) {
+			// memory policy tag found - check for correct syntax (-mem=<option,...>) and read options
+			int sep_index = arg.find("=");
+			std::string mem_str = arg.substr(sep_index+1, arg.length()-sep_index-1);
+			if ((mem_str.length() == 0) || !qSim_qcpu_device::dev_mem_policy_parse(mem_str, &mem_pol)) {
+				// wrong syntax
+				cerr << "ERROR!! wrong memory policy syntax [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+#endif
+		else if ((arg.find("-sh=") != std::string::npos) || (arg.find("-shards=") != std::string::npos)) {
+			// shards tag found - check for correct syntax (-shards=<value>) and read shards number
+			int sep_index = arg.find("=");
+			std::string sh_str = arg.substr(sep_index+1, arg.length()-sep_index-1);
+			if (sh_str.length() > 0) {
+				tot_sh = std::max(0, std::stoi(sh_str));
+			}
+			else {
+				// wrong syntax
+				cerr << "ERROR!! wrong shards number syntax [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+		else if ((arg.find("-l=") != std::string::npos) || (arg.find("-lanes=") != std::string::npos)) {
+			// lanes tag found - check for correct syntax (-lanes=<value>) and read lanes number
+			int sep_index = arg.find("=");
+			std::string ln_str = arg.substr(sep_index+1, arg.length()-sep_index-1);
+			if (ln_str.length() > 0) {
+				tot_ln = std::max(1, std::stoi(ln_str));
+			}
+			else {
+				// wrong syntax
+				cerr << "ERROR!! wrong lanes number syntax [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+		else if (arg.find("-trace=") == 0) {
+			// timeline tag found - check for correct syntax (-trace=<file>) and read file name
+			int sep_index = arg.find("=");
+			trace_file = arg.substr(sep_index+1, arg.length()-sep_index-1);
+			if (trace_file.length() == 0) {
+				// wrong syntax
+				cerr << "ERROR!! wrong timeline file syntax [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+		else if (arg.compare("-dev_stats") == 0) {
+			// set device kernels timing flag
+			dev_stats = true;
+		}
 		// other cases...
 
 		else if ((arg.compare("-help") == 0) || (arg.compare("-h") == 0)) {
@@ -154,10 +287,33 @@ int main(int argc, char *argv[]) {
 	cout << "-> port:           " << port << endl;
 	cout << "-> msg_tm (usec):  " << msg_tm << endl;
 	cout << "-> sock_tm (usec): " << sock_tm << endl;
+#ifdef __QSIM_CPU__
+	cout << "-> threads:        " << tot_thr << endl;
+	cout << "-> in-place:       " << in_place << endl;
+	cout << "-> memory policy:  " << qSim_qcpu_device::dev_mem_policy_to_string(mem_pol) << endl;
+#endif
+	cout << "-> shards:         " << tot_sh << endl;
+	cout << "-> lanes:          " << tot_ln << endl;
+	cout << "-> nodes (" << QSIM_NODES << "): " << qnode.get_tot_nodes() << " - rank: " << qnode.get_rank() << endl;
+	cout << "-> precision:      " << QSIM_PRECISION << endl;
+	cout << "-> timeline:       " << ((trace_file.length() > 0) ? trace_file : "disabled") << endl;
+	cout << "-> device stats:   " << (dev_stats || (trace_file.length() > 0)) << endl;
 	cout << endl;
 
+	// device kernels timing and instruction timeline - if requested
+	qSim_qstats::device_enable(dev_stats);
+	if (trace_file.length() > 0)
+		qSim_qstats::trace_enable(trace_file);
+
 	// initialise qsim component
-	qSim qsim(verbose);
+	qSim qsim(verbose, tot_thr, in_place, tot_sh, &qnode, tot_ln, mem_pol);
+
+	// worker nodes - root node instructions executed, no front-end
+	if (!qnode.is_root()) {
+		cout << "qSim initialised - starting worker node loop..." << endl;
+		qsim.nodeLoop();
+		return 0;
+	}
 	int ret = qsim.init(QSIM_DEFAULT_IPADDR, port, msg_tm, sock_tm);
 	if (ret == QSIM_ERROR) {
 		cerr << "ERROR!! qsim initialisation failed" << endl;
@@ -0,0 +1,619 @@
+/*
+ * qSim_bench.cpp
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * qSim native benchmark harness (no client access), timing the simulator layers directly:
+ * - kernels: device gate kernels per gate family, qubit position and qureg size, and
+ *   device state reductions (marginals and expectation)
+ * - qreg: qureg measurement (single and shots) and expectation instructions
+ * - qasm: QASM message encoding and decoding (text and binary), for QML q-net
+ *   instructions and state values arrays
+ * - dispatch: standard QML circuits (feature-map, q-net and expectation) executed by the
+ *   qCpu instruction dispatcher, as sent by clients
+ *
+ * Each benchmark is repeated until the minimum time is reached, with results as CSV rows
+ * (default) or JSON lines: operations per second (gates, calls, messages or instructions)
+ * and bandwidth in GB/s (state values or message bytes processed, 0 if not relevant).
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled CPU device memory policy argument.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <sstream>
+using namespace std;
+
+#include "qSim_qcpu.h"
+
+#ifdef __QSIM_CPU__
+#define QSIM_ARCH "CPU"
+#else
+#define QSIM_ARCH "GPU"
+#endif
+
+#ifdef __QSIM_SP__
+#define QSIM_PRECISION "single"
+#else
+#define QSIM_PRECISION "double"
+#endif
+
+// default benchmark settings
+#define QSIM_BENCH_DEFAULT_QUBITS "12,16,20"
+#define QSIM_BENCH_DEFAULT_MIN_TM 100 // min time per benchmark (msec)
+#define QSIM_BENCH_MAX_REPS (1L << 30)
+
+// QML circuit settings (dispatch suite) - q-net repetitions
+#define QSIM_BENCH_QNET_REP 2
+
+// state values array max size (qasm suite)
+#define QSIM_BENCH_MSG_MAX_STATES (1 << 12)
+
+
+// null output buffer - simulator execution logs discarded (results only on standard output)
+struct qSim_bench_null_buf : public std::streambuf {
+	int overflow(int c) { return c; }
+};
+
+// benchmark result record
+struct qSim_bench_record {
+	std::string m_suite;
+	std::string m_name;
+	int m_qn;
+	int m_pos;			// qubit position (-1 if not relevant)
+	long m_reps;
+	double m_sec;
+	std::string m_unit;	// operations unit
+	double m_bytes;		// bytes processed per operation (0 if not relevant)
+};
+
+// benchmark settings and output
+struct qSim_bench_setup {
+	std::vector<int> m_qn_vec;
+	double m_min_sec;
+	int m_tot_thr;
+	int m_mem_pol;
+	bool m_in_place;
+	bool m_json;
+	std::string m_suite;
+	FILE* m_out;
+	bool m_header;
+};
+
+// --------------------------------------------------------------------------
+// results output
+// --------------------------------------------------------------------------
+
+void bench_print(qSim_bench_setup* setup, qSim_bench_record rec) {
+	// print benchmark result - as CSV row (with header on first row) or JSON line
+	double ops_s = (rec.m_sec > 0) ? rec.m_reps / rec.m_sec : 0;
+	double gb_s = ops_s * rec.m_bytes / 1e9;
+	if (setup->m_json) {
+		fprintf(setup->m_out, "{\"suite\": \"%s\", \"name\": \"%s\", \"qubits\": %d, \"pos\": %d, \"reps\": %ld, "
+				"\"time_s\": %.6f, \"unit\": \"%s\", \"ops_per_s\": %.3f, \"gb_per_s\": %.3f, "
+				"\"arch\": \"%s\", \"precision\": \"%s\", \"threads\": %d}\n",
+				rec.m_suite.c_str(), rec.m_name.c_str(), rec.m_qn, rec.m_pos, rec.m_reps, rec.m_sec,
+				rec.m_unit.c_str(), ops_s, gb_s, QSIM_ARCH, QSIM_PRECISION, setup->m_tot_thr);
+	}
+	else {
+		if (!setup->m_header) {
+			fprintf(setup->m_out, "suite,name,qubits,pos,reps,time_s,unit,ops_per_s,gb_per_s,arch,precision,threads\n");
+			setup->m_header = true;
+		}
+		fprintf(setup->m_out, "%s,%s,%d,%d,%ld,%.6f,%s,%.3f,%.3f,%s,%s,%d\n",
+				rec.m_suite.c_str(), rec.m_name.c_str(), rec.m_qn, rec.m_pos, rec.m_reps, rec.m_sec,
+				rec.m_unit.c_str(), ops_s, gb_s, QSIM_ARCH, QSIM_PRECISION, setup->m_tot_thr);
+	}
+	fflush(setup->m_out);
+}
+
+// --------------------------------------------------------------------------
+// timing support
+// --------------------------------------------------------------------------
+
+bool bench_time(qSim_bench_setup* setup, std::function<bool()> op, std::function<void()> sync,
+				long* reps, double* sec) {
+	// time given operation - warm-up run first, then repetitions doubled (or scaled on last
+	// elapsed time) until min time reached, with device synchronised before stopping the clock
+	if (!op())
+		return false;
+	sync();
+
+	long n = 1;
+	while (true) {
+		auto t0 = std::chrono::steady_clock::now();
+		for (long i=0; i<n; i++) {
+			if (!op())
+				return false;
+		}
+		sync();
+		double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+		if ((t >= setup->m_min_sec) || (n >= QSIM_BENCH_MAX_REPS)) {
+			*reps = n;
+			*sec = t;
+			return true;
+		}
+		long n_next = (t > 0) ? (long)(n * 1.2 * setup->m_min_sec / t) : 2*n;
+		n = std::min(QSIM_BENCH_MAX_REPS, std::max(2*n, n_next));
+	}
+}
+
+void bench_run(qSim_bench_setup* setup, qSim_bench_record rec, std::function<bool()> op,
+			   std::function<void()> sync=[](){}) {
+	// run a benchmark and print its result - error logged otherwise
+	if (!bench_time(setup, op, sync, &rec.m_reps, &rec.m_sec)) {
+		cerr << "ERROR!! benchmark " << rec.m_suite << "/" << rec.m_name << " failed [qubits: "
+			 << rec.m_qn << " pos: " << rec.m_pos << "]" << endl;
+		return;
+	}
+	bench_print(setup, rec);
+}
+
+// --------------------------------------------------------------------------
+// kernels suite - device functions called directly
+// --------------------------------------------------------------------------
+
+void bench_kernels(qSim_bench_setup* setup, qSim_qcpu_device* dev) {
+	for (int qn : setup->m_qn_vec) {
+		QDEV_ST_INDEX_TYPE d_N = ((QDEV_ST_INDEX_TYPE)1) << qn;
+		double st_bytes = (double)d_N * sizeof(QDEV_ST_VAL_TYPE);
+		if (dev->dev_qreg_function_tables_reserve(qn) != QDEV_RES_OK) {
+			cerr << "ERROR!! device function tables reservation failed [qubits: " << qn << "]" << endl;
+			continue;
+		}
+
+		// input and output state vectors - uniform superposition state
+		QDEV_ST_VAL_TYPE* d_x = NULL;
+		QDEV_ST_VAL_TYPE* d_y = NULL;
+		dev->dev_qreg_device_alloc(&d_x, d_N);
+		dev->dev_qreg_device_alloc(&d_y, d_N);
+		QREG_F_ARGS_TYPE no_args;
+		dev->dev_qreg_set_state(d_x, d_N, 0, false);
+		dev->dev_qreg_apply_function_gate_1qubit(d_x, d_y, d_N, QASM_F_TYPE_Q1_H, qn, 0, &no_args, false);
+		std::swap(d_x, d_y);
+		std::function<void()> sync = [=]() { dev->dev_qreg_stream_sync(); };
+
+		// gate family benchmarks - on low, middle and high qubit positions
+		QREG_F_ARGS_TYPE rot_args = {QREG_F_ARG_TYPE(0.3)};
+		QDEV_ST_VAL_TYPE dense_mtx[1 << 6];
+		auto positions = [qn](int fn) {
+			std::vector<int> p_vec = {0, (qn-fn)/2, qn-fn};
+			p_vec.erase(std::unique(p_vec.begin(), p_vec.end()), p_vec.end());
+			return p_vec;
+		};
+		auto record = [&](std::string name, int pos, double bytes) {
+			return qSim_bench_record{"kernels", name, qn, pos, 0, 0, "gates", bytes};
+		};
+
+		for (int pos : positions(1)) {
+			// 1-qubit gates - butterfly (input to output vector)
+			bench_run(setup, record("h", pos, 2*st_bytes), [&]() {
+				bool ok = (dev->dev_qreg_apply_function_gate_1qubit(d_x, d_y, d_N, QASM_F_TYPE_Q1_H, 1, pos,
+																	&no_args, false) == QDEV_RES_OK);
+				std::swap(d_x, d_y);
+				return ok;
+			}, sync);
+			bench_run(setup, record("rx", pos, 2*st_bytes), [&]() {
+				bool ok = (dev->dev_qreg_apply_function_gate_1qubit(d_x, d_y, d_N, QASM_F_TYPE_Q1_Rx, 1, pos,
+																	&rot_args, false) == QDEV_RES_OK);
+				std::swap(d_x, d_y);
+				return ok;
+			}, sync);
+
+			// 1-qubit gates - fast path (diagonal and permutation, on input vector)
+			bench_run(setup, record("rz_fast", pos, 2*st_bytes), [&]() {
+				return (dev->dev_qreg_apply_function_fast(d_x, d_N, QASM_F_TYPE_Q1_Rz, 2, 1, pos, QASM_F_FORM_NULL, 0,
+														  QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL, &rot_args,
+														  false) == QDEV_RES_OK);
+			}, sync);
+			bench_run(setup, record("x_fast", pos, 2*st_bytes), [&]() {
+				return (dev->dev_qreg_apply_function_fast(d_x, d_N, QASM_F_TYPE_Q1_X, 2, 1, pos, QASM_F_FORM_NULL, 0,
+														  QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL, &no_args,
+														  false) == QDEV_RES_OK);
+			}, sync);
+		}
+
+		for (int pos : positions(2)) {
+			// 2-qubit controlled gate - fast path (bitmask engine, half states updated)
+			bench_run(setup, record("cx_fast", pos, st_bytes), [&]() {
+				return (dev->dev_qreg_apply_function_fast(d_x, d_N, QASM_F_TYPE_Q2_CX, 4, 1, pos, QASM_F_FORM_DIRECT, 0,
+														  QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL, &no_args,
+														  false) == QDEV_RES_OK);
+			}, sync);
+		}
+
+		for (int fn=2; fn<=3; fn++) {
+			// dense k-qubit unitaries (fused gates) - Hadamard tensor product
+			int f_dim = 1 << fn;
+			for (int r=0; r<f_dim; r++) {
+				for (int c=0; c<f_dim; c++) {
+					int sgn = (__builtin_popcount(r & c) % 2) ? -1 : 1;
+					dense_mtx[r*f_dim + c] = QDEV_ST_MAKE_VAL(sgn / std::sqrt((double)f_dim), 0);
+				}
+			}
+			for (int pos : positions(fn)) {
+				bench_run(setup, record("dense" + to_string(fn), pos, 2*st_bytes), [&]() {
+					bool ok = (dev->dev_qreg_apply_function_dense(d_x, d_y, d_N, pos, fn, dense_mtx,
+																  false) == QDEV_RES_OK);
+					std::swap(d_x, d_y);
+					return ok;
+				}, sync);
+			}
+		}
+
+		for (int pos : positions(1)) {
+			// state reductions - single pass on input vector
+			double pr_vec[2];
+			bench_run(setup, qSim_bench_record{"kernels", "marginals", qn, pos, 0, 0, "calls", st_bytes}, [&]() {
+				return (dev->dev_qreg_marginals(d_x, d_N, pos, 1, pr_vec, false) == QDEV_RES_OK);
+			}, sync);
+
+			double w_vec[2] = {1, -1};
+			double exp;
+			bench_run(setup, qSim_bench_record{"kernels", "expectation", qn, pos, 0, 0, "calls", st_bytes}, [&]() {
+				return (dev->dev_qreg_expectation(d_x, d_N, 0, 0, ((QDEV_ST_INDEX_TYPE)1) << pos, w_vec, &exp,
+												  false) == QDEV_RES_OK);
+			}, sync);
+		}
+
+		dev->dev_qreg_device_release(d_x);
+		dev->dev_qreg_device_release(d_y);
+	}
+}
+
+// --------------------------------------------------------------------------
+// qreg suite - measurement and expectation instructions
+// --------------------------------------------------------------------------
+
+void bench_qreg(qSim_bench_setup* setup, qSim_qcpu_device* dev) {
+	for (int qn : setup->m_qn_vec) {
+		double st_bytes = (double)(((QREG_ST_INDEX_TYPE)1) << qn) * sizeof(QREG_ST_RAW_VAL_TYPE);
+
+		// qureg in uniform superposition state
+		qSim_qreg qr(qn, dev, false, setup->m_in_place);
+		std::string res_str;
+		qSim_qinstruction_core h_instr(QASM_MSG_ID_QREG_ST_TRANSFORM, 0, QASM_F_TYPE_Q1_H, 2, qn, 0);
+		if (!qr.applyCoreInstruction(&h_instr, &res_str)) {
+			cerr << "ERROR!! qureg setup failed [qubits: " << qn << "] - " << res_str << endl;
+			continue;
+		}
+
+		// measurements - no state collapse, on all qubits
+		QREG_ST_INDEX_TYPE m_st;
+		double m_pr;
+		QREG_ST_INDEX_ARRAY_TYPE m_vec;
+		qSim_qinstruction_core m_instr(QASM_MSG_ID_QREG_ST_MEASURE, 0, 0, qn, true, false);
+		bench_run(setup, qSim_bench_record{"qreg", "measure", qn, -1, 0, 0, "calls", st_bytes}, [&]() {
+			return qr.applyCoreInstruction(&m_instr, &res_str, &m_st, &m_pr, &m_vec);
+		});
+
+		qSim_qinstruction_core ms_instr(QASM_MSG_ID_QREG_ST_MEASURE, 0, 0, qn, true, false, 1024, 1);
+		bench_run(setup, qSim_bench_record{"qreg", "measure_shots_1024", qn, -1, 0, 0, "calls", st_bytes}, [&]() {
+			m_vec.clear();
+			return qr.applyCoreInstruction(&ms_instr, &res_str, &m_st, &m_pr, &m_vec);
+		});
+
+		// expectations - all qubits observable, on all states and on a single state
+		double m_exp;
+		qSim_qinstruction_core ex_instr(QASM_MSG_ID_QREG_ST_EXPECT, 0, (QREG_ST_INDEX_TYPE)-1, 0, qn, QASM_EX_OBSOP_TYPE_PAULIZ);
+		bench_run(setup, qSim_bench_record{"qreg", "expect_pauliz", qn, -1, 0, 0, "calls", st_bytes}, [&]() {
+			return qr.applyCoreInstruction(&ex_instr, &res_str, &m_exp);
+		});
+
+		qSim_qinstruction_core ex1_instr(QASM_MSG_ID_QREG_ST_EXPECT, 0, (QREG_ST_INDEX_TYPE)0, 0, qn, QASM_EX_OBSOP_TYPE_COMP);
+		bench_run(setup, qSim_bench_record{"qreg", "expect_comp", qn, -1, 0, 0, "calls", st_bytes}, [&]() {
+			return qr.applyCoreInstruction(&ex1_instr, &res_str, &m_exp);
+		});
+	}
+}
+
+// --------------------------------------------------------------------------
+// qasm suite - message encoding and decoding
+// --------------------------------------------------------------------------
+
+void bench_qasm_message(qSim_bench_setup* setup, std::string name, int qn, qSim_qasm_message* msg) {
+	// encode and decode given message - bytes of the encoded message, once per direction, with
+	// decoded instructions syntax checked (response id only for responses)
+	unsigned int len;
+	char* buf;
+	msg->to_char_array(&len, &buf);
+	delete[] buf;
+
+	bench_run(setup, qSim_bench_record{"qasm", name + "_encode", qn, -1, 0, 0, "msgs", (double)len}, [&]() {
+		unsigned int e_len;
+		char* e_buf;
+		msg->to_char_array(&e_len, &e_buf);
+		delete[] e_buf;
+		return (e_len == len);
+	});
+
+	msg->to_char_array(&len, &buf);
+	qSim_qasm_message msg_dec;
+	bench_run(setup, qSim_bench_record{"qasm", name + "_decode", qn, -1, 0, 0, "msgs", (double)len}, [&]() {
+		msg_dec.reset();
+		msg_dec.from_char_array(len, buf);
+		if (msg_dec.get_id() != msg->get_id())
+			return false;
+		return (!msg_dec.is_instruction_message() || msg_dec.check_syntax());
+	});
+	delete[] buf;
+}
+
+void bench_qasm(qSim_bench_setup* setup) {
+	for (int qn : setup->m_qn_vec) {
+		// QML q-net transformation message - one rotation parameter per qubit and layer
+		QREG_F_ARGS_TYPE fargs;
+		for (int i=0; i<qn*(QSIM_BENCH_QNET_REP+1); i++)
+			fargs.push_back(QREG_F_ARG_TYPE((13 + 9*i) / 64.0));
+		QASM_MSG_PARAMS_TYPE params;
+		params[QASM_MSG_PARAM_TAG_QREG_H] = "1";
+		params[QASM_MSG_PARAM_TAG_F_TYPE] = to_string(QASM_FBQML_TYPE_QNET);
+		params[QASM_MSG_PARAM_TAG_FBQML_REP] = to_string(QSIM_BENCH_QNET_REP);
+		params[QASM_MSG_PARAM_TAG_FBQML_ENTANG] = "0";
+		params[QASM_MSG_PARAM_TAG_FBQML_SUBTYPE] = "0";
+		params[QASM_MSG_PARAM_TAG_F_ARGS] = qSim_qinstruction_base::fargs_to_string(fargs);
+		qSim_qasm_message qnet_msg(1, QASM_MSG_ID_QREG_ST_TRANSFORM, params);
+		bench_qasm_message(setup, "qnet_text", qn, &qnet_msg);
+		qnet_msg.set_binary(true);
+		bench_qasm_message(setup, "qnet_bin", qn, &qnet_msg);
+
+		// state values response message (as per peek) - string (text) or raw array (binary)
+		int st_n = std::min(1 << qn, QSIM_BENCH_MSG_MAX_STATES);
+		QREG_ST_VAL_ARRAY_TYPE st_vals;
+		QASM_MSG_ARRAYS_TYPE arrays;
+		for (int i=0; i<st_n; i++) {
+			QREG_ST_VAL_TYPE st_val(std::cos(0.1*i) / std::sqrt(st_n), std::sin(0.1*i) / std::sqrt(st_n));
+			st_vals.push_back(st_val);
+			arrays.m_cArrays[QASM_MSG_PARAM_TAG_QREG_STVALS].push_back(st_val);
+		}
+		params.clear();
+		params[QASM_MSG_PARAM_TAG_RESULT] = QASM_MSG_PARAM_VAL_OK;
+		params[QASM_MSG_PARAM_TAG_QREG_STVALS] = qSim_qinstruction_base::state_value_to_string(st_vals);
+		qSim_qasm_message st_msg_text(1, QASM_MSG_ID_RESPONSE, params);
+		bench_qasm_message(setup, "stvals_text", qn, &st_msg_text);
+
+		params.erase(QASM_MSG_PARAM_TAG_QREG_STVALS);
+		qSim_qasm_message st_msg_bin(1, QASM_MSG_ID_RESPONSE, params, arrays);
+		st_msg_bin.set_binary(true);
+		bench_qasm_message(setup, "stvals_bin", qn, &st_msg_bin);
+	}
+}
+
+// --------------------------------------------------------------------------
+// dispatch suite - QML circuits executed by the qCpu dispatcher
+// --------------------------------------------------------------------------
+
+bool bench_dispatch_instruction(qSim_qcpu* qcpu, QASM_MSG_ID_TYPE id, QASM_MSG_PARAMS_TYPE params,
+								std::string* qr_h=NULL) {
+	// dispatch instruction message and check response - qureg handler returned if requested
+	qSim_qasm_message msg_in(1, id, params);
+	qSim_qasm_message* msg_out = qcpu->dispatch_instruction(&msg_in);
+	bool ok = (msg_out->get_param_valueByTag(QASM_MSG_PARAM_TAG_RESULT) == QASM_MSG_PARAM_VAL_OK);
+	if (!ok)
+		cerr << "ERROR!! instruction [" << id << "] failed - " << msg_out->get_param_valueByTag(QASM_MSG_PARAM_TAG_ERROR) << endl;
+	if (ok && (qr_h != NULL))
+		*qr_h = msg_out->get_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_H);
+	delete msg_out;
+	return ok;
+}
+
+void bench_dispatch(qSim_bench_setup* setup, qSim_qcpu* qcpu) {
+	for (int qn : setup->m_qn_vec) {
+		std::string qr_h;
+		if (!bench_dispatch_instruction(qcpu, QASM_MSG_ID_QREG_ALLOCATE, {{QASM_MSG_PARAM_TAG_QREG_QN, to_string(qn)}},
+										&qr_h))
+			continue;
+
+		// QML circuit - reset, H on all qubits, ZZ feature-map, q-net and PauliZ expectation
+		QREG_F_ARGS_TYPE x_args, th_args;
+		for (int i=0; i<qn; i++)
+			x_args.push_back(QREG_F_ARG_TYPE((19 + 7*i) / 64.0));
+		for (int i=0; i<qn*(QSIM_BENCH_QNET_REP+1); i++)
+			th_args.push_back(QREG_F_ARG_TYPE((13 + 9*i) / 64.0));
+		std::vector<std::pair<QASM_MSG_ID_TYPE, QASM_MSG_PARAMS_TYPE>> circuit = {
+			{QASM_MSG_ID_QREG_ST_RESET, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h}}},
+			{QASM_MSG_ID_QREG_ST_TRANSFORM, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h},
+											 {QASM_MSG_PARAM_TAG_F_TYPE, to_string(QASM_F_TYPE_Q1_H)},
+											 {QASM_MSG_PARAM_TAG_F_SIZE, "2"},
+											 {QASM_MSG_PARAM_TAG_F_REP, to_string(qn)},
+											 {QASM_MSG_PARAM_TAG_F_LSQ, "0"}}},
+			{QASM_MSG_ID_QREG_ST_TRANSFORM, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h},
+											 {QASM_MSG_PARAM_TAG_F_TYPE, to_string(QASM_FBQML_TYPE_FMAP)},
+											 {QASM_MSG_PARAM_TAG_FBQML_REP, "1"},
+											 {QASM_MSG_PARAM_TAG_FBQML_ENTANG, "1"},
+											 {QASM_MSG_PARAM_TAG_FBQML_SUBTYPE, "1"},
+											 {QASM_MSG_PARAM_TAG_F_ARGS, qSim_qinstruction_base::fargs_to_string(x_args)}}},
+			{QASM_MSG_ID_QREG_ST_TRANSFORM, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h},
+											 {QASM_MSG_PARAM_TAG_F_TYPE, to_string(QASM_FBQML_TYPE_QNET)},
+											 {QASM_MSG_PARAM_TAG_FBQML_REP, to_string(QSIM_BENCH_QNET_REP)},
+											 {QASM_MSG_PARAM_TAG_FBQML_ENTANG, "0"},
+											 {QASM_MSG_PARAM_TAG_FBQML_SUBTYPE, "0"},
+											 {QASM_MSG_PARAM_TAG_F_ARGS, qSim_qinstruction_base::fargs_to_string(th_args)}}},
+			{QASM_MSG_ID_QREG_ST_EXPECT, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h},
+										  {QASM_MSG_PARAM_TAG_QREG_EXSTIDX, "-1"},
+										  {QASM_MSG_PARAM_TAG_QREG_EXQIDX, "0"},
+										  {QASM_MSG_PARAM_TAG_QREG_EXQLEN, to_string(qn)},
+										  {QASM_MSG_PARAM_TAG_QREG_EXOBSOP, to_string(QASM_EX_OBSOP_TYPE_PAULIZ)}}}};
+
+		// circuit instructions timed one by one, then the whole circuit
+		const char* names[] = {"reset", "h_all", "fmap_zz", "qnet", "expect_pauliz"};
+		for (unsigned int i=0; i<circuit.size(); i++) {
+			qSim_bench_record rec = {"dispatch", names[i], qn, -1, 0, 0, "instr", 0};
+			bench_run(setup, rec, [&]() {
+				return bench_dispatch_instruction(qcpu, circuit[i].first, circuit[i].second);
+			});
+		}
+
+		bench_run(setup, qSim_bench_record{"dispatch", "qml_circuit", qn, -1, 0, 0, "circuits", 0}, [&]() {
+			bool ok = true;
+			for (unsigned int i=0; (i<circuit.size()) && ok; i++)
+				ok = bench_dispatch_instruction(qcpu, circuit[i].first, circuit[i].second);
+			return ok;
+		});
+
+		bench_dispatch_instruction(qcpu, QASM_MSG_ID_QREG_RELEASE, {{QASM_MSG_PARAM_TAG_QREG_H, qr_h}});
+	}
+}
+
+// --------------------------------------------------------------------------
+
+// print usage information
+void show_usage(std::string cmd) {
+	cout << "Usage: " << cmd << " [args...]" << endl;
+	cout << "where arguments include:" << endl;
+	cout << " -help, -h" << endl;
+	cout << "\t to display this help" << endl;
+	cout << " -qubits=<n1,n2,...>, -q=<n1,n2,...>" << endl;
+	cout << "\t to set the qureg sizes to benchmark (default " << QSIM_BENCH_DEFAULT_QUBITS << ")" << endl;
+	cout << " -suite=<name>, -s=<name>" << endl;
+	cout << "\t to run a single suite (kernels, qreg, qasm, dispatch - all by default)" << endl;
+	cout << " -min_tm=<number>" << endl;
+	cout << "\t to set the min time per benchmark (msec - default " << QSIM_BENCH_DEFAULT_MIN_TM << ")" << endl;
+	cout << " -json" << endl;
+	cout << "\t to print results as JSON lines (CSV by default)" << endl;
+	cout << " -out=<file>, -o=<file>" << endl;
+	cout << "\t to write results to the given file (standard output by default)" << endl;
+#ifdef __QSIM_CPU__
+	cout << " -threads=<number>, -t=<number>" << endl;
+	cout << "\t to set the CPU device worker threads number (0 for all cores)" << endl;
+	cout << " -inplace, -ip" << endl;
+	cout << "\t to enable in-place qureg transformations (qreg and dispatch suites)" << endl;
+	cout << " -mem=<option,...>" << endl;
+	cout << "\t to set the CPU device memory policy (thp, 2m, 1g huge pages - ft, il NUMA placement)" << endl;
+#endif
+	cout << endl;
+}
+
+// main function entry point
+int main(int argc, char *argv[]) {
+
+	// setup parameters from command line arguments - if any
+	qSim_bench_setup setup = {{}, QSIM_BENCH_DEFAULT_MIN_TM / 1000.0, 1, 0, false, false, "", stdout, false};
+	std::string qn_str = QSIM_BENCH_DEFAULT_QUBITS;
+	std::string out_str;
+	for (int i=1; i<argc; i++) {
+		std::string arg = std::string(argv[i]);
+		int sep_index = arg.find("=");
+		std::string val_str = (sep_index > 0) ? arg.substr(sep_index+1) : "";
+		if ((arg.compare("-h") == 0) || (arg.compare("-help") == 0)) {
+			show_usage(std::string(argv[0]));
+			return 0;
+		}
+		else if ((arg.compare("-json") == 0)) {
+			setup.m_json = true;
+		}
+		else if (((arg.find("-q=") == 0) || (arg.find("-qubits=") == 0)) && (val_str.length() > 0)) {
+			qn_str = val_str;
+		}
+		else if (((arg.find("-s=") == 0) || (arg.find("-suite=") == 0)) && (val_str.length() > 0)) {
+			setup.m_suite = val_str;
+		}
+		else if ((arg.find("-min_tm=") == 0) && (val_str.length() > 0)) {
+			setup.m_min_sec = std::stoi(val_str) / 1000.0;
+		}
+		else if (((arg.find("-o=") == 0) || (arg.find("-out=") == 0)) && (val_str.length() > 0)) {
+			out_str = val_str;
+		}
+#ifdef __QSIM_CPU__
+		else if (((arg.find("-t=") == 0) || (arg.find("-threads=") == 0)) && (val_str.length() > 0)) {
+			setup.m_tot_thr = std::stoi(val_str);
+			if (setup.m_tot_thr <= 0)
+				setup.m_tot_thr = std::max(1u, std::thread::hardware_concurrency());
+		}
+		else if ((arg.compare("-ip") == 0) || (arg.compare("-inplace") == 0)) {
+			setup.m_in_place = true;
+		}
+		else if ((arg.find("-mem=") == 0) && (val_str.length() > 0)) {
+			if (!qSim_qcpu_device::dev_mem_policy_parse(val_str, &setup.m_mem_pol)) {
+				cerr << "ERROR!! wrong memory policy [" << arg << "]" << endl << endl;
+				show_usage(std::string(argv[0]));
+				return 0;
+			}
+		}
+#endif
+		else {
+			// wrong syntax
+			cerr << "ERROR!! wrong argument syntax [" << arg << "]" << endl << endl;
+			show_usage(std::string(argv[0]));
+			return 0;
+		}
+	}
+
+	// qureg sizes list
+	std::stringstream qn_ss(qn_str);
+	std::string qn_tk;
+	while (std::getline(qn_ss, qn_tk, ',')) {
+		int qn = std::atoi(qn_tk.c_str());
+		if (qn < 4) {
+			cerr << "ERROR!! wrong qureg size [" << qn_tk << "] - 4 qubits min" << endl;
+			return 0;
+		}
+		setup.m_qn_vec.push_back(qn);
+	}
+
+	if (out_str.length() > 0) {
+		setup.m_out = fopen(out_str.c_str(), "w");
+		if (setup.m_out == NULL) {
+			cerr << "ERROR!! results file [" << out_str << "] opening failed" << endl;
+			return 0;
+		}
+	}
+
+	// discard execution logs while running
+	qSim_bench_null_buf null_buf;
+	std::streambuf* cout_buf = cout.rdbuf(&null_buf);
+
+	// device for kernels and qreg suites, qCpu for dispatch suite
+#ifdef __QSIM_CPU__
+	qSim_qcpu_device dev(setup.m_tot_thr, setup.m_mem_pol);
+#else
+	qSim_qcpu_device dev;
+#endif
+	if ((setup.m_suite.length() == 0) || (setup.m_suite == "kernels"))
+		bench_kernels(&setup, &dev);
+	if ((setup.m_suite.length() == 0) || (setup.m_suite == "qreg"))
+		bench_qreg(&setup, &dev);
+	if ((setup.m_suite.length() == 0) || (setup.m_suite == "qasm"))
+		bench_qasm(&setup);
+	if ((setup.m_suite.length() == 0) || (setup.m_suite == "dispatch")) {
+		qSim_qcpu qcpu(false, setup.m_tot_thr, setup.m_in_place, 1, NULL, 1, setup.m_mem_pol);
+		bench_dispatch(&setup, &qcpu);
+	}
+
+	cout.rdbuf(cout_buf);
+	if (setup.m_out != stdout)
+		fclose(setup.m_out);
+	return 0;
+}
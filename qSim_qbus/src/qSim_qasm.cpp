@@ -43,16 +43,89 @@
  *                   Code clean-up.
  *  1.3   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
+ *  1.4   Oct-2026   Supported qureg transformation batch message.
+ *  1.5   Oct-2026   Supported binary message encoding, with integer parameter tags
+ *                   and raw state arrays.
+ *  1.6   Oct-2026   Supported qureg state measurement shots parameters.
+ *  1.7   Oct-2026   Added message content reset, for recycling message objects.
+ *  1.8   Oct-2026   Supported batched qureg parameters.
+ *  1.9   Oct-2026   Supported qureg q-net gradient message.
+ *  1.10  Oct-2026   Supported qureg clone and state snapshot/restore messages.
+ *  1.11  Oct-2026   Supported qureg state paged peek and top-k states peek parameters.
+ *  1.12  Oct-2026   Supported server statistics control message.
+ *  1.13  Oct-2026   Added message content setup, for recycled response messages.
  *
  *  --------------------------------------------------------------------------
  */
 
 #include <iostream>
+#include <cstring>
+#include <cstdlib>
 using namespace std;
 
 #include "qSim_qasm.h"
 
 
+// binary encoding parameter tags table - tag index as binary tag
+// => Note: order shared with clients (append new tags only!)
+static const char* QASM_MSG_BIN_TAGS[] = {
+	QASM_MSG_PARAM_TAG_CLIENT_ID,
+	QASM_MSG_PARAM_TAG_CLIENT_TOKEN,
+	QASM_MSG_PARAM_TAG_QREG_QN,
+	QASM_MSG_PARAM_TAG_QREG_H,
+	QASM_MSG_PARAM_TAG_QREG_STIDX,
+	QASM_MSG_PARAM_TAG_QREG_STVALS,
+	QASM_MSG_PARAM_TAG_QREG_MQIDX,
+	QASM_MSG_PARAM_TAG_QREG_MQLEN,
+	QASM_MSG_PARAM_TAG_QREG_MRAND,
+	QASM_MSG_PARAM_TAG_QREG_MCOLL,
+	QASM_MSG_PARAM_TAG_QREG_MSTIDX,
+	QASM_MSG_PARAM_TAG_QREG_MSTPR,
+	QASM_MSG_PARAM_TAG_QREG_MSTIDXS,
+	QASM_MSG_PARAM_TAG_QREG_EXSTIDX,
+	QASM_MSG_PARAM_TAG_QREG_EXQIDX,
+	QASM_MSG_PARAM_TAG_QREG_EXQLEN,
+	QASM_MSG_PARAM_TAG_QREG_EXOBSOP,
+	QASM_MSG_PARAM_TAG_QREG_EXSTVAL,
+	QASM_MSG_PARAM_TAG_QREG_BN,
+	QASM_MSG_PARAM_TAG_QREG_BDONE,
+	QASM_MSG_PARAM_TAG_F_TYPE,
+	QASM_MSG_PARAM_TAG_F_SIZE,
+	QASM_MSG_PARAM_TAG_F_REP,
+	QASM_MSG_PARAM_TAG_F_LSQ,
+	QASM_MSG_PARAM_TAG_F_CRANGE,
+	QASM_MSG_PARAM_TAG_F_TRANGE,
+	QASM_MSG_PARAM_TAG_F_UTYPE,
+	QASM_MSG_PARAM_TAG_F_ARGS,
+	QASM_MSG_PARAM_TAG_FBQML_REP,
+	QASM_MSG_PARAM_TAG_FBQML_ENTANG,
+	QASM_MSG_PARAM_TAG_FBQML_SUBTYPE,
+	QASM_MSG_PARAM_TAG_FBQML_QNETTYPE,
+	QASM_MSG_PARAM_TAG_RESULT,
+	QASM_MSG_PARAM_TAG_ERROR,
+	QASM_MSG_PARAM_TAG_ENCODING,
+	QASM_MSG_PARAM_TAG_QREG_MSHOTS,
+	QASM_MSG_PARAM_TAG_QREG_MSEED,
+	QASM_MSG_PARAM_TAG_QREG_MCOUNTS,
+	QASM_MSG_PARAM_TAG_QREG_SN,
+	QASM_MSG_PARAM_TAG_QREG_SMSTIDXS,
+	QASM_MSG_PARAM_TAG_QREG_SMSTPRS,
+	QASM_MSG_PARAM_TAG_QREG_SEXSTVALS,
+	QASM_MSG_PARAM_TAG_QREG_GRVALS,
+	QASM_MSG_PARAM_TAG_QREG_CLH,
+	QASM_MSG_PARAM_TAG_QREG_STOFFS,
+	QASM_MSG_PARAM_TAG_QREG_STCNT,
+	QASM_MSG_PARAM_TAG_QREG_STTOPK,
+	QASM_MSG_PARAM_TAG_QREG_STIDXS,
+	QASM_MSG_PARAM_TAG_STATS_RESET,
+	QASM_MSG_PARAM_TAG_STATS_TRACE,
+	QASM_MSG_PARAM_TAG_STATS_VALS,
+	QASM_MSG_PARAM_TAG_STATS_ELAPSED,
+	QASM_MSG_PARAM_TAG_STATS_TRACEN,
+};
+#define QASM_MSG_BIN_TOT_TAGS ((int)(sizeof(QASM_MSG_BIN_TAGS)/sizeof(QASM_MSG_BIN_TAGS[0])))
+
+
 ///////////////////////////////////////////////////////////////////////////
 //  QASM instruction information handling class
 ///////////////////////////////////////////////////////////////////////////
@@ -62,27 +135,71 @@ qSim_qasm_message::qSim_qasm_message() {
 	m_id = QASM_MSG_ID_NOPE;
 	m_counter = 0;
 	m_params = QASM_MSG_PARAMS_TYPE();
+	m_binary = false;
+	m_tstamp = 0;
 }
 
 qSim_qasm_message::qSim_qasm_message(QASM_MSG_COUNTER_TYPE counter,
 				    QASM_MSG_ID_TYPE id,
-				    QASM_MSG_PARAMS_TYPE params) {
+				    QASM_MSG_PARAMS_TYPE params,
+				    QASM_MSG_ARRAYS_TYPE arrays) {
 	// set class attributes
 	m_counter = counter;
 	m_id = id;
 	m_params = params;
+	m_arrays = std::move(arrays);
+	m_binary = false;
+	m_tstamp = 0;
 }
 
 qSim_qasm_message::~qSim_qasm_message() {
 	// nothing to do...
 }
 
+void qSim_qasm_message::reset() {
+	// reset class attributes - containers cleared
+	m_id = QASM_MSG_ID_NOPE;
+	m_counter = 0;
+	m_params.clear();
+	m_arrays.m_cArrays.clear();
+	m_arrays.m_iArrays.clear();
+	m_binary = false;
+	m_tstamp = 0;
+}
+
+void qSim_qasm_message::set_content(QASM_MSG_COUNTER_TYPE counter, QASM_MSG_ID_TYPE id,
+									QASM_MSG_PARAMS_TYPE params, QASM_MSG_ARRAYS_TYPE arrays) {
+	// set class attributes - encoding and arrival time left as they are
+	m_counter = counter;
+	m_id = id;
+	m_params = std::move(params);
+	m_arrays = std::move(arrays);
+}
+
 // ------------------------------------------------------
 
 void qSim_qasm_message::add_param_tagValue(std::string par_tag, std::string par_val) {
 	m_params.insert(std::make_pair(par_tag, par_val));
 }
 
+bool qSim_qasm_message::get_param_arrayByTag(std::string par_tag, QASM_MSG_CARRAY_TYPE* par_val) {
+	// return raw complex array param - if present
+	std::map<std::string, QASM_MSG_CARRAY_TYPE>::iterator it = m_arrays.m_cArrays.find(par_tag);
+	if (it == m_arrays.m_cArrays.end())
+		return false;
+	*par_val = it->second;
+	return true;
+}
+
+bool qSim_qasm_message::get_param_arrayByTag(std::string par_tag, QASM_MSG_IARRAY_TYPE* par_val) {
+	// return raw integer array param - if present
+	std::map<std::string, QASM_MSG_IARRAY_TYPE>::iterator it = m_arrays.m_iArrays.find(par_tag);
+	if (it == m_arrays.m_iArrays.end())
+		return false;
+	*par_val = it->second;
+	return true;
+}
+
 // ------------------------------------------------------
 // content syntax checking
 bool qSim_qasm_message::check_syntax() {
@@ -111,6 +228,19 @@ bool qSim_qasm_message::check_syntax() {
 		}
 		break;
 
+		case QASM_MSG_ID_STATS: {
+			// params:
+			// (1) token = <value>
+			// (2) reset flag = <value> - optional
+			// (3) timeline dump flag = <value> - optional
+			//
+			if (m_params.count(QASM_MSG_PARAM_TAG_CLIENT_TOKEN) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_CLIENT_TOKEN);
+				res = false;
+			}
+		}
+		break;
+
 		// --------------------
 
 		case QASM_MSG_ID_QREG_ALLOCATE: {
@@ -167,6 +297,8 @@ bool qSim_qasm_message::check_syntax() {
 			// (3) qr_mQlen = <value>
 			// (4) qr_mRand = <value> (optional - random probability used as default)
 			// (5) qr_mStColl = <value> (optional - state collapse used as default)
+			// (6) qr_mShots = <value> (optional - sampled outcome counts returned if > 0, no state collapse)
+			// (7) qr_mSeed = <value> (optional - shots random seed, non-deterministic as default)
 			//
 			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
 				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
@@ -238,9 +370,79 @@ bool qSim_qasm_message::check_syntax() {
 
 		// --------------------
 
+		case QASM_MSG_ID_QREG_ST_TRANSFORM_BATCH: {
+			// params:
+			// (1) qr_h = <value>
+			// (2) qr_bN = <value>
+			// (3) per-item transformation params, tagged as <par_tag>#<item_idx>
+			//     (checked in the instruction classes!)
+			//
+			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
+				res = false;
+			}
+			else if (m_params.count(QASM_MSG_PARAM_TAG_QREG_BN) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_BN);
+				res = false;
+			}
+		}
+		break;
+
+		// --------------------
+
+		case QASM_MSG_ID_QREG_ST_GRADIENT: {
+			// params:
+			// (1) qr_h = <value>
+			// (2) f_type = <value> (q-net QML block)
+			// (3) q-net block params (checked in the instruction classes!)
+			// (4) qr_exStIdx, qr_exQidx, qr_exQlen, qr_exObsOp = <value> (optional - as for
+			//     state expectation)
+			//
+			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
+				res = false;
+			}
+			else if (m_params.count(QASM_MSG_PARAM_TAG_F_TYPE) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_F_TYPE);
+				res = false;
+			}
+		}
+		break;
+
+		// --------------------
+
+		case QASM_MSG_ID_QREG_CLONE: {
+			// params:
+			// (1) qr_h = <value> (source qureg)
+			// (2) qr_clH = <value> (optional - existing target qureg, new qureg if not given)
+			//
+			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
+				res = false;
+			}
+		}
+		break;
+
+		case QASM_MSG_ID_QREG_ST_SNAPSHOT:
+		case QASM_MSG_ID_QREG_ST_RESTORE: {
+			// params:
+			// (1) qr_h = <value>
+			//
+			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
+				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
+				res = false;
+			}
+		}
+		break;
+
+		// --------------------
+
 		case QASM_MSG_ID_QREG_ST_PEEK: {
 			// params:
 			// (1) qr_h = <value>
+			// (2) qr_stOffs, qr_stCnt = <value> (optional - states page, whole state vector
+			//     if not given)
+			// (3) qr_stTopK = <value> (optional - k most probable states, with their indexes)
 			//
 			if (m_params.count(QASM_MSG_PARAM_TAG_QREG_H) == 0) {
 				log_missing_param_tag(QASM_MSG_PARAM_TAG_QREG_H);
@@ -270,6 +472,14 @@ bool qSim_qasm_message::check_syntax() {
 //	 <params> = <par_tag_1>=<par_value_1>:<par_tag_2>=<par_value_2>: ... <par_tag_n>=<par_value_n>:
 
 void qSim_qasm_message::from_char_array(unsigned int len, char* buf) {
+	// check for binary encoding first
+	m_binary = ((len >= 2) && ((unsigned char)buf[0] == QASM_MSG_BIN_MAGIC_0) &&
+			                  ((unsigned char)buf[1] == QASM_MSG_BIN_MAGIC_1));
+	if (m_binary) {
+		from_binary_array(len, buf);
+		return;
+	}
+
 	// extract counter, id and parameters from given string
 	std::string bufStr = std::string(buf); // input buffer cloned not to modify it
 
@@ -320,6 +530,10 @@ void qSim_qasm_message::from_char_array(unsigned int len, char* buf) {
 void qSim_qasm_message::to_char_array(unsigned int* len, char** buf) {
 	// compact counter, id and params into a string
 	// => Note: output buffer allocated in the method
+	if (m_binary) {
+		to_binary_array(len, buf);
+		return;
+	}
 
 	// convert fields to string and concatenate
 	std::string bufStr = to_string(m_counter);
@@ -341,6 +555,173 @@ void qSim_qasm_message::to_char_array(unsigned int* len, char** buf) {
 	(*buf)[bufStr.size()] = '\0';
 }
 
+// ------------------------------------------------------
+// binary encoding/decoding
+
+void qSim_qasm_message::from_binary_array(unsigned int len, char* buf) {
+	// extract header fields
+	if ((len < QASM_MSG_BIN_HEADER_SIZE) || ((unsigned char)buf[2] != QASM_MSG_BIN_VERSION)) {
+		cerr << "qSim_qasm_message::from_binary_array - wrong header format!" << endl;
+		return;
+	}
+	uint32_t par_count;
+	memcpy(&m_counter, buf+4, 4);
+	memcpy(&m_id, buf+8, 4);
+	memcpy(&par_count, buf+12, 4);
+
+	// get parameters
+	m_params.clear();
+	m_arrays = QASM_MSG_ARRAYS_TYPE();
+	unsigned int idx = QASM_MSG_BIN_HEADER_SIZE;
+	for (uint32_t i=0; i<par_count; i++) {
+		// get param header
+		if (idx + QASM_MSG_BIN_PARAM_HEADER_SIZE > len) {
+			cerr << "qSim_qasm_message::from_binary_array - wrong parameter format!" << endl;
+			m_id = QASM_MSG_ID_NOPE;
+			return;
+		}
+		uint16_t tag, item;
+		uint32_t val_len;
+		memcpy(&tag, buf+idx, 2);
+		memcpy(&item, buf+idx+2, 2);
+		unsigned char val_type = (unsigned char)buf[idx+4];
+		memcpy(&val_len, buf+idx+8, 4);
+		idx += QASM_MSG_BIN_PARAM_HEADER_SIZE;
+		if ((val_len > len - idx) || ((tag != QASM_MSG_BIN_TAG_NULL) && (tag >= QASM_MSG_BIN_TOT_TAGS))) {
+			cerr << "qSim_qasm_message::from_binary_array - wrong parameter tag-value format!" << endl;
+			m_id = QASM_MSG_ID_NOPE;
+			return;
+		}
+		char* val_buf = buf+idx;
+		idx += val_len;
+
+		// resolve param tag - inline for null tag
+		std::string par_tag;
+		if (tag != QASM_MSG_BIN_TAG_NULL)
+			par_tag = QASM_MSG_BIN_TAGS[tag];
+		else {
+			char* sep = (char*)memchr(val_buf, QASM_MSG_PARVAL_SEP[0], val_len);
+			if (sep == NULL) {
+				cerr << "qSim_qasm_message::from_binary_array - wrong parameter tag format!" << endl;
+				m_id = QASM_MSG_ID_NOPE;
+				return;
+			}
+			par_tag = std::string(val_buf, sep-val_buf);
+			val_len -= (sep-val_buf)+1;
+			val_buf = sep+1;
+		}
+		if (item != QASM_MSG_BIN_ITEM_NULL)
+			par_tag += QASM_MSG_BATCH_IDX_SEP + to_string(item);
+
+		// extract param value
+		switch (val_type) {
+			case QASM_MSG_BIN_VAL_STR:
+				m_params.insert(std::make_pair(par_tag, std::string(val_buf, val_len)));
+				break;
+
+			case QASM_MSG_BIN_VAL_CARRAY: {
+				QASM_MSG_CARRAY_TYPE* arr = &m_arrays.m_cArrays[par_tag];
+				arr->resize(val_len/sizeof(std::complex<double>));
+				memcpy(arr->data(), val_buf, arr->size()*sizeof(std::complex<double>));
+			}
+			break;
+
+			case QASM_MSG_BIN_VAL_IARRAY: {
+				QASM_MSG_IARRAY_TYPE* arr = &m_arrays.m_iArrays[par_tag];
+				arr->resize(val_len/sizeof(int64_t));
+				memcpy(arr->data(), val_buf, arr->size()*sizeof(int64_t));
+			}
+			break;
+
+			default:
+				cerr << "qSim_qasm_message::from_binary_array - unhandled value type "
+				     << (int)val_type << " for parameter [" << par_tag << "]!" << endl;
+				m_id = QASM_MSG_ID_NOPE;
+				return;
+		}
+	}
+}
+
+void qSim_qasm_message::to_binary_array(unsigned int* len, char** buf) {
+	// size output buffer first
+	// => Note: output buffer allocated in the method
+	unsigned int tot_len = QASM_MSG_BIN_HEADER_SIZE;
+	std::map<std::string, QASM_MSG_CARRAY_TYPE>::iterator itc;
+	std::map<std::string, QASM_MSG_IARRAY_TYPE>::iterator iti;
+	QASM_MSG_PARAMS_TYPE::iterator it;
+	for (it=m_params.begin(); it!=m_params.end(); it++)
+		tot_len += QASM_MSG_BIN_PARAM_HEADER_SIZE + it->first.size()+1 + it->second.size(); // worst case, null tag
+	for (itc=m_arrays.m_cArrays.begin(); itc!=m_arrays.m_cArrays.end(); itc++)
+		tot_len += QASM_MSG_BIN_PARAM_HEADER_SIZE + itc->first.size()+1 + itc->second.size()*sizeof(std::complex<double>);
+	for (iti=m_arrays.m_iArrays.begin(); iti!=m_arrays.m_iArrays.end(); iti++)
+		tot_len += QASM_MSG_BIN_PARAM_HEADER_SIZE + iti->first.size()+1 + iti->second.size()*sizeof(int64_t);
+
+	*buf = new char[tot_len+1];
+	char* p = *buf;
+
+	// fill-in header
+	uint32_t par_count = m_params.size() + m_arrays.m_cArrays.size() + m_arrays.m_iArrays.size();
+	memset(p, 0, QASM_MSG_BIN_HEADER_SIZE);
+	p[0] = (char)QASM_MSG_BIN_MAGIC_0;
+	p[1] = (char)QASM_MSG_BIN_MAGIC_1;
+	p[2] = (char)QASM_MSG_BIN_VERSION;
+	memcpy(p+4, &m_counter, 4);
+	memcpy(p+8, &m_id, 4);
+	memcpy(p+12, &par_count, 4);
+	p += QASM_MSG_BIN_HEADER_SIZE;
+
+	// fill-in params - tag resolved to binary tag and batch item index
+	auto put_param = [&p](std::string par_tag, unsigned char val_type, const char* val_buf, uint32_t val_len) {
+		uint16_t item = QASM_MSG_BIN_ITEM_NULL;
+		size_t sep_idx = par_tag.find(QASM_MSG_BATCH_IDX_SEP);
+		if (sep_idx != std::string::npos) {
+			// item index suffix - left inside tag if not a valid binary item index
+			char* end_ptr;
+			long k = strtol(par_tag.c_str()+sep_idx+1, &end_ptr, 10);
+			if ((*end_ptr == '\0') && (k >= 0) && (k < QASM_MSG_BIN_ITEM_NULL)) {
+				item = (uint16_t)k;
+				par_tag = par_tag.substr(0, sep_idx);
+			}
+		}
+		int b_tag = get_binary_tag(par_tag);
+		uint16_t tag = (b_tag >= 0) ? b_tag : QASM_MSG_BIN_TAG_NULL;
+		uint32_t tot_val_len = (b_tag >= 0) ? val_len : par_tag.size()+1+val_len;
+
+		memset(p, 0, QASM_MSG_BIN_PARAM_HEADER_SIZE);
+		memcpy(p, &tag, 2);
+		memcpy(p+2, &item, 2);
+		p[4] = (char)val_type;
+		memcpy(p+8, &tot_val_len, 4);
+		p += QASM_MSG_BIN_PARAM_HEADER_SIZE;
+		if (b_tag < 0) {
+			memcpy(p, par_tag.data(), par_tag.size());
+			p += par_tag.size();
+			*p++ = QASM_MSG_PARVAL_SEP[0];
+		}
+		memcpy(p, val_buf, val_len);
+		p += val_len;
+	};
+	for (it=m_params.begin(); it!=m_params.end(); it++)
+		put_param(it->first, QASM_MSG_BIN_VAL_STR, it->second.data(), it->second.size());
+	for (itc=m_arrays.m_cArrays.begin(); itc!=m_arrays.m_cArrays.end(); itc++)
+		put_param(itc->first, QASM_MSG_BIN_VAL_CARRAY, (const char*)itc->second.data(),
+				  itc->second.size()*sizeof(std::complex<double>));
+	for (iti=m_arrays.m_iArrays.begin(); iti!=m_arrays.m_iArrays.end(); iti++)
+		put_param(iti->first, QASM_MSG_BIN_VAL_IARRAY, (const char*)iti->second.data(),
+				  iti->second.size()*sizeof(int64_t));
+
+	*len = p - *buf;
+	(*buf)[*len] = '\0';
+}
+
+int qSim_qasm_message::get_binary_tag(std::string par_tag) {
+	// look-up given tag in binary tags table - -1 if not found
+	for (int i=0; i<QASM_MSG_BIN_TOT_TAGS; i++)
+		if (par_tag == QASM_MSG_BIN_TAGS[i])
+			return i;
+	return -1;
+}
+
 // ------------------------------------------------------
 // error logging
 
@@ -357,6 +738,7 @@ void qSim_qasm_message::dump() {
 
 	cout << "m_counter: " << m_counter << endl;
 	cout << "m_id:      " << m_id << endl;
+	cout << "m_binary:  " << m_binary << endl;
 	cout << "m_params count:" << m_params.size() << endl;
 	QASM_MSG_PARAMS_TYPE::iterator it;
 	int i = 0;
@@ -368,6 +750,12 @@ void qSim_qasm_message::dump() {
 	        cout << "  # " << i << "  par_tag: " << it->first << "  par_val: " << it->second.substr(0, 100) << "..." << endl;	        
 	    i++;
 	}
+	std::map<std::string, QASM_MSG_CARRAY_TYPE>::iterator itc;
+	for (itc=m_arrays.m_cArrays.begin(); itc!=m_arrays.m_cArrays.end(); itc++)
+		cout << "  # " << i++ << "  par_tag: " << itc->first << "  par_val: <complex array - size " << itc->second.size() << ">" << endl;
+	std::map<std::string, QASM_MSG_IARRAY_TYPE>::iterator iti;
+	for (iti=m_arrays.m_iArrays.begin(); iti!=m_arrays.m_iArrays.end(); iti++)
+		cout << "  # " << i++ << "  par_tag: " << iti->first << "  par_val: <integer array - size " << iti->second.size() << ">" << endl;
 	cout << endl;
 	cout << "**********************************" << endl << endl;
 }
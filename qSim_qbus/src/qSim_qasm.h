@@ -46,6 +46,18 @@
  *  1.3   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
  *                   Handled QML function blocks (feature map and q-net).
+ *  1.4   Oct-2026   Supported qureg transformation batch message.
+ *  1.5   Oct-2026   Supported binary message encoding (negotiated at client
+ *                   registration), with integer parameter tags and raw state arrays.
+ *  1.6   Oct-2026   Supported qureg state measurement shots (sampled outcome counts).
+ *  1.7   Oct-2026   Added message content reset, for recycling message objects.
+ *  1.8   Oct-2026   Supported batched quregs (per-sample measure and expectation results).
+ *  1.9   Oct-2026   Supported qureg q-net gradient message (parameter-shift rule).
+ *  1.10  Oct-2026   Supported qureg clone and state snapshot/restore messages.
+ *  1.11  Oct-2026   Supported qureg state paged peek and top-k states peek parameters.
+ *  1.12  Oct-2026   Supported server statistics control message, and message arrival time
+ *                   (queue wait statistics).
+ *  1.13  Oct-2026   Added message content setup, for recycled response messages.
  *
  *  --------------------------------------------------------------------------
  */
@@ -55,6 +67,9 @@
 
 #include <map>
 #include <string>
+#include <vector>
+#include <complex>
+#include <cstdint>
 
 
 ///////////////////////////////////////////////////////////////////////////
@@ -65,6 +80,7 @@
 #define QASM_MSG_ID_NOPE       0
 #define QASM_MSG_ID_REGISTER   1
 #define QASM_MSG_ID_UNREGISTER 2
+#define QASM_MSG_ID_STATS      3	// server execution statistics (and instruction timeline dump)
 
 // qureg handling instruction messages
 #define QASM_MSG_ID_QREG_ALLOCATE     10
@@ -75,14 +91,22 @@
 #define QASM_MSG_ID_QREG_ST_PEEK      15
 #define QASM_MSG_ID_QREG_ST_MEASURE   16
 #define QASM_MSG_ID_QREG_ST_EXPECT    17
+#define QASM_MSG_ID_QREG_ST_TRANSFORM_BATCH 18
+#define QASM_MSG_ID_QREG_ST_GRADIENT  19
 
 // message responses
 #define QASM_MSG_ID_RESPONSE 20
 
+// qureg copy instruction messages
+#define QASM_MSG_ID_QREG_CLONE        21
+#define QASM_MSG_ID_QREG_ST_SNAPSHOT  22
+#define QASM_MSG_ID_QREG_ST_RESTORE   23
+
 // message body separators
 #define QASM_MSG_FIELD_SEP "|"
 #define QASM_MSG_PARAM_SEP ":"
 #define QASM_MSG_PARVAL_SEP "="
+#define QASM_MSG_BATCH_IDX_SEP "#"	// batch item index suffix separator, as in <par_tag>#<item_idx>
 
 // message parameter tags
 #define QASM_MSG_PARAM_TAG_CLIENT_ID    "id"		// client mnemonic identifier
@@ -99,11 +123,32 @@
 #define QASM_MSG_PARAM_TAG_QREG_MSTIDX  "qr_mStIdx"	 // qureg measurement state index
 #define QASM_MSG_PARAM_TAG_QREG_MSTPR   "qr_mStPr"	 // qureg measurement state probability
 #define QASM_MSG_PARAM_TAG_QREG_MSTIDXS "qr_mStIdxs" // qureg measurement state index vector
+#define QASM_MSG_PARAM_TAG_QREG_MSHOTS  "qr_mShots"  // qureg measurement shots (# of sampled outcomes)
+#define QASM_MSG_PARAM_TAG_QREG_MSEED   "qr_mSeed"   // qureg measurement shots random seed
+#define QASM_MSG_PARAM_TAG_QREG_MCOUNTS "qr_mCounts" // qureg measurement shots outcome counts (index-count pairs)
 #define QASM_MSG_PARAM_TAG_QREG_EXSTIDX "qr_exStIdx" // qureg measurement state index
 #define QASM_MSG_PARAM_TAG_QREG_EXQIDX  "qr_exQidx"  // qureg state expectation start qubit
 #define QASM_MSG_PARAM_TAG_QREG_EXQLEN  "qr_exQlen"  // qureg state expectation length
 #define QASM_MSG_PARAM_TAG_QREG_EXOBSOP "qr_exObsOp" // qureg state expectation observable operator
 #define QASM_MSG_PARAM_TAG_QREG_EXSTVAL "qr_exStVal" // qureg state expectation value
+#define QASM_MSG_PARAM_TAG_QREG_BN      "qr_bN"      // qureg transformation batch size (# of items)
+#define QASM_MSG_PARAM_TAG_QREG_BDONE   "qr_bDone"   // qureg transformation batch executed items
+#define QASM_MSG_PARAM_TAG_QREG_SN       "qr_sN"        // batched qureg samples (# of state vectors)
+#define QASM_MSG_PARAM_TAG_QREG_SMSTIDXS "qr_sMStIdxs"  // batched qureg measured state index per sample
+#define QASM_MSG_PARAM_TAG_QREG_SMSTPRS  "qr_sMStPrs"   // batched qureg measured state probability per sample
+#define QASM_MSG_PARAM_TAG_QREG_SEXSTVALS "qr_sExStVals" // batched qureg state expectation value per sample
+#define QASM_MSG_PARAM_TAG_QREG_GRVALS  "qr_grVals"  // qureg state expectation gradient (q-net params derivatives)
+#define QASM_MSG_PARAM_TAG_QREG_CLH     "qr_clH"     // qureg clone target handler (existing qureg)
+#define QASM_MSG_PARAM_TAG_QREG_STOFFS  "qr_stOffs"  // qureg state peek page first state index
+#define QASM_MSG_PARAM_TAG_QREG_STCNT   "qr_stCnt"   // qureg state peek page size (# of states)
+#define QASM_MSG_PARAM_TAG_QREG_STTOPK  "qr_stTopK"  // qureg state peek of the k most probable states
+#define QASM_MSG_PARAM_TAG_QREG_STIDXS  "qr_stIdxs"  // qureg state peek state index vector (top-k states)
+
+#define QASM_MSG_PARAM_TAG_STATS_RESET   "st_reset"   // statistics reset flag (after reading)
+#define QASM_MSG_PARAM_TAG_STATS_TRACE   "st_trace"   // instruction timeline dump flag
+#define QASM_MSG_PARAM_TAG_STATS_VALS    "st_vals"    // statistics counters (stage, key, count, times, bytes)
+#define QASM_MSG_PARAM_TAG_STATS_ELAPSED "st_elapsed" // statistics collection time (nsec since last reset)
+#define QASM_MSG_PARAM_TAG_STATS_TRACEN  "st_traceN"  // instruction timeline dumped events
 
 #define QASM_MSG_PARAM_TAG_F_TYPE     "f_type"      // function type
 #define QASM_MSG_PARAM_TAG_F_SIZE     "f_size"		// # of function states
@@ -122,10 +167,35 @@
 #define QASM_MSG_PARAM_TAG_RESULT     "result"		// instruction result
 #define QASM_MSG_PARAM_TAG_ERROR      "error"		// instruction result error details
 
+#define QASM_MSG_PARAM_TAG_ENCODING   "enc"			// message encoding requested/granted at client registration
+
 // parameter values
 #define QASM_MSG_PARAM_VAL_OK  "Ok"
 #define QASM_MSG_PARAM_VAL_NOK "Not-Ok"
 
+#define QASM_MSG_PARAM_VAL_ENC_BIN "bin"	// binary encoding
+
+// binary encoding format (little-endian) - detected by magic bytes, text format otherwise
+//   <encoded_instruction> = <header><param_1> ... <param_n>
+//   <header> = <magic:2><version:1><reserved:1><counter:4><id:4><par_count:4>
+//   <param>  = <tag:2><item_idx:2><val_type:1><reserved:3><val_len:4><value:val_len>
+//
+// with tag as parameter index in binary tags table (or null tag, with "<par_tag>=" leading the value),
+// item index as batch item suffix (or null item) and value as raw string or raw array data
+#define QASM_MSG_BIN_MAGIC_0 0xB1
+#define QASM_MSG_BIN_MAGIC_1 0x51
+#define QASM_MSG_BIN_VERSION 1
+
+#define QASM_MSG_BIN_HEADER_SIZE 16
+#define QASM_MSG_BIN_PARAM_HEADER_SIZE 12
+
+#define QASM_MSG_BIN_TAG_NULL  0xFFFF
+#define QASM_MSG_BIN_ITEM_NULL 0xFFFF
+
+#define QASM_MSG_BIN_VAL_STR    0	// string value
+#define QASM_MSG_BIN_VAL_CARRAY 1	// complex array - real/imag double pairs
+#define QASM_MSG_BIN_VAL_IARRAY 2	// 64-bit integer array
+
 
 // -----------------------------------------------
 
@@ -136,6 +206,16 @@ typedef int QASM_MSG_ID_TYPE;
 typedef unsigned int QASM_MSG_COUNTER_TYPE;
 typedef std::map<std::string, std::string> QASM_MSG_PARAMS_TYPE;
 
+// raw array parameters - binary encoding only (string params used in text encoding)
+typedef std::vector<std::complex<double>> QASM_MSG_CARRAY_TYPE;
+typedef std::vector<int64_t> QASM_MSG_IARRAY_TYPE;
+
+struct qSim_qasm_message_arrays {
+	std::map<std::string, QASM_MSG_CARRAY_TYPE> m_cArrays;
+	std::map<std::string, QASM_MSG_IARRAY_TYPE> m_iArrays;
+};
+typedef qSim_qasm_message_arrays QASM_MSG_ARRAYS_TYPE;
+
 // -----------------------------------------------
 
 // QASM message handling class
@@ -145,7 +225,8 @@ public:
 	// constructors
 	qSim_qasm_message();
 	qSim_qasm_message(QASM_MSG_COUNTER_TYPE counter, QASM_MSG_ID_TYPE id,
-					  QASM_MSG_PARAMS_TYPE params=QASM_MSG_PARAMS_TYPE());
+					  QASM_MSG_PARAMS_TYPE params=QASM_MSG_PARAMS_TYPE(),
+					  QASM_MSG_ARRAYS_TYPE arrays=QASM_MSG_ARRAYS_TYPE());
 	virtual ~qSim_qasm_message();
 
 	// accessors
@@ -153,17 +234,41 @@ public:
 	QASM_MSG_ID_TYPE      get_id() 		{ return m_id; }
 	QASM_MSG_PARAMS_TYPE  get_params()	{ return m_params; }
 
-	bool is_control_message()     { return ((m_id==QASM_MSG_ID_REGISTER) || (m_id==QASM_MSG_ID_UNREGISTER)); }
-	bool is_instruction_message() { return ((m_id>=QASM_MSG_ID_QREG_ALLOCATE) && (m_id<=QASM_MSG_ID_QREG_ST_EXPECT)); }
+	bool is_control_message()     { return ((m_id==QASM_MSG_ID_REGISTER) || (m_id==QASM_MSG_ID_UNREGISTER) ||
+											(m_id==QASM_MSG_ID_STATS)); }
+	bool is_instruction_message() { return (((m_id>=QASM_MSG_ID_QREG_ALLOCATE) && (m_id<=QASM_MSG_ID_QREG_ST_GRADIENT)) ||
+										    ((m_id>=QASM_MSG_ID_QREG_CLONE) && (m_id<=QASM_MSG_ID_QREG_ST_RESTORE))); }
+	bool is_batch_message()       { return (m_id==QASM_MSG_ID_QREG_ST_TRANSFORM_BATCH); }
+
+	// encoding control
+	bool is_binary()              { return m_binary; }
+	void set_binary(bool binary)  { m_binary = binary; }
+
+	// arrival time (statistics monotonic clock, 0 if not set)
+	uint64_t get_tstamp()           { return m_tstamp; }
+	void set_tstamp(uint64_t tstamp) { m_tstamp = tstamp; }
 
 	// message parameters handling
-	bool check_param_valueByTag(std::string par_tag)      { return (m_params.count(par_tag) > 0); };
+	bool check_param_valueByTag(std::string par_tag)      { return ((m_params.count(par_tag) > 0) ||
+			                                                        (m_arrays.m_cArrays.count(par_tag) > 0) ||
+			                                                        (m_arrays.m_iArrays.count(par_tag) > 0)); };
 	std::string get_param_valueByTag(std::string par_tag) { return m_params[par_tag]; };
 	void add_param_tagValue(std::string par_tag, std::string par_val);
 
+	bool get_param_arrayByTag(std::string par_tag, QASM_MSG_CARRAY_TYPE* par_val);
+	bool get_param_arrayByTag(std::string par_tag, QASM_MSG_IARRAY_TYPE* par_val);
+
 	// content syntax checking
 	bool check_syntax();
 
+	// content reset - empty message, as newly constructed
+	void reset();
+
+	// content setup - recycled message filled as constructed with given values (containers
+	// moved in)
+	void set_content(QASM_MSG_COUNTER_TYPE counter, QASM_MSG_ID_TYPE id, QASM_MSG_PARAMS_TYPE params,
+					 QASM_MSG_ARRAYS_TYPE arrays=QASM_MSG_ARRAYS_TYPE());
+
 	// decoding/encoding from/to transmission raw format
 	void from_char_array(unsigned int len, char*);
 	void to_char_array(unsigned int* len, char**);
@@ -176,6 +281,15 @@ protected:
 	QASM_MSG_ID_TYPE m_id;
 	QASM_MSG_COUNTER_TYPE m_counter;
 	QASM_MSG_PARAMS_TYPE m_params;
+	QASM_MSG_ARRAYS_TYPE m_arrays;
+	bool m_binary;
+	uint64_t m_tstamp;
+
+	// binary encoding support methods
+	void from_binary_array(unsigned int len, char*);
+	void to_binary_array(unsigned int* len, char**);
+
+	static int get_binary_tag(std::string par_tag);
 
 	// error logging
  	void log_missing_param_tag(std::string par_tag);
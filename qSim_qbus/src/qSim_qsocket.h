@@ -30,6 +30,7 @@
  *  1.1   May-2022   Rewritten for simplification and c++ standard classes use.
  *                   Handled client reconnection to server in transparent way.
  *                   Included loop thread as class method.
+ *  1.2   Oct-2026   Added missing atomic header include.
  *
  *  --------------------------------------------------------------------------
  */
@@ -39,6 +40,7 @@
 #define QSIM_QSOCKET_H_
 
 #include <thread>
+#include <atomic>
 #include <cstring>
 
 #ifndef _WIN32
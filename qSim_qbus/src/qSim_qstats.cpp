@@ -0,0 +1,196 @@
+/*
+ * qSim_qstats.cpp
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-STATS support module, collecting server wide execution statistics.
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled device kernels timing enabling flag.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+using namespace std;
+
+#include "qSim_qstats.h"
+
+
+// stage counters - one slot per key, updated with relaxed atomics (no lock on recording)
+struct qSim_qstats_slot {
+	std::atomic<uint64_t> m_count;
+	std::atomic<uint64_t> m_tot;
+	std::atomic<uint64_t> m_max;
+	std::atomic<uint64_t> m_bytes;
+};
+
+static qSim_qstats_slot s_slots[QSTATS_STAGE_TOT][QSTATS_KEY_MAX+1];
+static std::atomic<uint64_t> s_reset_tm(qSim_qstats::now_ns());
+
+// instruction timeline events - recording thread as small sequential id
+struct qSim_qstats_event {
+	uint64_t m_start;
+	uint64_t m_dur;
+	int m_stage;
+	int m_key;
+	int m_tid;
+};
+
+static std::atomic<bool> s_device_on(false);
+static std::atomic<bool> s_trace_on(false);
+static std::string s_trace_file;
+static std::vector<qSim_qstats_event> s_trace_events;
+static std::mutex s_trace_mutex;
+static std::atomic<int> s_trace_tid(0);
+
+static const char* s_stage_names[QSTATS_STAGE_TOT] = {
+	"decode", "queue", "dispatch", "transform", "device", "sync", "encode"
+};
+
+// -------------------------------------
+
+uint64_t qSim_qstats::now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void qSim_qstats::record(QSTATS_STAGE_TYPE stage, int key, uint64_t t_start, uint64_t bytes) {
+	record_duration(stage, key, t_start, now_ns() - t_start, bytes);
+}
+
+void qSim_qstats::record_duration(QSTATS_STAGE_TYPE stage, int key, uint64_t t_start, uint64_t dur,
+								  uint64_t bytes) {
+	// update stage key counters - keys out of range on last slot
+	int k = std::max(0, std::min(QSTATS_KEY_MAX, key+1));
+	qSim_qstats_slot* slot = &s_slots[stage][k];
+	slot->m_count.fetch_add(1, std::memory_order_relaxed);
+	slot->m_tot.fetch_add(dur, std::memory_order_relaxed);
+	slot->m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+	uint64_t d_max = slot->m_max.load(std::memory_order_relaxed);
+	while ((dur > d_max) && !slot->m_max.compare_exchange_weak(d_max, dur, std::memory_order_relaxed));
+
+	// timeline event - if enabled
+	if (s_trace_on.load(std::memory_order_relaxed)) {
+		static thread_local int tid = ++s_trace_tid;
+		std::lock_guard<std::mutex> lock(s_trace_mutex);
+		if (s_trace_events.size() < QSTATS_TRACE_MAX_EVENTS)
+			s_trace_events.push_back({t_start, dur, stage, k-1, tid});
+	}
+}
+
+std::string qSim_qstats::to_string() {
+	// used keys only, as "<stage>,<key>,<count>,<tot_ns>,<max_ns>,<bytes>" items
+	std::string str;
+	for (int s=0; s<QSTATS_STAGE_TOT; s++) {
+		for (int k=0; k<=QSTATS_KEY_MAX; k++) {
+			qSim_qstats_slot* slot = &s_slots[s][k];
+			uint64_t count = slot->m_count.load(std::memory_order_relaxed);
+			if (count == 0)
+				continue;
+			if (str.length() > 0)
+				str += ";";
+			str += std::string(s_stage_names[s]) + "," + std::to_string(k-1) + "," + std::to_string(count) + "," +
+				   std::to_string(slot->m_tot.load(std::memory_order_relaxed)) + "," +
+				   std::to_string(slot->m_max.load(std::memory_order_relaxed)) + "," +
+				   std::to_string(slot->m_bytes.load(std::memory_order_relaxed));
+		}
+	}
+	return str;
+}
+
+uint64_t qSim_qstats::elapsed_ns() {
+	return now_ns() - s_reset_tm.load();
+}
+
+void qSim_qstats::reset() {
+	// clear counters - records in progress meanwhile may be kept partially
+	for (int s=0; s<QSTATS_STAGE_TOT; s++) {
+		for (int k=0; k<=QSTATS_KEY_MAX; k++) {
+			s_slots[s][k].m_count = 0;
+			s_slots[s][k].m_tot = 0;
+			s_slots[s][k].m_max = 0;
+			s_slots[s][k].m_bytes = 0;
+		}
+	}
+	s_reset_tm = now_ns();
+}
+
+// -------------------------------------
+
+void qSim_qstats::device_enable(bool on) {
+	s_device_on = on;
+}
+
+bool qSim_qstats::device_enabled() {
+	return s_device_on.load(std::memory_order_relaxed);
+}
+
+void qSim_qstats::trace_enable(std::string file_name) {
+	std::lock_guard<std::mutex> lock(s_trace_mutex);
+	s_trace_file = file_name;
+	s_trace_on = true;
+	s_device_on = true;
+}
+
+bool qSim_qstats::trace_enabled() {
+	return s_trace_on;
+}
+
+bool qSim_qstats::trace_dump(std::string* file_name, uint64_t* tot_events) {
+	// write timeline to its file (Chrome trace event format, complete events in usec)
+	std::lock_guard<std::mutex> lock(s_trace_mutex);
+	*file_name = s_trace_file;
+	*tot_events = s_trace_events.size();
+	if (!s_trace_on)
+		return false;
+
+	FILE* f = fopen(s_trace_file.c_str(), "w");
+	if (f == NULL) {
+		cerr << "qSim_qstats::trace_dump - file [" << s_trace_file << "] opening failed!!" << endl;
+		return false;
+	}
+	fprintf(f, "{\"traceEvents\": [\n");
+	for (size_t i=0; i<s_trace_events.size(); i++) {
+		qSim_qstats_event* ev = &s_trace_events[i];
+		fprintf(f, "{\"name\": \"%s %d\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+				"\"pid\": 1, \"tid\": %d}%s\n", s_stage_names[ev->m_stage], ev->m_key, s_stage_names[ev->m_stage],
+				ev->m_start / 1e3, ev->m_dur / 1e3, ev->m_tid, (i+1 < s_trace_events.size()) ? "," : "");
+	}
+	fprintf(f, "]}\n");
+	fclose(f);
+	return true;
+}
+
+const char* qSim_qstats::stage_name(int stage) {
+	return ((stage >= 0) && (stage < QSTATS_STAGE_TOT)) ? s_stage_names[stage] : "";
+}
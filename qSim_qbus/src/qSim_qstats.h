@@ -0,0 +1,102 @@
+/*
+ * qSim_qstats.h
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-STATS support module, collecting server wide execution statistics on the message
+ * processing stages (decode, queue wait, dispatch, device kernels, host/device sync and
+ * encode), keyed by message id or gate function type:
+ * - lock-free counters (count, total and max time, bytes), always on - device kernels timing
+ *   only if enabled (GPU events recorded around each transformation)
+ * - optional instruction timeline (Chrome trace format), enabled at start-up and dumped
+ *   on request to its file
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled device kernels timing enabling flag.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#ifndef QSIM_QSTATS_H_
+#define QSIM_QSTATS_H_
+
+#include <string>
+#include <cstdint>
+
+// processing stages - stage key as message id (decode, queue, dispatch, encode), gate function
+// type (transform, device - QSTATS_KEY_DENSE for fused dense unitaries) or copy direction (sync)
+enum QSTATS_STAGE_TYPE {
+	QSTATS_STAGE_DECODE = 0,	// raw message decoding (bytes decoded)
+	QSTATS_STAGE_QUEUE,			// instruction wait, from decoding to dispatching
+	QSTATS_STAGE_DISPATCH,		// instruction execution, from dispatching to response
+	QSTATS_STAGE_TRANSFORM,		// transformation instruction execution
+	QSTATS_STAGE_DEVICE,		// device kernels (CUDA events on GPU)
+	QSTATS_STAGE_SYNC,			// host/device state copies (bytes copied)
+	QSTATS_STAGE_ENCODE,		// raw message encoding (bytes encoded)
+	QSTATS_STAGE_TOT
+};
+
+#define QSTATS_KEY_DENSE     -1	// device key for fused dense unitaries (no gate type)
+#define QSTATS_KEY_SYNC_D2H  0	// sync key for device to host copies
+#define QSTATS_KEY_SYNC_H2D  1	// sync key for host to device copies
+
+// stage keys range - [-1, QSTATS_KEY_MAX), keys out of range collected on the last one
+#define QSTATS_KEY_MAX 255
+
+// max events recorded in the instruction timeline - further events discarded
+#define QSTATS_TRACE_MAX_EVENTS (1 << 20)
+
+class qSim_qstats {
+public:
+	// monotonic clock (nsec)
+	static uint64_t now_ns();
+
+	// stage execution record - from given start time to now, or with given duration
+	static void record(QSTATS_STAGE_TYPE stage, int key, uint64_t t_start, uint64_t bytes=0);
+	static void record_duration(QSTATS_STAGE_TYPE stage, int key, uint64_t t_start, uint64_t dur,
+								uint64_t bytes=0);
+
+	// collected counters as string, i.e. "<stage>,<key>,<count>,<tot_ns>,<max_ns>,<bytes>" items
+	// separated by ";" (used keys only), and time since last reset (nsec)
+	static std::string to_string();
+	static uint64_t elapsed_ns();
+	static void reset();
+
+	// device kernels timing - disabled by default (no device stage records), enabled at start-up
+	// or with the instruction timeline
+	static void device_enable(bool on);
+	static bool device_enabled();
+
+	// instruction timeline - enabled on given file (device kernels timing too), dumped on
+	// request (events kept)
+	static void trace_enable(std::string file_name);
+	static bool trace_enabled();
+	static bool trace_dump(std::string* file_name, uint64_t* tot_events);
+
+	// stage name
+	static const char* stage_name(int stage);
+};
+
+#endif /* QSIM_QSTATS_H_ */
@@ -41,6 +41,24 @@ Created on Sat May 28 21:58:57 2022
 *                 Supported qureg state expectations calculation.
 *                 Handled QML function blocks (feature map and q-net).
 *                 Supported diagnostic flag for getting message size info.
+* 1.3   Oct-2026  Supported qureg transformation batches (many transformations
+*                 in a single message round trip).
+* 1.4   Oct-2026  Supported binary message encoding, requested at registration
+*                 and used when granted by qSim server (text encoding otherwise).
+* 1.5   Oct-2026  Supported qureg state measurement shots (sampled outcome counts
+*                 returned as a dictionary).
+* 1.6   Oct-2026  Supported batched quregs (samples number at allocation, per-sample
+*                 measurement and expectation results).
+* 1.7   Oct-2026  Supported q-net gradient (state expectation and its derivatives by
+*                 the q-net params returned in a single message round trip).
+* 1.8   Oct-2026  Supported qureg clone and state snapshot/restore (server-side
+*                 device copies, no state transfer).
+* 1.9   Oct-2026  Supported qureg state paged peek (states index range) and top-k
+*                 most probable states peek (with their indexes).
+* 1.10  Oct-2026  Supported server statistics (per stage counters, optional reset
+*                 and instruction timeline dump on server file).
+* 1.11  Oct-2026  Handled batched measurement and expectation results of single
+*                 sample quregs (plain results returned by the server).
 * 
 * ------------------------------------------------------------------------
 *
@@ -64,13 +82,17 @@ import qSim_qcln_qasm as qasm
 # ==> qSim access client handling
 class qSim_qcln_access_client(): 
    
-    def __init__(self, id_mnem='qSim-qcln-client', verbose=False):
+    def __init__(self, id_mnem='qSim-qcln-client', verbose=False, binary=True):
         # class constructor 
         self.m_qsock = None
         self.m_token = None
         self.m_id = id_mnem
         self.m_counter = 1
         
+        # message encoding - binary requested at registration, text until granted
+        self.m_binary_req = binary
+        self.m_binary = False
+        
         self.m_verbose = verbose
     
     # ------------------
@@ -79,8 +101,9 @@ class qSim_qcln_access_client():
         # setup connection to qSim server
         # and perform client registration for getting the token
 
-        # reset token
+        # reset token and encoding
         self.m_token = None
+        self.m_binary = False
 
         # socket client setup
         self.m_qsock = qsock.qSim_qcln_socket()
@@ -95,22 +118,19 @@ class qSim_qcln_access_client():
         msg_reg.m_counter = 0 # not used here
         msg_reg.m_id = qasm.QASM_MSG_ID_REGISTER
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_ID, self.m_id)
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        if self.m_binary_req:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_ENCODING, qasm.QASM_MSG_PARAM_VAL_ENC_BIN)
+        self.send_message(msg_reg)
         if self.m_verbose:
             print('qSim-access - registration request sent - id:', self.m_id)
             msg_reg.dump()
-            print('raw_msg:', raw_msg)
             print()
 
         # (2) read response 
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         if self.m_verbose:
             print('qSim-access - server registration response received')
             msg_res.dump()
-            print('raw_msg:', raw_msg)
             print()
 
         # (3) check result and extract token
@@ -118,8 +138,11 @@ class qSim_qcln_access_client():
         if res:
             # request ok - get token
             self.m_token = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_TOKEN)
+            # switch to binary encoding - if granted
+            enc = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_ENCODING)
+            self.m_binary = (enc == qasm.QASM_MSG_PARAM_VAL_ENC_BIN)
             if self.m_verbose:
-                print('qSim-access - registration OK - token:', self.m_token)
+                print('qSim-access - registration OK - token:', self.m_token, '- binary:', self.m_binary)
         return res
     
     def disconnect(self):
@@ -132,8 +155,7 @@ class qSim_qcln_access_client():
         msg_reg.m_counter = 0 # not used here
         msg_reg.m_id = qasm.QASM_MSG_ID_UNREGISTER
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        self.send_message(msg_reg)
         if self.m_verbose:
             print('qSim-access - deregistration request sent - token:', self.m_token)
 
@@ -141,9 +163,7 @@ class qSim_qcln_access_client():
         self.m_token = None
         
         # (2) read response for a clean disconnection - not mandatory
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
 
         # socket client release
         self.m_qsock.disconnect() 
@@ -153,13 +173,49 @@ class qSim_qcln_access_client():
     def isConnected(self):
         # check is the client is connected and ready to go
         return not (self.m_token is None)
+
+    def server_stats(self, reset=False, trace=False):
+        # get server statistics - per stage counters as {(stage, key): (count, tot_ns, max_ns, bytes)},
+        # collection time (nsec) and dumped timeline events (if requested, None otherwise)
+
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = 0 # not used here
+        msg_reg.m_id = qasm.QASM_MSG_ID_STATS
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_STATS_RESET, '1' if reset else '0')
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_STATS_TRACE, '1' if trace else '0')
+        self.send_message(msg_reg)
+        if self.m_verbose:
+            print('qSim-access - statistics request sent - reset:', reset, 'trace:', trace)
+
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if not res:
+            print('ERROR - statistics request failed!!!')
+            return None, None, None
+
+        st_vals = {}
+        st_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_STATS_VALS)
+        if st_str:
+            for st_item in st_str.split(';'):
+                st_fields = st_item.split(',')
+                st_vals[(st_fields[0], int(st_fields[1]))] = tuple(int(v) for v in st_fields[2:6])
+        st_elapsed = int(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_STATS_ELAPSED))
+        st_traceN = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_STATS_TRACEN)
+        if not st_traceN is None:
+            st_traceN = int(st_traceN)
+        if self.m_verbose:
+            print('qSim-access - statistics OK - items:', len(st_vals), 'elapsed (nsec):', st_elapsed)
+        return st_vals, st_elapsed, st_traceN
             
     # --------------------------------------------------------------
     # --------------------------------------------------------------
     # message reception and transmission - all cases handled
     
-    def qreg_allocate(self, qn):
-        # allocate qureg of given size
+    def qreg_allocate(self, qn, sn=None):
+        # allocate qureg of given size - batched qureg if samples number given
         
         # send message
         msg_reg = qasm.qSim_qcln_qasm()
@@ -167,16 +223,15 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ALLOCATE
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_QN, str(qn))
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        if not sn is None:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_SN, str(sn))
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
-            print('qSim-access - qureg allocation request sent - qn:', qn)
+            print('qSim-access - qureg allocation request sent - qn:', qn, 'sn:', sn)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok - get qreg handler
@@ -199,16 +254,13 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_RELEASE
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg release request sent - qr_h:', qr_h)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok 
@@ -218,6 +270,89 @@ class qSim_qcln_access_client():
 
     # -------
     
+    def qreg_clone(self, qr_h, qr_clH=None):
+        # clone given qureg handler - into a new qureg if no target handler given,
+        # otherwise into the given existing qureg (same size)
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_CLONE
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        if not qr_clH is None:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_CLH, str(qr_clH))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg clone request sent - qr_h:', qr_h, 'qr_clH:', qr_clH)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get clone qreg handler
+            qr_clH = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_H)
+            if self.m_verbose:
+                print('qSim-access - qreg clone OK - qr_clH:', qr_clH)
+        else:
+            print('ERROR - qureg clone failed!!!')
+            qr_clH = None
+        return qr_clH
+
+    # -------
+    
+    def qreg_state_snapshot(self, qr_h):
+        # snapshot state for given qureg handler (kept on server, replacing the previous one)
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_SNAPSHOT
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg state snapshot request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok 
+            if self.m_verbose:
+                print('qSim-access - qreg state snapshot OK')
+        return res
+
+    # -------
+    
+    def qreg_state_restore(self, qr_h):
+        # restore last state snapshot for given qureg handler (snapshot kept for
+        # further restores)
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_RESTORE
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg state restore request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok 
+            if self.m_verbose:
+                print('qSim-access - qreg state restore OK')
+        return res
+
+    # -------
+    
     def qreg_state_reset(self, qr_h):
         # reset state for given qureg handler
         
@@ -227,16 +362,13 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_RESET
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state reset request sent - qr_h:', qr_h)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok 
@@ -259,19 +391,20 @@ class qSim_qcln_access_client():
             st_idx_str = str(st_idx)
             msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STIDX, st_idx_str)            
         elif not st_vals is None:
-            st_vals_str = self.states_complex_2_string(st_vals)
-            # print('st_vals:', st_vals, '-> st_vals_str:', st_vals_str)
-            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS, st_vals_str)
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+            if self.m_binary:
+                # raw complex array
+                msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS, np.asarray(st_vals, dtype=complex))
+            else:
+                st_vals_str = self.states_complex_2_string(st_vals)
+                # print('st_vals:', st_vals, '-> st_vals_str:', st_vals_str)
+                msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS, st_vals_str)
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state set request sent - qr_h:', qr_h)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok 
@@ -284,9 +417,6 @@ class qSim_qcln_access_client():
     def qreg_state_transform(self, qr_h, f_type, f_size, f_rep, f_lsq, f_crng=[], f_trng=[], f_args=None, 
                              fu_type=qasm.QASM_F_TYPE_NULL, fu_size=0, diag=False):
         # print('qreg_state_transform...f_args:', f_args)
-        if qasm.QASM_F_IS_Q2(fu_type):
-            # remove arg #3 (qureg size - not needed for QASM!!)
-            f_args = f_args[:2]
         
         # prepare message
         msg_reg = qasm.qSim_qcln_qasm()
@@ -294,28 +424,19 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_TRANSFORM
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_TYPE, str(f_type))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_SIZE, str(f_size))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_REP, str(f_rep))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_LSQ, str(f_lsq))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_CRANGE, self.index_range_to_string(f_crng))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_TRANGE, self.index_range_to_string(f_trng))
-        if fu_type != qasm.QASM_F_TYPE_NULL:
-            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_UTYPE, str(fu_type))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_ARGS, self.fargs_to_string(f_args, f_type, fu_type))
+        f_params = self.transform_params(f_type, f_size, f_rep, f_lsq, f_crng, f_trng, f_args, fu_type)
+        for p_key in f_params.keys():
+            msg_reg.add_param_tagValue(p_key, f_params[p_key])
         
         # send message
-        raw_msg1 = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg1)
+        raw_len1 = self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state transformation request sent - qr_h:', qr_h)
-            print('raw_msg:', raw_msg1)
+            msg_reg.dump()
         
         # receive response
-        raw_msg2 = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg2)
+        msg_res, raw_len2 = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok 
@@ -324,7 +445,7 @@ class qSim_qcln_access_client():
         if not diag:
             return res
         else:            
-            return res, (len(raw_msg1), len(raw_msg2))
+            return res, (raw_len1, raw_len2)
     
     # -------
     
@@ -337,24 +458,19 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_TRANSFORM
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_TYPE, str(f_type))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_FBQML_REP, str(f_rep))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_FBQML_ENTANG, str(f_entang))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_FBQML_SUBTYPE, str(f_subtype))
-        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_ARGS, self.fargs_to_string(f_args, f_type, qasm.QASM_F_TYPE_NULL))
+        f_params = self.transform_qml_params(f_type, f_rep, f_entang, f_subtype, f_args)
+        for p_key in f_params.keys():
+            msg_reg.add_param_tagValue(p_key, f_params[p_key])
         
         # send message
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state QML transformation request sent - qr_h:', qr_h)
-            print('raw_msg:', raw_msg)
+            msg_reg.dump()
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok 
@@ -364,8 +480,50 @@ class qSim_qcln_access_client():
     
     # -------
     
-    def qreg_state_getValues(self, qr_h):
-        # get state values for given qureg handler
+    def qreg_state_transform_batch(self, qr_h, b_items, diag=False):
+        # apply an ordered list of transformations to given qureg in a single message round trip
+        # -> each item as a dictionary of qreg_state_transform arguments (or qreg_state_transform_qml
+        #    ones for QML blocks), e.g. {'f_type': qasm.QASM_F_TYPE_H, 'f_size': 2, 'f_rep': 1, 'f_lsq': 0}
+        # -> items executed back-to-back by qSim, stopping at first error
+        
+        # prepare message - item params tagged as <par_tag>#<item_idx>
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_TRANSFORM_BATCH
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_BN, str(len(b_items)))
+        for b_idx, b_item in enumerate(b_items):
+            if qasm.QASM_FB_IS_BLOCK_QML(b_item['f_type']):
+                f_params = self.transform_qml_params(**b_item)
+            else:
+                f_params = self.transform_params(**b_item)
+            for p_key in f_params.keys():
+                msg_reg.add_param_tagValue(p_key + qasm.QASM_MSG_BATCH_IDX_SEP + str(b_idx), f_params[p_key])
+        
+        # send message
+        raw_len1 = self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg state transformation batch request sent - qr_h:', qr_h, 
+                  '- items:', len(b_items))
+        
+        # receive response
+        msg_res, raw_len2 = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if self.m_verbose:
+            b_done = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_BDONE)
+            print('qSim-access - qreg state transformation batch - res:', res, '- items done:', b_done)
+        if not diag:
+            return res
+        else:            
+            return res, (raw_len1, raw_len2)
+    
+    # -------
+    
+    def qreg_state_getValues(self, qr_h, st_offs=None, st_cnt=None):
+        # get state values for given qureg handler - whole state vector, or states page
+        # of st_cnt states from st_offs index if given
         
         # send message
         msg_reg = qasm.qSim_qcln_qasm()
@@ -373,24 +531,29 @@ class qSim_qcln_access_client():
         msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_PEEK
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        if not st_offs is None:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STOFFS, str(st_offs))
+        if not st_cnt is None:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STCNT, str(st_cnt))
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
-            print('qSim-access - qureg state get values request sent - qr_h:', qr_h)
+            print('qSim-access - qureg state get values request sent - qr_h:', qr_h,
+                  'st_offs:', st_offs, 'st_cnt:', st_cnt)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         # msg_res.dump()
         res = self.check_response_message(msg_res)
         if res:
             # request ok - get qreg state values
-            qr_st_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS)
-            # print(qr_st_str)
-            # convert to complex array
-            qr_st = self.states_string_2_complex(qr_st_str)
+            qr_st_val = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS)
+            # print(qr_st_val)
+            # convert to complex array - from string or raw real/imag pairs
+            if isinstance(qr_st_val, str):
+                qr_st = self.states_string_2_complex(qr_st_val)
+            else:
+                qr_st = np.frombuffer(qr_st_val, dtype=complex).copy()
             if self.m_verbose:
                 print('qSim-access - qreg state get values OK')
         else:
@@ -399,6 +562,46 @@ class qSim_qcln_access_client():
             
     # -------
     
+    def qreg_state_topk(self, qr_h, k):
+        # get the k most probable states for given qureg handler - state indexes and
+        # values, by decreasing probability
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_PEEK
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STTOPK, str(k))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg state top-k request sent - qr_h:', qr_h, 'k:', k)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get state indexes and values
+            st_idx_val = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_STIDXS)
+            if isinstance(st_idx_val, list):
+                st_idxs = st_idx_val
+            else:
+                st_idxs = eval(st_idx_val)
+            qr_st_val = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS)
+            if isinstance(qr_st_val, str):
+                qr_st = self.states_string_2_complex(qr_st_val)
+            else:
+                qr_st = np.frombuffer(qr_st_val, dtype=complex).copy()
+            if self.m_verbose:
+                print('qSim-access - qreg state top-k OK')
+        else:
+            st_idxs = None
+            qr_st = None
+        return st_idxs, qr_st
+            
+    # -------
+    
     def qreg_measure(self, qr_h, q_idx, q_len, m_rand, st_coll, diag=False):
         # state measurement for given qureg handler
         
@@ -412,16 +615,13 @@ class qSim_qcln_access_client():
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MQLEN, str(q_len))
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MRAND, str(int(m_rand)))
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MCOLL, str(int(st_coll)))
-        raw_msg1 = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg1)
+        raw_len1 = self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state get values request sent - qr_h:', qr_h)
         
         # receive response
-        raw_msg2 = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg2)
+        msg_res, raw_len2 = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok - get qreg measurement values
@@ -441,7 +641,9 @@ class qSim_qcln_access_client():
             # measurement residual qureg states - optional - convert to double array
             m_vec_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_MSTIDXS)
             # print('m_exp_str:', m_vec_str)
-            if not m_vec_str is None:
+            if isinstance(m_vec_str, list):
+                m_vec = m_vec_str
+            elif not m_vec_str is None:
                 m_vec = eval(m_vec_str)
             else:
                 m_vec = None
@@ -455,7 +657,97 @@ class qSim_qcln_access_client():
         if not diag:
             return m_st, m_pr, m_vec
         else:            
-            return m_st, m_pr, m_vec, (len(raw_msg1), len(raw_msg2))
+            return m_st, m_pr, m_vec, (raw_len1, raw_len2)
+            
+    # -------
+    
+    def qreg_measure_batch(self, qr_h, q_idx, q_len, m_rand, st_coll):
+        # per-sample state measurement for given batched qureg handler
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_MEASURE
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MQIDX, str(q_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MQLEN, str(q_len))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MRAND, str(int(m_rand)))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MCOLL, str(int(st_coll)))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg batch measure request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get per-sample measured state indexes and probabilities
+            # (single sample values for a non-batched qureg - 1 sample)
+            m_sts_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_SMSTIDXS)
+            if m_sts_str is None:
+                m_sts = [int(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_MSTIDX))]
+                m_prs = [float(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_MPR))]
+            else:
+                if isinstance(m_sts_str, list):
+                    m_sts = m_sts_str
+                else:
+                    m_sts = eval(m_sts_str)
+                m_prs_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_SMSTPRS)
+                m_prs = eval(m_prs_str)
+
+            if self.m_verbose:
+                print('qSim-access - qreg batch measurement OK - m_sts:', m_sts)
+        else:
+            m_sts = None
+            m_prs = None
+        return m_sts, m_prs
+            
+    # -------
+    
+    def qreg_measure_shots(self, qr_h, q_idx, q_len, shots, seed=None, diag=False):
+        # state measurement shots for given qureg handler - no state collapse
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_MEASURE
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MQIDX, str(q_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MQLEN, str(q_len))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MCOLL, str(int(False)))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MSHOTS, str(shots))
+        if not seed is None:
+            msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_MSEED, str(seed))
+        raw_len1 = self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg state measure shots request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, raw_len2 = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get outcome counts as (state index, count) pairs
+            m_cnt_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_MCOUNTS)
+            if isinstance(m_cnt_str, list):
+                m_cnt_vec = m_cnt_str
+            elif not m_cnt_str is None:
+                m_cnt_vec = eval(m_cnt_str)
+            else:
+                m_cnt_vec = []
+            m_counts = dict(zip(m_cnt_vec[0::2], m_cnt_vec[1::2]))
+
+            if self.m_verbose:
+                print('qSim-access - qreg measurement shots OK - outcomes:', len(m_counts))
+        else:
+            m_counts = None
+        if not diag:
+            return m_counts
+        else:            
+            return m_counts, (raw_len1, raw_len2)
             
     # -------
     
@@ -476,16 +768,13 @@ class qSim_qcln_access_client():
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQIDX, str(q_idx))
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQLEN, str(q_len))
         msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EOBSOP, str(q_obs_op))
-        raw_msg = msg_reg.to_raw_message()
-        self.m_qsock.send_raw_message(raw_msg)
+        self.send_message(msg_reg)
         self.m_counter += 1
         if self.m_verbose:
             print('qSim-access - qureg state get values request sent - qr_h:', qr_h)
         
         # receive response
-        raw_msg = self.m_qsock.receive_raw_message()
-        msg_res = qasm.qSim_qcln_qasm()
-        msg_res.from_raw_message(raw_msg)
+        msg_res, _ = self.receive_message()
         res = self.check_response_message(msg_res)
         if res:
             # request ok - get qreg expectation values
@@ -500,9 +789,140 @@ class qSim_qcln_access_client():
             m_exp = None
         return m_exp
             
+    # -------
+    
+    def qreg_expectation_batch(self, qr_h, st_idx, q_idx, q_len, q_obs_op):
+        # per-sample state expectation for given batched qureg handler
+        
+        # check index values
+        if st_idx is None:
+            st_idx = -1            
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_EXPECT
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_ESTIDX, str(st_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQIDX, str(q_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQLEN, str(q_len))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EOBSOP, str(q_obs_op))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg batch expectation request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get per-sample expectation values (single sample value for a
+            # non-batched qureg - 1 sample)
+            m_exps_str = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_SEXSTVALS)
+            if m_exps_str is None:
+                m_exps = [float(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_ESTVAL))]
+            else:
+                m_exps = eval(m_exps_str)
+            
+            if self.m_verbose:
+                print('qSim-access - qreg batch expectation OK - m_exps:', m_exps)
+        else:
+            m_exps = None
+        return m_exps
+            
+    # -------
+    
+    def qreg_gradient_qnet(self, qr_h, f_rep, f_entang, f_subtype, f_args, st_idx, q_idx, q_len, q_obs_op):
+        # q-net applied to given qureg handler state (e.g. feature map output), returning
+        # the state expectation and its derivatives by the q-net params
+        
+        # check index values
+        if st_idx is None:
+            st_idx = -1            
+        
+        # send message
+        msg_reg = qasm.qSim_qcln_qasm()
+        msg_reg.m_counter = self.m_counter
+        msg_reg.m_id = qasm.QASM_MSG_ID_QREG_ST_GRADIENT
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, self.m_token)
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, str(qr_h))
+        f_params = self.transform_qml_params(qasm.QASM_FBQML_TYPE_QNET, f_rep, f_entang, f_subtype, f_args)
+        for p_key in f_params.keys():
+            msg_reg.add_param_tagValue(p_key, f_params[p_key])
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_ESTIDX, str(st_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQIDX, str(q_idx))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EQLEN, str(q_len))
+        msg_reg.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_EOBSOP, str(q_obs_op))
+        self.send_message(msg_reg)
+        self.m_counter += 1
+        if self.m_verbose:
+            print('qSim-access - qureg q-net gradient request sent - qr_h:', qr_h)
+        
+        # receive response
+        msg_res, _ = self.receive_message()
+        res = self.check_response_message(msg_res)
+        if res:
+            # request ok - get expectation value and gradient vector
+            m_exp = float(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_ESTVAL))
+            m_grad = eval(msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_QREG_GRVALS))
+            
+            if self.m_verbose:
+                print('qSim-access - qreg q-net gradient OK - m_exp:', m_exp, 'm_grad:', m_grad)
+        else:
+            m_exp = None
+            m_grad = None
+        return m_exp, m_grad
+            
     # -------------------------
     # helper methods
 
+    def send_message(self, msg_reg):
+        # encode and send given message - return raw message size
+        if self.m_binary:
+            raw_msg = msg_reg.to_raw_bytes()
+            self.m_qsock.send_raw_bytes(raw_msg)
+        else:
+            raw_msg = msg_reg.to_raw_message()
+            self.m_qsock.send_raw_message(raw_msg)
+        return len(raw_msg)
+    
+    def receive_message(self):
+        # receive and decode a message (any encoding) - return message and raw message size
+        raw_msg = self.m_qsock.receive_raw_bytes()
+        msg_res = qasm.qSim_qcln_qasm()
+        msg_res.from_raw_bytes(raw_msg)
+        return msg_res, len(raw_msg)
+
+    def transform_params(self, f_type, f_size, f_rep, f_lsq, f_crng=[], f_trng=[], f_args=None, 
+                         fu_type=qasm.QASM_F_TYPE_NULL, fu_size=0):
+        # build transformation message params dictionary
+        if qasm.QASM_F_IS_Q2(fu_type):
+            # remove arg #3 (qureg size - not needed for QASM!!)
+            f_args = f_args[:2]
+        
+        f_params = {}
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_TYPE] = str(f_type)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_SIZE] = str(f_size)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_REP] = str(f_rep)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_LSQ] = str(f_lsq)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_CRANGE] = self.index_range_to_string(f_crng)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_TRANGE] = self.index_range_to_string(f_trng)
+        if fu_type != qasm.QASM_F_TYPE_NULL:
+            f_params[qasm.QASM_MSG_PARAM_TAG_F_UTYPE] = str(fu_type)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_ARGS] = self.fargs_to_string(f_args, f_type, fu_type)
+        return f_params
+    
+    def transform_qml_params(self, f_type, f_rep, f_entang, f_subtype, f_args=None):
+        # build QML transformation message params dictionary
+        f_params = {}
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_TYPE] = str(f_type)
+        f_params[qasm.QASM_MSG_PARAM_TAG_FBQML_REP] = str(f_rep)
+        f_params[qasm.QASM_MSG_PARAM_TAG_FBQML_ENTANG] = str(f_entang)
+        f_params[qasm.QASM_MSG_PARAM_TAG_FBQML_SUBTYPE] = str(f_subtype)
+        f_params[qasm.QASM_MSG_PARAM_TAG_F_ARGS] = self.fargs_to_string(f_args, f_type, qasm.QASM_F_TYPE_NULL)
+        return f_params
+
     def check_response_message(self, msg_res):
         # extract and check response return code
         res = msg_res.get_param_valueByTag(qasm.QASM_MSG_PARAM_TAG_RESULT)
@@ -41,6 +41,15 @@ Created on Sat May 28 17:46:04 2022
 * 1.2   Feb-2023  Added macro to identify 1-qubit parametric q-functions.
 *                 Supported qureg state expectations calculation.
 *                 Handled QML function blocks (feature map and q-net).
+* 1.3   Oct-2026  Supported qureg transformation batch message.
+* 1.4   Oct-2026  Supported binary message encoding, with integer parameter tags
+*                 and raw state arrays.
+* 1.5   Oct-2026  Supported qureg state measurement shots parameters.
+* 1.6   Oct-2026  Supported batched qureg parameters.
+* 1.7   Oct-2026  Supported qureg q-net gradient message.
+* 1.8   Oct-2026  Supported qureg clone and state snapshot/restore messages.
+* 1.9   Oct-2026  Supported qureg state paged peek and top-k states peek parameters.
+* 1.10  Oct-2026  Supported server statistics message.
 * 
 * ------------------------------------------------------------------------
 *
@@ -49,6 +58,10 @@ Created on Sat May 28 17:46:04 2022
 # TODO 
 # - check_syntax (where needed)
 
+import sys
+import struct
+from array import array
+
 
 # --------------------------------------------------------
 
@@ -56,6 +69,7 @@ Created on Sat May 28 17:46:04 2022
 QASM_MSG_ID_NOPE       = 0
 QASM_MSG_ID_REGISTER   = 1
 QASM_MSG_ID_UNREGISTER = 2
+QASM_MSG_ID_STATS      = 3
 
 # qureg handling instructions
 QASM_MSG_ID_QREG_ALLOCATE     = 10
@@ -66,14 +80,22 @@ QASM_MSG_ID_QREG_ST_TRANSFORM = 14
 QASM_MSG_ID_QREG_ST_PEEK      = 15
 QASM_MSG_ID_QREG_MEASURE      = 16
 QASM_MSG_ID_QREG_EXPECT       = 17
+QASM_MSG_ID_QREG_ST_TRANSFORM_BATCH = 18
+QASM_MSG_ID_QREG_ST_GRADIENT = 19
 
 # responses
 QASM_MSG_ID_RESPONSE = 20
 
+# qureg copies
+QASM_MSG_ID_QREG_CLONE       = 21
+QASM_MSG_ID_QREG_ST_SNAPSHOT = 22
+QASM_MSG_ID_QREG_ST_RESTORE  = 23
+
 # separators
 QASM_MSG_FIELD_SEP  = "|"
 QASM_MSG_PARAM_SEP  = ":"
 QASM_MSG_PARVAL_SEP = "="
+QASM_MSG_BATCH_IDX_SEP = "#"
 
 # parameter tags
 QASM_MSG_PARAM_TAG_ID         = "id"
@@ -90,11 +112,32 @@ QASM_MSG_PARAM_TAG_QREG_MCOLL   = "qr_mStColl"
 QASM_MSG_PARAM_TAG_QREG_MSTIDX  = "qr_mStIdx"
 QASM_MSG_PARAM_TAG_QREG_MPR     = "qr_mStPr"
 QASM_MSG_PARAM_TAG_QREG_MSTIDXS = "qr_mStIdxs"
+QASM_MSG_PARAM_TAG_QREG_MSHOTS  = "qr_mShots"
+QASM_MSG_PARAM_TAG_QREG_MSEED   = "qr_mSeed"
+QASM_MSG_PARAM_TAG_QREG_MCOUNTS = "qr_mCounts"
 QASM_MSG_PARAM_TAG_QREG_ESTIDX  = "qr_exStIdx"
 QASM_MSG_PARAM_TAG_QREG_EQIDX   = "qr_exQidx"
 QASM_MSG_PARAM_TAG_QREG_EQLEN   = "qr_exQlen"
 QASM_MSG_PARAM_TAG_QREG_EOBSOP  = "qr_exObsOp"
 QASM_MSG_PARAM_TAG_QREG_ESTVAL  = "qr_exStVal"
+QASM_MSG_PARAM_TAG_QREG_BN      = "qr_bN"
+QASM_MSG_PARAM_TAG_QREG_BDONE   = "qr_bDone"
+QASM_MSG_PARAM_TAG_QREG_SN      = "qr_sN"
+QASM_MSG_PARAM_TAG_QREG_SMSTIDXS = "qr_sMStIdxs"
+QASM_MSG_PARAM_TAG_QREG_SMSTPRS = "qr_sMStPrs"
+QASM_MSG_PARAM_TAG_QREG_SEXSTVALS = "qr_sExStVals"
+QASM_MSG_PARAM_TAG_QREG_GRVALS  = "qr_grVals"
+QASM_MSG_PARAM_TAG_QREG_CLH     = "qr_clH"
+QASM_MSG_PARAM_TAG_QREG_STOFFS  = "qr_stOffs"
+QASM_MSG_PARAM_TAG_QREG_STCNT   = "qr_stCnt"
+QASM_MSG_PARAM_TAG_QREG_STTOPK  = "qr_stTopK"
+QASM_MSG_PARAM_TAG_QREG_STIDXS  = "qr_stIdxs"
+
+QASM_MSG_PARAM_TAG_STATS_RESET   = "st_reset"
+QASM_MSG_PARAM_TAG_STATS_TRACE   = "st_trace"
+QASM_MSG_PARAM_TAG_STATS_VALS    = "st_vals"
+QASM_MSG_PARAM_TAG_STATS_ELAPSED = "st_elapsed"
+QASM_MSG_PARAM_TAG_STATS_TRACEN  = "st_traceN"
 
 QASM_MSG_PARAM_TAG_F_TYPE     = "f_type"
 QASM_MSG_PARAM_TAG_F_SIZE     = "f_size"
@@ -113,10 +156,45 @@ QASM_MSG_PARAM_TAG_FBQML_FMAPVEC  = "fqml_fmap_fvec"
 QASM_MSG_PARAM_TAG_RESULT   = "result"
 QASM_MSG_PARAM_TAG_ERROR    = "error"
 
+QASM_MSG_PARAM_TAG_ENCODING = "enc"
+
 # parameter values
 QASM_MSG_PARAM_VAL_OK  = "Ok"
 QASM_MSG_PARAM_VAL_NOK = "Not-Ok"
 
+QASM_MSG_PARAM_VAL_ENC_BIN = "bin"
+
+# binary encoding format (little-endian) - see qSim_qasm.h
+#    <header> = <magic:2><version:1><reserved:1><counter:4><id:4><par_count:4>
+#    <param>  = <tag:2><item_idx:2><val_type:1><reserved:3><val_len:4><value:val_len>
+QASM_MSG_BIN_MAGIC   = b'\xb1\x51'
+QASM_MSG_BIN_VERSION = 1
+
+QASM_MSG_BIN_HEADER_FMT = '<2sBxIiI'
+QASM_MSG_BIN_PARAM_HEADER_FMT = '<HHBxxxI'
+
+QASM_MSG_BIN_TAG_NULL  = 0xFFFF
+QASM_MSG_BIN_ITEM_NULL = 0xFFFF
+
+QASM_MSG_BIN_VAL_STR    = 0
+QASM_MSG_BIN_VAL_CARRAY = 1
+QASM_MSG_BIN_VAL_IARRAY = 2
+
+# binary encoding parameter tags - tag index as binary tag (same order as qSim server!)
+QASM_MSG_BIN_TAGS = ["id", "token", 
+                     "qr_n", "qr_h", "qr_stIdx", "qr_stVals", "qr_mQidx", "qr_mQlen", "qr_mRand", 
+                     "qr_mStColl", "qr_mStIdx", "qr_mStPr", "qr_mStIdxs", "qr_exStIdx", "qr_exQidx", 
+                     "qr_exQlen", "qr_exObsOp", "qr_exStVal", "qr_bN", "qr_bDone",
+                     "f_type", "f_size", "f_rep", "f_lsq", "f_cRange", "f_tRange", "f_uType", "f_args",
+                     "fqml_rep", "fqml_entang_type", "fqml_subtype", "fqml_qnet_type",
+                     "result", "error", "enc",
+                     "qr_mShots", "qr_mSeed", "qr_mCounts",
+                     "qr_sN", "qr_sMStIdxs", "qr_sMStPrs", "qr_sExStVals",
+                     "qr_grVals", "qr_clH", "qr_stOffs", "qr_stCnt", "qr_stTopK",
+                     "qr_stIdxs",
+                     "st_reset", "st_trace", "st_vals", "st_elapsed", "st_traceN"]
+QASM_MSG_BIN_TAGS_DICT = {tag: b_tag for b_tag, tag in enumerate(QASM_MSG_BIN_TAGS)}
+
 # --------------------
 
 # function types
@@ -330,6 +408,106 @@ class qSim_qcln_qasm():
                 
         return msg_str
     
+    # -------------------------
+    # binary encoding/decoding
+    
+    # params values as strings, or as raw arrays for complex values (states) and integer
+    # values (state indexes) - decoded as interleaved real/imag doubles array and int list
+    
+    def from_raw_bytes(self, msg_buf):
+        # extract counter, id and params from given bytes - text format if no binary magic
+        if msg_buf[:2] != QASM_MSG_BIN_MAGIC:
+            self.from_raw_message(msg_buf.decode())
+            return
+        
+        hdr_sz = struct.calcsize(QASM_MSG_BIN_HEADER_FMT)
+        _, ver, self.m_counter, self.m_id, par_count = struct.unpack_from(QASM_MSG_BIN_HEADER_FMT, msg_buf, 0)
+        if ver != QASM_MSG_BIN_VERSION:
+            print('qSim_qasm_message::from_raw_bytes - wrong version!')
+            return
+        
+        par_hdr_sz = struct.calcsize(QASM_MSG_BIN_PARAM_HEADER_FMT)
+        idx = hdr_sz
+        self.m_params_dict.clear()
+        for _ in range(par_count):
+            b_tag, item, val_type, val_len = struct.unpack_from(QASM_MSG_BIN_PARAM_HEADER_FMT, msg_buf, idx)
+            idx += par_hdr_sz
+            val_buf = msg_buf[idx:idx+val_len]
+            idx += val_len
+            
+            # resolve tag - inline for null tag
+            if b_tag != QASM_MSG_BIN_TAG_NULL:
+                par_tag = QASM_MSG_BIN_TAGS[b_tag]
+            else:
+                sep = val_buf.index(QASM_MSG_PARVAL_SEP.encode())
+                par_tag = val_buf[:sep].decode()
+                val_buf = val_buf[sep+1:]
+            if item != QASM_MSG_BIN_ITEM_NULL:
+                par_tag += QASM_MSG_BATCH_IDX_SEP + str(item)
+                
+            # extract value
+            if val_type == QASM_MSG_BIN_VAL_STR:
+                par_val = val_buf.decode()
+            elif val_type == QASM_MSG_BIN_VAL_CARRAY:
+                par_val = array('d')
+                par_val.frombytes(val_buf)
+                if sys.byteorder != 'little':
+                    par_val.byteswap()
+            else:
+                arr = array('q')
+                arr.frombytes(val_buf)
+                if sys.byteorder != 'little':
+                    arr.byteswap()
+                par_val = arr.tolist()
+            self.m_params_dict[par_tag] = par_val
+            
+    def to_raw_bytes(self):
+        # encode counter, id and params into bytes
+        msg_buf = [struct.pack(QASM_MSG_BIN_HEADER_FMT, QASM_MSG_BIN_MAGIC, QASM_MSG_BIN_VERSION,
+                               self.m_counter, self.m_id, len(self.m_params_dict))]
+        for p_key in self.m_params_dict.keys():
+            # resolve tag and batch item index
+            par_tag = p_key
+            item = QASM_MSG_BIN_ITEM_NULL
+            sep = par_tag.find(QASM_MSG_BATCH_IDX_SEP)
+            if sep >= 0 and par_tag[sep+1:].isdigit() and int(par_tag[sep+1:]) < QASM_MSG_BIN_ITEM_NULL:
+                item = int(par_tag[sep+1:])
+                par_tag = par_tag[:sep]
+            b_tag = QASM_MSG_BIN_TAGS_DICT.get(par_tag, QASM_MSG_BIN_TAG_NULL)
+            
+            # encode value - complex/integer sequences as raw arrays
+            par_val = self.m_params_dict[p_key]
+            if isinstance(par_val, str):
+                val_type = QASM_MSG_BIN_VAL_STR
+                val_buf = par_val.encode()
+            elif hasattr(par_val, 'dtype'):
+                # numpy array
+                if par_val.dtype.kind == 'c':
+                    val_type = QASM_MSG_BIN_VAL_CARRAY
+                    val_buf = par_val.astype('<c16').tobytes()
+                else:
+                    val_type = QASM_MSG_BIN_VAL_IARRAY
+                    val_buf = par_val.astype('<i8').tobytes()
+            elif any(isinstance(v, complex) for v in par_val):
+                val_type = QASM_MSG_BIN_VAL_CARRAY
+                arr = array('d', [x for v in par_val for x in (complex(v).real, complex(v).imag)])
+                if sys.byteorder != 'little':
+                    arr.byteswap()
+                val_buf = arr.tobytes()
+            else:
+                val_type = QASM_MSG_BIN_VAL_IARRAY
+                arr = array('q', [int(v) for v in par_val])
+                if sys.byteorder != 'little':
+                    arr.byteswap()
+                val_buf = arr.tobytes()
+            if b_tag == QASM_MSG_BIN_TAG_NULL:
+                val_buf = (par_tag + QASM_MSG_PARVAL_SEP).encode() + val_buf
+                
+            msg_buf.append(struct.pack(QASM_MSG_BIN_PARAM_HEADER_FMT, b_tag, item, val_type, len(val_buf)))
+            msg_buf.append(val_buf)
+            
+        return b''.join(msg_buf)
+    
     # -------------------------
     # diagnostics mehods
     
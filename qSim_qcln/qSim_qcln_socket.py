@@ -39,6 +39,8 @@ Created on Sat May 28 17:46:04 2022
 * 1.1   Nov-2022  Moved to qSim v2 and renamed to qSim_qcln_socket.
 * 1.2   Mar-2023  Improved socket transfer performance setting TCP NODELAY 
 *                 flag (2x improvement on client side).
+* 1.3   Oct-2026  Supported raw bytes messages (binary encoding) and fixed partial
+*                 socket reads/writes handling.
 * 
 * ------------------------------------------------------------------------
 *
@@ -92,40 +94,46 @@ class qSim_qcln_socket():
     
     def receive_raw_message(self):
         # read a raw message from server
-        
-        # get message length
-        from_server = self.m_sock_client.recv(4)
-        msg_len = int.from_bytes(from_server, 'little')
-        if self.m_verbose:
-            print('server raw message - len:', msg_len)
-        # print('raw_message...len field size:', len(from_server), ' val:', msg_len)
-    
-        # get message body - in a loop!
-        msg_str = ''
-        while len(msg_str) < msg_len:
-            from_server = self.m_sock_client.recv(msg_len)
-            msg_str += from_server.decode()
+        msg_str = self.receive_raw_bytes().decode()
         if self.m_verbose:
             print('server raw message - data:', msg_str)
-        # print('raw_message...data field size:', len(from_server), ' val (first 100!):', msg_str[:100])
-        
         return msg_str
         
     def send_raw_message(self, msg_str):
         # send a raw message from server
+        self.send_raw_bytes(msg_str.encode())
+    
+    def receive_raw_bytes(self):
+        # read a raw bytes message from server
         
-        # send message length
-        msg_len = len(msg_str)
-        self.m_sock_client.send(msg_len.to_bytes(4, byteorder='little'))
+        # get message length
+        from_server = self.recv_exact(4)
+        msg_len = int.from_bytes(from_server, 'little')
+        if self.m_verbose:
+            print('server raw message - len:', msg_len)
+    
+        # get message body - in a loop!
+        return self.recv_exact(msg_len)
         
-        # send message body
-        tot_sent = 0
-        while (tot_sent < msg_len):
-            tot_sent += self.m_sock_client.send(msg_str.encode())
-        # print('raw_message...data field size:', msg_len, ' tot_sent:', tot_sent)
+    def send_raw_bytes(self, msg_buf):
+        # send a raw bytes message from server - length first
+        msg_len = len(msg_buf)
+        self.m_sock_client.sendall(msg_len.to_bytes(4, byteorder='little') + msg_buf)
         
         if self.m_verbose:
             print('qSim-client - message sent to server')
+            
+    def recv_exact(self, tot_len):
+        # read given number of bytes - in a loop to handle partial reads
+        msg_buf = bytearray(tot_len)
+        msg_view = memoryview(msg_buf)
+        tot_read = 0
+        while tot_read < tot_len:
+            n = self.m_sock_client.recv_into(msg_view[tot_read:], tot_len-tot_read)
+            if n == 0:
+                raise ConnectionError('qSim-client - server disconnected')
+            tot_read += n
+        return bytes(msg_buf)
     
 
 # ******************************************************************
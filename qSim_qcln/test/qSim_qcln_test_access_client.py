@@ -139,6 +139,14 @@ def test_qcln_access_select_request():
     print('-----------------------')
     print('(6) - qreg_state_getValues')
     print('(7) - qreg_measure')
+    print('(8) - qreg_measure_shots')
+    print('-----------------------')
+    print('(9) - qreg_clone')
+    print('(10) - qreg_state_snapshot')
+    print('(11) - qreg_state_restore')
+    print('(12) - qreg_state_topk')
+    print('-----------------------')
+    print('(13) - server_stats')
     print('-----------------------')
     print('(0) - exit test')
     print('-----------------------')
@@ -156,6 +164,12 @@ REQ_QREG_STATE_SET = 4
 REQ_QREG_STATE_TRANSFORM = 5
 REQ_QREG_STATE_GET = 6
 REQ_QREG_STATE_MEASURE = 7
+REQ_QREG_STATE_MEASURE_SHOTS = 8
+REQ_QREG_CLONE = 9
+REQ_QREG_STATE_SNAPSHOT = 10
+REQ_QREG_STATE_RESTORE = 11
+REQ_QREG_STATE_TOPK = 12
+REQ_SERVER_STATS = 13
 
 def test_qcln_access_exec_request(qcln, req):
     # perform access client request execution
@@ -163,7 +177,9 @@ def test_qcln_access_exec_request(qcln, req):
         # qureg allocate - get size and execute        
         qn = input('qureg_allocate - qureg size? ')
         qn = int(qn)
-        qr_h = qcln.qreg_allocate(qn)
+        sn = input('batched qureg samples (empty for none)? ')
+        sn = int(sn) if sn != '' else None
+        qr_h = qcln.qreg_allocate(qn, sn)
         print('qureg_allocate done - qr:', qr_h)
         print()
         
@@ -222,10 +238,26 @@ def test_qcln_access_exec_request(qcln, req):
         # qureg state get values - get handler and execute
         qr_h = input('qreg_state_getValues - qureg handler? ')
         qr_h = int(qr_h)
-        st_vals = qcln.qreg_state_getValues(qr_h)
+        st_offs = input('states page first index (empty for whole state vector)? ')
+        st_offs = int(st_offs) if st_offs != '' else None
+        st_cnt = None
+        if not st_offs is None:
+            st_cnt = input('states page size? ')
+            st_cnt = int(st_cnt)
+        st_vals = qcln.qreg_state_getValues(qr_h, st_offs, st_cnt)
         print('qreg_state_getValues done - st_vals:', st_vals)
         print()
 
+    elif req == REQ_QREG_STATE_TOPK:
+        # qureg state top-k - get handler and states number and execute
+        qr_h = input('qreg_state_topk - qureg handler? ')
+        qr_h = int(qr_h)
+        k = input('most probable states number? ')
+        k = int(k)
+        st_idxs, st_vals = qcln.qreg_state_topk(qr_h, k)
+        print('qreg_state_topk done - st_idxs:', st_idxs, 'st_vals:', st_vals)
+        print()
+
     elif req == REQ_QREG_STATE_MEASURE:
         # qureg state measure - get handler and other args and execute
         qr_h = input('qreg_measure - qureg handler? ')
@@ -243,6 +275,61 @@ def test_qcln_access_exec_request(qcln, req):
         print('qreg_measure done - m_st:', m_st, 'm_pr:', m_pr, 'm_vec:', m_vec)
         print()
 
+    elif req == REQ_QREG_STATE_MEASURE_SHOTS:
+        # qureg state measure shots - get handler and other args and execute
+        qr_h = input('qreg_measure_shots - qureg handler? ')
+        qr_h = int(qr_h)
+        q_idx = input('qubit start index? ')
+        q_idx = int(q_idx)
+        q_len = input('sub-qureg size? ')
+        q_len = int(q_len)
+        shots = input('number of shots? ')
+        shots = int(shots)
+        seed = input('random seed (empty for none)? ')
+        seed = int(seed) if seed != '' else None
+    # def qreg_measure_shots(self, qr_h, q_idx, q_len, shots, seed=None):
+        m_counts = qcln.qreg_measure_shots(qr_h, q_idx, q_len, shots, seed)
+        print('qreg_measure_shots done - m_counts:', m_counts)
+        print()
+
+    elif req == REQ_QREG_CLONE:
+        # qureg clone - get source and target handlers and execute
+        qr_h = input('qreg_clone - qureg handler? ')
+        qr_h = int(qr_h)
+        qr_clH = input('target qureg handler (empty for a new qureg)? ')
+        qr_clH = int(qr_clH) if qr_clH != '' else None
+        qr_clH = qcln.qreg_clone(qr_h, qr_clH)
+        print('qreg_clone done - qr:', qr_clH)
+        print()
+
+    elif req == REQ_QREG_STATE_SNAPSHOT:
+        # qureg state snapshot - get handler and execute
+        qr_h = input('qreg_state_snapshot - qureg handler? ')
+        qr_h = int(qr_h)
+        res = qcln.qreg_state_snapshot(qr_h)
+        print('qreg_state_snapshot done - res:', res)
+        print()
+
+    elif req == REQ_QREG_STATE_RESTORE:
+        # qureg state restore - get handler and execute
+        qr_h = input('qreg_state_restore - qureg handler? ')
+        qr_h = int(qr_h)
+        res = qcln.qreg_state_restore(qr_h)
+        print('qreg_state_restore done - res:', res)
+        print()
+
+    elif req == REQ_SERVER_STATS:
+        # server statistics - get reset and timeline flags and execute
+        reset = input('server_stats - reset after reading (y/n)? ')
+        trace = input('timeline dump (y/n)? ')
+        st_vals, st_elapsed, st_traceN = qcln.server_stats(reset == 'y', trace == 'y')
+        if not st_vals is None:
+            for st_key, st_val in sorted(st_vals.items()):
+                print('  ', st_key, '- count:', st_val[0], 'tot (nsec):', st_val[1], 'max (nsec):', st_val[2],
+                      'bytes:', st_val[3])
+        print('server_stats done - elapsed (nsec):', st_elapsed, 'timeline events:', st_traceN)
+        print()
+
     elif req == REQ_QREG_NONE:
         pass
     
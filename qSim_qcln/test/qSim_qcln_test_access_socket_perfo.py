@@ -102,6 +102,7 @@ def test_qcln_access_client_socket_perfo(tot_msg=5, n=5, verbose=False):
     kb_sec_rate_vec = msg_sz_vec/msg_tm_vec
     msg_sec_rate_avg = np.mean(1./msg_tm_vec)
     kb_sec_rate_avg = np.mean(kb_sec_rate_vec)
+    msg_ms_vec = msg_tm_vec*1000 # round-trip latency - msec
     
     # plot results
     plt.figure()
@@ -145,6 +146,11 @@ def test_qcln_access_client_socket_perfo(tot_msg=5, n=5, verbose=False):
     print('...msg/sec avg:', ('%6.3f' % msg_sec_rate_avg))
     print('...kb/sec avg: ', ('%6.3f' % kb_sec_rate_avg))
     print()
+    print('...round-trip msec avg:   ', ('%6.3f' % np.mean(msg_ms_vec)))
+    print('...round-trip msec median:', ('%6.3f' % np.median(msg_ms_vec)))
+    print('...round-trip msec p95:   ', ('%6.3f' % np.percentile(msg_ms_vec, 95)))
+    print('...round-trip msec min:   ', ('%6.3f' % np.min(msg_ms_vec)))
+    print()
     
     print('done.')
     print()
@@ -173,11 +179,11 @@ def apply_transformation(qcln, qr_h, verbose=False):
             fu_size = 2
 
     # apply and get result and stats        
-    start_tm = time.time()
+    start_tm = time.perf_counter()
     res, diag = qcln.qreg_state_transform(qr_h, f_type, f_size, f_rep, f_lsq, 
                                     f_args=f_args, fu_type=fu_type, fu_size=fu_size, 
                                     diag=True)
-    end_tm = time.time() # take timing...
+    end_tm = time.perf_counter() # take timing...
     msg_tm = end_tm - start_tm
     msg_sz = diag[0] + diag[1] # cumulate request and response message sizes
     if verbose:
@@ -195,9 +201,9 @@ def apply_measure(qcln, qr_h, n, verbose=False):
     st_coll = False
 
     # apply and get result and stats        
-    start_tm = time.time()
+    start_tm = time.perf_counter()
     m_st, _, _, diag = qcln.qreg_measure(qr_h, q_idx, q_len, m_rand, st_coll, diag=True)
-    end_tm = time.time() # take timing...
+    end_tm = time.perf_counter() # take timing...
     msg_tm = end_tm - start_tm
     msg_sz = diag[0] + diag[1] # cumulate request and response message sizes
     if verbose:
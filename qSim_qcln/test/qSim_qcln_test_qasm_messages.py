@@ -53,3 +53,24 @@ def test_qcln_qasm():
     
 # -------------------------
 
+def test_qcln_qasm_binary():
+    qm = qasm.qSim_qcln_qasm()
+    qm.m_counter = 2
+    qm.m_id = qasm.QASM_MSG_ID_QREG_ST_SET # set qureg state - raw array
+    qm.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_TOKEN, '1653751880aaa')
+    qm.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_H, '1')
+    qm.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_QREG_STVALS, [.5+.5j, 0, 0, .5-.5j])
+    qm.add_param_tagValue(qasm.QASM_MSG_PARAM_TAG_F_TYPE + qasm.QASM_MSG_BATCH_IDX_SEP + '3', '1') # batch item
+    qm.add_param_tagValue('my_tag', 'my_val') # tag not in binary tags table
+    msg_buf = qm.to_raw_bytes()
+    print('=>> msg_buf:', msg_buf)
+    print()
+
+    qm2 = qasm.qSim_qcln_qasm()
+    qm2.from_raw_bytes(msg_buf)    
+    qm2.dump()
+    
+    print('done.')
+    
+# -------------------------
+
@@ -44,6 +44,43 @@
  *  2.2   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
  *                   Handled QML function blocks (feature map and q-net).
+ *  2.3   Oct-2026   Handled CPU device worker threads number passage as constructor
+ *                   argument.
+ *  2.4   Oct-2026   Handled qureg in-place mode passage as constructor argument.
+ *  2.5   Oct-2026   Handled qureg transformation batch messages.
+ *  2.6   Oct-2026   Handled binary message encoding, returning state values and measure
+ *                   indexes as raw arrays.
+ *  2.7   Oct-2026   Handled qureg state measurement shots, returning sampled outcome counts.
+ *  2.8   Oct-2026   Handled qureg state vector sharding across all GPU devices (peer access
+ *                   enabled among them), or on the single CPU device.
+ *  2.9   Oct-2026   Handled qureg state vector shards distribution on cluster nodes.
+ *  2.10  Oct-2026   Handled qureg handlers counter per instance (one qcpu per client session).
+ *  2.11  Oct-2026   Supported instruction scheduling on qureg lanes - quregs bound to a lane
+ *                   (own worker thread and device) on allocation, lane instructions executed
+ *                   in program order concurrently to other lanes, and completion callbacks
+ *                   called in submission order.
+ *  2.12  Oct-2026   Supported batched quregs allocation, with measure and expectation
+ *                   results returned per sample.
+ *  2.13  Oct-2026   Handled q-net gradient QML block instructions, returning the state
+ *                   expectation and its derivatives by the q-net params.
+ *  2.14  Oct-2026   Supported qureg clone (device to device copy into a new qureg on the
+ *                   source lane, or into an existing one) and state snapshot/restore.
+ *  2.15  Oct-2026   Supported paged and top-k states peek, top-k states returned with their
+ *                   indexes.
+ *  2.16  Oct-2026   Collected instruction queue wait and dispatch statistics, by message id
+ *                   and by gate function type for transformations.
+ *  2.17  Oct-2026   Shared the qureg lane QML block templates cache by its quregs.
+ *  2.18  Oct-2026   Warmed up the devices at start-up.
+ *  2.19  Oct-2026   Handled CPU device memory policy, set on all lane devices.
+ *  2.20  Oct-2026   Handled qureg allocation and clone failures on states allocation (qureg
+ *                   released and error result returned).
+ *  2.21  Oct-2026   Moved devices warm-up out of the qcpu constructor (once per process, not
+ *                   per client session).
+ *  2.22  Oct-2026   Handled lane devices shared by all qcpu handlers, so that CPU worker pools
+ *                   are not created per client session - instructions executed holding their
+ *                   lane device lock (all lane devices for non-lane instructions).
+ *  2.23  Oct-2026   Handled response messages taken from the session allocator on submission
+ *                   (sent responses recycled by qIo), filled on instruction execution.
  *
  *  --------------------------------------------------------------------------
  */
@@ -53,18 +90,44 @@
 #include <string>
 #include <iostream>
 #include <iterator>
+#include <vector>
+#include <algorithm>
 using namespace std;
 
 #include "qSim_qcpu.h"
 #include "qSim_qasm.h"
 #include "qSim_qreg.h"
+#include "qSim_qstats.h"
 
-static QREG_HNDL_TYPE s_qreg_id_counter = 1;
+// lane devices constructor - a device (and CPU worker pool) for each lane
+qSim_qcpu_devices::qSim_qcpu_devices(int tot_threads, int tot_lanes, int mem_policy) {
+	for (int l=0; l<std::max(1, tot_lanes); l++) {
+#ifndef __QSIM_CPU__
+		m_devices.push_back(new qSim_qcpu_device());
+#else
+		m_devices.push_back(new qSim_qcpu_device(tot_threads, mem_policy));
+#endif
+		m_mutexes.push_back(new std::mutex);
+	}
+}
+
+// lane devices destructor - no qcpu handler using them
+qSim_qcpu_devices::~qSim_qcpu_devices() {
+	for (size_t l=0; l<m_devices.size(); l++) {
+		delete m_devices[l];
+		delete m_mutexes[l];
+	}
+}
+
+// *********************************************************
 
 // constructor
-qSim_qcpu::qSim_qcpu(bool verbose) {
-	// instantiate CUDA device handler
-	m_qcpu_device = new qSim_qcpu_device();
+qSim_qcpu::qSim_qcpu(bool verbose, int tot_threads, bool in_place, int tot_shards, qSim_qcpu_node* qnode,
+					 int tot_lanes, int mem_policy, qSim_qcpu_devices* devices) {
+	// lane devices - shared ones if given, first one as qcpu device
+	m_ownDevices = (devices == NULL);
+	m_devices = m_ownDevices ? new qSim_qcpu_devices(tot_threads, tot_lanes, mem_policy) : devices;
+	m_qcpu_device = m_devices->device(0);
 
 #ifndef __QSIM_CPU__
 	// check for CUDA device availability
@@ -74,13 +137,81 @@ qSim_qcpu::qSim_qcpu(bool verbose) {
 	}
 #endif
 	m_verbose = verbose;
+	m_inPlace = in_place;
+
+	// qureg state vector shards - spread on all GPU devices (all shards on the single CPU
+	// device), one shard per device if not given
+#ifndef __QSIM_CPU__
+	m_totDevs = m_qcpu_device->dev_get_gpu_cuda_count();
+#else
+	m_totDevs = 1;
+#endif
+	m_totShards = (tot_shards > 0) ? tot_shards : m_totDevs;
+	if ((m_totShards > 1) && (m_totDevs > 1))
+		m_qcpu_device->dev_gpu_peer_enable(m_totDevs);
+
+	// quregs shards distributed on cluster nodes - if any
+	m_qnode = qnode;
+
+	// response messages - new ones until an allocator is set
+	m_alloc_cb = nullptr;
+
+	// qureg handlers from 1
+	m_qreg_id_counter = 1;
+
+	// qureg lanes - single lane (no worker thread) for distributed quregs, executed on all
+	// nodes in the same order, each lane on its own device (one per lane device at most)
+	if ((m_qnode != NULL) && m_qnode->is_cluster())
+		tot_lanes = 1;
+	tot_lanes = std::min(std::max(1, tot_lanes), m_devices->size());
+	for (int l=0; l<tot_lanes; l++) {
+		qSim_qcpu_lane* lane = new qSim_qcpu_lane;
+		lane->m_stop = false;
+		lane->m_totQuregs = 0;
+		lane->m_device = m_devices->device(l);
+		lane->m_devMutex = m_devices->mutex(l);
+		m_lanes.push_back(lane);
+	}
+	if (m_lanes.size() > 1)
+		for (size_t l=0; l<m_lanes.size(); l++)
+			m_lanes[l]->m_thr_id = std::thread(&qSim_qcpu::lane_loop, this, m_lanes[l]);
 }
 
 // destructor
 qSim_qcpu::~qSim_qcpu() {
-	// release qreg map objects
-	qreg_mapRelease();
-	delete m_qcpu_device;
+	// complete scheduled instructions and stop lanes
+	wait_instructions();
+	for (size_t l=0; l<m_lanes.size(); l++) {
+		{
+			std::lock_guard<std::mutex> lock(m_lanes[l]->m_mutex);
+			m_lanes[l]->m_stop = true;
+		}
+		m_lanes[l]->m_cv_task.notify_one();
+		if (m_lanes[l]->m_thr_id.joinable())
+			m_lanes[l]->m_thr_id.join();
+	}
+
+	// release qreg map objects - lane devices locked, then own devices released
+	{
+		std::vector<std::unique_lock<std::mutex> > dev_locks;
+		lock_devices(&dev_locks);
+		qreg_mapRelease();
+	}
+	for (size_t l=0; l<m_lanes.size(); l++)
+		delete m_lanes[l];
+	if (m_ownDevices)
+		delete m_devices;
+}
+
+// devices warm-up - all devices of the process (no device handler needed)
+void qSim_qcpu::devices_warmup(bool verbose) {
+#ifndef __QSIM_CPU__
+	int tot_devs = qSim_qcpu_device::dev_get_gpu_cuda_count();
+#else
+	int tot_devs = 1;
+#endif
+	if (qSim_qcpu_device::dev_gpu_warmup(tot_devs, verbose) != QDEV_RES_OK)
+		cerr << "WARNING!! qcpu - devices warm-up failed" << endl;
 }
 
 // *********************************************************
@@ -89,9 +220,12 @@ qSim_qcpu::~qSim_qcpu() {
 bool qSim_qcpu::reset() {
 	cout << "qSim_qcpu::reset" << endl;
 
-	// release qreg map objects
+	// release qreg map objects - once scheduled instructions completed, lane devices locked
+	wait_instructions();
+	std::vector<std::unique_lock<std::mutex> > dev_locks;
+	lock_devices(&dev_locks);
 	qreg_mapRelease();
-	s_qreg_id_counter = 1;
+	m_qreg_id_counter = 1;
 	return true;
 }
 
@@ -114,18 +248,55 @@ bool qSim_qcpu::switchOff() {
 		int id = QASM_MSG_ID_RESPONSE;\
 		params.insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));\
 		params.insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, err_msg_tag+" transformation syntax error"));\
-		qSim_qasm_message* msg_out = new qSim_qasm_message(counter, id, params);\
+		msg_out->set_content(counter, id, params);\
+		msg_out->set_binary(msg_in->is_binary());\
 		return msg_out;\
 	}\
 }
 
 // qasm message dispatching for execution entry point
 qSim_qasm_message* qSim_qcpu::dispatch_instruction(qSim_qasm_message* msg_in) {
+	// execute instruction holding all lane devices (any qureg accessed) - other qcpu handlers
+	// instructions on the same devices completed first
+	qSim_qasm_message* msg_out = alloc_response();
+	std::vector<std::unique_lock<std::mutex> > dev_locks;
+	lock_devices(&dev_locks);
+	return exec_instruction(msg_in, msg_out);
+}
+
+// response messages allocator - set by the instructions submitter
+void qSim_qcpu::set_response_alloc(QCPU_ALLOC_CB_TYPE alloc_cb) {
+	m_alloc_cb = alloc_cb;
+}
+
+qSim_qasm_message* qSim_qcpu::alloc_response() {
+	return (m_alloc_cb != nullptr) ? m_alloc_cb() : new qSim_qasm_message();
+}
+
+// lane devices locks - in lanes order (no lock order inversion between qcpu handlers)
+void qSim_qcpu::lock_devices(std::vector<std::unique_lock<std::mutex> >* dev_locks) {
+	for (size_t l=0; l<m_lanes.size(); l++)
+		dev_locks->push_back(std::unique_lock<std::mutex>(*m_lanes[l]->m_devMutex));
+}
+
+// qasm message execution - lane devices locked by the caller, response in the given message
+qSim_qasm_message* qSim_qcpu::exec_instruction(qSim_qasm_message* msg_in, qSim_qasm_message* msg_out) {
 	// handle instruction execution based on instruction type and return response
+	// => queue wait from message arrival (if set) to dispatching
+	uint64_t t_disp = qSim_qstats::now_ns();
+	if (msg_in->get_tstamp() != 0)
+		qSim_qstats::record_duration(QSTATS_STAGE_QUEUE, msg_in->get_id(), msg_in->get_tstamp(),
+									 t_disp - msg_in->get_tstamp());
 
 	// allocate a qureg instruction object and process it
+	// => raw array results returned for binary encoding only
 	QASM_MSG_PARAMS_TYPE params;
-	if (qSim_qinstruction_base::is_core(msg_in)) {
+	QASM_MSG_ARRAYS_TYPE arrays;
+	if (msg_in->is_batch_message()) {
+		// perform transformation batch instruction - items checked and executed in order
+		exec_qureg_instruction_batch(msg_in, &params);
+	}
+	else if (qSim_qinstruction_base::is_core(msg_in)) {
 		// perform core instruction
 		qSim_qinstruction_core qr_instr(msg_in);
 
@@ -133,7 +304,7 @@ qSim_qasm_message* qSim_qcpu::dispatch_instruction(qSim_qasm_message* msg_in) {
 		SAFE_INSTRUCTION_VALIDITY_CHECK(std::string("core instruction"))
 
 		// execute instruction
-		exec_qureg_instruction_core(&qr_instr, &params);
+		exec_qureg_instruction_core(&qr_instr, &params, (msg_in->is_binary() ? &arrays : NULL));
 	}
 	else if (qSim_qinstruction_base::is_block(msg_in)) {
 		// perform block instruction
@@ -166,19 +337,74 @@ qSim_qasm_message* qSim_qcpu::dispatch_instruction(qSim_qasm_message* msg_in) {
 	std::string res_val = params[QASM_MSG_PARAM_TAG_RESULT];
 	cout << "qCpu message [" << msg_in->get_id() << "] executed - result: " << res_val << endl;
 
-	// build output message
+	qSim_qstats::record(QSTATS_STAGE_DISPATCH, msg_in->get_id(), t_disp);
+	if (msg_in->get_id() == QASM_MSG_ID_QREG_ST_TRANSFORM)
+		qSim_qstats::record(QSTATS_STAGE_TRANSFORM, atoi(msg_in->get_param_valueByTag(QASM_MSG_PARAM_TAG_F_TYPE).c_str()),
+							t_disp);
+
+	// fill output message - recycled one, if given by the allocator
 	int counter = msg_in->get_counter();
 	int id = QASM_MSG_ID_RESPONSE;
-	qSim_qasm_message* msg_out = new qSim_qasm_message(counter, id, params);
+	msg_out->set_content(counter, id, std::move(params), std::move(arrays));
+	msg_out->set_binary(msg_in->is_binary());
 	return msg_out;
 }
 
+// QASM instruction message scheduler
+void qSim_qcpu::schedule_instruction(qSim_qasm_message* msg_in, QCPU_DONE_CB_TYPE done_cb) {
+	// schedule instruction on given qureg lane - if any
+	// => quregs map read only on lanes, changed by qureg allocation, release and clone (also
+	//    accessing two quregs, possibly on different lanes)
+	int l = -1;
+	if ((m_lanes.size() > 1) && (msg_in->get_id() != QASM_MSG_ID_QREG_ALLOCATE) &&
+		(msg_in->get_id() != QASM_MSG_ID_QREG_RELEASE) && (msg_in->get_id() != QASM_MSG_ID_QREG_CLONE) &&
+		msg_in->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_H)) {
+		int qr_h;
+		if (qSim_qinstruction_base::get_msg_param_value_as_int(msg_in, QASM_MSG_PARAM_TAG_QREG_H, &qr_h)) {
+			map<QREG_HNDL_TYPE, int>::iterator it = m_qreg_lane_map.find(qr_h);
+			if (it != m_qreg_lane_map.end())
+				l = it->second;
+		}
+	}
+
+	if (l < 0) {
+		// no lane (single lane, quregs map change or wrong qureg) - executed by calling thread, once
+		// all scheduled instructions completed
+		wait_instructions();
+		qSim_qasm_message* msg_out = dispatch_instruction(msg_in);
+		done_cb(msg_in, msg_out);
+		return;
+	}
+
+	// queue instruction for completion in submission order and on its lane for execution
+	qSim_qcpu_task* task = new qSim_qcpu_task;
+	task->m_msgIn = msg_in;
+	task->m_msgOut = NULL;
+	task->m_msgResp = alloc_response();
+	task->m_done_cb = done_cb;
+	{
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		m_tasks.push_back(task);
+	}
+	qSim_qcpu_lane* lane = m_lanes[l];
+	{
+		std::lock_guard<std::mutex> lock(lane->m_mutex);
+		lane->m_tasks.push_back(task);
+	}
+	lane->m_cv_task.notify_one();
+}
+
+void qSim_qcpu::wait_instructions() {
+	std::unique_lock<std::mutex> lock(m_tasksMutex);
+	m_cv_tasksDone.wait(lock, [this] { return (m_tasks.size() == 0); });
+}
+
 // *********************************************************
 // *********************************************************
 
 #define SAFE_QREG_OBJ(qr_h, qr_obj) { \
 	if (m_qreg_map.count(qr_h)) \
-		qr_obj = m_qreg_map[qr_h]; \
+		qr_obj = m_qreg_map.at(qr_h); \
 	else { \
 		cerr << "qSim_qcpu - wrong qreg handler provided [" << qr_h << "]!!!" << endl; \
 		return false; \
@@ -186,23 +412,39 @@ qSim_qasm_message* qSim_qcpu::dispatch_instruction(qSim_qasm_message* msg_in) {
 }
 
 // qureg control - allocation for given number of qubits
-QREG_HNDL_TYPE qSim_qcpu::qureg_allocate(qSim_qinstruction_core* qr_instr) {
+bool qSim_qcpu::qureg_allocate(qSim_qinstruction_core* qr_instr, QREG_HNDL_TYPE* qr_h) {
 	// perform qureg allocation using given instruction fields, namely:
 	// - qureg size
+	// - batched qureg samples (1 if not batched)
 	//
 	// extract arguments
 	int qn = qr_instr->m_qn;
+	int sn = qr_instr->m_sn;
 	if (m_verbose)
-		cout << "qSim_qcpu::qureg_allocate - qn: " << qn << endl;
-
-	// create a new qreg instance of given size and store in the map
-	qSim_qreg* qr_obj = new qSim_qreg(qn, m_qcpu_device, m_verbose);
+		cout << "qSim_qcpu::qureg_allocate - qn: " << qn << " sn: " << sn << endl;
+
+	// bind qureg to the lane with fewest quregs
+	int l = 0;
+	for (size_t i=1; i<m_lanes.size(); i++)
+		if (m_lanes[i]->m_totQuregs < m_lanes[l]->m_totQuregs)
+			l = i;
+
+	// create a new qreg instance of given size on the lane device and store in the map - released
+	// if its states not allocated
+	qSim_qreg* qr_obj = new qSim_qreg(qn, m_lanes[l]->m_device, m_verbose, m_inPlace, m_totShards, m_totDevs, m_qnode, sn);
+	if (!qr_obj->isAllocated()) {
+		delete qr_obj;
+		return false;
+	}
+	qr_obj->setQmlCache(&m_lanes[l]->m_qmlCache);
 //	qr_obj->dump();
 
-	const QREG_HNDL_TYPE qr_h = s_qreg_id_counter;
-	m_qreg_map.insert(std::make_pair(qr_h, qr_obj));
-	s_qreg_id_counter++;
-	return qr_h;
+	*qr_h = m_qreg_id_counter;
+	m_qreg_map.insert(std::make_pair(*qr_h, qr_obj));
+	m_qreg_lane_map.insert(std::make_pair(*qr_h, l));
+	m_lanes[l]->m_totQuregs++;
+	m_qreg_id_counter++;
+	return true;
 }
 
 // qureg control - allocation for given number of qubits
@@ -219,16 +461,64 @@ bool qSim_qcpu::qureg_release(qSim_qinstruction_core* qr_instr) {
 	qSim_qreg* qr_obj;// = m_qreg_map[qr_h];
 	SAFE_QREG_OBJ(qr_h, qr_obj);
 	m_qreg_map.erase(qr_h);
+	m_lanes[m_qreg_lane_map[qr_h]]->m_totQuregs--;
+	m_qreg_lane_map.erase(qr_h);
 	delete qr_obj;
 	return true;
 }
 
+// qureg control - clone of a given qureg
+bool qSim_qcpu::qureg_clone(qSim_qinstruction_core* qr_instr, QREG_HNDL_TYPE* clh) {
+	// perform qureg clone using given instruction fields, namely:
+	// - source qureg handler
+	// - target qureg handler (0 for a new qureg, same size as the source one)
+	//
+	// extract arguments
+	int qr_h = qr_instr->m_qr_h;
+	int qr_clH = qr_instr->m_qr_clH;
+	if (m_verbose)
+		cout << "qSim_qcpu::qureg_clone - qr_h: " << qr_h << " qr_clH: " << qr_clH << endl;
+
+	qSim_qreg* qr_src;
+	SAFE_QREG_OBJ(qr_h, qr_src);
+
+	if (qr_clH != 0) {
+		// copy into the existing target qureg
+		qSim_qreg* qr_dst;
+		SAFE_QREG_OBJ(qr_clH, qr_dst);
+		if (!qr_dst->copyState(qr_src))
+			return false;
+
+		*clh = qr_clH;
+		return true;
+	}
+
+	// create a new qreg instance of the source size and samples, bound to the source lane (on
+	// the same devices), and copy the source states
+	int l = m_qreg_lane_map[qr_h];
+	qSim_qreg* qr_obj = new qSim_qreg(qr_src->getSampleQubits(), m_lanes[l]->m_device, m_verbose, m_inPlace,
+									  m_totShards, m_totDevs, m_qnode, qr_src->getTotSamples());
+	qr_obj->setQmlCache(&m_lanes[l]->m_qmlCache);
+	if (!qr_obj->isAllocated() || !qr_obj->copyState(qr_src)) {
+		delete qr_obj;
+		return false;
+	}
+
+	*clh = m_qreg_id_counter;
+	m_qreg_map.insert(std::make_pair(*clh, qr_obj));
+	m_qreg_lane_map.insert(std::make_pair(*clh, l));
+	m_lanes[l]->m_totQuregs++;
+	m_qreg_id_counter++;
+	return true;
+}
+
 // -----------------------------------------------------
 
 // qureg core instructions handling
 bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
-		                                    QASM_MSG_PARAMS_TYPE* params) {
+		                                    QASM_MSG_PARAMS_TYPE* params, QASM_MSG_ARRAYS_TYPE* arrays) {
 	// execute qureg core instruction using given instruction fields - based on instruction type
+	// => state values and measure indexes returned as raw arrays, if arrays given (binary encoding)
 	//
 	bool res;
 	std::string res_str;
@@ -238,12 +528,18 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 			// allocate a new qureg of given size and return the handler
 			//
 			// apply to qureg
-			QREG_HNDL_TYPE qr_h = qureg_allocate(qr_instr);
-			res = true;
+			QREG_HNDL_TYPE qr_h;
+			res = qureg_allocate(qr_instr, &qr_h);
 
 			// store result
-			params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
-			params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_H, to_string(qr_h)));
+			if (res) {
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_H, to_string(qr_h)));
+			}
+			else {
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, "qureg allocation error - states memory not available"));
+			}
 		}
 		break;
 
@@ -259,17 +555,38 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 		}
 		break;
 
+		case QASM_MSG_ID_QREG_CLONE: {
+			// clone a given qureg by handler and return the clone handler
+			//
+			// apply to qureg
+			QREG_HNDL_TYPE qr_h;
+			res = qureg_clone(qr_instr, &qr_h);
+
+			// store result
+			if (res) {
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_H, to_string(qr_h)));
+			}
+			else {
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, "qureg clone error - wrong handlers or size, or states memory not available"));
+			}
+		}
+		break;
+
 		// --------------------
 
 		case QASM_MSG_ID_QREG_ST_RESET:
 		case QASM_MSG_ID_QREG_ST_SET:
-		case QASM_MSG_ID_QREG_ST_TRANSFORM: {
-			// reset/set or transform qureg state
+		case QASM_MSG_ID_QREG_ST_TRANSFORM:
+		case QASM_MSG_ID_QREG_ST_SNAPSHOT:
+		case QASM_MSG_ID_QREG_ST_RESTORE: {
+			// reset/set or transform qureg state, or state snapshot/restore
 			//
 			// extract arguments
 			int qr_h = qr_instr->m_qr_h;
 			if (m_verbose)
-				cout << "qSim_qcpu::exec_qureg_instruction_core reset/set/transform - qr_h: " << qr_h << endl;
+				cout << "qSim_qcpu::exec_qureg_instruction_core reset/set/transform/snapshot/restore - qr_h: " << qr_h << endl;
 
 			// apply to qureg
 			qSim_qreg* qr_obj;
@@ -297,6 +614,61 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 			// apply to qureg
 			qSim_qreg* qr_obj;
 			SAFE_QREG_OBJ(qr_h, qr_obj);
+
+			if ((qr_instr->m_shots == 0) && (qr_obj->getTotSamples() > 1)) {
+				// batched qureg - measured state index and probability of each sample
+				QREG_ST_INDEX_ARRAY_TYPE m_sts;
+				std::vector<double> m_prs;
+				res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &m_sts, &m_prs);
+
+				// store result
+				if (res) {
+					if (m_verbose)
+						cout << "measure batched ok...samples: " << m_sts.size() << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_SMSTPRS, qr_instr->double_vector_to_string(m_prs)));
+					if (arrays != NULL)
+						arrays->m_iArrays[QASM_MSG_PARAM_TAG_QREG_SMSTIDXS].swap(m_sts);
+					else {
+						std::string m_sts_str = qr_instr->measure_index_value_to_string(m_sts);
+						params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_SMSTIDXS, m_sts_str));
+					}
+				}
+				else {
+					if (m_verbose)
+						cerr << "measure batched error!!" << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, res_str));
+				}
+				break;
+			}
+
+			if (qr_instr->m_shots != 0) {
+				// measurement shots - sampled outcome counts only
+				QREG_ST_INDEX_ARRAY_TYPE m_counts;
+				res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &m_counts);
+
+				// store result
+				if (res) {
+					if (m_verbose)
+						cout << "measure shots ok...m_counts.size: " << m_counts.size()/2 << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+					if (arrays != NULL)
+						arrays->m_iArrays[QASM_MSG_PARAM_TAG_QREG_MCOUNTS].swap(m_counts);
+					else {
+						std::string m_counts_str = qr_instr->measure_index_value_to_string(m_counts);
+						params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_MCOUNTS, m_counts_str));
+					}
+				}
+				else {
+					if (m_verbose)
+						cerr << "measure shots error!!" << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, res_str));
+				}
+				break;
+			}
+
 			QREG_ST_INDEX_TYPE m_st;
 			double m_pr;
 			QREG_ST_INDEX_ARRAY_TYPE m_vec;
@@ -310,8 +682,12 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
 				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_MSTIDX, to_string(m_st)));
 				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_MSTPR, qr_instr->double_value_to_string(m_pr)));
-				std::string m_vec_str = qr_instr->measure_index_value_to_string(m_vec);
-				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_MSTIDXS, m_vec_str));
+				if (arrays != NULL)
+					arrays->m_iArrays[QASM_MSG_PARAM_TAG_QREG_MSTIDXS].swap(m_vec);
+				else {
+					std::string m_vec_str = qr_instr->measure_index_value_to_string(m_vec);
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_MSTIDXS, m_vec_str));
+				}
 			}
 			else {
 				// measure error
@@ -337,6 +713,28 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 			// apply to qureg
 			qSim_qreg* qr_obj;
 			SAFE_QREG_OBJ(qr_h, qr_obj);
+
+			if (qr_obj->getTotSamples() > 1) {
+				// batched qureg - expectation of each sample
+				std::vector<double> m_exps;
+				res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &m_exps);
+
+				// store result
+				if (res) {
+					if (m_verbose)
+						cout << "expectation batched ok...samples: " << m_exps.size() << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_SEXSTVALS, qr_instr->double_vector_to_string(m_exps)));
+				}
+				else {
+					if (m_verbose)
+						cerr << "expectation batched error!!" << endl;
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, res_str));
+				}
+				break;
+			}
+
 			double m_exp;
 			res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &m_exp);
 
@@ -361,7 +759,8 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 		// --------------------
 
 		case QASM_MSG_ID_QREG_ST_PEEK: {
-			// peek qureg state values - diagnostics only
+			// peek qureg state values - diagnostics only (whole state vector or states page, or
+			// k most probable states with their indexes)
 			//
 			int qr_h = qr_instr->m_qr_h;
 			if (m_verbose)
@@ -371,13 +770,27 @@ bool qSim_qcpu::exec_qureg_instruction_core(qSim_qinstruction_core* qr_instr,
 			qSim_qreg* qr_obj;
 			SAFE_QREG_OBJ(qr_h, qr_obj);
 			QREG_ST_VAL_ARRAY_TYPE q_st;
-			res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &q_st);
+			QREG_ST_INDEX_ARRAY_TYPE q_idx;
+			if (qr_instr->m_st_topk != 0)
+				res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &q_st, &q_idx);
+			else
+				res = qr_obj->applyCoreInstruction(qr_instr, &res_str, &q_st);
 
 			// store result
 			if (res) {
-				std::string qr_st_str = qr_instr->state_value_to_string(q_st);
 				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
-				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_STVALS, qr_st_str));
+				if (arrays != NULL) {
+					arrays->m_cArrays[QASM_MSG_PARAM_TAG_QREG_STVALS].swap(q_st);
+					if (qr_instr->m_st_topk != 0)
+						arrays->m_iArrays[QASM_MSG_PARAM_TAG_QREG_STIDXS].swap(q_idx);
+				}
+				else {
+					std::string qr_st_str = qr_instr->state_value_to_string(q_st);
+					params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_STVALS, qr_st_str));
+					if (qr_instr->m_st_topk != 0)
+						params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_STIDXS,
+													  qr_instr->measure_index_value_to_string(q_idx)));
+				}
 			}
 			else {
 				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
@@ -480,6 +893,37 @@ bool qSim_qcpu::exec_qureg_instruction_block_qml(qSim_qinstruction_block_qml* qr
 		break;
 		// --------------------
 
+		case QASM_MSG_ID_QREG_ST_GRADIENT: {
+			// apply q-net to qureg state and calculate state expectation and its gradient
+			//
+			// extract arguments
+			int qr_h = qr_instr->m_qr_h;
+			if (m_verbose)
+				cout << "qSim_qcpu::exec_qureg_instruction_block_qml gradient - qr_h: " << qr_h << endl;
+
+			// apply to qureg
+			qSim_qreg* qr_obj;
+			SAFE_QREG_OBJ(qr_h, qr_obj);
+			double m_exp;
+			std::vector<double> m_grad;
+			res = qr_obj->applyBlockInstructionQml(qr_instr, &res_str, &m_exp, &m_grad);
+
+			// store result
+			if (res) {
+				if (m_verbose)
+					cout << "gradient ok...m_exp: " << m_exp << " params: " << m_grad.size() << endl;
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_EXSTVAL, qr_instr->double_value_to_string(m_exp)));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_GRVALS, qr_instr->double_vector_to_string(m_grad)));
+			}
+			else {
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+				params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, res_str));
+			}
+		}
+		break;
+		// --------------------
+
 		default: {
 			// error case
 			cerr << "qSim_qcpu::exec_qureg_instruction_block_qml - unhandled qasm message type "
@@ -492,6 +936,122 @@ bool qSim_qcpu::exec_qureg_instruction_block_qml(qSim_qinstruction_block_qml* qr
 	return res;
 }
 
+// -----------------------------------------------------
+
+// qureg transformation batch handling
+bool qSim_qcpu::exec_qureg_instruction_batch(qSim_qasm_message* msg_in, QASM_MSG_PARAMS_TYPE* params) {
+	// execute batch items back-to-back on the given qureg and return one aggregated result
+	// => items params tagged as <par_tag>#<item_idx>, one transformation message each
+	// => consecutive core items applied as a single instruction list (gate fusion enabled)
+	//
+	params->clear();
+
+	// extract arguments
+	int qr_h;
+	int b_n;
+	if (!qSim_qinstruction_base::get_msg_param_value_as_int(msg_in, QASM_MSG_PARAM_TAG_QREG_H, &qr_h) ||
+		!qSim_qinstruction_base::get_msg_param_value_as_int(msg_in, QASM_MSG_PARAM_TAG_QREG_BN, &b_n) ||
+		(b_n < 0)) {
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, "batch instruction syntax error"));
+		return false;
+	}
+	if (m_verbose)
+		cout << "qSim_qcpu::exec_qureg_instruction_batch - qr_h: " << qr_h << " b_n: " << b_n << endl;
+
+	if (m_qreg_map.count(qr_h) == 0) {
+		cerr << "qSim_qcpu - wrong qreg handler provided [" << qr_h << "]!!!" << endl;
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, "wrong qureg handler"));
+		return false;
+	}
+	qSim_qreg* qr_obj = m_qreg_map.at(qr_h);
+
+	// split message params by item index - single pass
+	std::vector<QASM_MSG_PARAMS_TYPE> b_params(b_n);
+	QASM_MSG_PARAMS_TYPE msg_params = msg_in->get_params();
+	for (QASM_MSG_PARAMS_TYPE::iterator it=msg_params.begin(); it!=msg_params.end(); it++) {
+		size_t idx = it->first.rfind(QASM_MSG_BATCH_IDX_SEP);
+		if (idx == std::string::npos)
+			continue;
+		int b_idx = atoi(it->first.c_str()+idx+1);
+		if ((b_idx >= 0) && (b_idx < b_n))
+			b_params[b_idx].insert(std::make_pair(it->first.substr(0, idx), it->second));
+	}
+
+	// execute items in order
+	bool res = true;
+	std::string res_str;
+	int b_done = 0;
+	std::list<qSim_qinstruction_core*> qr_instr_list;
+	for (int k=0; (k<b_n) && res; k++) {
+		b_params[k][QASM_MSG_PARAM_TAG_QREG_H] = to_string(qr_h);
+		qSim_qasm_message item_msg(msg_in->get_counter(), QASM_MSG_ID_QREG_ST_TRANSFORM, b_params[k]);
+
+		if (qSim_qinstruction_base::is_core(&item_msg)) {
+			// core item - queued for execution with following ones
+			qSim_qinstruction_core* qr_instr = new qSim_qinstruction_core(&item_msg);
+			if (!qr_instr->is_valid()) {
+				cerr << "qSim_qcpu::exec_qureg_instruction_batch - incorrect core instruction received [#" << k << "]!!" << endl;
+				delete qr_instr;
+				res_str = "core instruction transformation syntax error";
+				res = false;
+			}
+			else
+				qr_instr_list.push_back(qr_instr);
+			continue;
+		}
+
+		// block item - pending core items executed first
+		res = exec_batch_core_list(qr_obj, &qr_instr_list, &b_done, &res_str);
+		if (!res)
+			break;
+
+		if (qSim_qinstruction_base::is_block(&item_msg)) {
+			qSim_qinstruction_block qr_instr = qSim_qinstruction_block(&item_msg);
+			if (qr_instr.is_valid())
+				res = qr_obj->applyBlockInstruction(&qr_instr, &res_str);
+			else {
+				res_str = "block instruction transformation syntax error";
+				res = false;
+			}
+		}
+		else if (qSim_qinstruction_base::is_block_qml(&item_msg)) {
+			qSim_qinstruction_block_qml qr_instr = qSim_qinstruction_block_qml(&item_msg);
+			if (qr_instr.is_valid())
+				res = qr_obj->applyBlockInstructionQml(&qr_instr, &res_str);
+			else {
+				res_str = "QML block instruction transformation syntax error";
+				res = false;
+			}
+		}
+		else {
+			cerr << "qSim_qcpu::exec_qureg_instruction_batch - unhandled batch item [#" << k << "]!!" << endl;
+			res_str = "Unhandled batch item type";
+			res = false;
+		}
+		if (res)
+			b_done++;
+	}
+	if (res)
+		res = exec_batch_core_list(qr_obj, &qr_instr_list, &b_done, &res_str);
+	else {
+		// release pending core items not executed
+		for (std::list<qSim_qinstruction_core*>::iterator it = qr_instr_list.begin(); it != qr_instr_list.end(); ++it)
+			delete *it;
+	}
+
+	// store result
+	params->insert(std::make_pair(QASM_MSG_PARAM_TAG_QREG_BDONE, to_string(b_done)));
+	if (res)
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK));
+	else {
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK));
+		params->insert(std::make_pair(QASM_MSG_PARAM_TAG_ERROR, "batch stopped after " + to_string(b_done) + " items - " + res_str));
+	}
+	return res;
+}
+
 // *********************************************************
 
 // monitoring & diagnostics
@@ -529,5 +1089,62 @@ void qSim_qcpu::qreg_mapRelease() {
 		delete keyval_pair.second;
 	}
 	m_qreg_map.clear();
+	m_qreg_lane_map.clear();
+	for (size_t l=0; l<m_lanes.size(); l++)
+		m_lanes[l]->m_totQuregs = 0;
+}
+
+// lane worker thread loop - lane instructions executed in program order
+void qSim_qcpu::lane_loop(qSim_qcpu_lane* lane) {
+	while (true) {
+		qSim_qcpu_task* task;
+		{
+			std::unique_lock<std::mutex> lock(lane->m_mutex);
+			lane->m_cv_task.wait(lock, [lane] { return (lane->m_stop || (lane->m_tasks.size() > 0)); });
+			if (lane->m_tasks.size() == 0)
+				break;
+			task = lane->m_tasks.front();
+			lane->m_tasks.pop_front();
+		}
+
+		// execute instruction on the lane device (locked against other qcpu handlers) and complete
+		// all instructions done so far, in submission order
+		qSim_qasm_message* msg_out;
+		{
+			std::lock_guard<std::mutex> dev_lock(*lane->m_devMutex);
+			msg_out = exec_instruction(task->m_msgIn, task->m_msgResp);
+		}
+		std::lock_guard<std::mutex> lock(m_tasksMutex);
+		task->m_msgOut = msg_out;
+		complete_tasks();
+	}
+}
+
+// scheduled instructions completion - in submission order (tasks lock held by caller)
+void qSim_qcpu::complete_tasks() {
+	while ((m_tasks.size() > 0) && (m_tasks.front()->m_msgOut != NULL)) {
+		qSim_qcpu_task* task = m_tasks.front();
+		m_tasks.pop_front();
+		task->m_done_cb(task->m_msgIn, task->m_msgOut);
+		delete task;
+	}
+	if (m_tasks.size() == 0)
+		m_cv_tasksDone.notify_all();
+}
+
+// execute and release batch pending core instructions - executed items count updated on success
+bool qSim_qcpu::exec_batch_core_list(qSim_qreg* qr_obj, std::list<qSim_qinstruction_core*>* qr_instr_list,
+									 int* b_done, std::string* res_str) {
+	if (qr_instr_list->size() == 0)
+		return true;
+
+	bool res = qr_obj->applyCoreInstructionList(qr_instr_list, res_str);
+	if (res)
+		(*b_done) += qr_instr_list->size();
+
+	for (std::list<qSim_qinstruction_core*>::iterator it = qr_instr_list->begin(); it != qr_instr_list->end(); ++it)
+		delete *it;
+	qr_instr_list->clear();
+	return res;
 }
 
@@ -41,6 +41,26 @@
  *                   to qSim_qcpu_device.
  *                   Code clean-up.
  *  2.2   Feb-2023   Handled QML function blocks (feature map and q-net).
+ *  2.3   Oct-2026   Handled CPU device worker threads number passage as constructor
+ *                   argument.
+ *  2.4   Oct-2026   Handled qureg in-place mode passage as constructor argument.
+ *  2.5   Oct-2026   Handled qureg transformation batch messages.
+ *  2.6   Oct-2026   Handled binary message encoding, returning state values and measure
+ *                   indexes as raw arrays.
+ *  2.7   Oct-2026   Handled qureg state vector shards number passage as constructor argument.
+ *  2.8   Oct-2026   Handled cluster node passage as constructor argument (distributed quregs).
+ *  2.9   Oct-2026   Handled qureg handlers counter per instance (one qcpu per client session).
+ *  2.10  Oct-2026   Supported instruction scheduling on qureg lanes - quregs bound to a lane
+ *                   (own worker thread and device), executed concurrently to other lanes in
+ *                   program order, and responses returned in submission order.
+ *  2.11  Oct-2026   Supported qureg clone (new qureg or existing target).
+ *  2.12  Oct-2026   Handled QML block templates cache per qureg lane.
+ *  2.13  Oct-2026   Handled CPU device memory policy passage as constructor argument.
+ *  2.14  Oct-2026   Handled qureg allocation failure (error result returned).
+ *  2.15  Oct-2026   Handled devices warm-up as a static method, called once per process.
+ *  2.16  Oct-2026   Handled lane devices shared by all qcpu handlers (one device and CPU
+ *                   worker pool per lane), instructions execution serialised on each device.
+ *  2.17  Oct-2026   Handled response messages taken from a given allocator (recycled ones).
  *
  *  --------------------------------------------------------------------------
  */
@@ -50,11 +70,18 @@
 #define QSIM_QCPU_H_
 
 #include <map>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
 
 #include "qSim_qreg.h"
 #include "qSim_qinstruction_core.h"
 #include "qSim_qinstruction_block.h"
 #include "qSim_qinstruction_block_qml.h"
+#include "qSim_qcpu_node.h"
 
 #ifndef __QSIM_CPU__
 #include <qSim_qcpu_device_GPU_CUDA.h>
@@ -65,15 +92,79 @@
 // data type for qreg handlers
 typedef unsigned int QREG_HNDL_TYPE;
 
+// scheduled instruction completion callback - instruction and response messages (owned by callee)
+typedef std::function<void (qSim_qasm_message*, qSim_qasm_message*)> QCPU_DONE_CB_TYPE;
+
+// response message allocator - empty message (recycled one, if any), called by the instructions
+// submitting thread only
+typedef std::function<qSim_qasm_message* ()> QCPU_ALLOC_CB_TYPE;
+
+// scheduled instruction - response set once executed
+struct qSim_qcpu_task {
+	qSim_qasm_message* m_msgIn;
+	qSim_qasm_message* m_msgOut;
+	qSim_qasm_message* m_msgResp;	// response message taken on submission, filled on execution
+	QCPU_DONE_CB_TYPE m_done_cb;
+};
+
+// qcpu lane devices - one device (and CPU worker pool) for each lane, shared by the same lane
+// of all qcpu handlers (client sessions), instructions executed holding the device lock (device
+// calls not re-entrant)
+class qSim_qcpu_devices {
+	public:
+		qSim_qcpu_devices(int tot_threads=1, int tot_lanes=1, int mem_policy=0);
+		virtual ~qSim_qcpu_devices();
+
+		int size() { return m_devices.size(); }
+		qSim_qcpu_device* device(int l) { return m_devices[l]; }
+		std::mutex* mutex(int l) { return m_mutexes[l]; }
+
+	private:
+		std::vector<qSim_qcpu_device*> m_devices;
+		std::vector<std::mutex*> m_mutexes;
+};
+
+// qureg lane - instructions of the quregs bound to it executed in program order by its own
+// worker thread and (shared) device, concurrently to other lanes
+struct qSim_qcpu_lane {
+	qSim_qcpu_device* m_device;
+	std::mutex* m_devMutex;
+	std::thread m_thr_id;
+	std::deque<qSim_qcpu_task*> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_cv_task;
+	bool m_stop;
+	int m_totQuregs;
+	qSim_qinstruction_block_qml_cache m_qmlCache;	// lane quregs QML block templates
+};
+
 class qSim_qcpu {
 	public:
 		// constructor and destructor
-		qSim_qcpu(bool verbose=false);
+		// - lane devices shared with other qcpu handlers if given (lanes limited to their number),
+		//   own ones otherwise
+		qSim_qcpu(bool verbose=false, int tot_threads=1, bool in_place=false, int tot_shards=1,
+				  qSim_qcpu_node* qnode=NULL, int tot_lanes=1, int mem_policy=0,
+				  qSim_qcpu_devices* devices=NULL);
 		virtual ~qSim_qcpu();
 
-		// QASM instruction message dispatcher
+		// QASM instruction message dispatcher - executed holding all lane devices locks
 		qSim_qasm_message* dispatch_instruction(qSim_qasm_message* msg_in);
 
+		// QASM instruction message scheduler - executed on the qureg lane (qureg allocation and
+		// release once all lanes are done), with completion callbacks called in submission order
+		void schedule_instruction(qSim_qasm_message* msg_in, QCPU_DONE_CB_TYPE done_cb);
+
+		// wait for all scheduled instructions completion
+		void wait_instructions();
+
+		// response messages allocator - new messages if not set
+		void set_response_alloc(QCPU_ALLOC_CB_TYPE alloc_cb);
+
+		// devices warm-up - contexts and kernels ready before the first request, once per process
+		// (not per qcpu handler)
+		static void devices_warmup(bool verbose=false);
+
 		// ----------------------------------------
 		// qcpu instructions execution handlers
 
@@ -82,11 +173,13 @@ class qSim_qcpu {
 		bool switchOff();
 
 		// qureg control
-		QREG_HNDL_TYPE qureg_allocate(qSim_qinstruction_core*);
+		bool qureg_allocate(qSim_qinstruction_core*, QREG_HNDL_TYPE*);
 		bool qureg_release(qSim_qinstruction_core*);
+		bool qureg_clone(qSim_qinstruction_core*, QREG_HNDL_TYPE*);
 
 		// qureg core instructions handling
-		bool exec_qureg_instruction_core(qSim_qinstruction_core*, QASM_MSG_PARAMS_TYPE*);
+		bool exec_qureg_instruction_core(qSim_qinstruction_core*, QASM_MSG_PARAMS_TYPE*,
+										 QASM_MSG_ARRAYS_TYPE* arrays=NULL);
 
 		// qureg block instructions handling
 		bool exec_qureg_instruction_block(qSim_qinstruction_block*, QASM_MSG_PARAMS_TYPE*);
@@ -94,6 +187,9 @@ class qSim_qcpu {
 		// qureg QML block instructions handling
 		bool exec_qureg_instruction_block_qml(qSim_qinstruction_block_qml*, QASM_MSG_PARAMS_TYPE*);
 
+		// qureg transformation batch handling (core and block instructions items)
+		bool exec_qureg_instruction_batch(qSim_qasm_message*, QASM_MSG_PARAMS_TYPE*);
+
 		// diagnostics
 		void dump();
 #ifndef __QSIM_CPU__
@@ -110,8 +206,51 @@ class qSim_qcpu {
 		// diagnostic message control
 		bool m_verbose;
 
+		// qureg in-place mode control (single device register)
+		bool m_inPlace;
+
+		// qureg state vector sharding control - shards number and devices they are spread on
+		int m_totShards;
+		int m_totDevs;
+
+		// cluster node - quregs shards distributed on all nodes (NULL for single node)
+		qSim_qcpu_node* m_qnode;
+
+		// qureg handlers counter - own handlers namespace for each instance
+		QREG_HNDL_TYPE m_qreg_id_counter;
+
+		// lane devices - own ones released on destruction
+		qSim_qcpu_devices* m_devices;
+		bool m_ownDevices;
+
+		// qureg lanes - first lane on the qcpu device, qureg lane bound on allocation (lanes
+		// and quregs map changed with no scheduled instructions only)
+		std::vector<qSim_qcpu_lane*> m_lanes;
+		map<QREG_HNDL_TYPE, int> m_qreg_lane_map;
+
+		// response messages allocator - submitting thread only
+		QCPU_ALLOC_CB_TYPE m_alloc_cb;
+		qSim_qasm_message* alloc_response();
+
+		// scheduled instructions - in submission order, for completion callbacks
+		std::deque<qSim_qcpu_task*> m_tasks;
+		std::mutex m_tasksMutex;
+		std::condition_variable m_cv_tasksDone;
+
+		void lane_loop(qSim_qcpu_lane* lane);
+
+		// instruction execution - lane devices locked by the caller (all of them, in lanes
+		// order, if not executed by a lane), response filled in the given message
+		qSim_qasm_message* exec_instruction(qSim_qasm_message* msg_in, qSim_qasm_message* msg_out);
+		void lock_devices(std::vector<std::unique_lock<std::mutex> >* dev_locks);
+		void complete_tasks();
+
 		// qureg map deallocation
 		void qreg_mapRelease();
+
+		// batch pending core instructions execution and release
+		bool exec_batch_core_list(qSim_qreg* qr_obj, std::list<qSim_qinstruction_core*>* qr_instr_list,
+								  int* b_done, std::string* res_str);
 	};
 
 #endif /* QSIM_QCPU_H_ */
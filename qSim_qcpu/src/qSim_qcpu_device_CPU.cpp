@@ -32,14 +32,60 @@
  *  --------------------------------------------------------------------------
  *  1.0   Dec-2022   Module creation adapting qSim_qcup_GPU_CUDA and agnostic
  *                   class renaming to qSim_qcpu_device.
+ *  1.1   Oct-2026   Handled 1-qubit gates by a dedicated strided 2x2 butterfly
+ *                   path, with gate matrix evaluated once per instruction.
+ *                   Handled multithreaded kernels execution via persistent
+ *                   worker thread pool, partitioning the state vector.
+ *  1.2   Oct-2026   Handled 64-bit state indexes and function vectors sized on
+ *                   qureg allocation (no max qureg size limit).
+ *  1.3   Oct-2026   Handled in-place 2-qubit and n-qubit gates application on
+ *                   qubit groups, and device memory allocation with no host data.
+ *  1.4   Oct-2026   Handled dense k-qubit unitary functions (fused gates).
+ *  1.5   Oct-2026   Handled qureg state marginal probabilities, expectation and
+ *                   measure collapse on device states, partitioned on pool workers
+ *                   with partial results summed up in chunk order.
+ *  1.6   Oct-2026   Handled kernels templated on gate family, selected once per
+ *                   instruction, with gates block loops limited to non-gap states.
+ *  1.7   Oct-2026   Handled diagonal and permutation gates fast path, applied in-place
+ *                   as index phase multiply and index bits swap, and fused unitaries with
+ *                   a single non-zero element per row as state index table lookup.
+ *  1.8   Oct-2026   Handled controlled gates by bitmask engine, applied in-place on the
+ *                   state groups having all control bits set only.
+ *  1.9   Oct-2026   Handled copies between device vectors (qureg shards exchanges),
+ *                   partitioned on pool workers.
+ *  1.10  Oct-2026   Handled vectorized kernels (AVX2/AVX-512, selected at run time) for
+ *                   1-qubit butterfly, dense unitaries, diagonal gates phase multiply
+ *                   and norm reductions, on runs of contiguous states.
+ *  1.11  Oct-2026   Handled batched dense unitaries (one matrix per state vector sample),
+ *                   partitioned on pool workers over all samples.
+ *  1.12  Oct-2026   Handled qureg state top-k reduction, with candidates kept per chunk
+ *                   and merged in chunk order.
+ *  1.13  Oct-2026   Handled device kernels statistics, host timed around synchronous kernels.
+ *  1.14  Oct-2026   Handled state vectors memory policy - large vectors on mapped memory with
+ *                   transparent or explicit huge pages, interleaved on NUMA nodes or placed
+ *                   on first touch by the pool workers on their own chunks - and host <-->
+ *                   device copies partitioned on pool workers.
+ *  1.15  Oct-2026   Handled controlled gates resolution for bitmask engine on any qubits layout.
  *
  *  --------------------------------------------------------------------------
  */
 
 #include <cstring>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include <qSim_qcpu_device_CPU.h>
-#include <qSim_qcpu_device_function_exec.h>
+#include <qSim_qcpu_device_CPU_simd.h>
+#include <qSim_qcpu_device_function_fast_gates.h>
 
 
 // --------------------------------
@@ -49,10 +95,10 @@
 // --------------------------------
 // sequential processing case
 
-void sequential_prod_fxi(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, int idx, int N,
-						QASM_F_TYPE* d_ftype_cuda_vec, int* d_fn_cuda_vec,
-						QDEV_F_ARGS_TYPE* d_fargs_cuda_vec, int tot_f, int max_block_size, int block_inner_gap_size,
-						int /*ftype*/, int fn, int fform, int gapn, int futype, int fun, int fuform) {
+template<class F_GATE>
+void sequential_prod_fxi(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE idx, QDEV_ST_INDEX_TYPE N,
+						 QDEV_ST_INDEX_TYPE max_block_size, QDEV_ST_INDEX_TYPE block_inner_gap_size,
+						 int fn, int frep, const QDEV_F_PARAMS_TYPE& fparams) {
 	// single kernel case
 
 	// combine all i-th row with x elements for y i-th result
@@ -60,39 +106,195 @@ void sequential_prod_fxi(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, int idx, int
 		y[idx] = QDEV_ST_MAKE_VAL(0.0, 0.0);
 
 		// define current calculation limits considering LSQ & MSQ gap fillers generated zeroes
-	    int k_step = block_inner_gap_size;
-		int k_start = max(0, (idx/max_block_size)*max_block_size);
-		int k_stop = min(N-1, k_start+max_block_size-1);
-
-		for (int k=k_start; k<k_stop+1; k++) {
-			// check for calculation limits considering LSQ gap fillers generated zeroes
-			if (k % k_step == idx % k_step) {
-				y[idx] += x[k] * f_dev_qn_exec(idx, k, d_ftype_cuda_vec, d_fn_cuda_vec,
-										   	   fn, fform, gapn, futype, fun, fuform, d_fargs_cuda_vec, tot_f);
+		// => only states within the same max block and sharing the LSQ gap bits
+	    QDEV_ST_INDEX_TYPE k_step = block_inner_gap_size;
+		QDEV_ST_INDEX_TYPE k_start = (idx/max_block_size)*max_block_size + idx%k_step;
+		QDEV_ST_INDEX_TYPE k_stop = min(N, (idx/max_block_size+1)*max_block_size);
+		QDEV_ST_INDEX_TYPE i_f = (idx%max_block_size)/k_step;
+
+		QDEV_ST_INDEX_TYPE j_f = 0;
+		for (QDEV_ST_INDEX_TYPE k=k_start; k<k_stop; k+=k_step, j_f++)
+			y[idx] += x[k] * f_dev_qn_exec<F_GATE>(i_f, j_f, fn, frep, fparams);
+	}
+}
+
+// gate family runner - product kernel on N elements, partitioned on pool workers
+struct qSim_qcpu_device_f_run_prod {
+	qSim_qcpu_device_CPU_pool* m_pool;
+	QDEV_ST_VAL_TYPE* m_x;
+	QDEV_ST_VAL_TYPE* m_y;
+	QDEV_ST_INDEX_TYPE m_N;
+	QDEV_ST_INDEX_TYPE m_max_block_size;
+	QDEV_ST_INDEX_TYPE m_block_inner_gap_size;
+	int m_fn;
+	int m_frep;
+
+	template<class F_GATE>
+	int run(const QDEV_F_PARAMS_TYPE& fparams) const {
+		m_pool->run(m_N, [&](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+			for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++) {
+				sequential_prod_fxi<F_GATE>(m_x, m_y, idx, m_N, m_max_block_size, m_block_inner_gap_size,
+											m_fn, m_frep, fparams);
+			}
+		});
+		return QDEV_RES_OK;
+	}
+};
+
+// --------------------------------
+// fast path gates case (1-qubit diagonal and permutation gates)
+
+void sequential_fast_diag(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE k_start, QDEV_ST_INDEX_TYPE k_stop,
+						  const QDEV_F_FAST_PARAMS_TYPE& fparams, const QDEV_SIMD_KERNELS_TYPE* simd) {
+	// multiply x states by their index phase factor, directly on x states
+	// => states in range [k_start, k_stop) handled - unit factors skipped
+	// => phase factor shared by the runs of states below the lowest gate qubit, each run
+	//    multiplied at once
+	QDEV_ST_INDEX_TYPE run = (QDEV_ST_INDEX_TYPE)1 << fparams.flsq;
+	for (QDEV_ST_INDEX_TYPE k=k_start; k<k_stop; ) {
+		QDEV_ST_INDEX_TYPE r_stop = min(k_stop, (k | (run-1)) + 1);
+		QDEV_ST_VAL_TYPE f_val = f_dev_fast_diag_val(k, fparams);
+		if (f_val != QDEV_ST_MAKE_VAL(1.0, 0.0))
+			simd->scale(x + k, r_stop - k, f_val);
+		k = r_stop;
+	}
+}
+
+void sequential_fast_perm(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE k_start, QDEV_ST_INDEX_TYPE k_stop,
+						  const QDEV_F_FAST_PARAMS_TYPE& fparams) {
+	// swap x states with their partner state, directly on x states
+	// => pairs with lower index in range [k_start, k_stop) handled
+	for (QDEV_ST_INDEX_TYPE k=k_start; k<k_stop; k++) {
+		QDEV_ST_INDEX_TYPE k_p = k ^ fparams.f_mask;
+		if (k_p > k)
+			std::swap(x[k], x[k_p]);
+	}
+}
+
+void sequential_fast_mtx(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+						 const QDEV_F_FAST_MTX_PARAMS_TYPE& fparams) {
+	// apply given single non-zero per row unitary to the fn qubits starting at flsq, directly
+	// on x states - each group state taken from its table one, gathered before update
+	// => groups in range [g_start, g_stop) handled, out of N/2^fn total
+	int q_lo = fparams.flsq;
+	int fsize = 1 << fparams.fn;
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	QDEV_ST_VAL_TYPE x_grp[1 << QDEV_F_DENSE_MAX_QUBITS];
+	for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fparams.fn)) | (g & lo_mask);
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = x[base + ((QDEV_ST_INDEX_TYPE)j << q_lo)];
+		for (int i=0; i<fsize; i++)
+			x[base + ((QDEV_ST_INDEX_TYPE)i << q_lo)] = fparams.p_val[i] * x_grp[fparams.p_idx[i]];
+	}
+}
+
+// --------------------------------
+// controlled gates case (bitmask engine)
+
+void sequential_fast_ctrl(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+						  const QDEV_F_CTRL_PARAMS_TYPE& fparams) {
+	// apply U-gate to the target qubits of each group having all control bits set, directly
+	// on x states - group states gathered before update
+	// => groups in range [g_start, g_stop) handled, out of N/2^(controls+targets) total
+	int usize = 1 << fparams.tn;
+	QDEV_ST_VAL_TYPE x_grp[1 << QDEV_F_UMTX_MAX_QUBITS];
+	for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+		QDEV_ST_INDEX_TYPE base = f_dev_ctrl_group_base(g, fparams);
+		for (int j=0; j<usize; j++)
+			x_grp[j] = x[base + fparams.t_off[j]];
+		if (fparams.p_mono) {
+			for (int i=0; i<usize; i++)
+				x[base + fparams.t_off[i]] = fparams.p_val[i] * x_grp[fparams.p_idx[i]];
+		}
+		else {
+			for (int i=0; i<usize; i++) {
+				const QDEV_ST_VAL_TYPE* m_i = &fparams.u_mtx[i*usize];
+				QDEV_ST_VAL_TYPE y_i = QDEV_ST_MAKE_VAL(0.0, 0.0);
+				for (int j=0; j<usize; j++)
+					y_i += m_i[j] * x_grp[j];
+				x[base + fparams.t_off[i]] = y_i;
 			}
 		}
 	}
 }
 
+// --------------------------------
+// in-place gate application case
+
+// gate matrix row element - non-zero values only
+struct qSim_qcpu_device_f_entry {
+	int j;
+	QDEV_ST_VAL_TYPE val;
+};
+typedef std::vector<std::vector<qSim_qcpu_device_f_entry>> QDEV_F_ROWS_TYPE;
+
+// gate family runner - gate matrix non-zero elements, rows partitioned on pool workers
+struct qSim_qcpu_device_f_run_rows {
+	qSim_qcpu_device_CPU_pool* m_pool;
+	QDEV_F_ROWS_TYPE* m_rows;
+	int m_fsize;
+
+	template<class F_GATE>
+	int run(const QDEV_F_PARAMS_TYPE& fparams) const {
+		m_pool->run(m_fsize, [&](QDEV_ST_INDEX_TYPE i_start, QDEV_ST_INDEX_TYPE i_stop, int) {
+			for (QDEV_ST_INDEX_TYPE i=i_start; i<i_stop; i++) {
+				for (int j=0; j<m_fsize; j++) {
+					QDEV_ST_VAL_TYPE f_val = F_GATE::val((int)i, j, fparams);
+					if (abs(f_val) >= QDEV_F_VAL_EPS)
+						(*m_rows)[i].push_back({j, f_val});
+				}
+			}
+		});
+		return QDEV_RES_OK;
+	}
+};
+
+void sequential_group_inplace(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+							  int q_lo, int fn, const QDEV_F_ROWS_TYPE& f_rows) {
+	// apply given gate matrix (sparse rows) to the fn qubits starting at q_lo, directly on x states
+	// => each group collects the 2^fn states sharing all other qubits, gathered before update
+	// => groups in range [g_start, g_stop) handled, out of N/2^fn total
+	int fsize = 1 << fn;
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	std::vector<QDEV_ST_VAL_TYPE> x_grp(fsize);
+	for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fn)) | (g & lo_mask);
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = x[base + ((QDEV_ST_INDEX_TYPE)j << q_lo)];
+		for (int i=0; i<fsize; i++) {
+			QDEV_ST_VAL_TYPE y_i = QDEV_ST_MAKE_VAL(0.0, 0.0);
+			for (unsigned int k=0; k<f_rows[i].size(); k++)
+				y_i += f_rows[i][k].val * x_grp[f_rows[i][k].j];
+			x[base + ((QDEV_ST_INDEX_TYPE)i << q_lo)] = y_i;
+		}
+	}
+}
+
 
 // --------------------------------------------------------
 // class methods
 // --------------------------------------------------------
 
-#define CPU_QREG_MAX_N 20 			// max qureg size supported
-#define CPU_TOT_F CPU_QREG_MAX_N  // bounded by max qureg size
-
 // constructor & destructor
-qSim_qcpu_device::qSim_qcpu_device() {
-    // allocate function host vectors
-    m_ftype_vec = (QASM_F_TYPE*)malloc(CPU_TOT_F*sizeof(QASM_F_TYPE));
-    m_fsize_vec = (int*)malloc(CPU_TOT_F*sizeof(int));
-    m_fargs_vec = (QDEV_F_ARGS_TYPE*)malloc(CPU_TOT_F*sizeof(QDEV_F_ARGS_TYPE));
+qSim_qcpu_device::qSim_qcpu_device(int tot_threads, int mem_policy) {
+    // function host vectors - sized on qureg allocation
+    m_ftype_vec = NULL;
+    m_fsize_vec = NULL;
+    m_fargs_vec = NULL;
+    m_tot_f_max = 0;
 
-    // device vectors direct link to host vectors
-    d_ftype_dev_vec = m_ftype_vec;
-    d_fsize_dev_vec = m_fsize_vec;
-    d_fargs_dev_vec = m_fargs_vec;
+    // start worker thread pool
+    m_thr_pool = new qSim_qcpu_device_CPU_pool(tot_threads);
+
+    // vectorized kernels - highest instruction set supported by the CPU
+    m_simd = qdev_simd_select();
+
+    // kernels statistics start time
+    m_stats_t0 = 0;
+
+    // state vectors memory policy
+    m_mem_policy = mem_policy;
 }
 
 qSim_qcpu_device::~qSim_qcpu_device() {
@@ -100,6 +302,37 @@ qSim_qcpu_device::~qSim_qcpu_device() {
 	free(m_ftype_vec);
 	free(m_fsize_vec);
 	free(m_fargs_vec);
+
+	// stop worker thread pool
+	delete m_thr_pool;
+}
+
+// ---------------------------------------------------------
+// function tables sizing
+// ---------------------------------------------------------
+
+int qSim_qcpu_device::dev_qreg_function_tables_reserve(int qn) {
+	// grow function vectors for the given qureg size, if needed - as gap fillers
+	// span at least 1 qubit each, total function elements are bounded by qn
+	if (qn <= m_tot_f_max)
+		return QDEV_RES_OK;
+
+	QASM_F_TYPE* ftype_vec = (QASM_F_TYPE*)realloc(m_ftype_vec, qn*sizeof(QASM_F_TYPE));
+	if (ftype_vec != NULL)
+		m_ftype_vec = ftype_vec;
+	QDEV_ST_INDEX_TYPE* fsize_vec = (QDEV_ST_INDEX_TYPE*)realloc(m_fsize_vec, qn*sizeof(QDEV_ST_INDEX_TYPE));
+	if (fsize_vec != NULL)
+		m_fsize_vec = fsize_vec;
+	QDEV_F_ARGS_TYPE* fargs_vec = (QDEV_F_ARGS_TYPE*)realloc(m_fargs_vec, qn*sizeof(QDEV_F_ARGS_TYPE));
+	if (fargs_vec != NULL)
+		m_fargs_vec = fargs_vec;
+	if ((ftype_vec == NULL) || (fsize_vec == NULL) || (fargs_vec == NULL)) {
+		printf("cpu_qreg_function_tables_reserve: function vectors allocation failed for qureg size %d - error!!\n", qn);
+		return QDEV_RES_ERROR; // return error
+	}
+	m_tot_f_max = qn;
+
+	return QDEV_RES_OK;
 }
 
 // ---------------------------------------------------------
@@ -107,14 +340,14 @@ qSim_qcpu_device::~qSim_qcpu_device() {
 // ---------------------------------------------------------
 
 // => 1-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 														  QASM_F_TYPE ftype, int frep, int flsq,
 														  QREG_F_ARGS_TYPE* fargs, bool verbose) {
 	// handle 1-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying 1-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - frep: %d - flsq: %d - fargs size: %u\n",
-				d_N, ftype, frep, flsq, (unsigned)fargs->size());
+		printf("d_N: %lld - ftype: %d - frep: %d - flsq: %d - fargs size: %u\n",
+				(long long)d_N, ftype, frep, flsq, (unsigned)fargs->size());
 		printf("fargs: ");
 		for (unsigned i=0; i<fargs->size(); i++)
 			printf("%s, ", (*fargs)[i].to_string().c_str());
@@ -126,29 +359,37 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x,
 	if (verbose)
 		printf("dev_fargs...argc: %d - argv: %g\n", dev_fargs.argc, dev_fargs.argv);
 
-	// perform function aggregation for gap filling w.r.t overall qureg size
-	int fn = 1; // fixed for 1-qubit gate
-	int fsize = 2; // fixed for 1-qubit gate
-	int tot_f = f_dev_gap_filling(d_N, ftype, fsize, frep, flsq, dev_fargs,
-								  m_ftype_vec, m_fsize_vec, m_fargs_vec, verbose);
-	if (tot_f < 1) {
-		printf("cpu_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!\n");
+	// check function limits w.r.t overall qureg size
+	int qn = log2((double)d_N);
+	if ((frep < 1) || (flsq < 0) || (flsq+frep > qn)) {
+		printf("cpu_qreg_apply_function_gate_1qubit: wrong function limits [frep: %d  flsq: %d] for qureg size %d - error!!\n",
+				frep, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// evaluate gate 2x2 matrix elements once - row-major order
+	QDEV_ST_VAL_TYPE f_mtx[4];
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_mtx f_run = {f_mtx, 2};
+	if (f_dev_select_gate(ftype, 1, QASM_F_FORM_NULL, 0, QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL,
+						  &dev_fargs, &fparams, f_run) != QDEV_RES_OK) {
+		printf("cpu_qreg_apply_function_gate_1qubit: unhandled function type [%d] - error!!\n", ftype);
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
 	if (verbose) {
-		printf("cuda_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("cpu_qreg_apply_function_gate_1qubit: gate matrix: [(%g, %g) (%g, %g); (%g, %g) (%g, %g)]\n",
+				f_mtx[0].real(), f_mtx[0].imag(), f_mtx[1].real(), f_mtx[1].imag(),
+				f_mtx[2].real(), f_mtx[2].imag(), f_mtx[3].real(), f_mtx[3].imag());
 	}
 
-	// perform kernel function on N elements
+	// perform butterfly on all repeated qubits - first one from x to y, then in-place on y
 	if (verbose)
-		printf("calling kernel...SK\n\n");
-	for (int idx=0; idx<d_N; idx++) {
-		sequential_prod_fxi(d_x, d_y, idx, d_N, d_ftype_dev_vec, d_fsize_dev_vec,
-							d_fargs_dev_vec, tot_f, max_block_size, block_inner_gap_size,
-							ftype, fn, 0, 0, 0, QASM_F_TYPE_NULL, 0); // form n.a. here
+		printf("calling kernel...BF\n\n");
+	for (int q=flsq; q<flsq+frep; q++) {
+		QDEV_ST_VAL_TYPE* d_src = (q == flsq) ? d_x : d_y;
+		m_thr_pool->run(d_N/2, [=](QDEV_ST_INDEX_TYPE p_start, QDEV_ST_INDEX_TYPE p_stop, int) {
+			m_simd->butterfly_1q(d_src, d_y, p_start, p_stop, q, f_mtx);
+		});
 	}
 
 	if (verbose)
@@ -160,14 +401,14 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x,
 // --------------------------------
 
 // => 2-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 														  QASM_F_TYPE ftype, int frep, int flsq, int fform, int futype,
 														  QREG_F_ARGS_TYPE* fuargs, bool verbose) {
 	// handle 2-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying 2-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fuargs size: %u\n",
-				d_N, ftype, frep, flsq, fform, futype, (unsigned)fuargs->size());
+		printf("d_N: %lld - ftype: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fuargs size: %u\n",
+				(long long)d_N, ftype, frep, flsq, fform, futype, (unsigned)fuargs->size());
 		printf("fuargs: ");
 		for (unsigned i=0; i<fuargs->size(); i++)
 			printf("%s, ", (*fuargs)[i].to_string().c_str());
@@ -189,21 +430,25 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x,
 		printf("cuda_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!");
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
+
+	// in-place case - same input and output state vector
+	if (d_x == d_y)
+		return dev_qreg_apply_function_inplace(d_x, d_N, ftype, fsize, frep, flsq, fform, 0,
+											   futype, 1, fuform, dev_fuargs, verbose);
+	QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (fn*frep + flsq);
+	QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << flsq;
 	if (verbose) {
-		printf("cuda_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("cuda_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %lld  block_inner_gap_size: %lld\n",
+				tot_f, (long long)max_block_size, (long long)block_inner_gap_size);
 	}
 
-	// perform kernel function on N elements
+	// perform kernel function on N elements - on selected gate family
 	if (verbose)
 		printf("calling kernel...SK\n\n");
-	for (int idx=0; idx<d_N; idx++) {
-		sequential_prod_fxi(d_x, d_y, idx, d_N, d_ftype_dev_vec, d_fsize_dev_vec,
-							d_fargs_dev_vec, tot_f, max_block_size, block_inner_gap_size,
-							ftype, fn, fform, 0, futype, 1, fuform);
-	}
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_prod f_run = {m_thr_pool, d_x, d_y, d_N, max_block_size, block_inner_gap_size, fn, frep};
+	if (f_dev_select_gate(ftype, fn, fform, 0, futype, 1, fuform, &dev_fuargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
 
 	if (verbose)
 		printf("qreg_apply_function done\n");
@@ -214,15 +459,15 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x,
 // --------------------------------
 
 // => n-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 														             QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform,
 															 		 int fgapn, int futype, int fun, int fuform,
 																 	 QREG_F_ARGS_TYPE* fuargs, bool verbose) {
 	// handle 2-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying n-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - fsize: %d - frep: %d - flsq: %d - fform: %d - fgapn: %d - futype: %d - fun: %d - fuform: %d - fuargs size: %u\n",
-				d_N, ftype, fsize, frep, flsq, fform, fgapn, futype, fun, fuform, (unsigned)fuargs->size());
+		printf("d_N: %lld - ftype: %d - fsize: %d - frep: %d - flsq: %d - fform: %d - fgapn: %d - futype: %d - fun: %d - fuform: %d - fuargs size: %u\n",
+				(long long)d_N, ftype, fsize, frep, flsq, fform, fgapn, futype, fun, fuform, (unsigned)fuargs->size());
 	}
 
 	// convert fargs to device pointer array
@@ -236,20 +481,283 @@ int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL
 		printf("cuda_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!");
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
+
+	// in-place case - same input and output state vector
+	if (d_x == d_y)
+		return dev_qreg_apply_function_inplace(d_x, d_N, ftype, fsize, frep, flsq, fform, fgapn,
+											   futype, fun, fuform, dev_fuargs, verbose);
+	QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (fn*frep + flsq);
+	QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << flsq;
 	if (verbose) {
-		printf("cuda_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("cuda_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %lld  block_inner_gap_size: %lld\n",
+				tot_f, (long long)max_block_size, (long long)block_inner_gap_size);
 	}
 
-	// perform kernel function on N elements
+	// perform kernel function on N elements - on selected gate family
 	if (verbose)
 		printf("calling kernel...SK\n\n");
-	for (int idx=0; idx<d_N; idx++) {
-		sequential_prod_fxi(d_x, d_y, idx, d_N, d_ftype_dev_vec, d_fsize_dev_vec,
-							d_fargs_dev_vec, tot_f, max_block_size, block_inner_gap_size,
-							ftype, fn, fform, fgapn, futype, fun, fuform);
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_prod f_run = {m_thr_pool, d_x, d_y, d_N, max_block_size, block_inner_gap_size, fn, frep};
+	if (f_dev_select_gate(ftype, fn, fform, fgapn, futype, fun, fuform, &dev_fuargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// --------------------------------
+
+// => dense k-qubit unitary functions
+int qSim_qcpu_device::dev_qreg_apply_function_dense(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+													int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose) {
+	// handle dense unitary application to given qureg data
+	if (verbose) {
+		printf("applying dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d\n", (long long)d_N, flsq, fn);
+	}
+
+	// check function limits w.r.t overall qureg size
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > qn)) {
+		printf("cpu_qreg_apply_function_dense: wrong function limits [fn: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// perform kernel function on all groups
+	if (verbose)
+		printf("calling kernel...DK\n\n");
+	m_thr_pool->run(d_N >> fn, [&](QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop, int) {
+		m_simd->dense_kq(d_x, d_y, g_start, g_stop, flsq, fn, f_mtx);
+	});
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// => batched dense k-qubit unitary functions
+int qSim_qcpu_device::dev_qreg_apply_function_dense_batch(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y,
+														  QDEV_ST_INDEX_TYPE d_N, int flsq, int fn,
+														  QDEV_ST_VAL_TYPE* f_mtx, int sqn, bool verbose) {
+	// handle batched dense unitaries application to given qureg data - samples of 2^sqn
+	// consecutive states, each one with its own matrix
+	if (verbose) {
+		printf("applying batched dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d - sqn: %d\n", (long long)d_N, flsq, fn, sqn);
+	}
+
+	// check function limits w.r.t sample and overall qureg size
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > sqn) || (sqn > qn)) {
+		printf("cpu_qreg_apply_function_dense_batch: wrong function limits [fn: %d  flsq: %d  sqn: %d] for qureg size %d - error!!\n",
+				fn, flsq, sqn, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// perform kernel function on all groups of all samples - 2^(sqn-fn) consecutive groups
+	// per sample, worker ranges split on sample limits
+	int sgn = sqn - fn;
+	QDEV_ST_INDEX_TYPE m_size = (QDEV_ST_INDEX_TYPE)1 << 2*fn;
+	if (verbose)
+		printf("calling kernel...DKB\n\n");
+	m_thr_pool->run(d_N >> fn, [&](QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop, int) {
+		for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; ) {
+			QDEV_ST_INDEX_TYPE s = g >> sgn;
+			QDEV_ST_INDEX_TYPE g_end = std::min(g_stop, (s+1) << sgn);
+			m_simd->dense_kq(d_x, d_y, g, g_end, flsq, fn, f_mtx + s*m_size);
+			g = g_end;
+		}
+	});
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// --------------------------------
+
+// => fast path gate functions (1-qubit diagonal and permutation gates, controlled gates)
+int qSim_qcpu_device::dev_qreg_apply_function_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+												   QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform,
+												   int fgapn, int futype, int fun, int fuform,
+												   QREG_F_ARGS_TYPE* fargs, bool verbose) {
+	// classify gate and, for diagonal, permutation or controlled ones, apply it directly on
+	// d_x states (no output state vector) - any other gate left to the generic functions
+	QDEV_F_ARGS_TYPE dev_fargs = qSim_qcpu_device::fargs_to_dev_ptr_array(*fargs);
+	int fn = log2(fsize); // function size in qubits
+	if (ftype == QASM_F_TYPE_Q3_CCX)
+		fn = 3;
+
+	// check function limits w.r.t overall qureg size
+	int qn = log2((double)d_N);
+	if ((frep < 1) || (flsq < 0) || (flsq+fn*frep > qn)) {
+		printf("cpu_qreg_apply_function_fast: wrong function limits [fn: %d  frep: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, frep, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	if (!QASM_F_TYPE_IS_GATE_1QUBIT(ftype)) {
+		// controlled gates - bitmask engine applied on each repetition block
+		QDEV_ST_INDEX_TYPE c_mask;
+		int tn;
+		int t_idx[QDEV_F_UMTX_MAX_QUBITS];
+		QDEV_ST_VAL_TYPE u_mtx[1 << 2*QDEV_F_UMTX_MAX_QUBITS];
+		int ret = f_dev_ctrl_select_gate(ftype, fn, flsq, fform, fgapn, futype, fun, fuform,
+										 &dev_fargs, &c_mask, &tn, t_idx, u_mtx);
+		if (ret != QDEV_RES_OK)
+			return ret;
+		for (int r=0; r<frep; r++) {
+			int t_idx_r[QDEV_F_UMTX_MAX_QUBITS];
+			for (int b=0; b<tn; b++)
+				t_idx_r[b] = t_idx[b] + r*fn;
+			ret = dev_qreg_apply_function_controlled(d_x, d_N, c_mask << (r*fn), tn, t_idx_r, u_mtx, verbose);
+			if (ret != QDEV_RES_OK)
+				return ret;
+		}
+		return QDEV_RES_OK;
+	}
+
+	QDEV_F_FAST_PARAMS_TYPE fparams;
+	int kind = f_dev_fast_select_gate(ftype, frep, flsq, &dev_fargs, &fparams);
+	if (kind == QDEV_F_FAST_NONE)
+		return QDEV_RES_NOT_APPLIED;
+	if (verbose) {
+		printf("applying fast path gate function...\n");
+		printf("d_N: %lld - ftype: %d - kind: %d - frep: %d - flsq: %d\n",
+				(long long)d_N, ftype, kind, frep, flsq);
+	}
+
+	// perform kernel function on N elements
+	if (kind == QDEV_F_FAST_DIAG) {
+		if (verbose)
+			printf("calling kernel...FD\n\n");
+		m_thr_pool->run(d_N, [&](QDEV_ST_INDEX_TYPE k_start, QDEV_ST_INDEX_TYPE k_stop, int) {
+			sequential_fast_diag(d_x, k_start, k_stop, fparams, m_simd);
+		});
+	}
+	else if (kind == QDEV_F_FAST_PERM) {
+		if (verbose)
+			printf("calling kernel...FP\n\n");
+		m_thr_pool->run(d_N, [&](QDEV_ST_INDEX_TYPE k_start, QDEV_ST_INDEX_TYPE k_stop, int) {
+			sequential_fast_perm(d_x, k_start, k_stop, fparams);
+		});
+	}
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// => controlled gate functions resolution (bitmask engine on any qubits layout)
+int qSim_qcpu_device::dev_qreg_function_controls(QREG_F_TYPE ftype, int fsize, int flsq, int fform, int fgapn,
+												 int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs,
+												 QDEV_ST_INDEX_TYPE* c_mask, int* tn, int* t_idx,
+												 QDEV_ST_VAL_TYPE* u_mtx) {
+	// resolve control mask, target qubits and U-gate matrix of a single function repetition
+	// at flsq - no device states accessed
+	if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype))
+		return QDEV_RES_NOT_APPLIED;
+	QDEV_F_ARGS_TYPE dev_fargs = qSim_qcpu_device::fargs_to_dev_ptr_array(*fargs);
+	return f_dev_ctrl_select_gate(ftype, log2(fsize), flsq, fform, fgapn, futype, fun, fuform,
+								  &dev_fargs, c_mask, tn, t_idx, u_mtx);
+}
+
+// => fast path dense k-qubit unitary functions (fused gates)
+int qSim_qcpu_device::dev_qreg_apply_function_dense_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+														 int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose) {
+	// classify unitary and, for a single non-zero element per row, apply it directly on d_x
+	// states (no output state vector) - any other unitary left to the generic dense function
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > qn)) {
+		printf("cpu_qreg_apply_function_dense_fast: wrong function limits [fn: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	QDEV_F_FAST_MTX_PARAMS_TYPE fparams;
+	if (f_dev_fast_select_mtx(flsq, fn, f_mtx, &fparams) == QDEV_F_FAST_NONE)
+		return QDEV_RES_NOT_APPLIED;
+
+	// perform kernel function on all groups
+	if (verbose) {
+		printf("applying fast path dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d\n", (long long)d_N, flsq, fn);
+		printf("calling kernel...FM\n\n");
+	}
+	m_thr_pool->run(d_N >> fn, [&](QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop, int) {
+		sequential_fast_mtx(d_x, g_start, g_stop, fparams);
+	});
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// => controlled gate functions (bitmask engine)
+int qSim_qcpu_device::dev_qreg_apply_function_controlled(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+														 QDEV_ST_INDEX_TYPE c_mask, int tn, const int* t_idx,
+														 const QDEV_ST_VAL_TYPE* u_mtx, bool verbose) {
+	// apply U-gate on target qubits directly on d_x states (no output state vector), visiting
+	// only the state groups having all control bits set
+	int qn = log2((double)d_N);
+	QDEV_F_CTRL_PARAMS_TYPE fparams;
+	if (f_dev_ctrl_set_params(qn, c_mask, tn, t_idx, u_mtx, &fparams) != QDEV_RES_OK) {
+		printf("cpu_qreg_apply_function_controlled: wrong function controls/targets for qureg size %d - error!!\n", qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// perform kernel function on all groups
+	QDEV_ST_INDEX_TYPE tot_g = d_N >> fparams.fix_n;
+	if (verbose) {
+		printf("applying controlled gate function...\n");
+		printf("d_N: %lld - c_mask: %llx - tn: %d - t_idx[0]: %d - groups: %lld - mono: %d\n",
+				(long long)d_N, (long long)c_mask, tn, t_idx[0], (long long)tot_g, fparams.p_mono);
+		printf("calling kernel...FC\n\n");
+	}
+	m_thr_pool->run(tot_g, [&](QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop, int) {
+		sequential_fast_ctrl(d_x, g_start, g_stop, fparams);
+	});
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// --------------------------------
+
+// => in-place gate functions (2-qubit and n-qubit gates)
+int qSim_qcpu_device::dev_qreg_apply_function_inplace(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+													  QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform,
+													  int fgapn, int futype, int fun, int fuform,
+													  QDEV_F_ARGS_TYPE dev_fuargs, bool verbose) {
+	// handle gate application on a single state vector - as the gap-filled function is a
+	// tensor product, each repetition is applied in turn to its own qubit group
+	int fn = log2(fsize); // function size in qubits
+
+	// evaluate gate matrix once on selected gate family, keeping non-zero elements only
+	// - rows handled on pool workers
+	QDEV_F_ROWS_TYPE f_rows(fsize);
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_rows f_run = {m_thr_pool, &f_rows, fsize};
+	if (f_dev_select_gate(ftype, fn, fform, fgapn, futype, fun, fuform, &dev_fuargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
+
+	// perform kernel function on all groups, for each repetition
+	if (verbose)
+		printf("calling kernel...IP\n\n");
+	for (int r=0; r<frep; r++) {
+		int q_lo = flsq + fn*r;
+		m_thr_pool->run(d_N >> fn, [&](QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop, int) {
+			sequential_group_inplace(d_x, g_start, g_stop, q_lo, fn, f_rows);
+		});
 	}
 
 	if (verbose)
@@ -263,7 +771,7 @@ int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL
 // ---------------------------------------------------------
 
 // => qureg state setup - kernel function
-void sequential_kernel_set_state(QDEV_ST_VAL_TYPE *x, int idx, int N, int st_val) {
+void sequential_kernel_set_state(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE idx, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE st_val) {
 	//	1D vector: only x-dimension used
 	if (idx < N) {
 		if (idx != st_val)
@@ -276,36 +784,379 @@ void sequential_kernel_set_state(QDEV_ST_VAL_TYPE *x, int idx, int N, int st_val
 // --------------------------------
 
 // => qureg state value set (any pure state)
-void qSim_qcpu_device::dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, int N, int st_val, bool verbose) {
-	// sequential kernel function call
-	for (int idx=0; idx<N; idx++) {
-		sequential_kernel_set_state(d_x, idx, N, st_val);
+void qSim_qcpu_device::dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE st_val, bool verbose) {
+	// sequential kernel function call - partitioned on pool workers
+	if (verbose)
+		printf("CPU - qreg_set_state...st_val: %lld\n", (long long)st_val);
+	m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+		for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++) {
+			sequential_kernel_set_state(d_x, idx, N, st_val);
+		}
+	});
+}
+
+// ---------------------------------------------------------
+// instructions execution - qureg state reductions
+// ---------------------------------------------------------
+
+int qSim_qcpu_device::dev_qreg_marginals(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int q_idx, int q_len,
+										 double* pr_vec, bool verbose) {
+	// single pass on the state vector - each state norm added to its sub-state bin
+	QDEV_ST_INDEX_TYPE q_stn = (QDEV_ST_INDEX_TYPE)1 << q_len;
+	QDEV_ST_INDEX_TYPE q_mask = q_stn - 1;
+	if (verbose)
+		printf("CPU - qreg_marginals...q_idx: %d - q_len: %d\n", q_idx, q_len);
+
+	// states below the sub-qureg sharing the same sub-state - runs summed up at once
+	QDEV_ST_INDEX_TYPE run = (QDEV_ST_INDEX_TYPE)1 << q_idx;
+	if (q_stn <= QDEV_MARGINAL_MAX_CHUNK_BINS) {
+		// few sub-states - state range partitioned, with bins accumulated per chunk
+		int tot_chunks = m_thr_pool->get_tot_threads();
+		std::vector<double> part_vec(tot_chunks*q_stn, 0.0);
+		m_thr_pool->run(N, [&](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int c_idx) {
+			double* pr_c = &part_vec[c_idx*q_stn];
+			if (run < QDEV_SIMD_MIN_RUN) {
+				for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++)
+					pr_c[(idx >> q_idx) & q_mask] += std::norm(d_x[idx]);
+				return;
+			}
+			for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; ) {
+				QDEV_ST_INDEX_TYPE r_stop = min(idx_stop, (idx | (run-1)) + 1);
+				pr_c[(idx >> q_idx) & q_mask] += m_simd->norm_sum(d_x + idx, r_stop - idx);
+				idx = r_stop;
+			}
+		});
+		for (QDEV_ST_INDEX_TYPE j=0; j<q_stn; j++) {
+			double pr = 0.0;
+			for (int c=0; c<tot_chunks; c++)
+				pr += part_vec[c*q_stn+j];
+			pr_vec[j] = pr;
+		}
 	}
+	else {
+		// many sub-states - sub-state range partitioned, each sub-state collecting its own
+		// states (i.e. all values of the qubits outside the sub-qureg)
+		QDEV_ST_INDEX_TYPE r_stn = N >> q_len;
+		QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_idx) - 1;
+		m_thr_pool->run(q_stn, [&](QDEV_ST_INDEX_TYPE j_start, QDEV_ST_INDEX_TYPE j_stop, int) {
+			for (QDEV_ST_INDEX_TYPE j=j_start; j<j_stop; j++) {
+				double pr = 0.0;
+				if (run < QDEV_SIMD_MIN_RUN) {
+					for (QDEV_ST_INDEX_TYPE r=0; r<r_stn; r++)
+						pr += std::norm(d_x[(r & lo_mask) | (j << q_idx) | ((r & ~lo_mask) << q_len)]);
+				}
+				else {
+					for (QDEV_ST_INDEX_TYPE r=0; r<r_stn; r+=run)
+						pr += m_simd->norm_sum(d_x + ((j << q_idx) | (r << q_len)), run);
+				}
+				pr_vec[j] = pr;
+			}
+		});
+	}
+	return QDEV_RES_OK;
+}
+
+int qSim_qcpu_device::dev_qreg_expectation(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N,
+										   QDEV_ST_INDEX_TYPE sel_mask, QDEV_ST_INDEX_TYPE sel_val, QDEV_ST_INDEX_TYPE obs_mask,
+										   double* w_vec, double* exp, bool verbose) {
+	// single pass on the state vector - selected state norms weighted by observable eigenvalues
+	// product (i.e. weight given by the number of set observable bits)
+	if (verbose)
+		printf("CPU - qreg_expectation...sel_mask: %lld - sel_val: %lld - obs_mask: %lld\n",
+				(long long)sel_mask, (long long)sel_val, (long long)obs_mask);
+
+	// states below the lowest selected or observable qubit sharing the same weight - runs
+	// summed up at once
+	QDEV_ST_INDEX_TYPE s_mask = sel_mask | obs_mask;
+	QDEV_ST_INDEX_TYPE run = (s_mask != 0) ? (s_mask & -s_mask) : N;
+	std::vector<double> part_vec(m_thr_pool->get_tot_threads(), 0.0);
+	m_thr_pool->run(N, [&](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int c_idx) {
+		double ex = 0.0;
+		if (run < QDEV_SIMD_MIN_RUN) {
+			for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++) {
+				if ((idx & sel_mask) == sel_val)
+					ex += w_vec[__builtin_popcountll(idx & obs_mask)]*std::norm(d_x[idx]);
+			}
+		}
+		else {
+			for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; ) {
+				QDEV_ST_INDEX_TYPE r_stop = min(idx_stop, (idx | (run-1)) + 1);
+				if ((idx & sel_mask) == sel_val)
+					ex += w_vec[__builtin_popcountll(idx & obs_mask)]*m_simd->norm_sum(d_x + idx, r_stop - idx);
+				idx = r_stop;
+			}
+		}
+		part_vec[c_idx] = ex;
+	});
+	*exp = 0.0;
+	for (unsigned int c=0; c<part_vec.size(); c++)
+		*exp += part_vec[c];
+	return QDEV_RES_OK;
+}
+
+int qSim_qcpu_device::dev_qreg_topk(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int k,
+									QDEV_ST_INDEX_TYPE* idx_vec, double* pr_vec, bool verbose) {
+	// single pass on the state vector - sorted candidates list per chunk (insertion of the
+	// states above the list tail), chunk lists merged at the end
+	if (verbose)
+		printf("CPU - qreg_topk...k: %d\n", k);
+	if ((k <= 0) || (k > QDEV_TOPK_MAX) || (k > N))
+		return QDEV_RES_ERROR;
+
+	typedef std::pair<double, QDEV_ST_INDEX_TYPE> TOPK_ITEM_TYPE;
+	int tot_chunks = m_thr_pool->get_tot_threads();
+	std::vector<TOPK_ITEM_TYPE> part_vec(tot_chunks*k, TOPK_ITEM_TYPE(-1.0, -1));
+	m_thr_pool->run(N, [&](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int c_idx) {
+		// states visited in index order - strict comparison keeps lower indexes first on ties
+		TOPK_ITEM_TYPE* top_c = &part_vec[c_idx*k];
+		for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++) {
+			double pr = std::norm(d_x[idx]);
+			if (pr > top_c[k-1].first) {
+				int j = k-1;
+				for (; (j > 0) && (top_c[j-1].first < pr); j--)
+					top_c[j] = top_c[j-1];
+				top_c[j] = TOPK_ITEM_TYPE(pr, idx);
+			}
+		}
+	});
+
+	// chunk lists merge - unused list items (negative probability) sorted last, as k <= N
+	std::sort(part_vec.begin(), part_vec.end(), [](const TOPK_ITEM_TYPE& a, const TOPK_ITEM_TYPE& b) {
+		return ((a.first > b.first) || ((a.first == b.first) && (a.second < b.second)));
+	});
+	for (int j=0; j<k; j++) {
+		idx_vec[j] = part_vec[j].second;
+		pr_vec[j] = part_vec[j].first;
+	}
+	return QDEV_RES_OK;
+}
+
+void qSim_qcpu_device::dev_qreg_collapse(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int q_idx, int q_len,
+										 QDEV_ST_INDEX_TYPE st_val, double st_pr, bool verbose) {
+	// measured sub-states renormalised, all others reset
+	QDEV_ST_INDEX_TYPE q_mask = ((QDEV_ST_INDEX_TYPE)1 << q_len) - 1;
+	QDEV_ST_VAL_TYPE st_norm = QDEV_ST_MAKE_VAL(sqrt(st_pr), 0.0);
+	if (verbose)
+		printf("CPU - qreg_collapse...st_val: %lld - st_pr: %g\n", (long long)st_val, st_pr);
+
+	m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+		for (QDEV_ST_INDEX_TYPE idx=idx_start; idx<idx_stop; idx++) {
+			if (((idx >> q_idx) & q_mask) == st_val)
+				d_x[idx] /= st_norm;
+			else
+				d_x[idx] = QDEV_ST_MAKE_VAL(0.0, 0.0);
+		}
+	});
+}
+
+// ---------------------------------------------------------
+// state vectors memory policy
+// ---------------------------------------------------------
+
+// explicit huge pages size flags and interleave policy - if not defined by system headers
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+#define QDEV_MEM_MPOL_INTERLEAVE 3	// as per linux/mempolicy.h
+
+// mapped state vectors with their mapping size - released by unmapping (heap ones freed),
+// shared by all device instances
+static std::mutex s_mem_map_mutex;
+static std::map<void*, size_t> s_mem_map;
+
+static void* f_mem_map(size_t n_bytes, int mem_policy, size_t* m_bytes) {
+	// map given size - explicit huge pages first (if requested), then 2 MiB aligned mapping
+	// advised for transparent huge pages (if requested or as explicit ones fallback), plain
+	// mapping otherwise - NULL on failure
+	const size_t pg_2m = (size_t)2 << 20;
+	bool huge_thp = (mem_policy & QDEV_MEM_POLICY_HUGE_THP);
+	if (mem_policy & (QDEV_MEM_POLICY_HUGE_2M | QDEV_MEM_POLICY_HUGE_1G)) {
+		bool pg_1g = (mem_policy & QDEV_MEM_POLICY_HUGE_1G) && (n_bytes >= ((size_t)1 << 30));
+		size_t pg = pg_1g ? ((size_t)1 << 30) : pg_2m;
+		*m_bytes = (n_bytes + pg - 1) & ~(pg - 1);
+		void* p = mmap(NULL, *m_bytes, PROT_READ | PROT_WRITE,
+					   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | (pg_1g ? MAP_HUGE_1GB : MAP_HUGE_2MB), -1, 0);
+		if (p != MAP_FAILED)
+			return p;
+		static std::atomic<bool> s_warned(false);
+		if (!s_warned.exchange(true))
+			printf("dev_qreg_device_alloc: explicit huge pages not available - using transparent huge pages\n");
+		huge_thp = true;
+	}
+	if (!huge_thp) {
+		*m_bytes = n_bytes;
+		void* p = mmap(NULL, *m_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		return (p != MAP_FAILED) ? p : NULL;
+	}
+
+	// transparent huge pages - mapping extended by a page for its 2 MiB alignment, then trimmed
+	*m_bytes = (n_bytes + pg_2m - 1) & ~(pg_2m - 1);
+	char* p_map = (char*)mmap(NULL, *m_bytes + pg_2m, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (p_map == MAP_FAILED)
+		return NULL;
+	char* p = (char*)(((uintptr_t)p_map + pg_2m - 1) & ~(uintptr_t)(pg_2m - 1));
+	if (p > p_map)
+		munmap(p_map, p - p_map);
+	if (p_map + pg_2m > p)
+		munmap(p + *m_bytes, p_map + pg_2m - p);
+	madvise(p, *m_bytes, MADV_HUGEPAGE);
+	return p;
+}
+
+static unsigned long f_mem_numa_nodes_mask() {
+	// online NUMA nodes (up to 64) as bitmask, from the system nodes ranges list (e.g. "0-1")
+	// - single node if not available
+	unsigned long nd_mask = 0;
+	std::ifstream nd_file("/sys/devices/system/node/online");
+	std::string nd_list;
+	if (nd_file && std::getline(nd_file, nd_list)) {
+		std::stringstream nd_ss(nd_list);
+		std::string nd_rng;
+		while (std::getline(nd_ss, nd_rng, ',')) {
+			int sep_index = nd_rng.find("-");
+			int nd_start = std::atoi(nd_rng.c_str());
+			int nd_stop = (sep_index > 0) ? std::atoi(nd_rng.c_str() + sep_index + 1) : nd_start;
+			for (int nd=nd_start; (nd<=nd_stop) && (nd<(int)(8*sizeof(nd_mask))); nd++)
+				nd_mask |= (1UL << nd);
+		}
+	}
+	return (nd_mask != 0) ? nd_mask : 1UL;
+}
+
+static void f_mem_interleave(void* p, size_t m_bytes) {
+	// mapped pages interleaved on all online NUMA nodes - no-op on a single node
+	unsigned long nd_mask = f_mem_numa_nodes_mask();
+	if ((nd_mask & (nd_mask - 1)) == 0)
+		return;
+#ifdef SYS_mbind
+	if (syscall(SYS_mbind, p, m_bytes, QDEV_MEM_MPOL_INTERLEAVE, &nd_mask, 8*sizeof(nd_mask) + 1, 0) != 0)
+		printf("dev_qreg_device_alloc: NUMA interleave policy not applied - error!!\n");
+#endif
+}
+
+bool qSim_qcpu_device::dev_mem_policy_parse(std::string pol_str, int* mem_policy) {
+	// comma separated options, default policy if empty
+	*mem_policy = QDEV_MEM_POLICY_DEFAULT;
+	std::stringstream pol_ss(pol_str);
+	std::string pol_tk;
+	while (std::getline(pol_ss, pol_tk, ',')) {
+		if (pol_tk == "thp")
+			*mem_policy |= QDEV_MEM_POLICY_HUGE_THP;
+		else if (pol_tk == "2m")
+			*mem_policy |= QDEV_MEM_POLICY_HUGE_2M;
+		else if (pol_tk == "1g")
+			*mem_policy |= QDEV_MEM_POLICY_HUGE_1G;
+		else if (pol_tk == "ft")
+			*mem_policy |= QDEV_MEM_POLICY_FIRST_TOUCH;
+		else if (pol_tk == "il")
+			*mem_policy |= QDEV_MEM_POLICY_INTERLEAVE;
+		else
+			return false;
+	}
+	return true;
+}
+
+std::string qSim_qcpu_device::dev_mem_policy_to_string(int mem_policy) {
+	std::string pol_str;
+	const char* pol_names[] = {"thp", "2m", "1g", "ft", "il"};
+	const int pol_flags[] = {QDEV_MEM_POLICY_HUGE_THP, QDEV_MEM_POLICY_HUGE_2M, QDEV_MEM_POLICY_HUGE_1G,
+							 QDEV_MEM_POLICY_FIRST_TOUCH, QDEV_MEM_POLICY_INTERLEAVE};
+	for (int i=0; i<5; i++) {
+		if (mem_policy & pol_flags[i])
+			pol_str += ((pol_str.length() > 0) ? "," : "") + std::string(pol_names[i]);
+	}
+	return (pol_str.length() > 0) ? pol_str : "default";
 }
 
 // ---------------------------------------------------------
-// static helper host <--> device conversion methods
+// helper host <--> device conversion methods
 // ---------------------------------------------------------
 
-void qSim_qcpu_device::dev_qreg_host2device(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_VAL_TYPE* x, int N) {
+int qSim_qcpu_device::dev_qreg_device_alloc(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_INDEX_TYPE N) {
+	// allocate device memory - no host data setup (states set by kernels), mapped on the memory
+	// policy for large vectors, on heap otherwise (or if mapping failed) - NULL on failure
+	size_t n_bytes = N*sizeof(QDEV_ST_VAL_TYPE);
+	size_t m_bytes = 0;
+	void* p = NULL;
+	if ((m_mem_policy != QDEV_MEM_POLICY_DEFAULT) && (n_bytes >= QDEV_MEM_POLICY_MIN_BYTES))
+		p = f_mem_map(n_bytes, m_mem_policy, &m_bytes);
+	if (p == NULL) {
+		*d_x = (QDEV_ST_VAL_TYPE*)malloc(n_bytes);
+		if (*d_x == NULL) {
+			printf("dev_qreg_device_alloc: device memory allocation failed - bytes: %zu - error!!\n", n_bytes);
+			return QDEV_RES_ERROR;
+		}
+		return QDEV_RES_OK;
+	}
+	if (m_mem_policy & QDEV_MEM_POLICY_INTERLEAVE)
+		f_mem_interleave(p, m_bytes);
+	{
+		std::lock_guard<std::mutex> lock(s_mem_map_mutex);
+		s_mem_map[p] = m_bytes;
+	}
+
+	// first-touch placement - pages faulted in by the pool worker of each chunk, i.e. on its
+	// NUMA node (same chunks partitioning as kernels on the state range)
+	QDEV_ST_VAL_TYPE* d_p = (QDEV_ST_VAL_TYPE*)p;
+	if ((m_mem_policy & QDEV_MEM_POLICY_FIRST_TOUCH) && !(m_mem_policy & QDEV_MEM_POLICY_INTERLEAVE)) {
+		m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+			memset((void*)(d_p + idx_start), 0, (idx_stop - idx_start)*sizeof(QDEV_ST_VAL_TYPE));
+		});
+	}
+	*d_x = d_p;
+	return QDEV_RES_OK;
+}
+
+void qSim_qcpu_device::dev_qreg_host2device(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE N) {
 	// allocate and setup device memory from given host one
-	*d_x = (QDEV_ST_VAL_TYPE*)malloc(N*sizeof(QDEV_ST_VAL_TYPE));
-	memcpy((*d_x), x, N*sizeof(QDEV_ST_VAL_TYPE));
+	if (dev_qreg_device_alloc(d_x, N) != QDEV_RES_OK)
+		return;
+	dev_qreg_host2device_align(*d_x, x, N);
 }
 
-void qSim_qcpu_device::dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, int N) {
-	// allocate and setup device memory with given host one
-	memcpy(x, d_x, N*sizeof(QDEV_ST_VAL_TYPE));
+void qSim_qcpu_device::dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, QDEV_ST_INDEX_TYPE N) {
+	// host memory alignment with given device one - chunks copied by pool workers
+	m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+		memcpy((void*)(x + idx_start), d_x + idx_start, (idx_stop - idx_start)*sizeof(QDEV_ST_VAL_TYPE));
+	});
 }
 
-void qSim_qcpu_device::dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, int N) {
-	// device memory alignment with given host one - no allocation
-	memcpy(d_x, x, N*sizeof(QDEV_ST_VAL_TYPE));
+void qSim_qcpu_device::dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE N) {
+	// device memory alignment with given host one - no allocation, chunks copied by pool workers
+	m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+		memcpy((void*)(d_x + idx_start), x + idx_start, (idx_stop - idx_start)*sizeof(QDEV_ST_VAL_TYPE));
+	});
 }
 
-// helper function for device memory release
+// helper function for device memory release - mapped vectors unmapped, heap ones freed
 void qSim_qcpu_device::dev_qreg_device_release(QDEV_ST_VAL_TYPE* d_x) {
-	free(d_x);
+	size_t m_bytes = 0;
+	{
+		std::lock_guard<std::mutex> lock(s_mem_map_mutex);
+		std::map<void*, size_t>::iterator it = s_mem_map.find((void*)d_x);
+		if (it != s_mem_map.end()) {
+			m_bytes = it->second;
+			s_mem_map.erase(it);
+		}
+	}
+	if (m_bytes > 0)
+		munmap((void*)d_x, m_bytes);
+	else
+		free(d_x);
+}
+
+// helper function for copies between device vectors - single host device
+void qSim_qcpu_device::dev_qreg_device_copy(QDEV_ST_VAL_TYPE* d_dst, int /*dst_dev*/, QDEV_ST_VAL_TYPE* d_src,
+											int /*src_dev*/, QDEV_ST_INDEX_TYPE N) {
+	m_thr_pool->run(N, [=](QDEV_ST_INDEX_TYPE idx_start, QDEV_ST_INDEX_TYPE idx_stop, int) {
+		memcpy(d_dst + idx_start, d_src + idx_start, (idx_stop - idx_start)*sizeof(QDEV_ST_VAL_TYPE));
+	});
 }
 
 // ---------------------------------
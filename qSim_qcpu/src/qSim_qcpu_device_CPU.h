@@ -32,6 +32,35 @@
  *  --------------------------------------------------------------------------
  *  1.0   Dec-2022   Module creation adapting qSim_qcup_GPU_CUDA and agnostic
  *                   class renaming to qSim_qcpu_device.
+ *  1.1   Oct-2026   Handled multithreaded kernels execution via persistent
+ *                   worker thread pool.
+ *  1.2   Oct-2026   Handled 64-bit state indexes and function vectors sized on
+ *                   qureg allocation (no max qureg size limit).
+ *  1.3   Oct-2026   Handled in-place 2-qubit and n-qubit gates application on
+ *                   qubit groups, and device memory allocation with no host data.
+ *  1.4   Oct-2026   Handled dense k-qubit unitary functions (fused gates).
+ *  1.5   Oct-2026   Handled qureg state marginal probabilities, expectation and
+ *                   measure collapse on device states (single pass reductions).
+ *  1.6   Oct-2026   Handled kernels templated on gate family (no function device vectors).
+ *  1.7   Oct-2026   Handled diagonal and permutation gates fast path (in-place).
+ *  1.8   Oct-2026   Handled controlled gates by bitmask engine (control mask and
+ *                   target qubits list).
+ *  1.9   Oct-2026   Handled qureg streams interface (no-op - transformations are
+ *                   synchronous on the worker pool).
+ *  1.10  Oct-2026   Handled multi-device interface (single host device), with copies
+ *                   between device vectors (qureg shards exchanges).
+ *  1.11  Oct-2026   Handled vectorized kernels table, selected on device creation.
+ *  1.12  Oct-2026   Handled single precision state values (__QSIM_SP__ compiling).
+ *  1.13  Oct-2026   Handled batched dense unitaries (one matrix per state vector sample).
+ *  1.14  Oct-2026   Handled qureg state top-k most probable states reduction.
+ *  1.15  Oct-2026   Handled device kernels statistics (host timed - kernels synchronous).
+ *  1.16  Oct-2026   Handled devices warm-up query (none needed on host).
+ *  1.17  Oct-2026   Handled state vectors memory policy (huge pages and NUMA placement),
+ *                   with host <--> device copies partitioned on pool workers.
+ *  1.18  Oct-2026   Handled device kernels statistics only if enabled.
+ *  1.19  Oct-2026   Handled controlled gates resolution (control mask, targets and U-gate),
+ *                   for sharded quregs placing target qubits only.
+ *  1.20  Oct-2026   Handled devices warm-up as a static method (once per process).
  *
  *  --------------------------------------------------------------------------
  */
@@ -42,18 +71,58 @@
 
 #include <cstdint>
 #include <complex>
+#include <string>
 
 #include "qSim_qasm.h"
 #include "qSim_qinstruction_core.h"
+#include "qSim_qcpu_device_CPU_pool.h"
+#include "qSim_qstats.h"
 
 
-// data type for a q-state value as complex
-typedef complex<double> QDEV_ST_VAL_TYPE;
-#define QDEV_ST_MAKE_VAL complex<double>
+// data type for a q-state value as complex - single precision (__QSIM_SP__ compiling) or double
+#ifdef __QSIM_SP__
+typedef float QDEV_ST_REAL_TYPE;
+#else
+typedef double QDEV_ST_REAL_TYPE;
+#endif
+typedef complex<QDEV_ST_REAL_TYPE> QDEV_ST_VAL_TYPE;
+#define QDEV_ST_MAKE_VAL complex<QDEV_ST_REAL_TYPE>
+
+// data type for a q-state index - 64-bit for qureg with more than 31 qubits
+typedef int64_t QDEV_ST_INDEX_TYPE;
+
+// max dense unitary width handled by kernels (fused gates)
+#define QDEV_F_DENSE_MAX_QUBITS 5
+
+// max U-gate width of controlled gates (bitmask engine)
+#define QDEV_F_CTRL_U_MAX_QUBITS 2
+
+// max marginal sub-states accumulated per worker chunk - above this size
+// the sub-state range is partitioned instead of the state range
+#define QDEV_MARGINAL_MAX_CHUNK_BINS (1 << 12)
+
+// max most probable states selected by the top-k reduction
+#define QDEV_TOPK_MAX 64
+
+// state vectors memory policy flags - huge pages (transparent ones, or explicit 2 MiB / 1 GiB
+// ones from the kernel pool, transparent ones if not available) and NUMA nodes placement
+#define QDEV_MEM_POLICY_DEFAULT     0x00	// heap allocation, pages placed on first use
+#define QDEV_MEM_POLICY_HUGE_THP    0x01	// transparent huge pages (2 MiB aligned mapping)
+#define QDEV_MEM_POLICY_HUGE_2M     0x02	// explicit 2 MiB huge pages
+#define QDEV_MEM_POLICY_HUGE_1G     0x04	// explicit 1 GiB huge pages (2 MiB ones below 1 GiB)
+#define QDEV_MEM_POLICY_FIRST_TOUCH 0x10	// pages placed by the pool workers on their own chunks
+#define QDEV_MEM_POLICY_INTERLEAVE  0x20	// pages interleaved on all NUMA nodes
+
+// min state vector size for the memory policy (bytes) - smaller ones on heap
+#define QDEV_MEM_POLICY_MIN_BYTES (2 << 20)
 
 // return codes
 #define QDEV_RES_OK     0
 #define QDEV_RES_ERROR -1
+#define QDEV_RES_NOT_APPLIED 1 // no fast path for given function - generic functions to be used
+
+// data type for a device stream - not used (NULL)
+typedef void* QDEV_STREAM_TYPE;
 
 // data type for qreg state value and array
 typedef QDEV_ST_VAL_TYPE QREG_ST_RAW_VAL_TYPE;
@@ -67,54 +136,150 @@ struct qSim_qreg_function_args_device {
 };
 typedef qSim_qreg_function_args_device QDEV_F_ARGS_TYPE;
 
+// vectorized kernels table (qSim_qcpu_device_CPU_simd)
+struct qSim_qcpu_device_simd_kernels;
+
 // ---------------------------------------------
 
 class qSim_qcpu_device {
 public:
 	// constructor & destructor
-	qSim_qcpu_device();
+	qSim_qcpu_device(int tot_threads=1, int mem_policy=QDEV_MEM_POLICY_DEFAULT);
 	~qSim_qcpu_device();
 
+	// in-place transformations support (same input and output state vector)
+	bool dev_qreg_inplace_supported() { return true; }
+
+	// qureg streams - not handled, transformations completed on return
+	int dev_qreg_stream_create(QDEV_STREAM_TYPE* d_s) { *d_s = NULL; return QDEV_RES_OK; }
+	void dev_qreg_stream_release(QDEV_STREAM_TYPE /*d_s*/) {}
+	void dev_qreg_stream_select(QDEV_STREAM_TYPE /*d_s*/) {}
+	void dev_qreg_stream_sync() {}
+
+	// device kernels statistics - kernels run between start and stop, by given key (if enabled)
+	void dev_qreg_stats_start() { m_stats_t0 = qSim_qstats::device_enabled() ? qSim_qstats::now_ns() : 0; }
+	void dev_qreg_stats_stop(int key) { if (m_stats_t0 != 0) qSim_qstats::record(QSTATS_STAGE_DEVICE, key, m_stats_t0); }
+
+	// multi-device support - single host device, vectors copies partitioned on pool workers
+	int dev_gpu_select(int /*dev_id*/) { return QDEV_RES_OK; }
+	int dev_gpu_peer_enable(int /*tot_dev*/) { return QDEV_RES_OK; }
+	static int dev_gpu_warmup(int /*tot_dev*/, bool /*verbose*/) { return QDEV_RES_OK; }
+	void dev_qreg_device_copy(QDEV_ST_VAL_TYPE* d_dst, int dst_dev, QDEV_ST_VAL_TYPE* d_src, int src_dev,
+							  QDEV_ST_INDEX_TYPE d_N);
+
 	// instructions execution
 
 	// - 1-qubit gate functions
-	int dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 			                                QREG_F_TYPE ftype, int frep, int flsq,
 											QREG_F_ARGS_TYPE* fargs, bool verbose);
 
 	// - 2-qubit gate functions
-	int dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 			                                QREG_F_TYPE ftype, int frep, int flsq, int fform, int futype,
 											QREG_F_ARGS_TYPE* fuargs, bool verbose);
 
+	// - dense k-qubit unitary functions (fused gates) - row-major host matrix
+	int dev_qreg_apply_function_dense(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+									  int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose);
+
+	// - batched dense k-qubit unitary functions - samples of 2^sqn consecutive states, each
+	//   one with its own row-major host matrix (d_N/2^sqn consecutive matrices)
+	int dev_qreg_apply_function_dense_batch(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+											int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, int sqn, bool verbose);
+
 	// - n-qubit gate functions
-	int dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 											 	 	   QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
 													   int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs, bool verbose);
 
+	// - fast path gate functions - 1-qubit diagonal and permutation gates, controlled gates
+	//   (and 1-qubit swap blocks) applied on d_x states only, QDEV_RES_NOT_APPLIED returned
+	//   for any other gate
+	int dev_qreg_apply_function_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+									 QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+									 int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs, bool verbose);
+	int dev_qreg_apply_function_dense_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+										   int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose);
+
+	// - controlled gate functions (bitmask engine) - U-gate (tn qubits wide, row-major)
+	//   applied on t_idx target qubits of d_x states having all c_mask control bits set
+	int dev_qreg_apply_function_controlled(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+										   QDEV_ST_INDEX_TYPE c_mask, int tn, const int* t_idx,
+										   const QDEV_ST_VAL_TYPE* u_mtx, bool verbose);
+
+	// - controlled gate functions resolution - control mask, target qubits and U-gate matrix
+	//   (row-major host matrix) of a single function repetition at flsq, for applying it on the
+	//   bitmask engine on any qubits layout (host side only), QDEV_RES_NOT_APPLIED returned for
+	//   non-controlled functions
+	int dev_qreg_function_controls(QREG_F_TYPE ftype, int fsize, int flsq, int fform, int fgapn,
+								   int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs,
+								   QDEV_ST_INDEX_TYPE* c_mask, int* tn, int* t_idx, QDEV_ST_VAL_TYPE* u_mtx);
+
+	// function tables sizing - to be called for each allocated qureg
+	int dev_qreg_function_tables_reserve(int qn);
+
 	// qureg state value set
-	void dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, int d_N, int st_val, bool verbose);
+	void dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, QDEV_ST_INDEX_TYPE st_val, bool verbose);
+
+	// qureg state reductions - marginal probabilities of all sub-states of the given
+	// sub-qureg, and expectation on selected states (i.e. (idx & sel_mask) == sel_val)
+	// with weights indexed by the number of set observable bits (idx & obs_mask)
+	int dev_qreg_marginals(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int q_idx, int q_len,
+						   double* pr_vec, bool verbose);
+	int dev_qreg_expectation(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+							 QDEV_ST_INDEX_TYPE sel_mask, QDEV_ST_INDEX_TYPE sel_val, QDEV_ST_INDEX_TYPE obs_mask,
+							 double* w_vec, double* exp, bool verbose);
+
+	// qureg state top-k - the k most probable states (k up to QDEV_TOPK_MAX), sorted by
+	// decreasing probability (lower index first on ties), with their probabilities
+	int dev_qreg_topk(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int k,
+					  QDEV_ST_INDEX_TYPE* idx_vec, double* pr_vec, bool verbose);
 
-	// static helper host <--> device conversion methods
-	static void dev_qreg_host2device(QDEV_ST_VAL_TYPE**, QDEV_ST_VAL_TYPE* x, int d_N);
-	static void dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, int d_N);
-	static void dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, int d_N);
+	// qureg state collapse on measured sub-qureg value, with given probability
+	void dev_qreg_collapse(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int q_idx, int q_len,
+						   QDEV_ST_INDEX_TYPE st_val, double st_pr, bool verbose);
+
+	// helper host <--> device conversion methods - device memory on the memory policy, copies
+	// partitioned on pool workers
+	int dev_qreg_device_alloc(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_host2device(QDEV_ST_VAL_TYPE**, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE d_N);
 	static void dev_qreg_device_release(QDEV_ST_VAL_TYPE* d_x);
 
+	// memory policy flags from/to string, as comma separated options (thp, 2m, 1g for huge pages,
+	// ft, il for first-touch and interleaved placement) - false on unknown options
+	static bool dev_mem_policy_parse(std::string pol_str, int* mem_policy);
+	static std::string dev_mem_policy_to_string(int mem_policy);
+
 	// function args to device pointer array conversions
 	static QDEV_F_ARGS_TYPE fargs_to_dev_ptr_array(QREG_F_ARGS_TYPE fargs);
 
 private:
+	// in-place gate application - gate by gate on the repeated qubit groups
+	int dev_qreg_apply_function_inplace(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+										QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+										int futype, int fun, int fuform, QDEV_F_ARGS_TYPE dev_fuargs, bool verbose);
+
 	// function type, size and arg host vectors
     // allocate function host vectors
 	QASM_F_TYPE* m_ftype_vec; 		// overall function type sequence to use
-	int* m_fsize_vec;			 	// overall function sizes, as per type sequence
+	QDEV_ST_INDEX_TYPE* m_fsize_vec; // overall function sizes, as per type sequence
 	QDEV_F_ARGS_TYPE* m_fargs_vec;	// overall function arguments, as per type sequence
+	int m_tot_f_max;				// function vectors allocated size
+
+	// worker thread pool for kernels execution
+	qSim_qcpu_device_CPU_pool* m_thr_pool;
+
+	// vectorized kernels - on instruction set supported by the CPU
+	const qSim_qcpu_device_simd_kernels* m_simd;
+
+	// device kernels statistics start time
+	uint64_t m_stats_t0;
 
-	// function type, size and arg CPU vectors
-	QASM_F_TYPE* d_ftype_dev_vec;
-	int* d_fsize_dev_vec;
-	QDEV_F_ARGS_TYPE* d_fargs_dev_vec;
+	// state vectors memory policy flags
+	int m_mem_policy;
 };
 
 #endif /* QSIM_QCPU_DEVICE_CPU_H_ */
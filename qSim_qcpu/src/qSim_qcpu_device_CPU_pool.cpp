@@ -0,0 +1,123 @@
+/*
+ * qSim_qcpu_device_CPU_pool.cpp
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing a persistent worker thread pool for CPU device
+ * kernels and qureg reductions, splitting a given index range in contiguous chunks,
+ * one per worker (calling thread included).
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled 64-bit index ranges.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+#include "qSim_qcpu_device_CPU_pool.h"
+
+
+// constructor & destructor
+qSim_qcpu_device_CPU_pool::qSim_qcpu_device_CPU_pool(int tot_threads) {
+	// calling thread handles chunk #0 - start the others as persistent workers
+	m_tot_threads = (tot_threads > 0) ? tot_threads : 1;
+	m_task_N = 0;
+	m_task_gen = 0;
+	m_task_pending = 0;
+	m_stop = false;
+
+	for (int w_idx=1; w_idx<m_tot_threads; w_idx++)
+		m_workers.push_back(std::thread(&qSim_qcpu_device_CPU_pool::worker_loop, this, w_idx));
+}
+
+qSim_qcpu_device_CPU_pool::~qSim_qcpu_device_CPU_pool() {
+	// stop and join all workers
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv_start.notify_all();
+	for (unsigned int i=0; i<m_workers.size(); i++)
+		m_workers[i].join();
+}
+
+// ---------------------------------------------------------
+
+void qSim_qcpu_device_CPU_pool::run(int64_t N, QDEV_POOL_TASK_TYPE task) {
+	// small ranges or single thread - no parallel run
+	if ((m_tot_threads == 1) || (N < QDEV_POOL_MIN_PARALLEL_SIZE)) {
+		task(0, N, 0);
+		return;
+	}
+
+	// publish task to workers
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_task = task;
+		m_task_N = N;
+		m_task_pending = m_tot_threads - 1;
+		m_task_gen++;
+	}
+	m_cv_start.notify_all();
+
+	// handle own chunk and wait for the others
+	run_chunk(0);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cv_done.wait(lock, [this] { return m_task_pending == 0; });
+}
+
+// ---------------------------------------------------------
+
+void qSim_qcpu_device_CPU_pool::worker_loop(int w_idx) {
+	// wait for a new task generation, execute own chunk and notify completion
+	unsigned long last_gen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv_start.wait(lock, [this, last_gen] { return m_stop || (m_task_gen != last_gen); });
+			if (m_stop)
+				break;
+			last_gen = m_task_gen;
+		}
+
+		run_chunk(w_idx);
+
+		bool done;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			done = (--m_task_pending == 0);
+		}
+		if (done)
+			m_cv_done.notify_one();
+	}
+}
+
+void qSim_qcpu_device_CPU_pool::run_chunk(int w_idx) {
+	// contiguous chunk for given worker index
+	int64_t N = m_task_N;
+	int64_t start = (N*w_idx)/m_tot_threads;
+	int64_t stop = (N*(w_idx+1))/m_tot_threads;
+	if (start < stop)
+		m_task(start, stop, w_idx);
+}
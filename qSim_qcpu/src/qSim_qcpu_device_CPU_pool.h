@@ -0,0 +1,90 @@
+/*
+ * qSim_qcpu_device_CPU_pool.h
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing a persistent worker thread pool for CPU device
+ * kernels and qureg reductions, splitting a given index range in contiguous chunks,
+ * one per worker (calling thread included).
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled 64-bit index ranges.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#ifndef QSIM_QCPU_DEVICE_CPU_POOL_H_
+#define QSIM_QCPU_DEVICE_CPU_POOL_H_
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// task function type - called with chunk range [start, stop) and chunk index
+typedef std::function<void (int64_t, int64_t, int)> QDEV_POOL_TASK_TYPE;
+
+// min range size for a parallel run - smaller ranges executed by calling thread only
+#define QDEV_POOL_MIN_PARALLEL_SIZE 4096
+
+
+class qSim_qcpu_device_CPU_pool {
+public:
+	// constructor & destructor
+	qSim_qcpu_device_CPU_pool(int tot_threads=1);
+	~qSim_qcpu_device_CPU_pool();
+
+	// total number of chunks a range is split in (i.e. workers + calling thread)
+	int get_tot_threads() { return m_tot_threads; }
+
+	// execute given task on range [0, N) - blocking until all chunks are done
+	void run(int64_t N, QDEV_POOL_TASK_TYPE task);
+
+private:
+	// worker thread loop
+	void worker_loop(int w_idx);
+
+	// chunk execution
+	void run_chunk(int w_idx);
+
+	int m_tot_threads;
+	std::vector<std::thread> m_workers;
+
+	// current task data
+	QDEV_POOL_TASK_TYPE m_task;
+	int64_t m_task_N;
+	unsigned long m_task_gen;
+	int m_task_pending;
+	bool m_stop;
+
+	// workers synchronisation
+	std::mutex m_mutex;
+	std::condition_variable m_cv_start;
+	std::condition_variable m_cv_done;
+};
+
+#endif /* QSIM_QCPU_DEVICE_CPU_POOL_H_ */
@@ -0,0 +1,427 @@
+/*
+ * qSim_qcpu_device_CPU_simd.cpp
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing the CPU device vectorized kernels, selected at run
+ * time on the instruction sets supported by the CPU (CPUID):
+ * - 1-qubit gate strided butterfly (2x2 matrix)
+ * - dense k-qubit unitary on qubit groups (fused gates, 4x4 and above)
+ * - contiguous states phase multiply (diagonal gates)
+ * - contiguous states norms sum (probability and expectation reductions)
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation, moving scalar butterfly and dense kernels from
+ *                   qSim_qcpu_device_CPU.
+ *  1.1   Oct-2026   AVX-512 kernels without undefined pass-through intrinsics (gcc -Wall warnings).
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+#include <algorithm>
+
+#include "qSim_qcpu_device_CPU_simd.h"
+
+#ifdef __QSIM_SIMD_X86__
+#include <immintrin.h>
+#define QDEV_SIMD_AVX2_TARGET   __attribute__((target("avx2")))
+#define QDEV_SIMD_AVX512_TARGET __attribute__((target("avx2,avx512f")))
+#endif
+
+
+// --------------------------------
+// scalar kernels
+// --------------------------------
+
+static void scalar_butterfly_1q(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE p_start, QDEV_ST_INDEX_TYPE p_stop,
+								int q_idx, const QDEV_ST_VAL_TYPE* m) {
+	// apply given 2x2 gate matrix (row-major) to the q_idx-th qubit of the x states,
+	// pairing each state having the q_idx-th bit at 0 with its partner at 1 - result in y
+	// (x and y can be the same vector, for an in-place update)
+	// => pairs in range [p_start, p_stop) handled, out of N/2 total
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)1 << q_idx;
+	for (QDEV_ST_INDEX_TYPE p=p_start; p<p_stop; p++) {
+		QDEV_ST_INDEX_TYPE idx0 = ((p >> q_idx) << (q_idx+1)) | (p & (stride-1));
+		QDEV_ST_INDEX_TYPE idx1 = idx0 + stride;
+		QDEV_ST_VAL_TYPE x0 = x[idx0];
+		QDEV_ST_VAL_TYPE x1 = x[idx1];
+		y[idx0] = m[0]*x0 + m[1]*x1;
+		y[idx1] = m[2]*x0 + m[3]*x1;
+	}
+}
+
+static void scalar_dense_kq(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+							int q_lo, int fn, const QDEV_ST_VAL_TYPE* m) {
+	// apply given dense 2^fn x 2^fn matrix (row-major) to the fn qubits starting at q_lo - result in y
+	// => each group collects the 2^fn states sharing all other qubits, gathered before update
+	//    (x and y can be the same vector, for an in-place update)
+	// => groups in range [g_start, g_stop) handled, out of N/2^fn total
+	int fsize = 1 << fn;
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	QDEV_ST_VAL_TYPE x_grp[1 << QDEV_F_DENSE_MAX_QUBITS];
+	for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fn)) | (g & lo_mask);
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = x[base + ((QDEV_ST_INDEX_TYPE)j << q_lo)];
+		for (int i=0; i<fsize; i++) {
+			const QDEV_ST_VAL_TYPE* m_i = m + i*fsize;
+			QDEV_ST_VAL_TYPE y_i = QDEV_ST_MAKE_VAL(0.0, 0.0);
+			for (int j=0; j<fsize; j++)
+				y_i += m_i[j] * x_grp[j];
+			y[base + ((QDEV_ST_INDEX_TYPE)i << q_lo)] = y_i;
+		}
+	}
+}
+
+static void scalar_scale(QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n, QDEV_ST_VAL_TYPE f) {
+	for (QDEV_ST_INDEX_TYPE k=0; k<n; k++)
+		x[k] *= f;
+}
+
+static double scalar_norm_sum(const QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n) {
+	double s = 0.0;
+	for (QDEV_ST_INDEX_TYPE k=0; k<n; k++)
+		s += std::norm(x[k]);
+	return s;
+}
+
+
+#ifdef __QSIM_SIMD_X86__
+
+// --------------------------------
+// AVX2 kernels - 2 states per register
+// --------------------------------
+
+// complex product of v states by f factor (real and imag parts broadcast) - products
+// difference on real lanes, sum on imag ones
+QDEV_SIMD_AVX2_TARGET
+static inline __m256d avx2_cmul(__m256d v, __m256d f_re, __m256d f_im) {
+	__m256d v_sw = _mm256_permute_pd(v, 0x5);
+	return _mm256_addsub_pd(_mm256_mul_pd(f_re, v), _mm256_mul_pd(f_im, v_sw));
+}
+
+QDEV_SIMD_AVX2_TARGET
+static void avx2_butterfly_1q(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE p_start, QDEV_ST_INDEX_TYPE p_stop,
+							  int q_idx, const QDEV_ST_VAL_TYPE* m) {
+	double* x_d = (double*)x;
+	double* y_d = (double*)y;
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)1 << q_idx;
+
+	if (stride < 2) {
+		// pair states adjacent, in a single register - both rows at once
+		__m256d a_re = _mm256_setr_pd(m[0].real(), m[0].real(), m[2].real(), m[2].real());
+		__m256d a_im = _mm256_setr_pd(m[0].imag(), m[0].imag(), m[2].imag(), m[2].imag());
+		__m256d b_re = _mm256_setr_pd(m[1].real(), m[1].real(), m[3].real(), m[3].real());
+		__m256d b_im = _mm256_setr_pd(m[1].imag(), m[1].imag(), m[3].imag(), m[3].imag());
+		for (QDEV_ST_INDEX_TYPE p=p_start; p<p_stop; p++) {
+			__m256d v = _mm256_loadu_pd(x_d + 4*p);
+			__m256d v0 = _mm256_permute2f128_pd(v, v, 0x00);
+			__m256d v1 = _mm256_permute2f128_pd(v, v, 0x11);
+			_mm256_storeu_pd(y_d + 4*p, _mm256_add_pd(avx2_cmul(v0, a_re, a_im), avx2_cmul(v1, b_re, b_im)));
+		}
+		return;
+	}
+
+	// 2 consecutive pairs per step, from an even pair index (same stride block)
+	__m256d m_re[4], m_im[4];
+	for (int i=0; i<4; i++) {
+		m_re[i] = _mm256_set1_pd(m[i].real());
+		m_im[i] = _mm256_set1_pd(m[i].imag());
+	}
+	QDEV_ST_INDEX_TYPE p = p_start;
+	if ((p & 1) && (p < p_stop)) {
+		scalar_butterfly_1q(x, y, p, p+1, q_idx, m);
+		p++;
+	}
+	for (; p+2<=p_stop; p+=2) {
+		QDEV_ST_INDEX_TYPE idx0 = ((p >> q_idx) << (q_idx+1)) | (p & (stride-1));
+		__m256d x0 = _mm256_loadu_pd(x_d + 2*idx0);
+		__m256d x1 = _mm256_loadu_pd(x_d + 2*(idx0+stride));
+		_mm256_storeu_pd(y_d + 2*idx0,
+						 _mm256_add_pd(avx2_cmul(x0, m_re[0], m_im[0]), avx2_cmul(x1, m_re[1], m_im[1])));
+		_mm256_storeu_pd(y_d + 2*(idx0+stride),
+						 _mm256_add_pd(avx2_cmul(x0, m_re[2], m_im[2]), avx2_cmul(x1, m_re[3], m_im[3])));
+	}
+	scalar_butterfly_1q(x, y, p, p_stop, q_idx, m);
+}
+
+QDEV_SIMD_AVX2_TARGET
+static void avx2_dense_kq(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+						  int q_lo, int fn, const QDEV_ST_VAL_TYPE* m) {
+	double* x_d = (double*)x;
+	double* y_d = (double*)y;
+	int fsize = 1 << fn;
+
+	if (q_lo == 0) {
+		// group states contiguous - 2 rows per register, with matrix columns packed by
+		// row pairs and group states broadcast
+		double m_pk[2 << 2*QDEV_F_DENSE_MAX_QUBITS];
+		double x_re[1 << QDEV_F_DENSE_MAX_QUBITS], x_im[1 << QDEV_F_DENSE_MAX_QUBITS];
+		for (int ib=0; ib<fsize/2; ib++) {
+			for (int j=0; j<fsize; j++) {
+				for (int w=0; w<2; w++) {
+					m_pk[4*(ib*fsize+j) + 2*w]   = m[(2*ib+w)*fsize + j].real();
+					m_pk[4*(ib*fsize+j) + 2*w+1] = m[(2*ib+w)*fsize + j].imag();
+				}
+			}
+		}
+		for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+			QDEV_ST_INDEX_TYPE base = g << fn;
+			for (int j=0; j<fsize; j++) {
+				x_re[j] = x[base+j].real();
+				x_im[j] = x[base+j].imag();
+			}
+			for (int ib=0; ib<fsize/2; ib++) {
+				__m256d acc = _mm256_setzero_pd();
+				for (int j=0; j<fsize; j++)
+					acc = _mm256_add_pd(acc, avx2_cmul(_mm256_loadu_pd(m_pk + 4*(ib*fsize+j)),
+													   _mm256_set1_pd(x_re[j]), _mm256_set1_pd(x_im[j])));
+				_mm256_storeu_pd(y_d + 2*(base + 2*ib), acc);
+			}
+		}
+		return;
+	}
+
+	// 2 consecutive groups per step, from an even group index (same low qubits block)
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	__m256d x_grp[1 << QDEV_F_DENSE_MAX_QUBITS];
+	QDEV_ST_INDEX_TYPE g = g_start;
+	if ((g & 1) && (g < g_stop)) {
+		scalar_dense_kq(x, y, g, g+1, q_lo, fn, m);
+		g++;
+	}
+	for (; g+2<=g_stop; g+=2) {
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fn)) | (g & lo_mask);
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = _mm256_loadu_pd(x_d + 2*(base + ((QDEV_ST_INDEX_TYPE)j << q_lo)));
+		for (int i=0; i<fsize; i++) {
+			const QDEV_ST_VAL_TYPE* m_i = m + i*fsize;
+			__m256d acc = _mm256_setzero_pd();
+			for (int j=0; j<fsize; j++)
+				acc = _mm256_add_pd(acc, avx2_cmul(x_grp[j], _mm256_set1_pd(m_i[j].real()),
+												   _mm256_set1_pd(m_i[j].imag())));
+			_mm256_storeu_pd(y_d + 2*(base + ((QDEV_ST_INDEX_TYPE)i << q_lo)), acc);
+		}
+	}
+	scalar_dense_kq(x, y, g, g_stop, q_lo, fn, m);
+}
+
+QDEV_SIMD_AVX2_TARGET
+static void avx2_scale(QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n, QDEV_ST_VAL_TYPE f) {
+	double* x_d = (double*)x;
+	__m256d f_re = _mm256_set1_pd(f.real());
+	__m256d f_im = _mm256_set1_pd(f.imag());
+	QDEV_ST_INDEX_TYPE k = 0;
+	for (; k+2<=n; k+=2)
+		_mm256_storeu_pd(x_d + 2*k, avx2_cmul(_mm256_loadu_pd(x_d + 2*k), f_re, f_im));
+	scalar_scale(x + k, n - k, f);
+}
+
+QDEV_SIMD_AVX2_TARGET
+static double avx2_norm_sum(const QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n) {
+	const double* x_d = (const double*)x;
+	__m256d acc = _mm256_setzero_pd();
+	QDEV_ST_INDEX_TYPE k = 0;
+	for (; k+2<=n; k+=2) {
+		__m256d v = _mm256_loadu_pd(x_d + 2*k);
+		acc = _mm256_add_pd(acc, _mm256_mul_pd(v, v));
+	}
+	double acc_d[4];
+	_mm256_storeu_pd(acc_d, acc);
+	return (acc_d[0] + acc_d[1]) + (acc_d[2] + acc_d[3]) + scalar_norm_sum(x + k, n - k);
+}
+
+// --------------------------------
+// AVX-512 kernels - 4 states per register (AVX2 ones used for qubits below the register width)
+// --------------------------------
+
+// complex product of v states by f factor (real and imag parts broadcast) - products
+// difference on real lanes, sum on imag ones (masked permute, the unmasked one leaves
+// its pass-through register undefined and trips gcc -Wmaybe-uninitialized)
+QDEV_SIMD_AVX512_TARGET
+static inline __m512d avx512_cmul(__m512d v, __m512d f_re, __m512d f_im) {
+	__m512d v_sw = _mm512_mask_permute_pd(v, 0xFF, v, 0x55);
+	__m512d p_re = _mm512_mul_pd(f_re, v);
+	__m512d p_im = _mm512_mul_pd(f_im, v_sw);
+	return _mm512_mask_sub_pd(_mm512_add_pd(p_re, p_im), 0x55, p_re, p_im);
+}
+
+QDEV_SIMD_AVX512_TARGET
+static void avx512_butterfly_1q(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE p_start, QDEV_ST_INDEX_TYPE p_stop,
+								int q_idx, const QDEV_ST_VAL_TYPE* m) {
+	double* x_d = (double*)x;
+	double* y_d = (double*)y;
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)1 << q_idx;
+	if (stride < 4) {
+		avx2_butterfly_1q(x, y, p_start, p_stop, q_idx, m);
+		return;
+	}
+
+	// 4 consecutive pairs per step, from a pair index multiple of 4 (same stride block)
+	__m512d m_re[4], m_im[4];
+	for (int i=0; i<4; i++) {
+		m_re[i] = _mm512_set1_pd(m[i].real());
+		m_im[i] = _mm512_set1_pd(m[i].imag());
+	}
+	QDEV_ST_INDEX_TYPE p = p_start;
+	QDEV_ST_INDEX_TYPE p_head = std::min(p_stop, (p + 3) & ~(QDEV_ST_INDEX_TYPE)3);
+	if (p < p_head) {
+		scalar_butterfly_1q(x, y, p, p_head, q_idx, m);
+		p = p_head;
+	}
+	for (; p+4<=p_stop; p+=4) {
+		QDEV_ST_INDEX_TYPE idx0 = ((p >> q_idx) << (q_idx+1)) | (p & (stride-1));
+		__m512d x0 = _mm512_loadu_pd(x_d + 2*idx0);
+		__m512d x1 = _mm512_loadu_pd(x_d + 2*(idx0+stride));
+		_mm512_storeu_pd(y_d + 2*idx0,
+						 _mm512_add_pd(avx512_cmul(x0, m_re[0], m_im[0]), avx512_cmul(x1, m_re[1], m_im[1])));
+		_mm512_storeu_pd(y_d + 2*(idx0+stride),
+						 _mm512_add_pd(avx512_cmul(x0, m_re[2], m_im[2]), avx512_cmul(x1, m_re[3], m_im[3])));
+	}
+	scalar_butterfly_1q(x, y, p, p_stop, q_idx, m);
+}
+
+QDEV_SIMD_AVX512_TARGET
+static void avx512_dense_kq(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE g_start, QDEV_ST_INDEX_TYPE g_stop,
+							int q_lo, int fn, const QDEV_ST_VAL_TYPE* m) {
+	double* x_d = (double*)x;
+	double* y_d = (double*)y;
+	int fsize = 1 << fn;
+
+	if ((q_lo == 0) && (fn >= 2)) {
+		// group states contiguous - 4 rows per register, with matrix columns packed by
+		// row quads and group states broadcast
+		double m_pk[2 << 2*QDEV_F_DENSE_MAX_QUBITS];
+		double x_re[1 << QDEV_F_DENSE_MAX_QUBITS], x_im[1 << QDEV_F_DENSE_MAX_QUBITS];
+		for (int ib=0; ib<fsize/4; ib++) {
+			for (int j=0; j<fsize; j++) {
+				for (int w=0; w<4; w++) {
+					m_pk[8*(ib*fsize+j) + 2*w]   = m[(4*ib+w)*fsize + j].real();
+					m_pk[8*(ib*fsize+j) + 2*w+1] = m[(4*ib+w)*fsize + j].imag();
+				}
+			}
+		}
+		for (QDEV_ST_INDEX_TYPE g=g_start; g<g_stop; g++) {
+			QDEV_ST_INDEX_TYPE base = g << fn;
+			for (int j=0; j<fsize; j++) {
+				x_re[j] = x[base+j].real();
+				x_im[j] = x[base+j].imag();
+			}
+			for (int ib=0; ib<fsize/4; ib++) {
+				__m512d acc = _mm512_setzero_pd();
+				for (int j=0; j<fsize; j++)
+					acc = _mm512_add_pd(acc, avx512_cmul(_mm512_loadu_pd(m_pk + 8*(ib*fsize+j)),
+														 _mm512_set1_pd(x_re[j]), _mm512_set1_pd(x_im[j])));
+				_mm512_storeu_pd(y_d + 2*(base + 4*ib), acc);
+			}
+		}
+		return;
+	}
+	if (q_lo < 2) {
+		avx2_dense_kq(x, y, g_start, g_stop, q_lo, fn, m);
+		return;
+	}
+
+	// 4 consecutive groups per step, from a group index multiple of 4 (same low qubits block)
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	__m512d x_grp[1 << QDEV_F_DENSE_MAX_QUBITS];
+	QDEV_ST_INDEX_TYPE g = g_start;
+	QDEV_ST_INDEX_TYPE g_head = std::min(g_stop, (g + 3) & ~(QDEV_ST_INDEX_TYPE)3);
+	if (g < g_head) {
+		scalar_dense_kq(x, y, g, g_head, q_lo, fn, m);
+		g = g_head;
+	}
+	for (; g+4<=g_stop; g+=4) {
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fn)) | (g & lo_mask);
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = _mm512_loadu_pd(x_d + 2*(base + ((QDEV_ST_INDEX_TYPE)j << q_lo)));
+		for (int i=0; i<fsize; i++) {
+			const QDEV_ST_VAL_TYPE* m_i = m + i*fsize;
+			__m512d acc = _mm512_setzero_pd();
+			for (int j=0; j<fsize; j++)
+				acc = _mm512_add_pd(acc, avx512_cmul(x_grp[j], _mm512_set1_pd(m_i[j].real()),
+													 _mm512_set1_pd(m_i[j].imag())));
+			_mm512_storeu_pd(y_d + 2*(base + ((QDEV_ST_INDEX_TYPE)i << q_lo)), acc);
+		}
+	}
+	scalar_dense_kq(x, y, g, g_stop, q_lo, fn, m);
+}
+
+QDEV_SIMD_AVX512_TARGET
+static void avx512_scale(QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n, QDEV_ST_VAL_TYPE f) {
+	double* x_d = (double*)x;
+	__m512d f_re = _mm512_set1_pd(f.real());
+	__m512d f_im = _mm512_set1_pd(f.imag());
+	QDEV_ST_INDEX_TYPE k = 0;
+	for (; k+4<=n; k+=4)
+		_mm512_storeu_pd(x_d + 2*k, avx512_cmul(_mm512_loadu_pd(x_d + 2*k), f_re, f_im));
+	scalar_scale(x + k, n - k, f);
+}
+
+QDEV_SIMD_AVX512_TARGET
+static double avx512_norm_sum(const QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n) {
+	const double* x_d = (const double*)x;
+	__m512d acc = _mm512_setzero_pd();
+	QDEV_ST_INDEX_TYPE k = 0;
+	for (; k+4<=n; k+=4) {
+		__m512d v = _mm512_loadu_pd(x_d + 2*k);
+		acc = _mm512_add_pd(acc, _mm512_mul_pd(v, v));
+	}
+	// same summation order of _mm512_reduce_add_pd (not used - undefined pass-through register)
+	double acc_d[8];
+	_mm512_storeu_pd(acc_d, acc);
+	return ((acc_d[0] + acc_d[4]) + (acc_d[2] + acc_d[6])) + ((acc_d[1] + acc_d[5]) + (acc_d[3] + acc_d[7]))
+			+ scalar_norm_sum(x + k, n - k);
+}
+
+#endif /* __QSIM_SIMD_X86__ */
+
+
+// --------------------------------
+// kernels selection
+// --------------------------------
+
+// kernels tables - indexed by instruction set level (scalar ones if not compiled)
+static const QDEV_SIMD_KERNELS_TYPE s_simd_kernels[] = {
+	{QDEV_SIMD_NONE, "scalar", scalar_butterfly_1q, scalar_dense_kq, scalar_scale, scalar_norm_sum},
+#ifdef __QSIM_SIMD_X86__
+	{QDEV_SIMD_AVX2, "avx2", avx2_butterfly_1q, avx2_dense_kq, avx2_scale, avx2_norm_sum},
+	{QDEV_SIMD_AVX512, "avx512", avx512_butterfly_1q, avx512_dense_kq, avx512_scale, avx512_norm_sum},
+#endif
+};
+
+const QDEV_SIMD_KERNELS_TYPE* qdev_simd_select(int max_level) {
+	// highest level supported by the CPU - OS support of the extended registers state
+	// checked as well
+	int level = QDEV_SIMD_NONE;
+#ifdef __QSIM_SIMD_X86__
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		level = QDEV_SIMD_AVX512;
+	else if (__builtin_cpu_supports("avx2"))
+		level = QDEV_SIMD_AVX2;
+#endif
+	if ((max_level >= QDEV_SIMD_NONE) && (level > max_level))
+		level = max_level;
+	return &s_simd_kernels[level];
+}
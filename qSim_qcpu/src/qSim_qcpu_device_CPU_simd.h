@@ -0,0 +1,93 @@
+/*
+ * qSim_qcpu_device_CPU_simd.h
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing the CPU device vectorized kernels, selected at run
+ * time on the instruction sets supported by the CPU (CPUID):
+ * - 1-qubit gate strided butterfly (2x2 matrix)
+ * - dense k-qubit unitary on qubit groups (fused gates, 4x4 and above)
+ * - contiguous states phase multiply (diagonal gates)
+ * - contiguous states norms sum (probability and expectation reductions)
+ *
+ * States are kept as interleaved real/imag pairs (i.e. complex array), each register
+ * holding 2 (AVX2) or 4 (AVX-512) consecutive states. Complex products are calculated
+ * with no fused multiply-add, giving the same results as the scalar kernels.
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Disabled on single precision compiling (scalar kernels used).
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#ifndef QSIM_QCPU_DEVICE_CPU_SIMD_H_
+#define QSIM_QCPU_DEVICE_CPU_SIMD_H_
+
+#include "qSim_qcpu_device_CPU.h"
+
+// vectorized kernels compiling - x86-64 GCC/Clang and double precision states only, unless
+// disabled (__QSIM_NO_SIMD__)
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__QSIM_SP__) && !defined(__QSIM_NO_SIMD__)
+#define __QSIM_SIMD_X86__
+#endif
+
+// instruction set levels
+#define QDEV_SIMD_NONE   0	// scalar kernels
+#define QDEV_SIMD_AVX2   1
+#define QDEV_SIMD_AVX512 2
+#define QDEV_SIMD_AUTO   -1	// highest level supported by the CPU
+
+// min contiguous states run handled by the vectorized reductions - shorter runs
+// left to the scalar loops
+#define QDEV_SIMD_MIN_RUN 8
+
+
+// kernels table - one per instruction set level
+struct qSim_qcpu_device_simd_kernels {
+	int level;
+	const char* name;
+
+	// 2x2 matrix (row-major) applied to the q_idx-th qubit, pairs in [p_start, p_stop) - result in y
+	// (x and y can be the same vector)
+	void (*butterfly_1q)(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* y, QDEV_ST_INDEX_TYPE p_start,
+						 QDEV_ST_INDEX_TYPE p_stop, int q_idx, const QDEV_ST_VAL_TYPE* m);
+
+	// dense 2^fn x 2^fn matrix (row-major) applied to the fn qubits from q_lo, groups in
+	// [g_start, g_stop) - result in y (x and y can be the same vector)
+	void (*dense_kq)(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* y, QDEV_ST_INDEX_TYPE g_start,
+					 QDEV_ST_INDEX_TYPE g_stop, int q_lo, int fn, const QDEV_ST_VAL_TYPE* m);
+
+	// n contiguous states multiplied by f
+	void (*scale)(QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n, QDEV_ST_VAL_TYPE f);
+
+	// n contiguous states norms sum
+	double (*norm_sum)(const QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE n);
+};
+typedef qSim_qcpu_device_simd_kernels QDEV_SIMD_KERNELS_TYPE;
+
+// kernels table selection - highest level supported by both the CPU and given max level
+const QDEV_SIMD_KERNELS_TYPE* qdev_simd_select(int max_level=QDEV_SIMD_AUTO);
+
+#endif /* QSIM_QCPU_DEVICE_CPU_SIMD_H_ */
@@ -40,6 +40,52 @@
  *                   Defined and handled a function arguments structure.
  *                   Code clean-up.
  *                   Module renamed to qSim_qcup_device_GPU_CUDA.
+ *  1.2   Oct-2026   Handled 64-bit state indexes and function vectors (and DP
+ *                   accumulation vectors) sized on qureg allocation (no max qureg
+ *                   size limit).
+ *  1.3   Oct-2026   Handled device memory allocation with no host data.
+ *  1.4   Oct-2026   Handled dense k-qubit unitary functions (fused gates).
+ *  1.5   Oct-2026   Handled qureg state marginal probabilities and expectation as
+ *                   block reductions (per-block partials summed up on host), and
+ *                   measure collapse kernel.
+ *  1.6   Oct-2026   Handled kernels templated on gate family, selected once per
+ *                   instruction with family parameters passed by value (no device
+ *                   function vectors copy), and gates block loops limited to
+ *                   non-gap states.
+ *  1.7   Oct-2026   Handled diagonal and permutation gates fast path kernels, applied
+ *                   in-place as index phase multiply and index bits swap, and fused
+ *                   unitaries with a single non-zero element per row as index table lookup.
+ *  1.8   Oct-2026   Handled controlled gates bitmask engine kernel, one thread per state
+ *                   group having all control bits set.
+ *  1.9   Oct-2026   Handled gates and dense unitaries by group engine kernel, staging
+ *                   state group tiles in shared memory with coalesced loads, and
+ *                   kernels block size by max occupancy on current device (replacing
+ *                   fixed block size and dynamic parallelism kernel).
+ *  1.10  Oct-2026   Handled per-qureg CUDA streams - kernels and copies enqueued on the
+ *                   selected stream with no device synchronisation after transformations,
+ *                   streams synchronised only on results access (reductions and device->host
+ *                   copies), dense unitaries and reductions partials on per-stream vectors.
+ *  1.11  Oct-2026   Handled multi-GPU support - device selection, peer access enabling among
+ *                   all devices and peer copies on the selected stream.
+ *  1.12  Oct-2026   Guarded data shared by all device instances (concurrent client sessions),
+ *                   i.e. launch block size cache and expectation weights constant memory.
+ *  1.13  Oct-2026   Handled single precision state values (__QSIM_SP__ compiling) - complex
+ *                   operations on selected precision, reductions accumulated in double.
+ *  1.14  Oct-2026   Handled batched dense unitaries (one matrix per state vector sample) by
+ *                   group engine kernel, with group element functors given the group index.
+ *  1.15  Oct-2026   Handled qureg state top-k reduction - per-thread candidates lists merged
+ *                   by block max reductions, block candidates merged on host.
+ *  1.16  Oct-2026   Handled device kernels statistics by CUDA events pairs recorded on the
+ *                   selected stream (no stream synchronisation), collected once completed.
+ *  1.17  Oct-2026   Handled device memory pool - released buffers kept on per-device size
+ *                   class free lists and reused by following allocations (qureg registers,
+ *                   snapshots, stream vectors and reductions partials), with cached buffers
+ *                   returned to the device on allocation failure, and devices warm-up
+ *                   (contexts creation and first kernel launch) at start-up.
+ *  1.18  Oct-2026   Handled device kernels statistics only if enabled, on CUDA events pairs
+ *                   recycled on per-device free lists (no events creation per transformation).
+ *  1.19  Oct-2026   Handled controlled gates resolution for bitmask engine on any qubits layout.
+ *  1.20  Oct-2026   Handled devices warm-up once per process, traced on verbose only.
  *
  *  -------------------------------------------------------------------------- 
  */
@@ -47,8 +93,13 @@
 
 #include <stdio.h>
 #include <math.h>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <mutex>
+#include <chrono>
 
-#include "qSim_qcpu_device_function_exec.h"
+#include "qSim_qcpu_device_function_fast_gates.h"
 #include "qSim_qcpu_device_GPU_CUDA.h"
 
 
@@ -84,167 +135,486 @@
 //  Max dimension size of a grid size    (x,y,z): (2147483647, 65535, 65535)
 // --------------------------------------------------------------
 
-#ifdef __CUDA_DYNPAR__
+// group engine - max width in qubits of the state groups staged in shared memory (gate
+// repetitions applied in chunks within this width, wider gates on the product kernel)
+#define QDEV_F_GROUP_MAX_QUBITS 5
 
-#define THREADS_PER_BLOCK 32 // best trade-off value for DP kernel
+// kernel launch - min and max block size (power of 2) and max grid size
+#define QDEV_LAUNCH_MIN_THREADS 32
+#define QDEV_LAUNCH_MAX_THREADS 1024
+#define QDEV_LAUNCH_MAX_BLOCKS  0x7FFFFFFF
 
-#else
+// data shared by all device instances (one per client session), i.e. launch block size cache
+// and expectation weights constant memory - guarded for concurrent sessions
+static std::mutex s_dev_shared_mutex;
 
-#define THREADS_PER_BLOCK 32 // best trade-off value for SK kernel (similar to 64 or 128)
+// --------------------------------
+// device memory pool - released buffers kept on free lists by device and size class (power
+// of 2 bytes), reused by following allocations of the same class with no CUDA allocation
+// and device synchronisation - shared by all device instances, guarded by its own mutex
+// --------------------------------
 
-#endif
+// min size class (bytes) and warm-up state vector size (qubits)
+#define QDEV_POOL_MIN_BYTES     256
+#define QDEV_WARMUP_QUBITS      10
+
+typedef std::pair<int, size_t> QDEV_POOL_CLASS_TYPE; // device, class bytes
+
+static std::mutex s_dev_pool_mutex;
+static std::map<QDEV_POOL_CLASS_TYPE, std::vector<void*> > s_dev_pool_free;
+static std::map<void*, QDEV_POOL_CLASS_TYPE> s_dev_pool_used;
+
+static void f_dev_pool_trim(int dev) {
+	// return cached buffers of given device to the device (caller holding the pool mutex)
+	std::map<QDEV_POOL_CLASS_TYPE, std::vector<void*> >::iterator it;
+	for (it = s_dev_pool_free.begin(); it != s_dev_pool_free.end(); ++it) {
+		if (it->first.first != dev)
+			continue;
+		for (size_t i=0; i<it->second.size(); i++)
+			cudaFree(it->second[i]);
+		it->second.clear();
+	}
+}
+
+static void* f_dev_pool_alloc(size_t n_bytes, bool oom_null = false) {
+	// buffer of the size class on the current device - cached one if any, new one otherwise
+	// (cached buffers released and allocation retried on failure, NULL returned if still out
+	// of memory and requested)
+	int dev = 0;
+	cudaGetDevice(&dev);
+	size_t c_bytes = QDEV_POOL_MIN_BYTES;
+	while (c_bytes < n_bytes)
+		c_bytes *= 2;
+	QDEV_POOL_CLASS_TYPE p_cls(dev, c_bytes);
+
+	std::lock_guard<std::mutex> lock(s_dev_pool_mutex);
+	void* d_p = NULL;
+	std::vector<void*>* p_free = &s_dev_pool_free[p_cls];
+	if (!p_free->empty()) {
+		d_p = p_free->back();
+		p_free->pop_back();
+	}
+	else if (cudaMalloc(&d_p, c_bytes) != cudaSuccess) {
+		cudaGetLastError(); // out of memory cleared
+		f_dev_pool_trim(dev);
+		if ((cudaMalloc(&d_p, c_bytes) != cudaSuccess) && oom_null) {
+			cudaGetLastError(); // out of memory reported to the caller
+			return NULL;
+		}
+	}
+	qSim_qcpu_device::checkCUDAError("cudaMalloc");
+	s_dev_pool_used[d_p] = p_cls;
+	return d_p;
+}
+
+static void f_dev_pool_free(void* d_p) {
+	// buffer back to its class free list - no pending work using it (caller synchronised)
+	if (d_p == NULL)
+		return;
+	std::lock_guard<std::mutex> lock(s_dev_pool_mutex);
+	std::map<void*, QDEV_POOL_CLASS_TYPE>::iterator it = s_dev_pool_used.find(d_p);
+	if (it == s_dev_pool_used.end()) {
+		fprintf(stderr, "f_dev_pool_free: buffer not allocated by device pool - error!!\n");
+		return;
+	}
+	s_dev_pool_free[it->second].push_back(d_p);
+	s_dev_pool_used.erase(it);
+}
 
 // --------------------------------
-// kernel entry point functions
+// stream context - CUDA stream and its own device vectors (dense unitary matrix and
+// reductions per-block partials), written only by work enqueued on the same stream
 // --------------------------------
 
-#ifdef __CUDA_DYNPAR__
+struct qSim_qcpu_device_stream_ctx {
+	cudaStream_t m_stream;
+	QDEV_ST_VAL_TYPE* d_fmtx;
+	double* d_red;
 
-// --------------------------------
-// multi kernel case
+	// batched dense unitaries CUDA matrices - allocated on first use, grown on demand
+	QDEV_ST_VAL_TYPE* d_fbmtx;
+	size_t m_fbmtx_n;
+};
 
-__global__
-void kernel_prod_ki(QDEV_ST_VAL_TYPE *x, int idx, int k_start, int k_stop, int k_step,
-		            QASM_F_TYPE* d_ftype_cuda_vec, int* d_fn_cuda_vec,
-					QDEV_F_ARGS_TYPE* d_fargs_cuda_vec, int tot_f,
-					int /*ftype*/, int fn, int fform, int gapn, int futype, int fun, int fuform,
-					double* d_y_real, double* d_y_img) {
-	// dynamic parallelism case - child kernel
-	int jdx = blockIdx.x * blockDim.x + threadIdx.x + k_start; // 1D vector: only x-dimension used
-//	printf("ki_dp - level 2...idx: %d  jdx:%d\n", idx, jdx);
+static qSim_qcpu_device_stream_ctx* f_dev_stream_ctx_alloc(cudaStream_t stream) {
+	qSim_qcpu_device_stream_ctx* ctx = new qSim_qcpu_device_stream_ctx;
+	ctx->m_stream = stream;
+
+	// dense unitary CUDA matrix - sized for max supported width
+	ctx->d_fmtx = (QDEV_ST_VAL_TYPE*)f_dev_pool_alloc((1 << 2*QDEV_F_DENSE_MAX_QUBITS)*sizeof(QDEV_ST_VAL_TYPE));
 
-	// check for calculation limits considering LSQ gap fillers generated zeroes
-	if ((jdx % k_step == idx % k_step) && (jdx < k_stop+1)) {
-		// calculate current coefficient
-		QDEV_ST_VAL_TYPE k = cuCmul(x[idx], f_dev_qn_exec(idx, jdx, d_ftype_cuda_vec, d_fn_cuda_vec,
-				                                          fn, fform, gapn, futype, fun, fuform, d_fargs_cuda_vec, tot_f));
+	// reductions partial results CUDA vector - sized for max shared memory bins
+	ctx->d_red = (double*)f_dev_pool_alloc(QDEV_REDUCE_BLOCKS*QDEV_MARGINAL_MAX_SHARED_BINS*sizeof(double));
 
-		// use atomic add on real and image parts separately
-		atomicAdd(&(d_y_real[idx]), (double)k.x);
-		atomicAdd(&(d_y_img[idx]), (double)k.y);
-//		printf("fxi_dp - k: %f %f  ---  d_y: %f %f\n", k.x, k.y, d_y_real[i], d_y_img[i]);
+	ctx->d_fbmtx = NULL;
+	ctx->m_fbmtx_n = 0;
+	return ctx;
+}
+
+static void f_dev_stream_ctx_free(qSim_qcpu_device_stream_ctx* ctx) {
+	// vectors back to the device pool - stream work completed
+	f_dev_pool_free(ctx->d_fmtx);
+	f_dev_pool_free(ctx->d_red);
+	f_dev_pool_free(ctx->d_fbmtx);
+	delete ctx;
+}
+
+// --------------------------------
+// kernel launch configuration
+// --------------------------------
+
+// => dynamic shared memory per block - none
+struct qSim_qcpu_device_smem_none {
+	__host__ __device__
+	size_t operator()(int /*block_size*/) const { return 0; }
+};
+
+// => dynamic shared memory per block - one state per thread, at least one state group
+struct qSim_qcpu_device_smem_group {
+	int m_gsize;
+	__host__ __device__
+	size_t operator()(int block_size) const {
+		return ((block_size > m_gsize) ? block_size : m_gsize)*sizeof(QDEV_ST_VAL_TYPE);
 	}
-//	printf("ki...%d %d -> %f %f\n", i, idx, k->x, k->y);
+};
+
+// => block size maximising occupancy for given kernel on current device, rounded down to
+//    a power of 2 - evaluated once per device, kernel and shared memory class
+template<class KERNEL, class SMEM_F>
+int f_dev_launch_block_size(KERNEL kernel, int smem_cls, const SMEM_F& smem_f) {
+	static std::map<std::tuple<int, const void*, int>, int> s_block_size;
+	std::lock_guard<std::mutex> lock(s_dev_shared_mutex);
+	int dev = 0;
+	cudaGetDevice(&dev);
+	std::tuple<int, const void*, int> key(dev, (const void*)kernel, smem_cls);
+	std::map<std::tuple<int, const void*, int>, int>::iterator it = s_block_size.find(key);
+	if (it != s_block_size.end())
+		return it->second;
+
+	int min_grid_size = 0;
+	int block_size = 0;
+	cudaOccupancyMaxPotentialBlockSizeVariableSMem(&min_grid_size, &block_size, kernel, smem_f,
+												   QDEV_LAUNCH_MAX_THREADS);
+	qSim_qcpu_device::checkCUDAError("cudaOccupancyMaxPotentialBlockSizeVariableSMem");
+	int bs = QDEV_LAUNCH_MIN_THREADS;
+	while (2*bs <= block_size)
+		bs *= 2;
+	s_block_size[key] = bs;
+	return bs;
 }
 
-__global__
-void kernel_prod_fxi_dp(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, int N,
-		                QASM_F_TYPE* d_ftype_cuda_vec, int* d_fn_cuda_vec,
-		                QDEV_F_ARGS_TYPE* d_fargs_cuda_vec, int tot_f, int max_block_size, int block_inner_gap_size,
-						int ftype, int fn, int fform, int gapn, int futype, int fun, int fuform,
-						double* d_y_real, double* d_y_img) {
-	// dynamic parallelism case - parent kernel
-	int idx = blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
-//	printf("fxi_dp - level 1...idx: %d\n", idx);
+// => threads per block for given kernel on n_items (one thread each), no shared memory
+template<class KERNEL>
+int f_dev_launch_threads(KERNEL kernel, QDEV_ST_INDEX_TYPE n_items) {
+	int bs = f_dev_launch_block_size(kernel, 0, qSim_qcpu_device_smem_none());
+	return MIN(n_items, (QDEV_ST_INDEX_TYPE)bs);
+}
 
-	// combine all i-th row with x elements for y i-th result
-	if (idx < N) {
-		// define current calculation limits considering LSQ & MSQ gap fillers generated zeroes
-	    int k_step = block_inner_gap_size;
-		int k_start = max(0, (idx/max_block_size)*max_block_size);
-		int k_stop = min(N-1, k_start+max_block_size-1);
-		int k_N = k_stop - k_start + 1;
-		int nblocks = (k_N+THREADS_PER_BLOCK-1)/THREADS_PER_BLOCK;
-		int nthreads = MIN(k_N, THREADS_PER_BLOCK);
-		kernel_prod_ki<<<nblocks, nthreads>>>(x, idx, k_start, k_stop, k_step,
-				                              d_ftype_cuda_vec, d_fn_cuda_vec, d_fargs_cuda_vec, tot_f,
-											  ftype, fn, fform, gapn, futype, fun, fuform, d_y_real, d_y_img);
-		cudaDeviceSynchronize(); // to sync children kernels - NEEDED!
-		y[idx] = QDEV_ST_MAKE_VAL(d_y_real[idx], d_y_img[idx]);
-//		printf("fxi_dp...%d -> %f %f\n", idx, y[idx].x, y[idx].y);
+// --------------------------------
+// kernel entry point functions
+// --------------------------------
+
+// --------------------------------
+// group engine case (shared memory staging)
+
+// each thread block stages a tile of 2^t_ln consecutive state groups - 2^gn states each,
+// sharing all qubits out of [q_lo, q_lo+gn) - into shared memory, with consecutive
+// threads loading consecutive group indexes (i.e. consecutive states for the same group
+// position), then each thread evaluates and stores its tile states from the staged ones
+// => group element functor, selected once per instruction:
+//    - gate family, repeated gate items combining as tensor-product
+template<class F_GATE>
+struct qSim_qcpu_device_f_elem_gate {
+	int m_fn;
+	int m_frep;
+	QDEV_F_PARAMS_TYPE m_fparams;
+
+	__device__
+	inline QDEV_ST_VAL_TYPE val(QDEV_ST_INDEX_TYPE /*g*/, int i, int j) const {
+		return f_dev_qn_exec<F_GATE>(i, j, m_fn, m_frep, m_fparams);
+	}
+};
+
+//    - dense unitary (fused gates), row-major matrix on device memory
+struct qSim_qcpu_device_f_elem_mtx {
+	const QDEV_ST_VAL_TYPE* m_mtx;
+	int m_fsize;
+
+	__device__
+	inline QDEV_ST_VAL_TYPE val(QDEV_ST_INDEX_TYPE /*g*/, int i, int j) const {
+		return m_mtx[i*m_fsize+j];
+	}
+};
+
+//    - batched dense unitaries, one row-major matrix per state vector sample (2^m_sgn
+//      consecutive groups each) on device memory
+struct qSim_qcpu_device_f_elem_mtx_batch {
+	const QDEV_ST_VAL_TYPE* m_mtx;
+	int m_fsize;
+	int m_sgn;
+
+	__device__
+	inline QDEV_ST_VAL_TYPE val(QDEV_ST_INDEX_TYPE g, int i, int j) const {
+		return m_mtx[((g >> m_sgn)*m_fsize + i)*m_fsize + j];
+	}
+};
+
+template<class F_ELEM>
+__global__
+void kernel_group_shared(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE tot_t,
+						 int q_lo, int gn, int t_ln, F_ELEM f_elem) {
+	// one thread block per tile (grid-stride loop on tiles) - tile states gathered before
+	// update (x and y can be the same vector)
+	extern __shared__ QDEV_ST_VAL_TYPE sh_x[];
+	int gsize = 1 << gn;
+	int t_n = gsize << t_ln;
+	int l_mask = (1 << t_ln) - 1;
+	QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+	for (QDEV_ST_INDEX_TYPE t=blockIdx.x; t<tot_t; t+=gridDim.x) {
+		// => coalesced load - tile state s as group position j of group l
+		for (int s=threadIdx.x; s<t_n; s+=blockDim.x) {
+			QDEV_ST_INDEX_TYPE g = (t << t_ln) | (s & l_mask);
+			QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+gn)) | (g & lo_mask);
+			sh_x[s] = x[base + ((QDEV_ST_INDEX_TYPE)(s >> t_ln) << q_lo)];
+		}
+		__syncthreads();
+
+		// => group row product from staged states and coalesced store
+		for (int s=threadIdx.x; s<t_n; s+=blockDim.x) {
+			int i = s >> t_ln;
+			int l = s & l_mask;
+			QDEV_ST_INDEX_TYPE g = (t << t_ln) | l;
+			QDEV_ST_VAL_TYPE y_s = QDEV_ST_MAKE_VAL(0.0, 0.0);
+			for (int j=0; j<gsize; j++)
+				y_s = QDEV_ST_ADD(y_s, QDEV_ST_MUL(f_elem.val(g, i, j), sh_x[(j << t_ln) | l]));
+			QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+gn)) | (g & lo_mask);
+			y[base + ((QDEV_ST_INDEX_TYPE)i << q_lo)] = y_s;
+		}
+		__syncthreads(); // shared states reused by next tile
 	}
 }
 
-#else
+// => group engine launch on given group element functor - N/2^gn groups, tiled as per
+//    occupancy block size
+template<class F_ELEM>
+void f_dev_launch_group(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE N,
+						int q_lo, int gn, const F_ELEM& f_elem, cudaStream_t stream, bool verbose) {
+	int gsize = 1 << gn;
+	qSim_qcpu_device_smem_group smem_f = {gsize};
+	int bs = f_dev_launch_block_size(kernel_group_shared<F_ELEM>, gn, smem_f);
+
+	// groups per tile - one state per thread, within total groups
+	QDEV_ST_INDEX_TYPE tot_g = N >> gn;
+	int t_ln = 0;
+	while (((gsize << (t_ln+1)) <= bs) && (((QDEV_ST_INDEX_TYPE)2 << t_ln) <= tot_g))
+		t_ln++;
+	QDEV_ST_INDEX_TYPE tot_t = tot_g >> t_ln;
+	int nthreads = MIN(gsize << t_ln, bs);
+	QDEV_ST_INDEX_TYPE nblocks = MIN(tot_t, (QDEV_ST_INDEX_TYPE)QDEV_LAUNCH_MAX_BLOCKS);
+	size_t smem = ((size_t)gsize << t_ln)*sizeof(QDEV_ST_VAL_TYPE);
+	if (verbose) {
+		printf("q_lo: %d  gn: %d  t_ln: %d  tot_t: %lld\n", q_lo, gn, t_ln, (long long)tot_t);
+		printf("nblocks: %lld  nthreads: %d  smem: %lu\n\n", (long long)nblocks, nthreads, (unsigned long)smem);
+		printf("calling kernel...GS\n\n");
+	}
+	kernel_group_shared<F_ELEM><<<nblocks, nthreads, smem, stream>>>(x, y, tot_t, q_lo, gn, t_ln, f_elem);
+	qSim_qcpu_device::checkCUDAError("kernel_group_shared");
+}
 
 // --------------------------------
-// single kernel case
+// product kernel case (gates wider than group engine max width)
 
+template<class F_GATE>
 __global__
-void kernel_prod_fxi_sk(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, int N,
-						QASM_F_TYPE* d_ftype_cuda_vec, int* d_fn_cuda_vec,
-						QDEV_F_ARGS_TYPE* d_fargs_cuda_vec, int tot_f, int max_block_size, int block_inner_gap_size,
-						int /*ftype*/, int fn, int fform, int gapn, int futype, int fun, int fuform) {
+void kernel_prod_fxi_sk(QDEV_ST_VAL_TYPE *x, QDEV_ST_VAL_TYPE *y, QDEV_ST_INDEX_TYPE N,
+						QDEV_ST_INDEX_TYPE max_block_size, QDEV_ST_INDEX_TYPE block_inner_gap_size,
+						int fn, int frep, QDEV_F_PARAMS_TYPE fparams) {
 	// single kernel case
-	int idx = blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	QDEV_ST_INDEX_TYPE idx = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
 //	printf("fxi_sk...idx: %d\n", idx);
 
 	// combine all i-th row with x elements for y i-th result
 	if (idx < N) {
-		y[idx] = QDEV_ST_MAKE_VAL(0.0, 0.0);
-
 		// define current calculation limits considering LSQ & MSQ gap fillers generated zeroes
-	    int k_step = block_inner_gap_size;
-		int k_start = max(0, (idx/max_block_size)*max_block_size);
-		int k_stop = min(N-1, k_start+max_block_size-1);
+		// => only states within the same max block and sharing the LSQ gap bits
+	    QDEV_ST_INDEX_TYPE k_step = block_inner_gap_size;
+		QDEV_ST_INDEX_TYPE k_start = (idx/max_block_size)*max_block_size + idx%k_step;
+		QDEV_ST_INDEX_TYPE k_stop = MIN(N, (idx/max_block_size+1)*max_block_size);
+		QDEV_ST_INDEX_TYPE i_f = (idx%max_block_size)/k_step;
 //		printf("fxi_sk...idx: %d  N: %d  k_step: %d  k_start: %d  k_stop: %d\n", idx, N, k_step, k_start, k_stop);
-		
-		for (int k=k_start; k<k_stop+1; k++) {
-			// check for calculation limits considering LSQ gap fillers generated zeroes
-			if (k % k_step == idx % k_step) {
-//				printf("...found idx: %d  k: %d", idx, k);
-				y[idx] = cuCadd(y[idx], cuCmul(x[k], f_dev_qn_exec(idx, k, d_ftype_cuda_vec, d_fn_cuda_vec,
-										       fn, fform, gapn, futype, fun, fuform, d_fargs_cuda_vec, tot_f)));
+
+		QDEV_ST_VAL_TYPE y_i = QDEV_ST_MAKE_VAL(0.0, 0.0);
+		QDEV_ST_INDEX_TYPE j_f = 0;
+		for (QDEV_ST_INDEX_TYPE k=k_start; k<k_stop; k+=k_step, j_f++)
+			y_i = QDEV_ST_ADD(y_i, QDEV_ST_MUL(x[k], f_dev_qn_exec<F_GATE>(i_f, j_f, fn, frep, fparams)));
+		y[idx] = y_i;
+//		printf("fxi_sk...%d -> %f %f\n", idx, y[idx].x, y[idx].y);
+	}
+}
+
+// --------------------------------
+// gate family runner - group engine on gate repetitions chunks (first one from x to y,
+// then in-place on y), or product kernel on N elements for gates wider than max group,
+// enqueued on the given stream
+
+struct qSim_qcpu_device_f_run_group {
+	QDEV_ST_VAL_TYPE* m_x;
+	QDEV_ST_VAL_TYPE* m_y;
+	QDEV_ST_INDEX_TYPE m_N;
+	int m_flsq;
+	int m_fn;
+	int m_frep;
+	cudaStream_t m_stream;
+	bool m_verbose;
+
+	template<class F_GATE>
+	int run(const QDEV_F_PARAMS_TYPE& fparams) const {
+		if (m_fn > QDEV_F_GROUP_MAX_QUBITS) {
+			// product kernel - x and y must differ
+			if (m_x == m_y) {
+				printf("qSim_qcpu_device_f_run_group: in-place product kernel not supported [fn: %d] - error!!\n", m_fn);
+				return QDEV_RES_ERROR;
+			}
+			QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (m_fn*m_frep + m_flsq);
+			QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << m_flsq;
+			int nthreads = f_dev_launch_threads(kernel_prod_fxi_sk<F_GATE>, m_N);
+			QDEV_ST_INDEX_TYPE nblocks = (m_N+nthreads-1)/nthreads;
+			if (m_verbose) {
+				printf("nblocks: %lld  nthreads: %d\n\n", (long long)nblocks, nthreads);
+				printf("calling kernel...SK\n\n");
 			}
-//			printf("\n");
+			kernel_prod_fxi_sk<F_GATE><<<nblocks, nthreads, 0, m_stream>>>(m_x, m_y, m_N, max_block_size, block_inner_gap_size,
+																	   m_fn, m_frep, fparams);
+			qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_sk");
 		}
-//		printf("fxi_sk...%d -> %f %f\n", idx, y[idx].x, y[idx].y);
+		else {
+			// group engine - repetitions chunks within max group width
+			int c_rep = QDEV_F_GROUP_MAX_QUBITS / m_fn;
+			for (int r=0; r<m_frep; r+=c_rep) {
+				int n_rep = MIN(c_rep, m_frep-r);
+				qSim_qcpu_device_f_elem_gate<F_GATE> f_elem = {m_fn, n_rep, fparams};
+				f_dev_launch_group((r == 0) ? m_x : m_y, m_y, m_N, m_flsq + r*m_fn, m_fn*n_rep, f_elem,
+								   m_stream, m_verbose);
+			}
+		}
+
+		// no wait for kernel instances completion - stream synchronised on results access
+		return QDEV_RES_OK;
 	}
+};
+
+// --------------------------------
+// fast path gates case (1-qubit diagonal and permutation gates)
+
+__global__
+void kernel_fast_diag(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, QDEV_F_FAST_PARAMS_TYPE fparams) {
+	// one thread per state - multiplied by its index phase factor, directly on x states
+	QDEV_ST_INDEX_TYPE idx = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	if (idx < N)
+		x[idx] = QDEV_ST_MUL(x[idx], f_dev_fast_diag_val(idx, fparams));
 }
 
-#endif
+__global__
+void kernel_fast_perm(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, QDEV_F_FAST_PARAMS_TYPE fparams) {
+	// one thread per state - swapped with its partner state by the lower index thread,
+	// directly on x states
+	QDEV_ST_INDEX_TYPE idx = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	if (idx < N) {
+		QDEV_ST_INDEX_TYPE idx_p = idx ^ fparams.f_mask;
+		if (idx_p > idx) {
+			QDEV_ST_VAL_TYPE x_p = x[idx_p];
+			x[idx_p] = x[idx];
+			x[idx] = x_p;
+		}
+	}
+}
+
+__global__
+void kernel_fast_mtx(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE tot_g, QDEV_F_FAST_MTX_PARAMS_TYPE fparams) {
+	// one thread per group of 2^fn states sharing all qubits out of [flsq, flsq+fn) - each
+	// group state taken from its table one, gathered before update, directly on x states
+	QDEV_ST_INDEX_TYPE g = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	if (g < tot_g) {
+		int q_lo = fparams.flsq;
+		int fsize = 1 << fparams.fn;
+		QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_lo) - 1;
+		QDEV_ST_INDEX_TYPE base = ((g >> q_lo) << (q_lo+fparams.fn)) | (g & lo_mask);
+		QDEV_ST_VAL_TYPE x_grp[1 << QDEV_F_DENSE_MAX_QUBITS];
+		for (int j=0; j<fsize; j++)
+			x_grp[j] = x[base + ((QDEV_ST_INDEX_TYPE)j << q_lo)];
+		for (int i=0; i<fsize; i++)
+			x[base + ((QDEV_ST_INDEX_TYPE)i << q_lo)] = QDEV_ST_MUL(fparams.p_val[i], x_grp[fparams.p_idx[i]]);
+	}
+}
+
+// --------------------------------
+// controlled gates case (bitmask engine)
+
+__global__
+void kernel_fast_ctrl(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE tot_g, QDEV_F_CTRL_PARAMS_TYPE fparams) {
+	// one thread per group of 2^tn states having all control bits set and sharing all other
+	// qubits out of targets - U-gate applied on group states gathered before update, directly
+	// on x states
+	QDEV_ST_INDEX_TYPE g = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	if (g < tot_g) {
+		int usize = 1 << fparams.tn;
+		QDEV_ST_INDEX_TYPE base = f_dev_ctrl_group_base(g, fparams);
+		QDEV_ST_VAL_TYPE x_grp[1 << QDEV_F_UMTX_MAX_QUBITS];
+		for (int j=0; j<usize; j++)
+			x_grp[j] = x[base + fparams.t_off[j]];
+		if (fparams.p_mono) {
+			for (int i=0; i<usize; i++)
+				x[base + fparams.t_off[i]] = QDEV_ST_MUL(fparams.p_val[i], x_grp[fparams.p_idx[i]]);
+		}
+		else {
+			for (int i=0; i<usize; i++) {
+				QDEV_ST_VAL_TYPE y_i = QDEV_ST_MAKE_VAL(0.0, 0.0);
+				for (int j=0; j<usize; j++)
+					y_i = QDEV_ST_ADD(y_i, QDEV_ST_MUL(fparams.u_mtx[i*usize+j], x_grp[j]));
+				x[base + fparams.t_off[i]] = y_i;
+			}
+		}
+	}
+}
 
 // --------------------------------------------------------
 // class methods
 // --------------------------------------------------------
 
-#define dev_qreg_MAX_N 20 			// max qureg size supported
-#define CUDA_TOT_F dev_qreg_MAX_N  // bounded by max qureg size
-
 // constructor & destructor
 qSim_qcpu_device::qSim_qcpu_device() {
-    // allocate function host vectors
-    m_ftype_vec = (QASM_F_TYPE*)malloc(CUDA_TOT_F*sizeof(QASM_F_TYPE));
-    m_fsize_vec = (int*)malloc(CUDA_TOT_F*sizeof(int));
-    m_fargs_vec = (QDEV_F_ARGS_TYPE*)malloc(CUDA_TOT_F*sizeof(QDEV_F_ARGS_TYPE));
-
-    // allocate function param vectors
-	cudaMalloc((void**)&d_ftype_cuda_vec, CUDA_TOT_F*sizeof(QASM_F_TYPE));
-	qSim_qcpu_device::checkCUDAError("cudaMalloc");
-	cudaMalloc((void**)&d_fsize_cuda_vec, CUDA_TOT_F*sizeof(int));
-	qSim_qcpu_device::checkCUDAError("cudaMalloc");
-	cudaMalloc((void**)&d_fargs_cuda_vec, CUDA_TOT_F*sizeof(QDEV_F_ARGS_TYPE));
-	qSim_qcpu_device::checkCUDAError("cudaMalloc");
-
-#ifdef __CUDA_DYNPAR__
-	// DP case specific part
-	int qreg_max_stn = pow(2, dev_qreg_MAX_N);
-	cudaMalloc(&d_y_real, qreg_max_stn*sizeof(double));
-	qSim_qcpu_device::checkCUDAError("cudaMalloc");
-	cudaMalloc(&d_y_img, qreg_max_stn*sizeof(double));
-	qSim_qcpu_device::checkCUDAError("cudaMalloc");
-
-	cudaMemset(d_y_real, 0, qreg_max_stn*sizeof(double));
-	qSim_qcpu_device::checkCUDAError("cudaMemset");
-	cudaMemset(d_y_img, 0, qreg_max_stn*sizeof(double));
-	qSim_qcpu_device::checkCUDAError("cudaMemset");
-	cudaDeviceSynchronize();	
-#endif
+    // function host vectors - sized on qureg allocation (gate family parameters
+    // passed by value to kernels, no function CUDA vectors)
+    m_ftype_vec = NULL;
+    m_fsize_vec = NULL;
+    m_fargs_vec = NULL;
+    m_tot_f_max = 0;
+
+	// default stream context - CUDA default stream, selected until a qureg stream is
+	m_def_stream = f_dev_stream_ctx_alloc(0);
+	m_cur_stream = m_def_stream;
+
+	// no kernels statistics recorded
+	m_stats_cur = NULL;
 }
 
 qSim_qcpu_device::~qSim_qcpu_device() {
-	// release function CUDA vectors
-	cudaFree(d_ftype_cuda_vec);
-	cudaFree(d_fsize_cuda_vec);
-	cudaFree(d_fargs_cuda_vec);
-	qSim_qcpu_device::checkCUDAError("cudaFree");
-
-#ifdef __CUDA_DYNPAR__
-	// DP case specific part
-	cudaFree(d_y_real);
-	cudaFree(d_y_img);
-	qSim_qcpu_device::checkCUDAError("cudaFree");
-#endif
+	// collect pending kernels statistics and release recycled events
+	dev_qreg_stats_collect(true);
+	if (m_stats_cur != NULL)
+		m_stats_free[m_stats_cur->m_dev].push_back(m_stats_cur);
+	std::map<int, std::vector<qSim_qcpu_device_stats_ev*> >::iterator it;
+	for (it = m_stats_free.begin(); it != m_stats_free.end(); ++it) {
+		for (size_t i=0; i<it->second.size(); i++) {
+			cudaEventDestroy(it->second[i]->m_start);
+			cudaEventDestroy(it->second[i]->m_stop);
+			delete it->second[i];
+		}
+	}
+
+	// release default stream context CUDA vectors - pending work completed
+	cudaStreamSynchronize(m_def_stream->m_stream);
+	f_dev_stream_ctx_free(m_def_stream);
 
 	// release function host vectors
 	free(m_ftype_vec);
@@ -252,19 +622,224 @@ qSim_qcpu_device::~qSim_qcpu_device() {
 	free(m_fargs_vec);
 }
 
+// ---------------------------------------------------------
+// function tables sizing
+// ---------------------------------------------------------
+
+int qSim_qcpu_device::dev_qreg_function_tables_reserve(int qn) {
+	// grow function vectors for the given qureg size, if needed - as gap fillers
+	// span at least 1 qubit each, total function elements are bounded by qn
+	if (qn > m_tot_f_max) {
+		// host vectors
+		free(m_ftype_vec);
+		free(m_fsize_vec);
+		free(m_fargs_vec);
+		m_ftype_vec = (QASM_F_TYPE*)malloc(qn*sizeof(QASM_F_TYPE));
+		m_fsize_vec = (QDEV_ST_INDEX_TYPE*)malloc(qn*sizeof(QDEV_ST_INDEX_TYPE));
+		m_fargs_vec = (QDEV_F_ARGS_TYPE*)malloc(qn*sizeof(QDEV_F_ARGS_TYPE));
+		if ((m_ftype_vec == NULL) || (m_fsize_vec == NULL) || (m_fargs_vec == NULL)) {
+			printf("dev_qreg_function_tables_reserve: function vectors allocation failed for qureg size %d - error!!\n", qn);
+			m_tot_f_max = 0;
+			return QDEV_RES_ERROR; // return error
+		}
+		m_tot_f_max = qn;
+	}
+
+
+	return QDEV_RES_OK;
+}
+
+// ---------------------------------------------------------
+// qureg streams
+// ---------------------------------------------------------
+
+int qSim_qcpu_device::dev_qreg_stream_create(QDEV_STREAM_TYPE* d_s) {
+	// non-blocking stream - no implicit synchronisation with other qureg streams work
+	cudaStream_t stream;
+	if (cudaStreamCreateWithFlags(&stream, cudaStreamNonBlocking) != cudaSuccess) {
+		qSim_qcpu_device::checkCUDAError("cudaStreamCreateWithFlags");
+		*d_s = NULL;
+		return QDEV_RES_ERROR; // return error
+	}
+	*d_s = f_dev_stream_ctx_alloc(stream);
+	return QDEV_RES_OK;
+}
+
+void qSim_qcpu_device::dev_qreg_stream_release(QDEV_STREAM_TYPE d_s) {
+	// wait for pending stream work before releasing its vectors
+	if (d_s == NULL)
+		return;
+	if (m_cur_stream == d_s)
+		m_cur_stream = m_def_stream;
+	cudaStreamSynchronize(d_s->m_stream);
+	cudaStreamDestroy(d_s->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaStreamDestroy");
+	f_dev_stream_ctx_free(d_s);
+}
+
+void qSim_qcpu_device::dev_qreg_stream_select(QDEV_STREAM_TYPE d_s) {
+	// following kernels and copies enqueued on given stream - default one if NULL
+	m_cur_stream = (d_s != NULL) ? d_s : m_def_stream;
+}
+
+void qSim_qcpu_device::dev_qreg_stream_sync() {
+	// wait for all work enqueued on the selected stream
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaStreamSynchronize");
+}
+
+// ---------------------------------------------------------
+// device kernels statistics
+// ---------------------------------------------------------
+
+struct qSim_qcpu_device_stats_ev {
+	cudaEvent_t m_start;
+	cudaEvent_t m_stop;
+	uint64_t m_t0;
+	int m_key;
+	int m_dev;	// device the events were created on
+};
+
+void qSim_qcpu_device::dev_qreg_stats_start() {
+	// record start event on the selected stream - if device timing enabled, on a recycled
+	// events pair of the selected device (created on first use)
+	if (!qSim_qstats::device_enabled())
+		return;
+	int dev = 0;
+	cudaGetDevice(&dev);
+	if ((m_stats_cur != NULL) && (m_stats_cur->m_dev != dev)) {
+		m_stats_free[m_stats_cur->m_dev].push_back(m_stats_cur);
+		m_stats_cur = NULL;
+	}
+	if (m_stats_cur == NULL) {
+		std::vector<qSim_qcpu_device_stats_ev*>* ev_free = &m_stats_free[dev];
+		if (!ev_free->empty()) {
+			m_stats_cur = ev_free->back();
+			ev_free->pop_back();
+		}
+		else {
+			m_stats_cur = new qSim_qcpu_device_stats_ev;
+			cudaEventCreate(&m_stats_cur->m_start);
+			cudaEventCreate(&m_stats_cur->m_stop);
+			m_stats_cur->m_dev = dev;
+		}
+	}
+	cudaEventRecord(m_stats_cur->m_start, m_cur_stream->m_stream);
+	m_stats_cur->m_t0 = qSim_qstats::now_ns();
+}
+
+void qSim_qcpu_device::dev_qreg_stats_stop(int key) {
+	// record stop event on the selected stream and collect completed ones
+	if (m_stats_cur == NULL)
+		return;
+	cudaEventRecord(m_stats_cur->m_stop, m_cur_stream->m_stream);
+	m_stats_cur->m_key = key;
+	m_stats_evs.push_back(m_stats_cur);
+	m_stats_cur = NULL;
+	dev_qreg_stats_collect(false);
+}
+
+void qSim_qcpu_device::dev_qreg_stats_collect(bool wait) {
+	// elapsed time of completed events pairs, in recording order
+	while (!m_stats_evs.empty()) {
+		qSim_qcpu_device_stats_ev* ev = m_stats_evs.front();
+		if (wait)
+			cudaEventSynchronize(ev->m_stop);
+		else if (cudaEventQuery(ev->m_stop) != cudaSuccess)
+			break;
+
+		float ms = 0;
+		cudaEventElapsedTime(&ms, ev->m_start, ev->m_stop);
+		qSim_qstats::record_duration(QSTATS_STAGE_DEVICE, ev->m_key, ev->m_t0, (uint64_t)(ms*1e6));
+		m_stats_free[ev->m_dev].push_back(ev);
+		m_stats_evs.pop_front();
+	}
+	cudaGetLastError(); // not ready results cleared
+}
+
+// ---------------------------------------------------------
+// multi-GPU support
+// ---------------------------------------------------------
+
+int qSim_qcpu_device::dev_gpu_select(int dev_id) {
+	// following allocations, streams and kernels on given device
+	if (cudaSetDevice(dev_id) != cudaSuccess) {
+		qSim_qcpu_device::checkCUDAError("cudaSetDevice");
+		return QDEV_RES_ERROR; // return error
+	}
+	return QDEV_RES_OK;
+}
+
+int qSim_qcpu_device::dev_gpu_peer_enable(int tot_dev) {
+	// direct peer access (P2P/NVLink) between each devices pair, where supported - copies
+	// between devices with no peer access staged through host memory by the runtime
+	int tot_p2p = 0;
+	for (int i=0; i<tot_dev; i++) {
+		cudaSetDevice(i);
+		for (int j=0; j<tot_dev; j++) {
+			int can_access = 0;
+			if ((i == j) || (cudaDeviceCanAccessPeer(&can_access, i, j) != cudaSuccess) || !can_access)
+				continue;
+			cudaError_t err = cudaDeviceEnablePeerAccess(j, 0);
+			if ((err == cudaSuccess) || (err == cudaErrorPeerAccessAlreadyEnabled))
+				tot_p2p++;
+			cudaGetLastError(); // clear already enabled error
+		}
+	}
+	cudaSetDevice(0);
+	printf("dev_gpu_peer_enable: %d devices - %d peer access links enabled\n", tot_dev, tot_p2p);
+	return QDEV_RES_OK;
+}
+
+// => qureg state setup - kernel function (defined with the state setup methods)
+__global__
+void kernel_set_state(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE st_val);
+
+int qSim_qcpu_device::dev_gpu_warmup(int tot_dev, bool verbose) {
+	// create each device context and load kernels on a first |0> state setup, on a pooled
+	// state vector then kept for the first small quregs - no start-up costs on first request
+	std::chrono::steady_clock::time_point t_start = std::chrono::steady_clock::now();
+	for (int i=0; i<tot_dev; i++) {
+		if (cudaSetDevice(i) != cudaSuccess) {
+			qSim_qcpu_device::checkCUDAError("cudaSetDevice");
+			return QDEV_RES_ERROR; // return error
+		}
+		cudaFree(0);
+		QDEV_ST_INDEX_TYPE d_N = (QDEV_ST_INDEX_TYPE)1 << QDEV_WARMUP_QUBITS;
+		QDEV_ST_VAL_TYPE* d_x = (QDEV_ST_VAL_TYPE*)f_dev_pool_alloc(d_N*sizeof(QDEV_ST_VAL_TYPE));
+		int nthreads = f_dev_launch_threads(kernel_set_state, d_N);
+		kernel_set_state<<<(d_N+nthreads-1)/nthreads, nthreads>>>(d_x, d_N, 0);
+		cudaDeviceSynchronize();
+		qSim_qcpu_device::checkCUDAError("kernel_set_state");
+		f_dev_pool_free(d_x);
+	}
+	cudaSetDevice(0);
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count();
+	if (verbose)
+		printf("dev_gpu_warmup: %d devices ready - %.3f ms\n", tot_dev, ms);
+	return QDEV_RES_OK;
+}
+
+void qSim_qcpu_device::dev_qreg_device_copy(QDEV_ST_VAL_TYPE* d_dst, int dst_dev, QDEV_ST_VAL_TYPE* d_src, int src_dev,
+											QDEV_ST_INDEX_TYPE N) {
+	// copy enqueued on the selected stream - no synchronisation
+	cudaMemcpyPeerAsync(d_dst, dst_dev, d_src, src_dev, N*sizeof(QDEV_ST_VAL_TYPE), m_cur_stream->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaMemcpyPeerAsync");
+}
+
 // ---------------------------------------------------------
 // instructions execution - qureg transformations
 // ---------------------------------------------------------
 
 // => 1-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 														 QASM_F_TYPE ftype, int frep, int flsq,
 														 QREG_F_ARGS_TYPE* fargs, bool verbose) {
 	// handle 1-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying 1-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - frep: %d - flsq: %d - fargs size: %lu\n",
-				d_N, ftype, frep, flsq, fargs->size());
+		printf("d_N: %lld - ftype: %d - frep: %d - flsq: %d - fargs size: %lu\n",
+				(long long)d_N, ftype, frep, flsq, fargs->size());
 	}
 
 	// convert fargs to CUDA device pointer array
@@ -281,57 +856,19 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x,
 		printf("dev_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!\n");
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
+	QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (fn*frep + flsq);
+	QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << flsq;
 	if (verbose) {
-		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %lld  block_inner_gap_size: %lld\n",
+				tot_f, (long long)max_block_size, (long long)block_inner_gap_size);
 	}
 
-	// store function type vectors into CUDA device memory objects for use in kernels
-	dev_vec_host2device((void**)&d_ftype_cuda_vec, m_ftype_vec, tot_f, sizeof(QASM_F_TYPE));
-	dev_vec_host2device((void**)&d_fsize_cuda_vec, m_fsize_vec, tot_f, sizeof(int));
-	if (verbose)
-		printf("ftype & fsize prepared...\n");
-
-	// convert function args vector to CUDA memory objects
-	dev_args_host2device(&d_fargs_cuda_vec, m_fargs_vec, tot_f);
-	if (verbose) {
-		printf("fargs prepared...\n");
-//		for (int jj=0; jj<tot_f; jj++) {
-//			printf("#%d - d_fargs_cuda: (%d %f)\n", jj, d_fargs_cuda_vec[jj].argc, d_fargs_cuda_vec[jj].argv);
-//		}
-	}
-
-	// perform kernel function on N elements
-	int nblocks = (d_N+THREADS_PER_BLOCK-1)/THREADS_PER_BLOCK;
-	int nthreads = MIN(d_N, THREADS_PER_BLOCK);
-	if (verbose)
-		printf("nblocks: %d  nthreads: %d\n\n", nblocks, nthreads);
-
-#ifdef __CUDA_DYNPAR__
-	// dynamic parallelism mode
-	if (verbose)
-		printf("calling kernel...DP\n\n");
-	kernel_prod_fxi_dp<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-			                                  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, 0, 0, 0, QASM_F_TYPE_NULL, 0, // form n.a. here
-											  d_y_real, d_y_img);
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_dp");
-
-#else
-	// single kernel mode
-	if (verbose)
-		printf("calling kernel...SK\n\n");
-	kernel_prod_fxi_sk<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-											  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, 0, 0, 0, QASM_F_TYPE_NULL, 0); // form n.a. here
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_sk");
-
-#endif
-
-	// wait for all kernel instances to complete
-	cudaDeviceSynchronize();
+	// perform kernel function on N elements - on selected gate family
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_group f_run = {d_x, d_y, d_N, flsq, fn, frep, m_cur_stream->m_stream, verbose};
+	if (f_dev_select_gate(ftype, fn, QASM_F_FORM_NULL, 0, QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL,
+						  &dev_fargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
 
 	if (verbose)
 		printf("qreg_apply_function done\n");
@@ -342,14 +879,14 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x,
 // --------------------------------
 
 // => 2-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 														 QASM_F_TYPE ftype, int frep, int flsq, int fform, int futype,
 														 QREG_F_ARGS_TYPE* fuargs, bool verbose) {
 	// handle 2-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying 2-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fargs size: %lu\n",
-				d_N, ftype, frep, flsq, fform, futype, fuargs->size());
+		printf("d_N: %lld - ftype: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fargs size: %lu\n",
+				(long long)d_N, ftype, frep, flsq, fform, futype, fuargs->size());
 	}
 
 	// convert fargs to CUDA device pointer array
@@ -367,57 +904,18 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x,
 		printf("dev_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!");
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
+	QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (fn*frep + flsq);
+	QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << flsq;
 	if (verbose) {
-		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %lld  block_inner_gap_size: %lld\n",
+				tot_f, (long long)max_block_size, (long long)block_inner_gap_size);
 	}
 
-	// store function type vectors into CUDA device memory objects for use in kernels
-	dev_vec_host2device((void**)&d_ftype_cuda_vec, m_ftype_vec, tot_f, sizeof(QASM_F_TYPE));
-	dev_vec_host2device((void**)&d_fsize_cuda_vec, m_fsize_vec, tot_f, sizeof(int));
-	if (verbose)
-		printf("ftype & fsize prepared...\n");
-
-	// convert function args vector to CUDA memory objects
-	dev_args_host2device(&d_fargs_cuda_vec, m_fargs_vec, tot_f);
-	if (verbose) {
-		printf("fargs prepared...\n");
-		// for (int jj=0; jj<tot_f; jj++) {
-			// printf("#%d - d_fargs_cuda: (%d %f)\n", jj, d_fargs_cuda_vec[jj].argc, d_fargs_cuda_vec[jj].argv);
-		// }
-	}
-
-	// perform kernel function on N elements
-	int nblocks = (d_N+THREADS_PER_BLOCK-1)/THREADS_PER_BLOCK;
-	int nthreads = MIN(d_N, THREADS_PER_BLOCK);
-	if (verbose)
-		printf("nblocks: %d  nthreads: %d\n\n", nblocks, nthreads);
-
-#ifdef __CUDA_DYNPAR__
-	// dynamic parallelism mode
-	if (verbose)
-		printf("calling kernel...DP\n\n");
-	kernel_prod_fxi_dp<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-			                                  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, fform, 0, futype, 1, fuform,
-											  d_y_real, d_y_img);
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_dp");
-
-#else
-	// single kernel mode
-	if (verbose)
-		printf("calling kernel...SK\n\n");
-	kernel_prod_fxi_sk<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-											  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, fform, 0, futype, 1, fuform);
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_sk");
-
-#endif
-
-	// wait for all kernel instances to complete
-	cudaDeviceSynchronize();
+	// perform kernel function on N elements - on selected gate family
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_group f_run = {d_x, d_y, d_N, flsq, fn, frep, m_cur_stream->m_stream, verbose};
+	if (f_dev_select_gate(ftype, fn, fform, 0, futype, 1, fuform, &dev_fuargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
 
 	if (verbose)
 		printf("qreg_apply_function done\n");
@@ -428,15 +926,15 @@ int qSim_qcpu_device::dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x,
 // --------------------------------
 
 // => n-qubit gate functions
-int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 																	 QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform,
 																	 int fgapn, int futype, int fun, int fuform,
 																	 QREG_F_ARGS_TYPE* fuargs, bool verbose) {
 	// handle 2-qubit gate application to given qureg data
 	if (verbose) {
 		printf("applying n-qubit gate function...\n");
-		printf("d_N: %d - ftype: %d - fsize: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fargs size: %lu\n",
-				d_N, ftype, fsize, frep, flsq, fform, futype, fuargs->size());
+		printf("d_N: %lld - ftype: %d - fsize: %d - frep: %d - flsq: %d - fform: %d - futype: %d - fargs size: %lu\n",
+				(long long)d_N, ftype, fsize, frep, flsq, fform, futype, fuargs->size());
 	}
 
 	// convert fargs to CUDA pointer array
@@ -450,57 +948,256 @@ int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL
 		printf("dev_qreg_apply_function_gate_1qubit: 0 functions returned by gap filling - error!!");
 		return QDEV_RES_ERROR; // return error
 	}
-	int max_block_size = powf(2, fn*frep + flsq);
-	int block_inner_gap_size = powf(2, flsq);
+	QDEV_ST_INDEX_TYPE max_block_size = (QDEV_ST_INDEX_TYPE)1 << (fn*frep + flsq);
+	QDEV_ST_INDEX_TYPE block_inner_gap_size = (QDEV_ST_INDEX_TYPE)1 << flsq;
 	if (verbose) {
-		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %d  block_inner_gap_size: %d\n",
-				tot_f, max_block_size, block_inner_gap_size);
+		printf("dev_qreg_apply_function_gate_1qubit: gap filling tot_f: %d  max_block_size: %lld  block_inner_gap_size: %lld\n",
+				tot_f, (long long)max_block_size, (long long)block_inner_gap_size);
 	}
 
-	// store function type vectors into CUDA device memory objects for use in kernels
-	dev_vec_host2device((void**)&d_ftype_cuda_vec, m_ftype_vec, tot_f, sizeof(QASM_F_TYPE));
-	dev_vec_host2device((void**)&d_fsize_cuda_vec, m_fsize_vec, tot_f, sizeof(int));
+	// perform kernel function on N elements - on selected gate family
+	QDEV_F_PARAMS_TYPE fparams;
+	qSim_qcpu_device_f_run_group f_run = {d_x, d_y, d_N, flsq, fn, frep, m_cur_stream->m_stream, verbose};
+	if (f_dev_select_gate(ftype, fn, fform, fgapn, futype, fun, fuform, &dev_fargs, &fparams, f_run) != QDEV_RES_OK)
+		return QDEV_RES_ERROR; // return error
+
 	if (verbose)
-		printf("ftype & fsize prepared...\n");
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// --------------------------------
 
-	// convert function args vector to CUDA memory objects
-	dev_args_host2device(&d_fargs_cuda_vec, m_fargs_vec, tot_f);
+// => dense k-qubit unitary functions
+int qSim_qcpu_device::dev_qreg_apply_function_dense(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+													int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose) {
+	// handle dense unitary application to given qureg data
 	if (verbose) {
-		printf("fargs prepared...\n");
-		// for (int jj=0; jj<tot_f; jj++) {
-			// printf("#%d - d_fargs_cuda: (%d %f)\n", jj, d_fargs_cuda_vec[jj].argc, d_fargs_cuda_vec[jj].argv);
-		// }
+		printf("applying dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d\n", (long long)d_N, flsq, fn);
 	}
 
-	// perform kernel function on N elements
-	int nblocks = (d_N+THREADS_PER_BLOCK-1)/THREADS_PER_BLOCK;
-	int nthreads = MIN(d_N, THREADS_PER_BLOCK);
+	// check function limits w.r.t overall qureg size
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > qn)) {
+		printf("dev_qreg_apply_function_dense: wrong function limits [fn: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// store matrix into stream CUDA device memory object for use in kernel - copy
+	// enqueued on the stream, so no previous kernel is still reading it
+	dev_vec_host2device((void**)&m_cur_stream->d_fmtx, f_mtx, 1 << 2*fn, sizeof(QDEV_ST_VAL_TYPE));
+
+	// perform kernel function on N/2^fn groups - group engine with matrix elements
+	qSim_qcpu_device_f_elem_mtx f_elem = {m_cur_stream->d_fmtx, 1 << fn};
+	f_dev_launch_group(d_x, d_y, d_N, flsq, fn, f_elem, m_cur_stream->m_stream, verbose);
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// => batched dense k-qubit unitary functions
+int qSim_qcpu_device::dev_qreg_apply_function_dense_batch(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y,
+														  QDEV_ST_INDEX_TYPE d_N, int flsq, int fn,
+														  QDEV_ST_VAL_TYPE* f_mtx, int sqn, bool verbose) {
+	// handle batched dense unitaries application to given qureg data - samples of 2^sqn
+	// consecutive states, each one with its own matrix
+	if (verbose) {
+		printf("applying batched dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d - sqn: %d\n", (long long)d_N, flsq, fn, sqn);
+	}
+
+	// check function limits w.r.t sample and overall qureg size
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > sqn) || (sqn > qn)) {
+		printf("dev_qreg_apply_function_dense_batch: wrong function limits [fn: %d  flsq: %d  sqn: %d] for qureg size %d - error!!\n",
+				fn, flsq, sqn, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// store matrices into stream CUDA device memory object - grown on demand (stream
+	// synchronised on release, so no previous kernel is still reading it)
+	size_t m_n = (d_N >> sqn) << 2*fn;
+	if (m_cur_stream->m_fbmtx_n < m_n) {
+		if (m_cur_stream->d_fbmtx != NULL) {
+			cudaStreamSynchronize(m_cur_stream->m_stream);
+			f_dev_pool_free(m_cur_stream->d_fbmtx);
+		}
+		m_cur_stream->d_fbmtx = (QDEV_ST_VAL_TYPE*)f_dev_pool_alloc(m_n*sizeof(QDEV_ST_VAL_TYPE));
+		m_cur_stream->m_fbmtx_n = m_n;
+	}
+	dev_vec_host2device((void**)&m_cur_stream->d_fbmtx, f_mtx, m_n, sizeof(QDEV_ST_VAL_TYPE));
+
+	// perform kernel function on N/2^fn groups in a single launch - group engine with
+	// matrix elements selected by group sample
+	qSim_qcpu_device_f_elem_mtx_batch f_elem = {m_cur_stream->d_fbmtx, 1 << fn, sqn - fn};
+	f_dev_launch_group(d_x, d_y, d_N, flsq, fn, f_elem, m_cur_stream->m_stream, verbose);
+
 	if (verbose)
-		printf("nblocks: %d  nthreads: %d\n\n", nblocks, nthreads);
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
 
-#ifdef __CUDA_DYNPAR__
-	// dynamic parallelism mode
+// --------------------------------
+
+// => fast path gate functions (1-qubit diagonal and permutation gates, controlled gates)
+int qSim_qcpu_device::dev_qreg_apply_function_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+												   QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform,
+												   int fgapn, int futype, int fun, int fuform,
+												   QREG_F_ARGS_TYPE* fargs, bool verbose) {
+	// classify gate and, for diagonal, permutation or controlled ones, apply it directly on
+	// d_x states (no output state vector) - any other gate left to the generic functions
+	QDEV_F_ARGS_TYPE dev_fargs = qSim_qcpu_device::fargs_to_dev_ptr_array(*fargs);
+	int fn = log2(fsize); // function size in qubits
+	if (ftype == QASM_F_TYPE_Q3_CCX)
+		fn = 3;
+
+	// check function limits w.r.t overall qureg size
+	int qn = log2((double)d_N);
+	if ((frep < 1) || (flsq < 0) || (flsq+fn*frep > qn)) {
+		printf("cuda_qreg_apply_function_fast: wrong function limits [fn: %d  frep: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, frep, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	if (!QASM_F_TYPE_IS_GATE_1QUBIT(ftype)) {
+		// controlled gates - bitmask engine applied on each repetition block
+		QDEV_ST_INDEX_TYPE c_mask;
+		int tn;
+		int t_idx[QDEV_F_UMTX_MAX_QUBITS];
+		QDEV_ST_VAL_TYPE u_mtx[1 << 2*QDEV_F_UMTX_MAX_QUBITS];
+		int ret = f_dev_ctrl_select_gate(ftype, fn, flsq, fform, fgapn, futype, fun, fuform,
+										 &dev_fargs, &c_mask, &tn, t_idx, u_mtx);
+		if (ret != QDEV_RES_OK)
+			return ret;
+		for (int r=0; r<frep; r++) {
+			int t_idx_r[QDEV_F_UMTX_MAX_QUBITS];
+			for (int b=0; b<tn; b++)
+				t_idx_r[b] = t_idx[b] + r*fn;
+			ret = dev_qreg_apply_function_controlled(d_x, d_N, c_mask << (r*fn), tn, t_idx_r, u_mtx, verbose);
+			if (ret != QDEV_RES_OK)
+				return ret;
+		}
+		return QDEV_RES_OK;
+	}
+
+	QDEV_F_FAST_PARAMS_TYPE fparams;
+	int kind = f_dev_fast_select_gate(ftype, frep, flsq, &dev_fargs, &fparams);
+	if (kind == QDEV_F_FAST_NONE)
+		return QDEV_RES_NOT_APPLIED;
+	if (verbose) {
+		printf("applying fast path gate function...\n");
+		printf("d_N: %lld - ftype: %d - kind: %d - frep: %d - flsq: %d\n",
+				(long long)d_N, ftype, kind, frep, flsq);
+	}
+	if (kind == QDEV_F_FAST_IDENT)
+		return QDEV_RES_OK;
+
+	// perform kernel function on N elements - parameters passed by value
+	int nthreads = (kind == QDEV_F_FAST_DIAG) ? f_dev_launch_threads(kernel_fast_diag, d_N)
+											  : f_dev_launch_threads(kernel_fast_perm, d_N);
+	QDEV_ST_INDEX_TYPE nblocks = (d_N+nthreads-1)/nthreads;
 	if (verbose)
-		printf("calling kernel...DP\n\n");
-	kernel_prod_fxi_dp<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-			                                  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, fform, fgapn, futype, fun, fuform,
-											  d_y_real, d_y_img);
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_dp");
+		printf("nblocks: %lld  nthreads: %d\n\n", (long long)nblocks, nthreads);
+	if (kind == QDEV_F_FAST_DIAG) {
+		if (verbose)
+			printf("calling kernel...FD\n\n");
+		kernel_fast_diag<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, d_N, fparams);
+		qSim_qcpu_device::checkCUDAError("kernel_fast_diag");
+	}
+	else {
+		if (verbose)
+			printf("calling kernel...FP\n\n");
+		kernel_fast_perm<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, d_N, fparams);
+		qSim_qcpu_device::checkCUDAError("kernel_fast_perm");
+	}
 
-#else
-	// single kernel mode
 	if (verbose)
-		printf("calling kernel...SK\n\n");
-	kernel_prod_fxi_sk<<<nblocks, nthreads>>>(d_x, d_y, d_N, d_ftype_cuda_vec, d_fsize_cuda_vec,
-											  d_fargs_cuda_vec, tot_f, max_block_size, block_inner_gap_size,
-											  ftype, fn, fform, fgapn, futype, fun, fuform);
-	qSim_qcpu_device::checkCUDAError("kernel_prod_fxi_sk");
+		printf("qreg_apply_function done\n");
 
-#endif
+	return QDEV_RES_OK;
+}
 
-	// wait for all kernel instances to complete
-	cudaDeviceSynchronize();
+// => controlled gate functions resolution (bitmask engine on any qubits layout)
+int qSim_qcpu_device::dev_qreg_function_controls(QREG_F_TYPE ftype, int fsize, int flsq, int fform, int fgapn,
+												 int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs,
+												 QDEV_ST_INDEX_TYPE* c_mask, int* tn, int* t_idx,
+												 QDEV_ST_VAL_TYPE* u_mtx) {
+	// resolve control mask, target qubits and U-gate matrix of a single function repetition
+	// at flsq - no device states accessed
+	if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype))
+		return QDEV_RES_NOT_APPLIED;
+	QDEV_F_ARGS_TYPE dev_fargs = qSim_qcpu_device::fargs_to_dev_ptr_array(*fargs);
+	return f_dev_ctrl_select_gate(ftype, log2(fsize), flsq, fform, fgapn, futype, fun, fuform,
+								  &dev_fargs, c_mask, tn, t_idx, u_mtx);
+}
+
+// => fast path dense k-qubit unitary functions (fused gates)
+int qSim_qcpu_device::dev_qreg_apply_function_dense_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+														 int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose) {
+	// classify unitary and, for a single non-zero element per row, apply it directly on d_x
+	// states (no output state vector) - any other unitary left to the generic dense function
+	int qn = log2((double)d_N);
+	if ((fn < 1) || (fn > QDEV_F_DENSE_MAX_QUBITS) || (flsq < 0) || (flsq+fn > qn)) {
+		printf("cuda_qreg_apply_function_dense_fast: wrong function limits [fn: %d  flsq: %d] for qureg size %d - error!!\n",
+				fn, flsq, qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	QDEV_F_FAST_MTX_PARAMS_TYPE fparams;
+	if (f_dev_fast_select_mtx(flsq, fn, f_mtx, &fparams) == QDEV_F_FAST_NONE)
+		return QDEV_RES_NOT_APPLIED;
+
+	// perform kernel function on N/2^fn groups - parameters passed by value
+	QDEV_ST_INDEX_TYPE tot_g = d_N >> fn;
+	int nthreads = f_dev_launch_threads(kernel_fast_mtx, tot_g);
+	QDEV_ST_INDEX_TYPE nblocks = (tot_g+nthreads-1)/nthreads;
+	if (verbose) {
+		printf("applying fast path dense unitary function...\n");
+		printf("d_N: %lld - flsq: %d - fn: %d\n", (long long)d_N, flsq, fn);
+		printf("nblocks: %lld  nthreads: %d\n\n", (long long)nblocks, nthreads);
+		printf("calling kernel...FM\n\n");
+	}
+	kernel_fast_mtx<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, tot_g, fparams);
+	qSim_qcpu_device::checkCUDAError("kernel_fast_mtx");
+
+	if (verbose)
+		printf("qreg_apply_function done\n");
+
+	return QDEV_RES_OK;
+}
+
+// => controlled gate functions (bitmask engine)
+int qSim_qcpu_device::dev_qreg_apply_function_controlled(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+														 QDEV_ST_INDEX_TYPE c_mask, int tn, const int* t_idx,
+														 const QDEV_ST_VAL_TYPE* u_mtx, bool verbose) {
+	// apply U-gate on target qubits directly on d_x states (no output state vector), visiting
+	// only the state groups having all control bits set
+	int qn = log2((double)d_N);
+	QDEV_F_CTRL_PARAMS_TYPE fparams;
+	if (f_dev_ctrl_set_params(qn, c_mask, tn, t_idx, u_mtx, &fparams) != QDEV_RES_OK) {
+		printf("cuda_qreg_apply_function_controlled: wrong function controls/targets for qureg size %d - error!!\n", qn);
+		return QDEV_RES_ERROR; // return error
+	}
+
+	// perform kernel function on N/2^(controls+targets) groups - parameters passed by value
+	QDEV_ST_INDEX_TYPE tot_g = d_N >> fparams.fix_n;
+	int nthreads = f_dev_launch_threads(kernel_fast_ctrl, tot_g);
+	QDEV_ST_INDEX_TYPE nblocks = (tot_g+nthreads-1)/nthreads;
+	if (verbose) {
+		printf("applying controlled gate function...\n");
+		printf("d_N: %lld - c_mask: %llx - tn: %d - t_idx[0]: %d - groups: %lld - mono: %d\n",
+				(long long)d_N, (long long)c_mask, tn, t_idx[0], (long long)tot_g, fparams.p_mono);
+		printf("nblocks: %lld  nthreads: %d\n\n", (long long)nblocks, nthreads);
+		printf("calling kernel...FC\n\n");
+	}
+	kernel_fast_ctrl<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, tot_g, fparams);
+	qSim_qcpu_device::checkCUDAError("kernel_fast_ctrl");
 
 	if (verbose)
 		printf("qreg_apply_function done\n");
@@ -514,8 +1211,8 @@ int qSim_qcpu_device::dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL
 
 // => qureg state setup - kernel function
 __global__
-void kernel_set_state(QDEV_ST_VAL_TYPE *x, int N, int st_val) {
-	int idx = blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+void kernel_set_state(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE st_val) {
+	QDEV_ST_INDEX_TYPE idx = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
 //	printf("N: %d  idx: %d\n", rN, idx);
 	if (idx < N)
 		if (idx != st_val)
@@ -527,67 +1224,376 @@ void kernel_set_state(QDEV_ST_VAL_TYPE *x, int N, int st_val) {
 // --------------------------------
 
 // => qureg state value set
-void qSim_qcpu_device::dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, int N, int st_val, bool verbose) {
+void qSim_qcpu_device::dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE st_val, bool verbose) {
 	// perform kernel function on N elements
-	int nblocks = (N+THREADS_PER_BLOCK-1)/THREADS_PER_BLOCK;
-	int nthreads = MIN(N, THREADS_PER_BLOCK);
+	int nthreads = f_dev_launch_threads(kernel_set_state, N);
+	QDEV_ST_INDEX_TYPE nblocks = (N+nthreads-1)/nthreads;
 	if (verbose) {
-		printf("CUDA - qreg_set_state...st_val: %d\n", st_val);
-		printf("nblocks: %d  nthreads: %d\n\n", nblocks, nthreads);
+		printf("CUDA - qreg_set_state...st_val: %lld\n", (long long)st_val);
+		printf("nblocks: %lld  nthreads: %d\n\n", (long long)nblocks, nthreads);
 	}
 
 	// call CUDA kernel functions
-	kernel_set_state<<<nblocks, nthreads>>>(d_x, N, st_val);
+	kernel_set_state<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, N, st_val);
 	qSim_qcpu_device::checkCUDAError("kernel_set_state");
+}
 
-	// wait for all kernel instances to complete
-	cudaDeviceSynchronize();
+// ---------------------------------------------------------
+// instructions execution - qureg state reductions
+// ---------------------------------------------------------
+
+// observable weights by number of set observable bits (64-bit indexes)
+__constant__ double c_exp_w_vec[65];
+
+// => marginal probabilities, few sub-states - grid-stride sweep with bins accumulated
+//    in block shared memory, one partial bins vector per block
+__global__
+void kernel_marginals_shared(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, int q_idx, QDEV_ST_INDEX_TYPE q_stn,
+							 double* part_vec) {
+	extern __shared__ double s_bins[];
+	for (QDEV_ST_INDEX_TYPE j=threadIdx.x; j<q_stn; j+=blockDim.x)
+		s_bins[j] = 0.0;
+	__syncthreads();
+
+	QDEV_ST_INDEX_TYPE q_mask = q_stn - 1;
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)gridDim.x * blockDim.x;
+	for (QDEV_ST_INDEX_TYPE idx=(QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; idx<N; idx+=stride) {
+		QDEV_ST_VAL_TYPE v = x[idx];
+		atomicAdd(&s_bins[(idx >> q_idx) & q_mask], v.x*v.x + v.y*v.y);
+	}
+	__syncthreads();
+
+	for (QDEV_ST_INDEX_TYPE j=threadIdx.x; j<q_stn; j+=blockDim.x)
+		part_vec[blockIdx.x*q_stn + j] = s_bins[j];
+}
+
+// => marginal probabilities, many sub-states - one thread per sub-state collecting
+//    its own states (i.e. all values of the qubits outside the sub-qureg)
+__global__
+void kernel_marginals_direct(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, int q_idx, int q_len, double* pr_vec) {
+	QDEV_ST_INDEX_TYPE j = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	QDEV_ST_INDEX_TYPE q_stn = (QDEV_ST_INDEX_TYPE)1 << q_len;
+	if (j < q_stn) {
+		QDEV_ST_INDEX_TYPE r_stn = N >> q_len;
+		QDEV_ST_INDEX_TYPE lo_mask = ((QDEV_ST_INDEX_TYPE)1 << q_idx) - 1;
+		double pr = 0.0;
+		for (QDEV_ST_INDEX_TYPE r=0; r<r_stn; r++) {
+			QDEV_ST_VAL_TYPE v = x[(r & lo_mask) | (j << q_idx) | ((r & ~lo_mask) << q_len)];
+			pr += v.x*v.x + v.y*v.y;
+		}
+		pr_vec[j] = pr;
+	}
+}
+
+// => expectation - grid-stride sweep with block tree reduction, one partial per block
+__global__
+void kernel_expectation(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, QDEV_ST_INDEX_TYPE sel_mask,
+						QDEV_ST_INDEX_TYPE sel_val, QDEV_ST_INDEX_TYPE obs_mask, double* part_vec) {
+	__shared__ double s_ex[QDEV_REDUCE_THREADS];
+	double ex = 0.0;
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)gridDim.x * blockDim.x;
+	for (QDEV_ST_INDEX_TYPE idx=(QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; idx<N; idx+=stride) {
+		if ((idx & sel_mask) == sel_val) {
+			QDEV_ST_VAL_TYPE v = x[idx];
+			ex += c_exp_w_vec[__popcll(idx & obs_mask)]*(v.x*v.x + v.y*v.y);
+		}
+	}
+	s_ex[threadIdx.x] = ex;
+	__syncthreads();
+
+	for (int s=blockDim.x/2; s>0; s>>=1) {
+		if (threadIdx.x < s)
+			s_ex[threadIdx.x] += s_ex[threadIdx.x + s];
+		__syncthreads();
+	}
+	if (threadIdx.x == 0)
+		part_vec[blockIdx.x] = s_ex[0];
+}
+
+// => top-k - grid-stride sweep with a sorted candidates list per thread, block top-k
+//    selected in k rounds of block max reduction on the threads list heads (lower index
+//    first on ties), one candidates list per block
+__global__
+void kernel_topk(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, int k, QDEV_ST_INDEX_TYPE* part_idx, double* part_pr) {
+	__shared__ double s_pr[QDEV_REDUCE_THREADS];
+	__shared__ QDEV_ST_INDEX_TYPE s_idx[QDEV_REDUCE_THREADS];
+	__shared__ int s_thr[QDEV_REDUCE_THREADS];
+	double t_pr[QDEV_TOPK_MAX];
+	QDEV_ST_INDEX_TYPE t_idx[QDEV_TOPK_MAX];
+	for (int j=0; j<k; j++) {
+		t_pr[j] = -1.0;
+		t_idx[j] = -1;
+	}
+
+	QDEV_ST_INDEX_TYPE stride = (QDEV_ST_INDEX_TYPE)gridDim.x * blockDim.x;
+	for (QDEV_ST_INDEX_TYPE idx=(QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; idx<N; idx+=stride) {
+		QDEV_ST_VAL_TYPE v = x[idx];
+		double pr = (double)v.x*v.x + (double)v.y*v.y;
+		if (pr > t_pr[k-1]) {
+			int j = k-1;
+			for (; (j > 0) && (t_pr[j-1] < pr); j--) {
+				t_pr[j] = t_pr[j-1];
+				t_idx[j] = t_idx[j-1];
+			}
+			t_pr[j] = pr;
+			t_idx[j] = idx;
+		}
+	}
+
+	int head = 0;
+	for (int r=0; r<k; r++) {
+		s_pr[threadIdx.x] = (head < k) ? t_pr[head] : -1.0;
+		s_idx[threadIdx.x] = (head < k) ? t_idx[head] : -1;
+		s_thr[threadIdx.x] = threadIdx.x;
+		__syncthreads();
+
+		for (int s=blockDim.x/2; s>0; s>>=1) {
+			if (threadIdx.x < s) {
+				int o = threadIdx.x + s;
+				if ((s_pr[o] > s_pr[threadIdx.x]) ||
+					((s_pr[o] == s_pr[threadIdx.x]) && (s_idx[o] >= 0) && (s_idx[o] < s_idx[threadIdx.x]))) {
+					s_pr[threadIdx.x] = s_pr[o];
+					s_idx[threadIdx.x] = s_idx[o];
+					s_thr[threadIdx.x] = s_thr[o];
+				}
+			}
+			__syncthreads();
+		}
+
+		if (threadIdx.x == 0) {
+			part_pr[blockIdx.x*k + r] = s_pr[0];
+			part_idx[blockIdx.x*k + r] = s_idx[0];
+		}
+		if (threadIdx.x == s_thr[0])
+			head++;
+		__syncthreads();
+	}
+}
+
+// => measure collapse - measured sub-states renormalised, all others reset
+__global__
+void kernel_collapse(QDEV_ST_VAL_TYPE *x, QDEV_ST_INDEX_TYPE N, int q_idx, QDEV_ST_INDEX_TYPE q_mask,
+					 QDEV_ST_INDEX_TYPE st_val, double st_norm) {
+	QDEV_ST_INDEX_TYPE idx = (QDEV_ST_INDEX_TYPE)blockIdx.x * blockDim.x + threadIdx.x; // 1D vector: only x-dimension used
+	if (idx < N) {
+		if (((idx >> q_idx) & q_mask) == st_val)
+			x[idx] = QDEV_ST_MAKE_VAL(x[idx].x/st_norm, x[idx].y/st_norm);
+		else
+			x[idx] = QDEV_ST_MAKE_VAL(0.0, 0.0);
+	}
+}
+
+// --------------------------------
+
+int qSim_qcpu_device::dev_qreg_marginals(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int q_idx, int q_len,
+										 double* pr_vec, bool verbose) {
+	// single pass on the state vector - device-side reduction, only sub-state
+	// probabilities (or per-block partials) copied to host
+	QDEV_ST_INDEX_TYPE q_stn = (QDEV_ST_INDEX_TYPE)1 << q_len;
+	if (verbose)
+		printf("CUDA - qreg_marginals...q_idx: %d  q_len: %d\n", q_idx, q_len);
+
+	if (q_stn <= QDEV_MARGINAL_MAX_SHARED_BINS) {
+		// few sub-states - shared memory bins, partials summed up on host in block order
+		QDEV_ST_INDEX_TYPE nblocks = MIN((N+QDEV_REDUCE_THREADS-1)/QDEV_REDUCE_THREADS, QDEV_REDUCE_BLOCKS);
+		kernel_marginals_shared<<<nblocks, QDEV_REDUCE_THREADS, q_stn*sizeof(double), m_cur_stream->m_stream>>>(
+				d_x, N, q_idx, q_stn, m_cur_stream->d_red);
+		qSim_qcpu_device::checkCUDAError("kernel_marginals_shared");
+
+		// results needed - stream synchronised after partials copy
+		std::vector<double> part_vec(nblocks*q_stn);
+		cudaMemcpyAsync(part_vec.data(), m_cur_stream->d_red, nblocks*q_stn*sizeof(double), cudaMemcpyDeviceToHost,
+						m_cur_stream->m_stream);
+		cudaStreamSynchronize(m_cur_stream->m_stream);
+		qSim_qcpu_device::checkCUDAError("cudaMemcpyAsync");
+		for (QDEV_ST_INDEX_TYPE j=0; j<q_stn; j++) {
+			double pr = 0.0;
+			for (QDEV_ST_INDEX_TYPE b=0; b<nblocks; b++)
+				pr += part_vec[b*q_stn+j];
+			pr_vec[j] = pr;
+		}
+	}
+	else {
+		// many sub-states - one thread per sub-state, results vector copied to host
+		double* d_pr_vec;
+		d_pr_vec = (double*)f_dev_pool_alloc(q_stn*sizeof(double));
+
+		int nthreads = f_dev_launch_threads(kernel_marginals_direct, q_stn);
+		QDEV_ST_INDEX_TYPE nblocks = (q_stn+nthreads-1)/nthreads;
+		kernel_marginals_direct<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, N, q_idx, q_len, d_pr_vec);
+		qSim_qcpu_device::checkCUDAError("kernel_marginals_direct");
+
+		cudaMemcpyAsync(pr_vec, d_pr_vec, q_stn*sizeof(double), cudaMemcpyDeviceToHost, m_cur_stream->m_stream);
+		cudaStreamSynchronize(m_cur_stream->m_stream);
+		qSim_qcpu_device::checkCUDAError("cudaMemcpyAsync");
+		f_dev_pool_free(d_pr_vec);
+	}
+	return QDEV_RES_OK;
+}
+
+int qSim_qcpu_device::dev_qreg_expectation(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N,
+										   QDEV_ST_INDEX_TYPE sel_mask, QDEV_ST_INDEX_TYPE sel_val, QDEV_ST_INDEX_TYPE obs_mask,
+										   double* w_vec, double* exp, bool verbose) {
+	// single pass on the state vector - device-side reduction, per-block partials
+	// summed up on host in block order
+	if (verbose)
+		printf("CUDA - qreg_expectation...sel_mask: %lld  sel_val: %lld  obs_mask: %lld\n",
+				(long long)sel_mask, (long long)sel_val, (long long)obs_mask);
+
+	// observable weights - one per number of set observable bits, copy enqueued on the
+	// stream (constant memory shared by all streams and device instances, held until the
+	// blocking call is done)
+	QDEV_ST_INDEX_TYPE nblocks = MIN((N+QDEV_REDUCE_THREADS-1)/QDEV_REDUCE_THREADS, QDEV_REDUCE_BLOCKS);
+	std::lock_guard<std::mutex> lock(s_dev_shared_mutex);
+	cudaMemcpyToSymbolAsync(c_exp_w_vec, w_vec, (__builtin_popcountll(obs_mask)+1)*sizeof(double), 0,
+							cudaMemcpyHostToDevice, m_cur_stream->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaMemcpyToSymbolAsync");
+
+	kernel_expectation<<<nblocks, QDEV_REDUCE_THREADS, 0, m_cur_stream->m_stream>>>(d_x, N, sel_mask, sel_val, obs_mask,
+																				   m_cur_stream->d_red);
+	qSim_qcpu_device::checkCUDAError("kernel_expectation");
+
+	// results needed - stream synchronised after partials copy
+	std::vector<double> part_vec(nblocks);
+	cudaMemcpyAsync(part_vec.data(), m_cur_stream->d_red, nblocks*sizeof(double), cudaMemcpyDeviceToHost,
+					m_cur_stream->m_stream);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaMemcpyAsync");
+	*exp = 0.0;
+	for (QDEV_ST_INDEX_TYPE b=0; b<nblocks; b++)
+		*exp += part_vec[b];
+	return QDEV_RES_OK;
+}
+
+int qSim_qcpu_device::dev_qreg_topk(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int k,
+									QDEV_ST_INDEX_TYPE* idx_vec, double* pr_vec, bool verbose) {
+	// single pass on the state vector - device-side selection, only the per-block
+	// candidates lists copied to host and merged in block order
+	if (verbose)
+		printf("CUDA - qreg_topk...k: %d\n", k);
+	if ((k <= 0) || (k > QDEV_TOPK_MAX) || (k > N))
+		return QDEV_RES_ERROR;
+
+	QDEV_ST_INDEX_TYPE nblocks = MIN((N+QDEV_REDUCE_THREADS-1)/QDEV_REDUCE_THREADS, QDEV_REDUCE_BLOCKS);
+	QDEV_ST_INDEX_TYPE* d_part_idx;
+	double* d_part_pr;
+	d_part_idx = (QDEV_ST_INDEX_TYPE*)f_dev_pool_alloc(nblocks*k*sizeof(QDEV_ST_INDEX_TYPE));
+	d_part_pr = (double*)f_dev_pool_alloc(nblocks*k*sizeof(double));
+
+	kernel_topk<<<nblocks, QDEV_REDUCE_THREADS, 0, m_cur_stream->m_stream>>>(d_x, N, k, d_part_idx, d_part_pr);
+	qSim_qcpu_device::checkCUDAError("kernel_topk");
+
+	// results needed - stream synchronised after candidates copy
+	std::vector<QDEV_ST_INDEX_TYPE> part_idx(nblocks*k);
+	std::vector<double> part_pr(nblocks*k);
+	cudaMemcpyAsync(part_idx.data(), d_part_idx, nblocks*k*sizeof(QDEV_ST_INDEX_TYPE), cudaMemcpyDeviceToHost,
+					m_cur_stream->m_stream);
+	cudaMemcpyAsync(part_pr.data(), d_part_pr, nblocks*k*sizeof(double), cudaMemcpyDeviceToHost,
+					m_cur_stream->m_stream);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	qSim_qcpu_device::checkCUDAError("cudaMemcpyAsync");
+	f_dev_pool_free(d_part_idx);
+	f_dev_pool_free(d_part_pr);
+
+	// block lists merge - each one sorted, unused items (negative probability) last
+	std::vector<int> b_head(nblocks, 0);
+	for (int j=0; j<k; j++) {
+		QDEV_ST_INDEX_TYPE b_max = -1;
+		for (QDEV_ST_INDEX_TYPE b=0; b<nblocks; b++) {
+			if (b_head[b] >= k)
+				continue;
+			QDEV_ST_INDEX_TYPE i_b = b*k + b_head[b];
+			if ((b_max < 0) || (part_pr[i_b] > pr_vec[j]) ||
+				((part_pr[i_b] == pr_vec[j]) && (part_idx[i_b] < idx_vec[j]))) {
+				b_max = b;
+				pr_vec[j] = part_pr[i_b];
+				idx_vec[j] = part_idx[i_b];
+			}
+		}
+		b_head[b_max]++;
+	}
+	return QDEV_RES_OK;
+}
+
+void qSim_qcpu_device::dev_qreg_collapse(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE N, int q_idx, int q_len,
+										 QDEV_ST_INDEX_TYPE st_val, double st_pr, bool verbose) {
+	// perform kernel function on N elements
+	int nthreads = f_dev_launch_threads(kernel_collapse, N);
+	QDEV_ST_INDEX_TYPE nblocks = (N+nthreads-1)/nthreads;
+	if (verbose)
+		printf("CUDA - qreg_collapse...st_val: %lld  st_pr: %g\n", (long long)st_val, st_pr);
+
+	kernel_collapse<<<nblocks, nthreads, 0, m_cur_stream->m_stream>>>(d_x, N, q_idx, ((QDEV_ST_INDEX_TYPE)1 << q_len) - 1, st_val, sqrt(st_pr));
+	qSim_qcpu_device::checkCUDAError("kernel_collapse");
 }
 
 // ---------------------------------------------------------
-// static helper host <--> device conversion methods
+// helper host <--> device conversion methods
 // ---------------------------------------------------------
 
-void qSim_qcpu_device::dev_qreg_host2device(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_VAL_TYPE* x, int N) {
-	// allocate and setup device memory with given host one
-	cudaMalloc((void**)d_x, N*sizeof(QDEV_ST_VAL_TYPE));
-	checkCUDAError("cudaMalloc");
-	cudaMemcpy((*d_x), x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyHostToDevice);
-	checkCUDAError("cudaMemcpy");
-//	cudaDeviceSynchronize();	-> not needed after a cudaMemcpy (it is synchronous)
+int qSim_qcpu_device::dev_qreg_device_alloc(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_INDEX_TYPE N) {
+	// allocate device memory from the device pool - no host data setup (states set on device),
+	// NULL on failure
+	*d_x = (QDEV_ST_VAL_TYPE*)f_dev_pool_alloc(N*sizeof(QDEV_ST_VAL_TYPE), true);
+	if (*d_x == NULL) {
+		printf("dev_qreg_device_alloc: device memory allocation failed - bytes: %zu - error!!\n",
+			   (size_t)N*sizeof(QDEV_ST_VAL_TYPE));
+		return QDEV_RES_ERROR;
+	}
+	return QDEV_RES_OK;
 }
 
-void qSim_qcpu_device::dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, int N) {
+void qSim_qcpu_device::dev_qreg_host2device(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE N) {
 	// allocate and setup device memory with given host one
-	cudaMemcpy(x, d_x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyDeviceToHost);
-	checkCUDAError("cudaMemcpy");
-//	cudaDeviceSynchronize();	-> not needed after a cudaMemcpy (it is synchronous)
+	if (dev_qreg_device_alloc(d_x, N) != QDEV_RES_OK)
+		return;
+	cudaMemcpyAsync((*d_x), x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyHostToDevice, m_cur_stream->m_stream);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	checkCUDAError("cudaMemcpyAsync");
 }
 
-void qSim_qcpu_device::dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, int N) {
-	// device memory alignment with given host one - no allocation
-	cudaMemcpy(d_x, x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyHostToDevice);
-	checkCUDAError("cudaMemcpy");
-//	cudaDeviceSynchronize();	-> not needed after a cudaMemcpy (it is synchronous)
+void qSim_qcpu_device::dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, QDEV_ST_INDEX_TYPE N) {
+	// results needed - copy enqueued after pending stream transformations, then synchronised
+	cudaMemcpyAsync(x, d_x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyDeviceToHost, m_cur_stream->m_stream);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	checkCUDAError("cudaMemcpyAsync");
 }
 
-void qSim_qcpu_device::dev_vec_host2device(void** d_x, void* x, int n, int size) {
-	// allocate and setup unified memory with given one
-	cudaMemcpy((*d_x), x, n*size, cudaMemcpyHostToDevice);
-	checkCUDAError("cudaMemcpy");
-//	cudaDeviceSynchronize();	-> not needed after a cudaMemcpy (it is synchronous)
+void qSim_qcpu_device::dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE N) {
+	// device memory alignment with given host one - no allocation, host states reusable
+	// once the stream is synchronised
+	cudaMemcpyAsync(d_x, x, N*sizeof(QDEV_ST_VAL_TYPE), cudaMemcpyHostToDevice, m_cur_stream->m_stream);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	checkCUDAError("cudaMemcpyAsync");
 }
 
-void qSim_qcpu_device::dev_args_host2device(QDEV_F_ARGS_TYPE** d_fargs, QDEV_F_ARGS_TYPE* fargs, int tot_f) {
-	// allocate and setup unified memory with given one - iterating over function arguments
-	cudaMemcpy((*d_fargs), fargs, tot_f*sizeof(QDEV_F_ARGS_TYPE), cudaMemcpyHostToDevice);
-	checkCUDAError("cudaMemcpy");
-//	cudaDeviceSynchronize();	-> not needed after a cudaMemcpy (it is synchronous)
+void qSim_qcpu_device::dev_vec_host2device(void** d_x, void* x, int n, int size) {
+	// setup device memory with given host one - copy enqueued on the stream, pageable host
+	// data staged by the runtime on call return (no stream synchronisation needed)
+	cudaMemcpyAsync((*d_x), x, n*size, cudaMemcpyHostToDevice, m_cur_stream->m_stream);
+	checkCUDAError("cudaMemcpyAsync");
 }
 
-// helper function for device memory release
+// helper function for device memory release - back to the device pool, reusable on other
+// streams once the selected stream pending work (possibly using it) is completed
 void qSim_qcpu_device::dev_qreg_device_release(QDEV_ST_VAL_TYPE* d_x) {
-	cudaFree(d_x);
+	cudaStreamSynchronize(m_cur_stream->m_stream);
+	checkCUDAError("cudaStreamSynchronize");
+	f_dev_pool_free(d_x);
+}
+
+void qSim_qcpu_device::dev_mem_pool_trim() {
+	// return cached buffers of all devices to the devices
+	int tot_dev = 0;
+	int cur_dev = 0;
+	cudaGetDeviceCount(&tot_dev);
+	cudaGetDevice(&cur_dev);
+	std::lock_guard<std::mutex> lock(s_dev_pool_mutex);
+	for (int i=0; i<tot_dev; i++) {
+		cudaSetDevice(i);
+		f_dev_pool_trim(i);
+	}
+	cudaSetDevice(cur_dev);
 	checkCUDAError("cudaFree");
 }
 
@@ -35,6 +35,38 @@
  *                   Transformed to class.
  *                   Defined and handled a function arguments structure.
  *                   Module renamed to qSim_qcup_device_GPU_CUDA.
+ *  1.2   Oct-2026   Handled 64-bit state indexes and function vectors sized on
+ *                   qureg allocation (no max qureg size limit).
+ *  1.3   Oct-2026   Handled device memory allocation with no host data and in-place
+ *                   support query (not supported).
+ *  1.4   Oct-2026   Handled dense k-qubit unitary functions (fused gates).
+ *  1.5   Oct-2026   Handled qureg state marginal probabilities, expectation and
+ *                   measure collapse as device kernels (no host states copy).
+ *  1.6   Oct-2026   Handled kernels templated on gate family, with no function
+ *                   CUDA vectors.
+ *  1.7   Oct-2026   Handled diagonal and permutation gates fast path (in-place).
+ *  1.8   Oct-2026   Handled controlled gates by bitmask engine (control mask and
+ *                   target qubits list).
+ *  1.9   Oct-2026   Removed dynamic parallelism mode (replaced by shared memory group
+ *                   engine).
+ *  1.10  Oct-2026   Handled per-qureg CUDA streams, with transformations enqueued
+ *                   asynchronously and stream synchronisation only on results access.
+ *  1.11  Oct-2026   Handled multi-GPU support - device selection, peer access and copies
+ *                   between device vectors (qureg shards exchanges).
+ *  1.12  Oct-2026   Handled single precision state values (__QSIM_SP__ compiling), with
+ *                   matching complex operations.
+ *  1.13  Oct-2026   Handled batched dense unitaries (one matrix per state vector sample).
+ *  1.14  Oct-2026   Handled qureg state top-k most probable states reduction.
+ *  1.15  Oct-2026   Handled device kernels statistics, timed by CUDA events on the selected
+ *                   stream and collected once completed.
+ *  1.16  Oct-2026   Handled device memory pool (allocations and releases reusing cached
+ *                   buffers) and devices warm-up at start-up.
+ *  1.17  Oct-2026   Handled device kernels statistics only if enabled, on recycled CUDA
+ *                   events pairs.
+ *  1.18  Oct-2026   Handled controlled gates resolution (control mask, targets and U-gate),
+ *                   for sharded quregs placing target qubits only.
+ *  1.19  Oct-2026   Handled devices warm-up as a static method (once per process), traced
+ *                   on verbose only.
  *
  *  --------------------------------------------------------------------------
  */
@@ -43,19 +75,64 @@
 #ifndef QSIM_QCPU_DEVICE_GPU_CUDA_H_
 #define QSIM_QCPU_DEVICE_GPU_CUDA_H_
 
+#include <deque>
+#include <map>
+#include <vector>
+
 #include "cuComplex.h"
 
 #include "qSim_qasm.h"
 #include "qSim_qinstruction_core.h"
+#include "qSim_qstats.h"
 
 
-// data type for a q-state value as complex
+// data type for a q-state value as complex - single precision (__QSIM_SP__ compiling) or double,
+// with matching complex operations
+#ifdef __QSIM_SP__
+typedef float QDEV_ST_REAL_TYPE;
+typedef cuFloatComplex QDEV_ST_VAL_TYPE;
+#define QDEV_ST_MAKE_VAL make_cuFloatComplex
+#define QDEV_ST_ADD cuCaddf
+#define QDEV_ST_MUL cuCmulf
+#define QDEV_ST_ABS cuCabsf
+#else
+typedef double QDEV_ST_REAL_TYPE;
 typedef cuDoubleComplex QDEV_ST_VAL_TYPE;
 #define QDEV_ST_MAKE_VAL make_cuDoubleComplex
+#define QDEV_ST_ADD cuCadd
+#define QDEV_ST_MUL cuCmul
+#define QDEV_ST_ABS cuCabs
+#endif
+
+// data type for a q-state index - 64-bit for qureg with more than 31 qubits
+typedef long long QDEV_ST_INDEX_TYPE;
+
+// max dense unitary width handled by kernels (fused gates)
+#define QDEV_F_DENSE_MAX_QUBITS 5
+
+// max U-gate width of controlled gates (bitmask engine)
+#define QDEV_F_CTRL_U_MAX_QUBITS 2
+
+// reductions grid size and max marginal sub-states accumulated in block shared
+// memory - above this size one thread per sub-state is used
+#define QDEV_REDUCE_BLOCKS 256
+#define QDEV_REDUCE_THREADS 256
+#define QDEV_MARGINAL_MAX_SHARED_BINS 1024
+
+// max most probable states selected by the top-k reduction (per-thread candidates list)
+#define QDEV_TOPK_MAX 64
 
 // return codes
 #define QDEV_RES_OK    0
 #define QDEV_RES_ERROR -1
+#define QDEV_RES_NOT_APPLIED 1 // no fast path for given function - generic functions to be used
+
+// data type for a device stream - per-qureg CUDA stream context (NULL for default stream)
+struct qSim_qcpu_device_stream_ctx;
+typedef qSim_qcpu_device_stream_ctx* QDEV_STREAM_TYPE;
+
+// device kernels statistics CUDA events pair
+struct qSim_qcpu_device_stats_ev;
 
 // data type for qreg state value and array
 typedef QDEV_ST_VAL_TYPE QREG_ST_RAW_VAL_TYPE; // same type as in the GPU
@@ -77,61 +154,144 @@ public:
 	qSim_qcpu_device();
 	~qSim_qcpu_device();
 
+	// in-place transformations support (same input and output state vector) - not handled by kernels
+	bool dev_qreg_inplace_supported() { return false; }
+
+	// qureg streams - transformations enqueued on the selected stream, with stream
+	// synchronisation only on results access (reductions and device->host copies)
+	int dev_qreg_stream_create(QDEV_STREAM_TYPE* d_s);
+	void dev_qreg_stream_release(QDEV_STREAM_TYPE d_s);
+	void dev_qreg_stream_select(QDEV_STREAM_TYPE d_s);
+	void dev_qreg_stream_sync();
+
+	// device kernels statistics - kernels enqueued between start and stop, by given key
+	void dev_qreg_stats_start();
+	void dev_qreg_stats_stop(int key);
+
+	// multi-GPU support - device selection for the following calls (allocations, streams
+	// and kernels), peer access among all devices and copies between device vectors, and
+	// devices warm-up (contexts and kernels loaded before the first request)
+	int dev_gpu_select(int dev_id);
+	int dev_gpu_peer_enable(int tot_dev);
+	static int dev_gpu_warmup(int tot_dev, bool verbose);
+	void dev_qreg_device_copy(QDEV_ST_VAL_TYPE* d_dst, int dst_dev, QDEV_ST_VAL_TYPE* d_src, int src_dev,
+							  QDEV_ST_INDEX_TYPE d_N);
+
 	// instructions execution
 
 	// - 1-qubit gate functions
-	int dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_gate_1qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 			                                 QREG_F_TYPE ftype, int frep, int flsq,
 											 QREG_F_ARGS_TYPE* fargs, bool verbose);
 
 	// - 2-qubit gate functions
-	int dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_gate_2qubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 											QREG_F_TYPE ftype, int frep, int flsq, int fform, int futype,
 											QREG_F_ARGS_TYPE* fuargs, bool verbose);
 
+	// - dense k-qubit unitary functions (fused gates) - row-major host matrix
+	int dev_qreg_apply_function_dense(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+									  int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose);
+
+	// - batched dense k-qubit unitary functions - samples of 2^sqn consecutive states, each
+	//   one with its own row-major host matrix (d_N/2^sqn consecutive matrices)
+	int dev_qreg_apply_function_dense_batch(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
+											int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, int sqn, bool verbose);
+
 	// - n-qubit gate functions
-	int dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, int d_N,
+	int dev_qreg_apply_function_controlled_gate_nqubit(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_VAL_TYPE*d_y, QDEV_ST_INDEX_TYPE d_N,
 													   QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
 													   int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs, bool verbose);
 
+	// - fast path gate functions - 1-qubit diagonal and permutation gates, controlled gates
+	//   (and 1-qubit swap blocks) applied on d_x states only, QDEV_RES_NOT_APPLIED returned
+	//   for any other gate
+	int dev_qreg_apply_function_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+									 QREG_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+									 int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs, bool verbose);
+	int dev_qreg_apply_function_dense_fast(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+										   int flsq, int fn, QDEV_ST_VAL_TYPE* f_mtx, bool verbose);
+
+	// - controlled gate functions (bitmask engine) - U-gate (tn qubits wide, row-major)
+	//   applied on t_idx target qubits of d_x states having all c_mask control bits set
+	int dev_qreg_apply_function_controlled(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+										   QDEV_ST_INDEX_TYPE c_mask, int tn, const int* t_idx,
+										   const QDEV_ST_VAL_TYPE* u_mtx, bool verbose);
+
+	// - controlled gate functions resolution - control mask, target qubits and U-gate matrix
+	//   (row-major host matrix) of a single function repetition at flsq, for applying it on the
+	//   bitmask engine on any qubits layout (host side only), QDEV_RES_NOT_APPLIED returned for
+	//   non-controlled functions
+	int dev_qreg_function_controls(QREG_F_TYPE ftype, int fsize, int flsq, int fform, int fgapn,
+								   int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs,
+								   QDEV_ST_INDEX_TYPE* c_mask, int* tn, int* t_idx, QDEV_ST_VAL_TYPE* u_mtx);
+
+	// function tables sizing - to be called for each allocated qureg
+	int dev_qreg_function_tables_reserve(int qn);
+
 	// qureg state value set
-	void dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, int d_N, int st_val, bool verbose);
+	void dev_qreg_set_state(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, QDEV_ST_INDEX_TYPE st_val, bool verbose);
+
+	// qureg state reductions - marginal probabilities of all sub-states of the given
+	// sub-qureg, and expectation on selected states (i.e. (idx & sel_mask) == sel_val)
+	// with weights indexed by the number of set observable bits (idx & obs_mask)
+	int dev_qreg_marginals(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int q_idx, int q_len,
+						   double* pr_vec, bool verbose);
+	int dev_qreg_expectation(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N,
+							 QDEV_ST_INDEX_TYPE sel_mask, QDEV_ST_INDEX_TYPE sel_val, QDEV_ST_INDEX_TYPE obs_mask,
+							 double* w_vec, double* exp, bool verbose);
+
+	// qureg state top-k - the k most probable states (k up to QDEV_TOPK_MAX), sorted by
+	// decreasing probability (lower index first on ties), with their probabilities
+	int dev_qreg_topk(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int k,
+					  QDEV_ST_INDEX_TYPE* idx_vec, double* pr_vec, bool verbose);
 
-	// static helper host <--> device conversion methods
-	static void dev_qreg_host2device(QDEV_ST_VAL_TYPE**, QDEV_ST_VAL_TYPE* x, int d_N);
-	static void dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, int d_N);
-	static void dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, int d_N);
-	static void dev_qreg_device_release(QDEV_ST_VAL_TYPE* d_x);
+	// qureg state collapse on measured sub-qureg value, with given probability
+	void dev_qreg_collapse(QDEV_ST_VAL_TYPE*d_x, QDEV_ST_INDEX_TYPE d_N, int q_idx, int q_len,
+						   QDEV_ST_INDEX_TYPE st_val, double st_pr, bool verbose);
+
+	// helper host <--> device conversion methods - copies on the selected stream, device
+	// memory on the device pool (released buffers cached for following allocations, to be
+	// trimmed to return them to the devices)
+	static int dev_qreg_device_alloc(QDEV_ST_VAL_TYPE** d_x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_host2device(QDEV_ST_VAL_TYPE**, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_device2host(QDEV_ST_VAL_TYPE* x, QDEV_ST_VAL_TYPE* d_x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_host2device_align(QDEV_ST_VAL_TYPE* d_x, QDEV_ST_VAL_TYPE* x, QDEV_ST_INDEX_TYPE d_N);
+	void dev_qreg_device_release(QDEV_ST_VAL_TYPE* d_x);
+	static void dev_mem_pool_trim();
 
 	static void checkCUDAError(const char* cmd_msg);
 
-	static void dev_vec_host2device(void** d_x, void* x, int n, int size);
-	static void dev_args_host2device(QDEV_F_ARGS_TYPE** d_fargs, QDEV_F_ARGS_TYPE* fargs, int tot_f);
+	void dev_vec_host2device(void** d_x, void* x, int n, int size);
 
 	// function args to CUDA device pointer array conversions
 	static QDEV_F_ARGS_TYPE fargs_to_dev_ptr_array(QREG_F_ARGS_TYPE fargs);
 
 	// CUDA device info diagnostics
-	int dev_get_gpu_cuda_count();
+	static int dev_get_gpu_cuda_count();
 	void dev_gpu_cuda_properties_dump();
 
 private:
 	// function type, size and arg host vectors
     // allocate function host vectors
 	QASM_F_TYPE* m_ftype_vec; 		// overall function type sequence to use
-	int* m_fsize_vec;			 	// overall function sizes, as per type sequence
+	QDEV_ST_INDEX_TYPE* m_fsize_vec; // overall function sizes, as per type sequence
 	QDEV_F_ARGS_TYPE* m_fargs_vec;	// overall function arguments, as per type sequence
+	int m_tot_f_max;				// function vectors allocated size
 
-	// function type, size and arg CUDA vectors
-	QASM_F_TYPE* d_ftype_cuda_vec;
-	int* d_fsize_cuda_vec;
-	QDEV_F_ARGS_TYPE* d_fargs_cuda_vec;
+	// default stream context (CUDA default stream) and selected one - each context
+	// holding its own dense unitary CUDA matrix (fused gates) and reductions per-block
+	// partial results CUDA vector, so that concurrent streams share no device buffer
+	QDEV_STREAM_TYPE m_def_stream;
+	QDEV_STREAM_TYPE m_cur_stream;
 
-#ifdef __CUDA_DYNPAR__
-	// DP specific CUDA vectors for transformation result accumulation
-	double* d_y_real;
-	double* d_y_img;
-#endif
+	// device kernels statistics - CUDA events pair being recorded and recorded ones, collected
+	// in recording order once completed (all of them if waiting), then recycled on the free
+	// events pairs of their device
+	qSim_qcpu_device_stats_ev* m_stats_cur;
+	std::deque<qSim_qcpu_device_stats_ev*> m_stats_evs;
+	std::map<int, std::vector<qSim_qcpu_device_stats_ev*> > m_stats_free;
+	void dev_qreg_stats_collect(bool wait);
 };
 
 #endif /* QSIM_QCPU_DEVICE_GPU_CUDA_H_ */
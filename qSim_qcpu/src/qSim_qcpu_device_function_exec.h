@@ -31,6 +31,12 @@
  *  1.1   Nov-2022   Instruction set limitation to 1 and 2 qubit gates.
  *                   Updated function arguments passage.
  *                   Module renamed to qSim_qcpu_GPU_CUDA_function_exec.
+ *  1.2   Oct-2026   Handled 64-bit state indexes and gap filler sizes, with identity
+ *                   gap fillers evaluated inline.
+ *  1.3   Oct-2026   Handled tensor-product execution templated on gate family, with
+ *                   LSQ/MSQ gap fillers resolved by the kernels index ranges, and gate
+ *                   family selection once per instruction (no function pointers).
+ *  1.4   Oct-2026   Used complex operations on selected state value precision.
  *
  *  --------------------------------------------------------------------------
  */
@@ -60,8 +66,8 @@
 // ----------------------------------------------
 
 // => function LSQ & MSQ gap filling
-int f_dev_gap_filling(int qsize, QASM_F_TYPE ftype, int fsize, int frep, int flsq, QDEV_F_ARGS_TYPE fargs,
-					  QASM_F_TYPE* ftype_vec, int* fsize_vec, QDEV_F_ARGS_TYPE* fargs_vec,
+int f_dev_gap_filling(QDEV_ST_INDEX_TYPE qsize, QASM_F_TYPE ftype, int fsize, int frep, int flsq, QDEV_F_ARGS_TYPE fargs,
+					  QASM_F_TYPE* ftype_vec, QDEV_ST_INDEX_TYPE* fsize_vec, QDEV_F_ARGS_TYPE* fargs_vec,
 					  bool verbose) {
 	// perform function aggregation for gap filling w.r.t overall qureg size
 	// => IN
@@ -77,21 +83,21 @@ int f_dev_gap_filling(int qsize, QASM_F_TYPE ftype, int fsize, int frep, int fls
 	// - fargs_vec: array of function arguments corresponding to function types
 
 	// calculate supporting qubits & states info
-	int qn = log2(qsize);
+	int qn = log2((double)qsize);
 	int fn = log2(fsize);
 	int fmsq = flsq + fn*frep - 1;
 	if (verbose)
-		printf("fvec... qsize: %d qn: %d fsize: %d fn: %d - frep: %d - flsq: %d - fmsq: %d\n",
-				qsize, qn, fsize, fn, frep, flsq, fmsq);
+		printf("fvec... qsize: %lld qn: %d fsize: %d fn: %d - frep: %d - flsq: %d - fmsq: %d\n",
+				(long long)qsize, qn, fsize, fn, frep, flsq, fmsq);
 
-	// make some sanity checks on params
-	if (powf(2, fmsq) > qsize) {
-		fprintf(stderr, "ERROR!! - f_dev_gap_filling - too many function repetitions - limit [%d] exceeded!!!\n", qsize);
+	// make some sanity checks on params - on qubit indexes, to avoid overflows
+	if (fmsq > qn-1) {
+		fprintf(stderr, "ERROR!! - f_dev_gap_filling - too many function repetitions - limit [%d] exceeded!!!\n", qn);
 		return 0;
 	}
 
-	if (fsize > qsize) {
-		fprintf(stderr, "ERROR!! - f_dev_gap_filling - function size [%d] cannot be larger than qureg one [%d]!!!\n", fsize, qsize);
+	if (fn > qn) {
+		fprintf(stderr, "ERROR!! - f_dev_gap_filling - function size [%d] cannot be larger than qureg one [%lld]!!!\n", fsize, (long long)qsize);
 		return 0;
 	}
 
@@ -101,7 +107,7 @@ int f_dev_gap_filling(int qsize, QASM_F_TYPE ftype, int fsize, int frep, int fls
 		// gap on MSQ part - add I (nxn) gate as filler
 //		printf("device - f_dev_gap_filling...adding I on MSQ part\n");
 		ftype_vec[tot_f] = QASM_F_TYPE_Q1_I;
-		fsize_vec[tot_f] = pow(2, (qn-fmsq-1));
+		fsize_vec[tot_f] = (QDEV_ST_INDEX_TYPE)1 << (qn-fmsq-1);
 		fargs_vec[tot_f++] = QDEV_F_ARGS_TYPE(); // no args for I gate
 	}
 	
@@ -117,7 +123,7 @@ int f_dev_gap_filling(int qsize, QASM_F_TYPE ftype, int fsize, int frep, int fls
 		// gap on LSQ part - add I (nxn) gate as filler
 //		printf("device - f_dev_gap_filling...adding I on LSQ part\n");
 		ftype_vec[tot_f] = QASM_F_TYPE_Q1_I;
-		fsize_vec[tot_f] = pow(2, flsq);
+		fsize_vec[tot_f] = (QDEV_ST_INDEX_TYPE)1 << flsq;
 		fargs_vec[tot_f++] = QDEV_F_ARGS_TYPE(); // no args for I gate
 	}
 
@@ -136,112 +142,201 @@ int f_dev_gap_filling(int qsize, QASM_F_TYPE ftype, int fsize, int frep, int fls
 
 // --------------------------------------------
 
-#define QDEV_F_VAL_EPS 1e-21
-
-// gap-filled function items combining as tensor-product - n-qubits
+// repeated gate family items combining as tensor-product - n-qubits
+template<class F_GATE>
 __device__
-QDEV_ST_VAL_TYPE f_dev_qn_exec(int i, int j, QASM_F_TYPE* ftype_dev_vec, int* fsize_dev_vec,
-						 	   int fn, int fform, int gapn, int futype, int fun, int fuform,
-							   QDEV_F_ARGS_TYPE* fargs_dev_vec, int tot_f) {
+inline QDEV_ST_VAL_TYPE f_dev_qn_exec(QDEV_ST_INDEX_TYPE i, QDEV_ST_INDEX_TYPE j, int fn, int frep,
+									  const QDEV_F_PARAMS_TYPE& fparams) {
 	// perform overall transformation function application to current state element (i, j)
-	// by iteration over all function elements to apply and handling function form (direct/inverse)
-	// and function class (general/controlled)
+	// by iteration over all function repetitions, starting from LSQ
 	//
 	// => IN
-	// - i, j: state element iteration indeces (i: state index, j: moving cursor for value-i calculation)
-	// - ftype_dev_vec: function types to apply - device vector
-	// - fsize_dev_vec: function sizes (tot states) - device vector
+	// - i, j: state element indeces within the function block (i.e. gap fillers excluded,
+	//         as identity ones are handled by the kernel index ranges)
 	// - fn: function width in qubits
-	// - fform: function form
-	// - gapn: gap width in qubits
-	// - futype: U-gate function type
-	// - fun: U-gate function width in qubits
-	// - fargs_cuda_vec: function args - device vector
-	// - tot_f: # of function elements to apply
+	// - frep: # of function repetitions
+	// - fparams: gate family parameters
 	//
 	// => OUT
 	// - f_val: state value at position i for j contribution
+	QDEV_ST_VAL_TYPE f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
+	QDEV_ST_INDEX_TYPE f_mask = ((QDEV_ST_INDEX_TYPE)1 << fn) - 1;
+	for (int r=0; r<frep; r++) {
+#ifdef __QSIM_CPU__
+		f_val *= F_GATE::val((int)(i & f_mask), (int)(j & f_mask), fparams);
+#else
+		f_val = QDEV_ST_MUL(f_val, F_GATE::val((int)(i & f_mask), (int)(j & f_mask), fparams));
+#endif
+		i >>= fn;
+		j >>= fn;
+	}
+	return f_val;
+}
 
-	// *** N-QUBIT GATE CASE ***
-	//	printf("f_cuda_qn_exec...\n");
-//	printf("f_dev_qn_exec...fn: %d  fform: %d  gapn: %d  futype: %d...\n", fn, fform, gapn, futype);
 
-	// setup result accumulator
-	QDEV_ST_VAL_TYPE f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
+// ############################################################
 
-	// setup working indexes to starting position
-	int ik = i;
-	int jk = j;
+// ----------------------------------------------
+// gate family selection - once per instruction
+// ----------------------------------------------
 
-	// loop through function elements
-	for (int k=0; k<tot_f; k++) {
-		// access elements from last i.e. starting from LSQ
-		int f_idx = tot_f - k - 1;
-		int fN_k = fsize_dev_vec[f_idx];
+// the selected gate family is handed to the given runner, as template argument of its
+// run method (i.e. f_run.template run<F_GATE>(fparams)), for kernels instantiation
 
-		if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype_dev_vec[f_idx])) {
-			// 1-qubit gate case
-//			printf("1-qubit case...f_idx: %d -> ftype: %d\n", f_idx, ftype_dev_vec[f_idx]);
+// => generic gate matrix runner - gate family evaluated into a row-major matrix
+struct qSim_qcpu_device_f_run_mtx {
+	QDEV_ST_VAL_TYPE* m_mtx;
+	int m_fsize;
 
-			// multiply for i-th function block value
-			FunctionCallback f_dev_k;
-			f_dev_k = QDEV_F_GATE_1Q_SELECTOR((QASM_F_TYPE)ftype_dev_vec[f_idx]);
-#ifdef __QSIM_CPU__
-			f_val *= f_dev_k(ik%fN_k, jk%fN_k, &(fargs_dev_vec[f_idx]));
-#else
-			f_val = cuCmul(f_val, f_dev_k(ik%fN_k, jk%fN_k, &(fargs_dev_vec[f_idx])));
-#endif
-		}
-		else if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype_dev_vec[f_idx])) {
-			// 2-qubit gate case
-//			printf("2-qubit case...f_idx: %d -> ftype: %d\n", f_idx, ftype_dev_vec[f_idx]);
+	template<class F_GATE>
+	int run(const QDEV_F_PARAMS_TYPE& fparams) const {
+		for (int i=0; i<m_fsize; i++)
+			for (int j=0; j<m_fsize; j++)
+				m_mtx[i*m_fsize+j] = F_GATE::val(i, j, fparams);
+		return QDEV_RES_OK;
+	}
+};
 
-			// multiply for i-th function block value
-			FunctionCallback_2q f_dev_k;
-			f_dev_k = QDEV_F_GATE_2Q_SELECTOR((QASM_F_TYPE)ftype_dev_vec[f_idx]);
-#ifdef __QSIM_CPU__
-			f_val *= f_dev_k(ik%fN_k, jk%fN_k, fform, futype, &(fargs_dev_vec[f_idx]));
-//			printf("f_val after 2q: %g  %g\n", f_val.real(), f_val.imag());
-#else
-			f_val = cuCmul(f_val, f_dev_k(ik%fN_k, jk%fN_k, fform, futype, &(fargs_dev_vec[f_idx])));
-#endif
-		}
-		else if (QASM_F_TYPE_IS_GATE_NQUBIT(ftype_dev_vec[f_idx])) {
-			// n-qubit gate case
-//			printf("n-qubit case...f_idx: %d -> ftype: %d\n", f_idx, ftype_dev_vec[f_idx]);
+// --------------------------------------------
 
-			// multiply for i-th function block value
-			FunctionCallback_nq f_dev_k;
-			f_dev_k = QDEV_F_GATE_NQ_SELECTOR((QASM_F_TYPE)ftype_dev_vec[f_idx]);
-#ifdef __QSIM_CPU__
-			f_val *= f_dev_k(ik%fN_k, jk%fN_k, fn, fform, gapn, futype, fun, fuform, &(fargs_dev_vec[f_idx]));
-//			printf("f_val after nq: %g  %g\n", f_val.real(), f_val.imag());
-#else
-			f_val = cuCmul(f_val, f_dev_k(ik%fN_k, jk%fN_k, fn, fform, gapn, futype, fun, fuform, &(fargs_dev_vec[f_idx])));
-#endif
-		}
+// => 1-qubit gates
+template<class F_RUN>
+int f_dev_select_gate_1qubit(QASM_F_TYPE ftype, QDEV_F_ARGS_TYPE* fargs, QDEV_F_PARAMS_TYPE* fparams,
+							 const F_RUN& f_run) {
+	switch (ftype) {
+	case QASM_F_TYPE_Q1_I:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_I> >(*fparams);
+	case QASM_F_TYPE_Q1_X:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_X> >(*fparams);
+	case QASM_F_TYPE_Q1_Y:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_Y> >(*fparams);
+	case QASM_F_TYPE_Q1_Z:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_Z> >(*fparams);
+	case QASM_F_TYPE_Q1_H:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_fixed<QASM_F_TYPE_Q1_H> >(*fparams);
+	case QASM_F_TYPE_Q1_SX:
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_fixed<QASM_F_TYPE_Q1_SX> >(*fparams);
+	case QASM_F_TYPE_Q1_PS:
+	case QASM_F_TYPE_Q1_S:
+	case QASM_F_TYPE_Q1_T:
+	case QASM_F_TYPE_Q1_Rz:
+		qSim_qcpu_device_f_gate_q1_phase::set_params(ftype, fargs, fparams);
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_phase>(*fparams);
+	case QASM_F_TYPE_Q1_Rx:
+	case QASM_F_TYPE_Q1_Ry:
+		qSim_qcpu_device_f_gate_q1_rotation::set_params(ftype, fargs, fparams);
+		return f_run.template run<qSim_qcpu_device_f_gate_q1_rotation>(*fparams);
+	default:
+		printf("!!!f_dev_select_gate_1qubit ERROR - device function type %d out of allowed range [%d, %d]!!!\n",
+				ftype, QASM_F_TYPE_Q1_I, QASM_F_TYPE_Q1_Rz);
+		return QDEV_RES_ERROR;
+	}
+}
 
-		// update working indexes by the size f the processed function
-		ik = ik / fN_k;
-		jk = jk / fN_k;
+// --------------------------------------------
 
-		// check for an early exit condition on zero value
-#ifdef __QSIM_CPU__
-		if (abs(f_val) < QDEV_F_VAL_EPS) // avoid to test vs. zero using floats!
-#else
-		if (cuCabs(f_val) < QDEV_F_VAL_EPS) // avoid to test vs. zero using floats!
-#endif
-			break;
+// => controlled gates - on function form
+template<template<int, class> class F_CTRL, class F_U, class F_RUN>
+int f_dev_select_gate_form(int fform, const QDEV_F_PARAMS_TYPE& fparams, const F_RUN& f_run) {
+	if (fform == QASM_F_FORM_DIRECT)
+		return f_run.template run<F_CTRL<QASM_F_FORM_DIRECT, F_U> >(fparams);
+	return f_run.template run<F_CTRL<QASM_F_FORM_INVERSE, F_U> >(fparams);
+}
+
+// => controlled gates - on U-gate type: Pauli U-gates inlined, others as precomputed
+//    U-gate matrix (fparams->fun qubits wide)
+template<template<int, class> class F_CTRL, class F_RUN>
+int f_dev_select_gate_controlled(int fform, int futype, int fuform, QDEV_F_ARGS_TYPE* fuargs,
+								 QDEV_F_PARAMS_TYPE* fparams, const F_RUN& f_run) {
+	if (futype == QASM_F_TYPE_Q1_X)
+		return f_dev_select_gate_form<F_CTRL, qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_X> >(fform, *fparams, f_run);
+	if (futype == QASM_F_TYPE_Q1_Y)
+		return f_dev_select_gate_form<F_CTRL, qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_Y> >(fform, *fparams, f_run);
+	if (futype == QASM_F_TYPE_Q1_Z)
+		return f_dev_select_gate_form<F_CTRL, qSim_qcpu_device_f_gate_q1_pauli<QASM_F_TYPE_Q1_Z> >(fform, *fparams, f_run);
+
+	// U-gate matrix evaluation
+	QDEV_F_PARAMS_TYPE u_params;
+	u_params.fun = 1;
+	u_params.ctrln = 1;
+	u_params.gapn = 0;
+	qSim_qcpu_device_f_run_mtx u_run = {fparams->u_mtx, 1 << fparams->fun};
+	int ret = QDEV_RES_ERROR;
+	if (QASM_F_TYPE_IS_GATE_1QUBIT(futype) && (fparams->fun == 1))
+		ret = f_dev_select_gate_1qubit((QASM_F_TYPE)futype, fuargs, &u_params, u_run);
+	else if (QASM_F_TYPE_IS_GATE_2QUBIT(futype) && (fparams->fun == 2)) {
+		// 2-qubit U-gate (n-qubit gates only) - generic CU as controlled identity
+		int fuutype = QASM_F_TYPE_Q1_I;
+		if (futype == QASM_F_TYPE_Q2_CX)
+			fuutype = QASM_F_TYPE_Q1_X;
+		else if (futype == QASM_F_TYPE_Q2_CY)
+			fuutype = QASM_F_TYPE_Q1_Y;
+		else if (futype == QASM_F_TYPE_Q2_CZ)
+			fuutype = QASM_F_TYPE_Q1_Z;
+		ret = f_dev_select_gate_controlled<qSim_qcpu_device_f_gate_q2_cu>(fuform, fuutype, 0, fuargs, &u_params, u_run);
 	}
+	else
+		printf("!!!f_dev_select_gate_controlled ERROR - unhandled U-gate function type %d for U-gate size %d!!!\n",
+				futype, fparams->fun);
+	if (ret != QDEV_RES_OK)
+		return ret;
+	return f_dev_select_gate_form<F_CTRL, qSim_qcpu_device_f_gate_mtx>(fform, *fparams, f_run);
+}
 
-#ifdef __QSIM_CPU__
-//	printf("f_dev_qn_exec...%d %d %d  -> %f %f\n", i, j, tot_f, f_val.real(), f_val.imag());
-#else
-//	printf("f_dev_qn_exec...%d %d %d  -> %f %f\n", i, j, tot_f, f_val.x, f_val.y);
-#endif
-    return f_val;
+// --------------------------------------------
+
+// => any gate - gate family parameters setup and selection
+template<class F_RUN>
+int f_dev_select_gate(QASM_F_TYPE ftype, int fn, int fform, int fgapn, int futype, int fun, int fuform,
+					  QDEV_F_ARGS_TYPE* fargs, QDEV_F_PARAMS_TYPE* fparams, const F_RUN& f_run) {
+	// => IN
+	// - ftype, fn, fform: function type, width in qubits and form
+	// - fgapn: gap width in qubits (n-qubit gates)
+	// - futype, fun, fuform: U-gate function type, width in qubits and form (controlled gates)
+	// - fargs: function arguments (U-gate ones for controlled gates)
+	// - f_run: gate family runner
+	// => OUT
+	// - fparams: gate family parameters, as passed to runner
+	fparams->fun = 1;
+	fparams->ctrln = 0;
+	fparams->gapn = 0;
+	if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype))
+		return f_dev_select_gate_1qubit(ftype, fargs, fparams, f_run);
+
+	if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype)) {
+		// CX, CY and CZ as controlled Pauli U-gates
+		fparams->ctrln = 1;
+		if (ftype == QASM_F_TYPE_Q2_CX)
+			futype = QASM_F_TYPE_Q1_X;
+		else if (ftype == QASM_F_TYPE_Q2_CY)
+			futype = QASM_F_TYPE_Q1_Y;
+		else if (ftype == QASM_F_TYPE_Q2_CZ)
+			futype = QASM_F_TYPE_Q1_Z;
+		return f_dev_select_gate_controlled<qSim_qcpu_device_f_gate_q2_cu>(fform, futype, 0, fargs, fparams, f_run);
+	}
+
+	if (QASM_F_TYPE_IS_GATE_NQUBIT(ftype)) {
+		if (ftype == QASM_F_TYPE_Q3_CCX) {
+			// Toffoli as 2-controls X U-gate
+			fn = 3;
+			fgapn = 0;
+			futype = QASM_F_TYPE_Q1_X;
+			fun = 1;
+		}
+		if ((fun < 1) || (fun > QDEV_F_UMTX_MAX_QUBITS) || (fgapn < 0) || (fn - fun - fgapn < 1)) {
+			printf("!!!f_dev_select_gate ERROR - inconsistent n-qubit gate [fn: %d  fun: %d  fgapn: %d]!!!\n",
+					fn, fun, fgapn);
+			return QDEV_RES_ERROR;
+		}
+		fparams->fun = fun;
+		fparams->gapn = fgapn;
+		fparams->ctrln = fn - fun - fgapn;
+		return f_dev_select_gate_controlled<qSim_qcpu_device_f_gate_qn_mcu>(fform, futype, fuform, fargs, fparams, f_run);
+	}
+
+	printf("!!!f_dev_select_gate ERROR - unhandled function type %d!!!\n", ftype);
+	return QDEV_RES_ERROR;
 }
 
 
 #endif /* QSIM_QCPU_DEVICE_FUNCTION_EXEC_H_ */
-
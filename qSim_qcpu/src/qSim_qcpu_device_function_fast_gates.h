@@ -0,0 +1,371 @@
+/*
+ * qSim_qcpu_device_function_fast_gates.h
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module implementing the fast path classification of device supported
+ * transformation functions, for in-place application with no tensor-product evaluation:
+ * - 1-qubit diagonal gates (Z, S, T, PS, Rz) as a phase multiply calculated from the
+ *   state index bits
+ * - 1-qubit permutation gates (X) as a state index bits swap
+ * - controlled gates (CU, CX, CY, CZ, MCSLRU, CCX, SWAP and CSWAP blocks) as a U-gate
+ *   applied on the given target qubits, for the states having all control bits set only
+ *   (bitmask engine)
+ * - dense unitaries (fused gates) with a single non-zero element per row, as a state
+ *   index table lookup and phase multiply
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *  1.1   Oct-2026   Handled controlled gates by bitmask engine - control mask and target
+ *                   qubits list, with arbitrary layouts.
+ *  1.2   Oct-2026   Used complex operations on selected state value precision.
+ *  1.3   Oct-2026   Checked controlled gates U-gate width against the device interface limit.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#ifndef QSIM_QCPU_DEVICE_FUNCTION_FAST_GATES_H_
+#define QSIM_QCPU_DEVICE_FUNCTION_FAST_GATES_H_
+
+#include <math.h>
+
+#ifdef __QSIM_CPU__
+#include "qSim_qcpu_device_CPU.h"
+#define __device__ /* dummy */
+#else
+#include "qSim_qcpu_device_GPU_CUDA.h"
+#endif
+
+#include "qSim_qcpu_device_function_exec.h"
+
+#if QDEV_F_UMTX_MAX_QUBITS > QDEV_F_CTRL_U_MAX_QUBITS
+#error "controlled gates U-gate width exceeds device controls resolution limit"
+#endif
+
+
+// ################################################################
+// fast path gate parameters - resolved once per instruction
+// ################################################################
+
+// fast path gate kinds
+#define QDEV_F_FAST_NONE  0 // generic gate - tensor-product kernels to be used
+#define QDEV_F_FAST_IDENT 1 // identity - nothing to apply
+#define QDEV_F_FAST_DIAG  2 // diagonal gate - phase multiply
+#define QDEV_F_FAST_PERM  3 // permutation gate - index bits swap
+
+// => 1-qubit gates
+struct qSim_qcpu_device_function_fast_params {
+	int kind;		// fast path gate kind
+	int frep;		// gate repetitions
+	int flsq;		// gate LSQ index
+	QDEV_ST_INDEX_TYPE f_mask;	// permutation gates - flipped bits (all repetitions)
+	QDEV_ST_VAL_TYPE d_val[2];	// diagonal gates - values for qubit at 0 and 1
+};
+typedef qSim_qcpu_device_function_fast_params QDEV_F_FAST_PARAMS_TYPE;
+
+// => dense unitaries (fused gates) - single non-zero element per row, i.e. diagonal or
+//    permutation matrix up to phases (row i takes state p_idx[i] times p_val[i])
+struct qSim_qcpu_device_function_fast_mtx_params {
+	int fn;		// unitary width in qubits
+	int flsq;	// unitary LSQ index
+	int p_idx[1 << QDEV_F_DENSE_MAX_QUBITS];				// non-zero element column
+	QDEV_ST_VAL_TYPE p_val[1 << QDEV_F_DENSE_MAX_QUBITS];	// non-zero element value
+};
+typedef qSim_qcpu_device_function_fast_mtx_params QDEV_F_FAST_MTX_PARAMS_TYPE;
+
+// => controlled gates (bitmask engine) - U-gate applied on the target qubits of each group
+//    of states sharing all other qubits, for the groups having all control bits set only
+//    (i.e. N/2^(controls + targets) groups)
+#define QDEV_F_CTRL_MAX_QUBITS 64
+
+struct qSim_qcpu_device_function_ctrl_params {
+	QDEV_ST_INDEX_TYPE c_mask;				// control bits - all set for the U-gate to apply
+	int tn;									// U-gate width (targets count)
+	int t_idx[QDEV_F_UMTX_MAX_QUBITS];		// target qubits - U-gate bits order, from LSB
+	int fix_n;								// controls and targets count
+	int fix_pos[QDEV_F_CTRL_MAX_QUBITS];	// controls and targets qubits - ascending order
+	QDEV_ST_INDEX_TYPE t_off[1 << QDEV_F_UMTX_MAX_QUBITS];	// group state offsets - U-gate index order
+	QDEV_ST_VAL_TYPE u_mtx[1 << 2*QDEV_F_UMTX_MAX_QUBITS];	// U-gate matrix (row-major)
+	int p_mono;								// U-gate with single non-zero element per row
+	int p_idx[1 << QDEV_F_UMTX_MAX_QUBITS];				// non-zero element column (p_mono case)
+	QDEV_ST_VAL_TYPE p_val[1 << QDEV_F_UMTX_MAX_QUBITS];	// non-zero element value (p_mono case)
+};
+typedef qSim_qcpu_device_function_ctrl_params QDEV_F_CTRL_PARAMS_TYPE;
+
+
+// ################################################################
+// fast path element functions
+// ################################################################
+
+// => 1-qubit diagonal gates - state index phase factor, combining all gate repetitions
+__device__
+inline QDEV_ST_VAL_TYPE f_dev_fast_diag_val(QDEV_ST_INDEX_TYPE idx, const QDEV_F_FAST_PARAMS_TYPE& fparams) {
+	QDEV_ST_VAL_TYPE f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
+	QDEV_ST_INDEX_TYPE b = idx >> fparams.flsq;
+	for (int r=0; r<fparams.frep; r++) {
+#ifdef __QSIM_CPU__
+		f_val *= fparams.d_val[b & 1];
+#else
+		f_val = QDEV_ST_MUL(f_val, fparams.d_val[b & 1]);
+#endif
+		b >>= 1;
+	}
+	return f_val;
+}
+
+// => controlled gates - g-th group first state index, inserting a zero bit on each target
+//    qubit and a set bit on each control qubit
+__device__
+inline QDEV_ST_INDEX_TYPE f_dev_ctrl_group_base(QDEV_ST_INDEX_TYPE g, const QDEV_F_CTRL_PARAMS_TYPE& fparams) {
+	QDEV_ST_INDEX_TYPE idx = g;
+	for (int k=0; k<fparams.fix_n; k++) {
+		int p = fparams.fix_pos[k];
+		idx = ((idx >> p) << (p+1)) | (idx & (((QDEV_ST_INDEX_TYPE)1 << p) - 1));
+	}
+	return idx | fparams.c_mask;
+}
+
+
+// ################################################################
+// fast path gate classification - once per instruction
+// ################################################################
+
+// => 1-qubit gates
+int f_dev_fast_select_gate(QASM_F_TYPE ftype, int frep, int flsq, QDEV_F_ARGS_TYPE* fargs,
+						   QDEV_F_FAST_PARAMS_TYPE* fparams) {
+	fparams->frep = frep;
+	fparams->flsq = flsq;
+	fparams->f_mask = (((QDEV_ST_INDEX_TYPE)1 << frep) - 1) << flsq;
+	switch (ftype) {
+	case QASM_F_TYPE_Q1_I:
+		fparams->kind = QDEV_F_FAST_IDENT;
+		break;
+	case QASM_F_TYPE_Q1_X:
+		fparams->kind = QDEV_F_FAST_PERM;
+		break;
+	case QASM_F_TYPE_Q1_Z:
+		fparams->kind = QDEV_F_FAST_DIAG;
+		fparams->d_val[0] = QDEV_ST_MAKE_VAL(1.0, 0.0);
+		fparams->d_val[1] = QDEV_ST_MAKE_VAL(-1.0, 0.0);
+		break;
+	case QASM_F_TYPE_Q1_PS:
+	case QASM_F_TYPE_Q1_S:
+	case QASM_F_TYPE_Q1_T:
+	case QASM_F_TYPE_Q1_Rz: {
+		// diagonal values from phase gates family matrix
+		QDEV_F_PARAMS_TYPE u_params;
+		qSim_qcpu_device_f_gate_q1_phase::set_params(ftype, fargs, &u_params);
+		fparams->kind = QDEV_F_FAST_DIAG;
+		fparams->d_val[0] = u_params.u_mtx[0];
+		fparams->d_val[1] = u_params.u_mtx[3];
+		break;
+	}
+	default:
+		fparams->kind = QDEV_F_FAST_NONE;
+	}
+	return fparams->kind;
+}
+
+// --------------------------------------------
+
+// => single non-zero element per row check on given row-major matrix (fn qubits wide),
+//    with non-zero elements columns and values
+bool f_dev_fast_mono_rows(int fn, const QDEV_ST_VAL_TYPE* f_mtx, int* p_idx, QDEV_ST_VAL_TYPE* p_val) {
+	int fsize = 1 << fn;
+	for (int i=0; i<fsize; i++) {
+		int nz = 0;
+		for (int j=0; j<fsize; j++) {
+#ifdef __QSIM_CPU__
+			bool is_nz = (abs(f_mtx[i*fsize+j]) >= QDEV_F_VAL_EPS);
+#else
+			bool is_nz = (QDEV_ST_ABS(f_mtx[i*fsize+j]) >= QDEV_F_VAL_EPS);
+#endif
+			if (is_nz) {
+				p_idx[i] = j;
+				p_val[i] = f_mtx[i*fsize+j];
+				nz++;
+			}
+		}
+		if (nz != 1)
+			return false;
+	}
+	return true;
+}
+
+// => dense unitary (fused gates) - fast path parameters setup from given row-major matrix,
+//    returning selected kind (permutation up to phases, or generic)
+int f_dev_fast_select_mtx(int flsq, int fn, const QDEV_ST_VAL_TYPE* f_mtx, QDEV_F_FAST_MTX_PARAMS_TYPE* fparams) {
+	fparams->fn = fn;
+	fparams->flsq = flsq;
+	if (!f_dev_fast_mono_rows(fn, f_mtx, fparams->p_idx, fparams->p_val))
+		return QDEV_F_FAST_NONE;
+	return QDEV_F_FAST_PERM;
+}
+
+// --------------------------------------------
+
+// => controlled gates - bitmask engine parameters setup from given control mask, target
+//    qubits (U-gate bits order) and U-gate row-major matrix
+int f_dev_ctrl_set_params(int qn, QDEV_ST_INDEX_TYPE c_mask, int tn, const int* t_idx, const QDEV_ST_VAL_TYPE* u_mtx,
+						  QDEV_F_CTRL_PARAMS_TYPE* fparams) {
+	if ((tn < 1) || (tn > QDEV_F_UMTX_MAX_QUBITS) || (c_mask < 0) || ((qn < 64) && (c_mask >> qn) != 0)) {
+		printf("!!!f_dev_ctrl_set_params ERROR - inconsistent controls/targets [tn: %d  c_mask: %llx]!!!\n",
+				tn, (long long)c_mask);
+		return QDEV_RES_ERROR;
+	}
+
+	// targets - out of controls, distinct and within qureg size
+	QDEV_ST_INDEX_TYPE fix_mask = c_mask;
+	fparams->c_mask = c_mask;
+	fparams->tn = tn;
+	for (int b=0; b<tn; b++) {
+		QDEV_ST_INDEX_TYPE t_bit = (QDEV_ST_INDEX_TYPE)1 << t_idx[b];
+		if ((t_idx[b] < 0) || (t_idx[b] >= qn) || (fix_mask & t_bit)) {
+			printf("!!!f_dev_ctrl_set_params ERROR - inconsistent target qubit %d!!!\n", t_idx[b]);
+			return QDEV_RES_ERROR;
+		}
+		fix_mask |= t_bit;
+		fparams->t_idx[b] = t_idx[b];
+	}
+
+	// controls and targets positions, ascending order
+	fparams->fix_n = 0;
+	for (int q=0; q<qn; q++) {
+		if ((fix_mask >> q) & 1)
+			fparams->fix_pos[fparams->fix_n++] = q;
+	}
+
+	// group state offsets and U-gate matrix
+	int usize = 1 << tn;
+	for (int u=0; u<usize; u++) {
+		fparams->t_off[u] = 0;
+		for (int b=0; b<tn; b++) {
+			if ((u >> b) & 1)
+				fparams->t_off[u] |= (QDEV_ST_INDEX_TYPE)1 << t_idx[b];
+		}
+	}
+	for (int k=0; k<usize*usize; k++)
+		fparams->u_mtx[k] = u_mtx[k];
+	fparams->p_mono = f_dev_fast_mono_rows(tn, u_mtx, fparams->p_idx, fparams->p_val);
+	return QDEV_RES_OK;
+}
+
+// => controlled gates - control mask, target qubits and U-gate matrix resolved from given
+//    function block (at given block LSQ), QDEV_RES_NOT_APPLIED returned for non-controlled ones
+int f_dev_ctrl_select_gate(QASM_F_TYPE ftype, int fn, int blsq, int fform, int fgapn,
+						   int futype, int fun, int fuform, QDEV_F_ARGS_TYPE* fargs,
+						   QDEV_ST_INDEX_TYPE* c_mask, int* tn, int* t_idx, QDEV_ST_VAL_TYPE* u_mtx) {
+	// => IN
+	// - ftype, fn, blsq: function type, width in qubits and block LSQ index
+	// - fform, fgapn: function form and gap width in qubits (n-qubit gates and c-swap)
+	// - futype, fun, fuform: U-gate function type, width in qubits and form (controlled gates)
+	// - fargs: U-gate function arguments
+	// => OUT
+	// - c_mask, tn, t_idx, u_mtx: control mask, targets count, target qubits and U-gate matrix
+	int ctrln;
+	if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype)) {
+		// CX, CY and CZ as controlled Pauli U-gates
+		if (ftype == QASM_F_TYPE_Q2_CX)
+			futype = QASM_F_TYPE_Q1_X;
+		else if (ftype == QASM_F_TYPE_Q2_CY)
+			futype = QASM_F_TYPE_Q1_Y;
+		else if (ftype == QASM_F_TYPE_Q2_CZ)
+			futype = QASM_F_TYPE_Q1_Z;
+		fun = 1;
+		fgapn = 0;
+		ctrln = 1;
+	}
+	else if (QASM_F_TYPE_IS_GATE_NQUBIT(ftype)) {
+		if (ftype == QASM_F_TYPE_Q3_CCX) {
+			// Toffoli as 2-controls X U-gate
+			fn = 3;
+			fgapn = 0;
+			futype = QASM_F_TYPE_Q1_X;
+			fun = 1;
+		}
+		ctrln = fn - fun - fgapn;
+		if ((fun < 1) || (fun > QDEV_F_UMTX_MAX_QUBITS) || (fgapn < 0) || (ctrln < 1))
+			return QDEV_RES_NOT_APPLIED;
+	}
+	else if ((ftype == QASM_FB_TYPE_Q1_SWAP) || (ftype == QASM_FB_TYPE_Q1_CSWAP)) {
+		// swap blocks - swapped qubit pair on LSQ (direct form) or MSQ (inverse form)
+		// of the block, with a single control qubit on the opposite side for c-swap
+		if (ftype == QASM_FB_TYPE_Q1_SWAP) {
+			if (fn != 2)
+				return QDEV_RES_NOT_APPLIED;
+			fform = QASM_F_FORM_DIRECT;
+			fgapn = 0;
+			ctrln = 0;
+		}
+		else {
+			if ((fn < 3) || (fn - fgapn != 3))
+				return QDEV_RES_NOT_APPLIED;
+			ctrln = 1;
+		}
+		fun = 2;
+		for (int i=0; i<4; i++)
+			for (int j=0; j<4; j++)
+				u_mtx[i*4+j] = QDEV_ST_MAKE_VAL((j == (((i & 1) << 1) | (i >> 1))) ? 1.0 : 0.0, 0.0);
+	}
+	else
+		return QDEV_RES_NOT_APPLIED;
+
+	// U-gate matrix evaluation on selected gate family (swap U-gate already set) - 2-qubit
+	// U-gate (n-qubit gates only) as CU gate, generic CU as controlled identity
+	QDEV_F_PARAMS_TYPE u_params;
+	u_params.fun = 1;
+	u_params.ctrln = 0;
+	u_params.gapn = 0;
+	qSim_qcpu_device_f_run_mtx u_run = {u_mtx, 1 << fun};
+	int ret = QDEV_RES_OK;
+	if (!QASM_F_TYPE_IS_FUNC_BLOCK(ftype)) {
+		if (QASM_F_TYPE_IS_GATE_1QUBIT(futype) && (fun == 1))
+			ret = f_dev_select_gate_1qubit((QASM_F_TYPE)futype, fargs, &u_params, u_run);
+		else if (QASM_F_TYPE_IS_GATE_2QUBIT(futype) && (fun == 2))
+			ret = f_dev_select_gate((QASM_F_TYPE)futype, 2, fuform, 0, QASM_F_TYPE_Q1_I, 1, QASM_F_FORM_NULL,
+									fargs, &u_params, u_run);
+		else
+			return QDEV_RES_NOT_APPLIED; // left to generic functions (error handling)
+	}
+	if (ret != QDEV_RES_OK)
+		return ret;
+
+	// place U-gate and controls within the function block
+	// => <direct> form - controls on MSQ, U-gate on LSQ
+	// => <inverse> form - U-gate on MSQ, controls on LSQ
+	int u_lsq = blsq;
+	int c_lsq = blsq + fun + fgapn;
+	if (fform != QASM_F_FORM_DIRECT) {
+		u_lsq = blsq + ctrln + fgapn;
+		c_lsq = blsq;
+	}
+	for (int b=0; b<fun; b++)
+		t_idx[b] = u_lsq + b;
+	*c_mask = (((QDEV_ST_INDEX_TYPE)1 << ctrln) - 1) << c_lsq;
+	*tn = fun;
+	return QDEV_RES_OK;
+}
+
+
+#endif /* QSIM_QCPU_DEVICE_FUNCTION_FAST_GATES_H_ */
@@ -23,6 +23,7 @@
  *
  * Q-CPU support module implementing device supported transformation functions:
  * - basic 1-qubit gates (I, X, H, Pauli, etc.)
+ * - generic small gate matrix (precomputed values)
  *
  *  Version History:
  *
@@ -32,6 +33,9 @@
  *  1.1   Nov-2022   Renamed to qSim_qcpu_device_function_gates_1qubit and
  *                   scope limited to 1-qubit gates.
  *                   Transformed to class and supported both GPU CUDA and CPU devices.
+ *  1.2   Oct-2026   Replaced per-gate functions and runtime function pointers selector
+ *                   with gate family templates (constant matrices inlined), with
+ *                   parametric gate matrices evaluated once per instruction.
  *
  *  --------------------------------------------------------------------------
  */
@@ -44,9 +48,11 @@
 
 #ifdef __QSIM_CPU__
 #include "qSim_qcpu_device_CPU.h"
+#define __host__ /* dummy */
 #ifdef __WIN32
 #define __device__ /* dummy */
 #define M_PI 2*acos(0.0) // !!!! not working directly from <cmat> in Windows!!!
+#define M_SQRT1_2 sqrt(0.5)
 #endif
 #else
 #include "qSim_qcpu_device_GPU_CUDA.h"
@@ -54,291 +60,129 @@
 
 
 // ################################################################
-// 1-qubit gates - handling functions and relevant static pointers
+// gate family parameters - resolved once per instruction
 // ################################################################
 
-class qSim_qcpu_device_function_gates_1qubit {
-public:
-	// constructor & destructor
-	qSim_qcpu_device_function_gates_1qubit();
-	~qSim_qcpu_device_function_gates_1qubit();
+// U-gate matrix max width in qubits (1-qubit gates and 2-qubit U-gates of n-qubit gates)
+#define QDEV_F_UMTX_MAX_QUBITS 2
 
-	// ----------------------------------------------
-	// transformation methods
-	// ----------------------------------------------
+// gate matrix elements below this value handled as zeroes (sparse rows)
+#define QDEV_F_VAL_EPS 1e-21
 
-	// => Q1 - identity function --> Note: working also for I (nxn) cases and then used for gap fillers !!!!
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_i(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (i==j)
-			f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-//		printf("f_dev_q1_i...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
-	}
-
-	// -------------------------------------
-
-	// => Q1 - Hadamard function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_h(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (j<1)
-			f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(powf(-1.0, i), 0.0);
-#ifdef __QSIM_CPU__
-		f_val /= QDEV_ST_MAKE_VAL(sqrtf(2.0), 0.0);
-//		printf("f_dev_q1_h...%d %d  -> %f %f\n", i, j, f_val.real(), f_val.imag());
-#else
-		f_val = cuCdiv(f_val, QDEV_ST_MAKE_VAL(sqrtf(2.0), 0.0));
-//		printf("f_dev_q1_h...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-#endif
-		return f_val;
-	}
-
-	// ------------------------------------
-
-	// => Q1 - X function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_x(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-	//	printf("f_dev_q1_x...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
-	}
-
-	// ------------------------------------
-
-	// => Q1 - Y function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_y(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, powf(-1.0, i+1));
-	//	printf("f_dev_q1_y...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
-	}
-
-	// ------------------------------------
-
-	// > Q1 - Z function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_z(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(powf(-1.0, i), 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-	//	printf("f_dev_q1_z...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
-	}
-
-	// ------------------------------------
-
-	// => Q1 - SX function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_sx(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		QDEV_ST_VAL_TYPE f_val;
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(1.0, 1.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(1.0, -1.0);
-#ifdef __QSIM_CPU__
-		f_val /= QDEV_ST_MAKE_VAL(2.0, 0.0);
-#else
-		f_val = cuCdiv(f_val, QDEV_ST_MAKE_VAL(2.0, 0.0));
-		//	printf("f_dev_q1_sx...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-#endif
-		return f_val;
-	}
-
-	// ------------------------------------
+struct qSim_qcpu_device_function_params {
+	QDEV_ST_VAL_TYPE u_mtx[1 << 2*QDEV_F_UMTX_MAX_QUBITS]; // U-gate matrix (row-major) - parametric gates
+	int fun;	// U-gate width in qubits
+	int ctrln;	// controls width in qubits
+	int gapn;	// gap width in qubits
+};
+typedef qSim_qcpu_device_function_params QDEV_F_PARAMS_TYPE;
 
-	// => Q1 - PS function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_ps(int i, int j, QDEV_F_ARGS_TYPE* f_args) {
-		// f_args[0] : phi
 
-		QDEV_ST_VAL_TYPE f_val;
-		double phi = 0.0;
-		if (f_args->argc > 0)
-			phi = f_args->argv;
-		else
-			printf("ERROR - f_dev_q1_ps - missing phi argument!! - 0.0 used");
-//		printf("f_dev_q1_ps - i: %d  j: %d  phi: %g\n", i, j, phi);
+// ################################################################
+// 1-qubit gates - gate family element functions
+// ################################################################
 
-		if (i == j)
-			if (i == 0)
-				f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-			else
-				f_val = QDEV_ST_MAKE_VAL(cos(phi), sin(phi));
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-//		printf("f_dev_q1_ps...%d %d %f -> %f %f\n", i, j, phi, f_val.x, f_val.y);
-		return f_val;
+// each family provides the (i, j) gate element as an inlined static function, with
+// constant gates resolved at compile time on the template function type
+
+// => Q1 - Pauli gates family (I, X, Y, Z)
+template<int FTYPE>
+struct qSim_qcpu_device_f_gate_q1_pauli {
+	__host__ __device__
+	static inline QDEV_ST_VAL_TYPE val(int i, int j, const QDEV_F_PARAMS_TYPE& /*fparams*/) {
+		if (FTYPE == QASM_F_TYPE_Q1_X)
+			return (i != j) ? QDEV_ST_MAKE_VAL(1.0, 0.0) : QDEV_ST_MAKE_VAL(0.0, 0.0);
+		if (FTYPE == QASM_F_TYPE_Q1_Y)
+			return (i != j) ? QDEV_ST_MAKE_VAL(0.0, (i == 0) ? -1.0 : 1.0) : QDEV_ST_MAKE_VAL(0.0, 0.0);
+		if (FTYPE == QASM_F_TYPE_Q1_Z)
+			return (i == j) ? QDEV_ST_MAKE_VAL((i == 0) ? 1.0 : -1.0, 0.0) : QDEV_ST_MAKE_VAL(0.0, 0.0);
+		return (i == j) ? QDEV_ST_MAKE_VAL(1.0, 0.0) : QDEV_ST_MAKE_VAL(0.0, 0.0); // identity
 	}
+};
 
-	// ------------------------------------
-
-	// => Q1 - S function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_s(int i, int j, QDEV_F_ARGS_TYPE* /*f_args*/) {
-		// apply Q1 PS function with PI/2 argument
-		QDEV_ST_VAL_TYPE f_val;
-		double phi = M_PI/2.0;
-//		printf("S...phi: %g\n", phi);
+// ------------------------------------
 
-		if (j==i)
-			if (i==0)
-				f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-			else
-				f_val = QDEV_ST_MAKE_VAL(cos(phi), sin(phi));
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-	//	printf("f_dev_q1_s...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
+// => Q1 - fixed gates family (H, SX)
+template<int FTYPE>
+struct qSim_qcpu_device_f_gate_q1_fixed {
+	__host__ __device__
+	static inline QDEV_ST_VAL_TYPE val(int i, int j, const QDEV_F_PARAMS_TYPE& /*fparams*/) {
+		if (FTYPE == QASM_F_TYPE_Q1_SX)
+			return (i == j) ? QDEV_ST_MAKE_VAL(0.5, 0.5) : QDEV_ST_MAKE_VAL(0.5, -0.5);
+		return QDEV_ST_MAKE_VAL((i & j) ? -M_SQRT1_2 : M_SQRT1_2, 0.0); // Hadamard
 	}
+};
 
-	// ------------------------------------
-
-	// => Q1 - T function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_t(int i, int j, QDEV_F_ARGS_TYPE* /*f_args[]*/) {
-		// apply Q1 PS function with PI/4 argument
-		QDEV_ST_VAL_TYPE f_val;
-		double phi = M_PI/4.0;
-	//	printf("S tot_args: %d   phi: %g\n", tot_args, phi);
+// ------------------------------------
 
-		if (j==i)
-			if (i==0)
-				f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-			else
-				f_val = QDEV_ST_MAKE_VAL(cos(phi), sin(phi));
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-	//	printf("f_dev_q1_s...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
+// => Q1 - phase gates family (PS, S, T, Rz) - diagonal values from precomputed matrix
+struct qSim_qcpu_device_f_gate_q1_phase {
+	__host__ __device__
+	static inline QDEV_ST_VAL_TYPE val(int i, int j, const QDEV_F_PARAMS_TYPE& fparams) {
+		return (i == j) ? fparams.u_mtx[3*i] : QDEV_ST_MAKE_VAL(0.0, 0.0);
 	}
 
-	// ------------------------------------
-
-	// => Q1 - Rx function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_rx(int i, int j, QDEV_F_ARGS_TYPE* f_args) {
-		// f_args[0] : phi
-
-		QDEV_ST_VAL_TYPE f_val;
+	// gate matrix calculation - once per instruction
+	static void set_params(QASM_F_TYPE ftype, QDEV_F_ARGS_TYPE* fargs, QDEV_F_PARAMS_TYPE* fparams) {
 		double phi = 0.0;
-		if (f_args->argc > 0)
-			phi = f_args->argv;
-		else
-			printf("ERROR - f_dev_q1_rx - missing phi argument!! - 0.0 used");
-
-		 //    printf("Rx tot_args: %d   phi: %g\n", tot_args, phi);
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(cos(phi/2), 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, -sin(phi/2));
-	//	printf("f_dev_q1_ps...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
+		if (ftype == QASM_F_TYPE_Q1_S)
+			phi = M_PI/2.0;
+		else if (ftype == QASM_F_TYPE_Q1_T)
+			phi = M_PI/4.0;
+		else if (fargs->argc > 0)
+			phi = fargs->argv;
+		else
+			printf("ERROR - f_gate_q1_phase - missing phi argument for function type %d!! - 0.0 used\n", ftype);
+
+		if (ftype == QASM_F_TYPE_Q1_Rz) {
+			fparams->u_mtx[0] = QDEV_ST_MAKE_VAL(cos(-phi/2.0), sin(-phi/2.0));
+			fparams->u_mtx[3] = QDEV_ST_MAKE_VAL(cos(phi/2.0), sin(phi/2.0));
+		}
+		else {
+			fparams->u_mtx[0] = QDEV_ST_MAKE_VAL(1.0, 0.0);
+			fparams->u_mtx[3] = QDEV_ST_MAKE_VAL(cos(phi), sin(phi));
+		}
+		fparams->u_mtx[1] = QDEV_ST_MAKE_VAL(0.0, 0.0);
+		fparams->u_mtx[2] = QDEV_ST_MAKE_VAL(0.0, 0.0);
 	}
+};
 
-	// ------------------------------------
-
-	// => Q1 - Ry function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_ry(int i, int j, QDEV_F_ARGS_TYPE* f_args) {
-		QDEV_ST_VAL_TYPE f_val;
-		double phi = 0.0;
-		if (f_args->argc > 0)
-			phi = f_args->argv;
-		else
-			printf("ERROR - f_dev_q1_ry - missing phi argument!! - 0.0 used");
+// ------------------------------------
 
- //    printf("Ry tot_args: %d   phi: %g\n", tot_args, phi);
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL(cos(phi/2), 0.0);
-		else
-			f_val = QDEV_ST_MAKE_VAL(powf(-1, i+1)*sin(phi/2), 0.0);
-	//	printf("f_dev_q1_ry...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
+// => generic gate family - element from precomputed matrix (fun qubits wide)
+struct qSim_qcpu_device_f_gate_mtx {
+	__host__ __device__
+	static inline QDEV_ST_VAL_TYPE val(int i, int j, const QDEV_F_PARAMS_TYPE& fparams) {
+		return fparams.u_mtx[(i << fparams.fun) + j];
 	}
+};
 
-	// ------------------------------------
+// ------------------------------------
 
-	// => Q1 - Rz function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q1_rz(int i, int j, QDEV_F_ARGS_TYPE* f_args) {
-		QDEV_ST_VAL_TYPE f_val;
+// => Q1 - rotation gates family (Rx, Ry) - as generic gate with precomputed matrix
+struct qSim_qcpu_device_f_gate_q1_rotation : public qSim_qcpu_device_f_gate_mtx {
+	// gate matrix calculation - once per instruction
+	static void set_params(QASM_F_TYPE ftype, QDEV_F_ARGS_TYPE* fargs, QDEV_F_PARAMS_TYPE* fparams) {
 		double phi = 0.0;
-		if (f_args->argc > 0)
-			phi = f_args->argv;
-		else
-			printf("ERROR - f_dev_q1_rz - missing phi argument!! - 0.0 used");
-
-		//	printf("Rz tot_args: %d   phi: %g\n", tot_args, phi);
-		if (j==i)
-			f_val = QDEV_ST_MAKE_VAL((double)cos(powf(-1.0, i+1)*phi/2.0), (double)sin(powf(-1.0, i+1)*phi/2.0));
-		else
-			f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-	//	printf("f_dev_q1_rz...%d %d  -> %f %f\n", i, j, f_val.x, f_val.y);
-		return f_val;
+		if (fargs->argc > 0)
+			phi = fargs->argv;
+		else
+			printf("ERROR - f_gate_q1_rotation - missing phi argument for function type %d!! - 0.0 used\n", ftype);
+
+		double c = cos(phi/2);
+		double s = sin(phi/2);
+		fparams->u_mtx[0] = QDEV_ST_MAKE_VAL(c, 0.0);
+		fparams->u_mtx[3] = QDEV_ST_MAKE_VAL(c, 0.0);
+		if (ftype == QASM_F_TYPE_Q1_Rx) {
+			fparams->u_mtx[1] = QDEV_ST_MAKE_VAL(0.0, -s);
+			fparams->u_mtx[2] = QDEV_ST_MAKE_VAL(0.0, -s);
+		}
+		else {
+			fparams->u_mtx[1] = QDEV_ST_MAKE_VAL(-s, 0.0);
+			fparams->u_mtx[2] = QDEV_ST_MAKE_VAL(s, 0.0);
+		}
 	}
-
 };
 
-// ################################################################
-// Function pointers definition
-// ################################################################
-
-// function type
-typedef QDEV_ST_VAL_TYPE (*FunctionCallback)(int, int, QDEV_F_ARGS_TYPE*);
-
-// ---------------------------------------------
-
-// Static array of pointers to functions - same order as for QASM function type values!!
-#define QASM_F_TYPE_GATE_1Q_TOT_ENTRIES 12
-
-__device__
-FunctionCallback pf_device_gates_1qubit_vec[] = {
-	// 1-qubit
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_i,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_h,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_x,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_y,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_z,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_sx,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_ps,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_t,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_s,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_rx,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_ry,
-	qSim_qcpu_device_function_gates_1qubit::f_dev_q1_rz
-};
-
-__device__
-FunctionCallback get_functionRefByFtype_gates_1qubit(QASM_F_TYPE ftype) {
-	if ((ftype < QASM_F_TYPE_Q1_I) || (ftype > QASM_F_TYPE_Q1_Rz)) {
-		printf("!!!get_functionRefByFtype_gates_1qubit ERROR - device function type %d out of allowed range [%d, %d]!!!\n",
-				ftype, QASM_F_TYPE_Q1_I, QASM_F_TYPE_Q1_Rz);
-		return NULL;
-	}
-	FunctionCallback f_ptr = pf_device_gates_1qubit_vec[ftype-QASM_F_TYPE_Q1_I];
-	if (f_ptr == NULL)
-		printf("!!!get_functionRefByFtype_gates_1qubit ERROR - device function type %d not defined in function pointer vector!!!", ftype);
-	return f_ptr;
-}
-
-#define QDEV_F_GATE_1Q_SELECTOR get_functionRefByFtype_gates_1qubit
-
 
 #endif /* QSIM_QCPU_DEVICE_FUNCTION_GATES_1QUBIT_H_ */
-
@@ -29,6 +29,8 @@
  *  Ver   Date       Change
  *  --------------------------------------------------------------------------
  *  1.0   Nov-2022   Module creation.
+ *  1.2   Oct-2026   Replaced per-gate functions and runtime function pointers selector
+ *                   with controlled-U gate family template on form and U-gate family.
  *
  *  --------------------------------------------------------------------------
  */
@@ -50,23 +52,15 @@
 
 
 // ################################################################
-// 2-qubit gates - handling functions and relevant static pointers
+// 2-qubit gates - gate family element functions
 // ################################################################
 
-class qSim_qcpu_device_function_gates_2qubit {
-public:
-	// constructor & destructor
-	qSim_qcpu_device_function_gates_2qubit();
-	~qSim_qcpu_device_function_gates_2qubit();
-
-	// ----------------------------------------------
-	// transformation methods
-	// ----------------------------------------------
-
-	// => Q2 - CU function (generic controlled-U function)
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q2_cu(int i, int j, int fform, int fu_type, QDEV_F_ARGS_TYPE* fu_args) {
-		// apply controlled form on given 1-qubit U-gate
+// => Q2 - CU gates family (generic controlled-U, CX, CY, CZ)
+template<int FFORM, class F_U>
+struct qSim_qcpu_device_f_gate_q2_cu {
+	__host__ __device__
+	static inline QDEV_ST_VAL_TYPE val(int i, int j, const QDEV_F_PARAMS_TYPE& fparams) {
+		// apply controlled form on given 1-qubit U-gate family
 		//
 		// => <direct> form
 		// - control: q1 / i0,j0 (MSQ)
@@ -75,118 +69,17 @@ public:
 		// => <inverse> form
 		// - U function: q1 / i0/j0 (MSQ)
 		// - control: q0 / i1,j1 (LSQ)
-
-		// calculate value based on given i,j indeces
-		QDEV_ST_VAL_TYPE f_val;
-		if (fform == QASM_F_FORM_DIRECT) {
-			// direct form
-			if ((i > 1) && (j > 1)) {
-				// apply gate
-				FunctionCallback fu_dev_k = QDEV_F_GATE_1Q_SELECTOR((QASM_F_TYPE)fu_type);
-				f_val = fu_dev_k(i%2, j%2, fu_args);
-			}
-			else if ((i == j) && (i < 2)) {
-				// printf("f_dev_q2_cu...direct...1.0...i: %d  j:%d \n", i, j);
-				f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-			}
-			else {
-				// printf("f_dev_q2_cu...direct...0.0...i: %d  j:%d \n", i, j);
-				f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
-			}
+		if (FFORM == QASM_F_FORM_DIRECT) {
+			if (i & j & 2)
+				return F_U::val(i & 1, j & 1, fparams);
 		}
 		else {
-			// inverse form
-			if ((i%2 == 1) && (j%2 == 1) && ((i == j) || (i == j+2) || (j == i+2))) {
-				// apply gate
-				FunctionCallback fu_dev_k = QDEV_F_GATE_1Q_SELECTOR((QASM_F_TYPE)fu_type);
-				f_val = fu_dev_k(i/2, j/2, fu_args);
-			}
-			else if ((i == j) && ((j == 0) || (j == 2)))
-				f_val = QDEV_ST_MAKE_VAL(1.0, 0.0);
-			else
-				f_val = QDEV_ST_MAKE_VAL(0.0, 0.0);
+			if (i & j & 1)
+				return F_U::val(i >> 1, j >> 1, fparams);
 		}
-		// return result
-		return f_val;
-	}
-
-	// -----------------------------------
-
-	// => Q2 - CX function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q2_cx(int i, int j, int fform, int, QDEV_F_ARGS_TYPE*) {
-		// apply controlled form on given 1-qubit X-gate
-		// calling controlled-U function
-		QDEV_ST_VAL_TYPE f_val = f_dev_q2_cu(i, j, fform, QASM_F_TYPE_Q1_X, NULL);
-
-		// return result
-		return f_val;
-	}
-
-	// -----------------------------------
-
-	// => Q2 - CY function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q2_cy(int i, int j, int fform, int, QDEV_F_ARGS_TYPE*) {
-		// apply controlled form on given 1-qubit Y-gate
-		// calling controlled-U function
-		QDEV_ST_VAL_TYPE f_val = f_dev_q2_cu(i, j, fform, QASM_F_TYPE_Q1_Y, NULL);
-
-		// return result
-		return f_val;
-	}
-
-	// -----------------------------------
-
-	// => Q2 - CZ function
-	__device__
-	static QDEV_ST_VAL_TYPE f_dev_q2_cz(int i, int j, int fform, int, QDEV_F_ARGS_TYPE*) {
-		// apply controlled form on given 1-qubit Z-gate
-		// calling controlled-U function
-		QDEV_ST_VAL_TYPE f_val = f_dev_q2_cu(i, j, fform, QASM_F_TYPE_Q1_Z, NULL);
-
-		// return result
-		return f_val;
+		return (i == j) ? QDEV_ST_MAKE_VAL(1.0, 0.0) : QDEV_ST_MAKE_VAL(0.0, 0.0);
 	}
-
-};
-
-// ################################################################
-// Function pointers definition
-// ################################################################
-
-// function type
-typedef QDEV_ST_VAL_TYPE (*FunctionCallback_2q)(int, int, int, int, QDEV_F_ARGS_TYPE*);
-
-// ---------------------------------------------
-
-// Static array of pointers to functions - same order as for QASM function type values!!
-#define QASM_F_TYPE_GATE_2Q_TOT_ENTRIES (QASM_F_TYPE_Q2_CZ - QASM_F_TYPE_Q2_CU + 1)
-
-__device__
-FunctionCallback_2q pf_device_gates_2qubit_vec[] = {
-	// 2-qubit
-		qSim_qcpu_device_function_gates_2qubit::f_dev_q2_cu,
-		qSim_qcpu_device_function_gates_2qubit::f_dev_q2_cx,
-		qSim_qcpu_device_function_gates_2qubit::f_dev_q2_cy,
-		qSim_qcpu_device_function_gates_2qubit::f_dev_q2_cz,
 };
 
-__device__
-FunctionCallback_2q get_functionRefByFtype_gates_2qubit(QASM_F_TYPE ftype) {
-	if ((ftype < QASM_F_TYPE_Q2_CU) | (ftype > QASM_F_TYPE_Q2_CZ)) {
-		printf("!!!get_functionRefByFtype_gates_2qubit ERROR - device function type %d out of allowed range [%d, %d]!!!\n",
-				ftype, QASM_F_TYPE_Q2_CU, QASM_F_TYPE_Q2_CZ);
-		return NULL;
-	}
-	FunctionCallback_2q f_ptr = pf_device_gates_2qubit_vec[ftype-QASM_F_TYPE_Q2_CU];
-	if (f_ptr == NULL)
-		printf("!!!get_functionRefByFtype_gates_2qubit ERROR - device function type %d not defined in function pointer vector!!!", ftype);
-	return f_ptr;
-}
-
-#define QDEV_F_GATE_2Q_SELECTOR get_functionRefByFtype_gates_2qubit
-
 
 #endif /* QSIM_QCPU_DEVICE_FUNCTION_GATES_2QUBIT_H_ */
-
@@ -0,0 +1,167 @@
+/*
+ * qSim_qcpu_node.cpp
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing the cluster node control for distributed
+ * quregs - MPI based (__QSIM_MPI__ compiling), or a single node otherwise:
+ * - root node (rank 0) running the qSim front-end and broadcasting instructions
+ * - worker nodes executing the same instructions on their state vector shards
+ * - shard halves exchange among node pairs
+ * - node results reduction and gathering on root node
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+#include <iostream>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __QSIM_MPI__
+#include <mpi.h>
+#endif
+
+#include "qSim_qcpu_node.h"
+
+using namespace std;
+
+// max transfer chunk size (bytes) - MPI counts limited to int
+#define QNODE_MAX_CHUNK_BYTES ((size_t)1 << 30)
+
+
+// constructor & destructor
+qSim_qcpu_node::qSim_qcpu_node() {
+	// single node until cluster joined
+	m_rank = QNODE_ROOT_RANK;
+	m_totNodes = 1;
+	m_init = false;
+}
+
+qSim_qcpu_node::~qSim_qcpu_node() {
+	finalize();
+}
+
+// ---------------------------------------------------------
+
+int qSim_qcpu_node::init(int* argc, char*** argv) {
+#ifdef __QSIM_MPI__
+	// root node front-end loop thread calling MPI, one call at a time
+	int provided;
+	if (MPI_Init_thread(argc, argv, MPI_THREAD_SERIALIZED, &provided) != MPI_SUCCESS) {
+		cerr << "ERROR!! qSim_qcpu_node::init - MPI initialisation failed" << endl;
+		return QNODE_RES_ERROR;
+	}
+	m_init = true;
+	if (provided < MPI_THREAD_SERIALIZED)
+		cerr << "WARNING!! qSim_qcpu_node::init - MPI serialized threads support not provided" << endl;
+	MPI_Comm_rank(MPI_COMM_WORLD, &m_rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &m_totNodes);
+
+	// shards split by node on the highest global qubits
+	if ((m_totNodes & (m_totNodes - 1)) != 0) {
+		cerr << "ERROR!! qSim_qcpu_node::init - total nodes [" << m_totNodes << "] not a power of 2" << endl;
+		return QNODE_RES_ERROR;
+	}
+#else
+	(void)argc;
+	(void)argv;
+#endif
+	return QNODE_RES_OK;
+}
+
+void qSim_qcpu_node::finalize() {
+#ifdef __QSIM_MPI__
+	if (m_init)
+		MPI_Finalize();
+#endif
+	m_init = false;
+}
+
+// ---------------------------------------------------------
+
+void qSim_qcpu_node::bcast(void* buf, size_t bytes) {
+#ifdef __QSIM_MPI__
+	for (size_t off=0; off<bytes; off+=QNODE_MAX_CHUNK_BYTES)
+		MPI_Bcast((char*)buf + off, (int)std::min(QNODE_MAX_CHUNK_BYTES, bytes-off), MPI_BYTE,
+				  QNODE_ROOT_RANK, MPI_COMM_WORLD);
+#else
+	(void)buf;
+	(void)bytes;
+#endif
+}
+
+void qSim_qcpu_node::bcast_message(unsigned int* len, char** buf) {
+	// message length first (zero terminated buffer) - worker nodes buffer allocated afterwards
+	bcast(len, sizeof(unsigned int));
+	if (!is_root())
+		*buf = new char[(*len)+1];
+	bcast(*buf, (*len)+1);
+}
+
+void qSim_qcpu_node::allreduce_sum(double* vals, size_t n) {
+#ifdef __QSIM_MPI__
+	size_t c_n = QNODE_MAX_CHUNK_BYTES / sizeof(double);
+	for (size_t off=0; off<n; off+=c_n)
+		MPI_Allreduce(MPI_IN_PLACE, vals + off, (int)std::min(c_n, n-off), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+#else
+	(void)vals;
+	(void)n;
+#endif
+}
+
+void qSim_qcpu_node::exchange(void* buf, size_t bytes, int peer) {
+#ifdef __QSIM_MPI__
+	for (size_t off=0; off<bytes; off+=QNODE_MAX_CHUNK_BYTES)
+		MPI_Sendrecv_replace((char*)buf + off, (int)std::min(QNODE_MAX_CHUNK_BYTES, bytes-off), MPI_BYTE,
+							 peer, 0, peer, 0, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+#else
+	(void)buf;
+	(void)bytes;
+	(void)peer;
+#endif
+}
+
+void qSim_qcpu_node::gather(void* send_buf, size_t bytes, void* recv_buf) {
+#ifdef __QSIM_MPI__
+	if (m_totNodes > 1) {
+		// chunked per node - root buffer holding each node slice in rank order
+		for (size_t off=0; off<bytes; off+=QNODE_MAX_CHUNK_BYTES) {
+			int c_bytes = (int)std::min(QNODE_MAX_CHUNK_BYTES, bytes-off);
+			if (is_root()) {
+				memcpy((char*)recv_buf + off, (char*)send_buf + off, c_bytes);
+				for (int r=1; r<m_totNodes; r++)
+					MPI_Recv((char*)recv_buf + r*bytes + off, c_bytes, MPI_BYTE, r, 0, MPI_COMM_WORLD,
+							 MPI_STATUS_IGNORE);
+			}
+			else
+				MPI_Send((char*)send_buf + off, c_bytes, MPI_BYTE, QNODE_ROOT_RANK, 0, MPI_COMM_WORLD);
+		}
+		return;
+	}
+#endif
+	if (recv_buf != send_buf)
+		memcpy(recv_buf, send_buf, bytes);
+}
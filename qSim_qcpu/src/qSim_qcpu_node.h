@@ -0,0 +1,90 @@
+/*
+ * qSim_qcpu_node.h
+ *
+ * --------------------------------------------------------------------------
+ * Copyright (C) 2026 Gianni Casonato
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ * --------------------------------------------------------------------------
+ *
+ *  Created on: Oct 14, 2026
+ *      Author: gianni
+ *
+ * Q-CPU support module, providing the cluster node control for distributed
+ * quregs - MPI based (__QSIM_MPI__ compiling), or a single node otherwise:
+ * - root node (rank 0) running the qSim front-end and broadcasting instructions
+ * - worker nodes executing the same instructions on their state vector shards
+ * - shard halves exchange among node pairs
+ * - node results reduction and gathering on root node
+ *
+ *  Version History:
+ *
+ *  Ver   Date       Change
+ *  --------------------------------------------------------------------------
+ *  1.0   Oct-2026   Module creation.
+ *
+ *  --------------------------------------------------------------------------
+ */
+
+
+#ifndef QSIM_QCPU_NODE_H_
+#define QSIM_QCPU_NODE_H_
+
+#include <cstddef>
+
+// return codes
+#define QNODE_RES_OK     0
+#define QNODE_RES_ERROR -1
+
+// root node rank
+#define QNODE_ROOT_RANK 0
+
+
+class qSim_qcpu_node {
+public:
+	// constructor & destructor
+	qSim_qcpu_node();
+	virtual ~qSim_qcpu_node();
+
+	// cluster join and leave - total nodes must be a power of 2
+	int init(int* argc, char*** argv);
+	void finalize();
+
+	// accessors
+	int get_rank()      { return m_rank; }
+	int get_tot_nodes() { return m_totNodes; }
+	bool is_root()      { return (m_rank == QNODE_ROOT_RANK); }
+	bool is_cluster()   { return (m_totNodes > 1); }
+
+	// root node buffer broadcast - given size on all nodes
+	void bcast(void* buf, size_t bytes);
+
+	// root node message broadcast - buffer allocated on worker nodes (released by caller)
+	void bcast_message(unsigned int* len, char** buf);
+
+	// values sum on all nodes
+	void allreduce_sum(double* vals, size_t n);
+
+	// buffer exchange with peer node - same size on both nodes, replaced in place
+	void exchange(void* buf, size_t bytes, int peer);
+
+	// node buffers gathered on root node, in rank order (root buffer sized for all nodes)
+	void gather(void* send_buf, size_t bytes, void* recv_buf);
+
+private:
+	int m_rank;
+	int m_totNodes;
+	bool m_init;
+};
+
+#endif /* QSIM_QCPU_NODE_H_ */
@@ -30,6 +30,10 @@
  *  1.0   Dec-2022   Module creation.
  *  1.1   Feb-2023   Handled QML function blocks (feature map and q-net).
  *                   Added double to string precise conversion helper method.
+ *  1.2   Oct-2026   Handled 64-bit state index type and relevant param access.
+ *  1.3   Oct-2026   Handled raw state array params (binary message encoding).
+ *  1.4   Oct-2026   Added double vector to string conversion (batched qureg results).
+ *  1.5   Oct-2026   Handled q-net gradient messages as QML block instructions.
  *
  *  --------------------------------------------------------------------------
  */
@@ -214,7 +218,8 @@ qSim_qinstruction_base::~qSim_qinstruction_base()
 bool qSim_qinstruction_base::is_core(qSim_qasm_message* msg) {
 	// core instruction message check
 	// -> it must be a qureg state control or a 1Q-2Q-nQ transformation
-	if (msg->is_instruction_message() && (msg->get_id() != QASM_MSG_ID_QREG_ST_TRANSFORM))
+	if (msg->is_instruction_message() && (msg->get_id() != QASM_MSG_ID_QREG_ST_TRANSFORM) &&
+		(msg->get_id() != QASM_MSG_ID_QREG_ST_GRADIENT))
 		return true;
 	if (msg->is_instruction_message() && (msg->get_id() == QASM_MSG_ID_QREG_ST_TRANSFORM)) {
 		QASM_F_TYPE ftype;
@@ -249,8 +254,9 @@ bool qSim_qinstruction_base::is_block(qSim_qasm_message* msg) {
 
 bool qSim_qinstruction_base::is_block_qml(qSim_qasm_message* msg) {
 	// QML block instruction message check
-	// -> it must be a block transformation of QML type
-	if (msg->is_instruction_message() && (msg->get_id() == QASM_MSG_ID_QREG_ST_TRANSFORM)) {
+	// -> it must be a block transformation of QML type, or a q-net gradient
+	if (msg->is_instruction_message() && ((msg->get_id() == QASM_MSG_ID_QREG_ST_TRANSFORM) ||
+										  (msg->get_id() == QASM_MSG_ID_QREG_ST_GRADIENT))) {
 		QASM_F_TYPE ftype;
 		if (!qSim_qinstruction_base::get_msg_param_value_as_ftype(msg, QASM_MSG_PARAM_TAG_F_TYPE, &ftype)) {
 			cerr << "qSim_qcpu::dispatch_message - no function type parameter in instruction message!!" << endl;
@@ -436,14 +442,14 @@ bool qSim_qinstruction_base::measure_index_string_to_value(std::string idx_vec_s
 		else if (idx1 > 0) {
 			// first or middle index
 //			cout << "... 1st/middle index read...str_val: " << strBuf.substr(0, idx1-1) << endl;
-			int idx_val = stoi(strBuf.substr(0, idx1));
+			QREG_ST_INDEX_TYPE idx_val = stoll(strBuf.substr(0, idx1));
 			m_vec->push_back(idx_val);
 			strBuf.erase(0, idx1+2);
 		}
 		else {
 			// last or single index - remove ending "]" if present
 //			cout << "... last/single index read...str_val: " << strBuf << endl;
-			int idx_val = stoi(strBuf);
+			QREG_ST_INDEX_TYPE idx_val = stoll(strBuf);
 //			cout << "... idx_val: " << idx_val << endl;
 			m_vec->push_back(idx_val);
 			strBuf.clear();
@@ -484,6 +490,21 @@ bool qSim_qinstruction_base::get_msg_param_value_as_uint(qSim_qasm_message* msg,
 	return res;
 }
 
+bool qSim_qinstruction_base::get_msg_param_value_as_state_index(qSim_qasm_message* msg, std::string par_name,
+												               QREG_ST_INDEX_TYPE* par_val) {
+	// read given param string as 64-bit integer and catch exceptions
+	bool res = true;
+	try {
+		std::string str_val = msg->get_param_valueByTag(par_name);
+		*par_val = stoll(str_val);
+	} catch (const std::exception& e) {
+		cerr <<"qSim_qinstruction - error reading param: " << par_name << " as <state index>!!" << endl;
+		cerr << e.what() << endl;
+		res = false;
+	}
+	return res;
+}
+
 bool qSim_qinstruction_base::get_msg_param_value_as_ftype(qSim_qasm_message* msg, std::string par_name,
 												         QASM_F_TYPE* par_val) {
 	// read given param string as integer and catch exceptions
@@ -501,7 +522,9 @@ bool qSim_qinstruction_base::get_msg_param_value_as_ftype(qSim_qasm_message* msg
 
 bool qSim_qinstruction_base::get_msg_param_value_as_state_array(qSim_qasm_message* msg, std::string par_name,
 		                                                   QREG_ST_VAL_ARRAY_TYPE* par_val) {
-	// read given param string as integer and catch exceptions
+	// use raw array if present (binary encoding) - otherwise read given param string and catch exceptions
+	if (msg->get_param_arrayByTag(par_name, par_val))
+		return true;
 	bool res = true;
 	try {
 		std::string str_val = msg->get_param_valueByTag(par_name);
@@ -567,3 +590,15 @@ std::string qSim_qinstruction_base::double_value_to_string(double d_val) {
 	return out.str();
 }
 
+// => double vector string format: [d1, d2, ..., dn]
+std::string qSim_qinstruction_base::double_vector_to_string(std::vector<double> d_vec) {
+	std::string d_vec_str = "[";
+	for (unsigned int i=0; i<d_vec.size(); i++) {
+		d_vec_str += double_value_to_string(d_vec[i]);
+		if (i < d_vec.size()-1)
+			d_vec_str += ", ";
+	}
+	d_vec_str += "]";
+	return d_vec_str;
+}
+
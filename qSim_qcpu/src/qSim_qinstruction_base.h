@@ -30,6 +30,8 @@
  *  1.0   Dec-2022   Module creation.
  *  1.1   Feb-2023   Handled QML function blocks (feature map and q-net).
  *                   Added double to string precise conversion helper method.
+ *  1.2   Oct-2026   Handled 64-bit state index type and relevant param access.
+ *  1.3   Oct-2026   Added double vector to string conversion (batched qureg results).
  *
  *  --------------------------------------------------------------------------
  */
@@ -38,6 +40,7 @@
 #define QSIM_QINSTRUCTION_BASE_H_
 
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <complex>
@@ -54,7 +57,7 @@ typedef QASM_MSG_ID_TYPE QREG_INSTR_TYPE;
 typedef QASM_F_TYPE QREG_F_TYPE;
 typedef std::vector<std::complex<double>> QREG_ST_VAL_ARRAY_TYPE; // CPU convenient type using std::vector
 typedef std::complex<double> QREG_ST_VAL_TYPE;
-typedef unsigned int QREG_ST_INDEX_TYPE;
+typedef int64_t QREG_ST_INDEX_TYPE; // 64-bit state index - qureg size bounded by memory only
 typedef std::vector<QREG_ST_INDEX_TYPE> QREG_ST_INDEX_ARRAY_TYPE;
 
 // data type for instruction function control/target index ranges
@@ -138,6 +141,7 @@ public:
 
 	// double value to string with precision conversion helpers
 	static std::string double_value_to_string(double d_val);
+	static std::string double_vector_to_string(std::vector<double> d_vec);
 
 	// diagnostics
 	virtual void dump() = 0;
@@ -145,6 +149,7 @@ public:
 	// parameters access helper methods
 	static bool get_msg_param_value_as_int(qSim_qasm_message* msg, std::string par_name, int* par_val);
 	static bool get_msg_param_value_as_uint(qSim_qasm_message* msg, std::string par_name, unsigned* par_val);
+	static bool get_msg_param_value_as_state_index(qSim_qasm_message* msg, std::string par_name, QREG_ST_INDEX_TYPE* par_val);
 	static bool get_msg_param_value_as_ftype(qSim_qasm_message* msg, std::string par_name, QASM_F_TYPE* par_val);
 	static bool get_msg_param_value_as_state_array(qSim_qasm_message* msg, std::string par_name, QREG_ST_VAL_ARRAY_TYPE* par_val);
 	static bool get_msg_param_value_as_index_range(qSim_qasm_message* msg, std::string par_name, QREG_F_INDEX_RANGE_TYPE* par_val);
@@ -179,7 +184,7 @@ protected:
 }
 
 #define SAFE_MSG_GET_PARAM_AS_STATE_INDEX(par_name, int_val) {\
-	m_valid = qSim_qinstruction_base::get_msg_param_value_as_int(msg, par_name, &int_val);\
+	m_valid = qSim_qinstruction_base::get_msg_param_value_as_state_index(msg, par_name, &int_val);\
 	if (!m_valid)\
 		return; \
 }
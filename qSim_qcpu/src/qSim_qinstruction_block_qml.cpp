@@ -24,6 +24,7 @@
  * supporting:
  * - feature map blocks
  * - QVC q-net blocks
+ * - QVC q-net blocks gradient (state expectation derivatives by q-net params)
  *
  * Derived class from qSim_qinstruction_block.
  *
@@ -32,6 +33,9 @@
  *  Ver   Date       Change
  *  --------------------------------------------------------------------------
  *  1.0   Feb-2023   Module creation.
+ *  1.1   Oct-2026   Handled q-net gradient messages, with state expectation params.
+ *  1.2   Oct-2026   Handled blocks unwrapping on an LRU cache of instruction list templates
+ *                   keyed by block shape (args bound on execution), built from a pool.
  *
  *  --------------------------------------------------------------------------
  */
@@ -41,6 +45,7 @@
 #include <complex>
 #include <cmath>
 #include <string.h>
+#include <algorithm>
 using namespace std;
 
 
@@ -74,6 +79,7 @@ qSim_qinstruction_block_qml::qSim_qinstruction_block_qml(qSim_qasm_message* msg)
 	m_type = msg->get_id();
 	m_qr_h = 0;
 	m_valid = true; // updated in the switch in case of exceptions
+	m_pool = NULL;
 //	cout << "qSim_qinstruction_block...m_type: " << m_type << "  msg_id: " << msg->get_id() << endl;
 
 	// qureg state transformation QML block message handling
@@ -86,6 +92,26 @@ qSim_qinstruction_block_qml::qSim_qinstruction_block_qml(qSim_qasm_message* msg)
 	SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_FBQML_SUBTYPE, m_fbsubtype)
 	SAFE_MSG_GET_PARAM_AS_FARGS(QASM_MSG_PARAM_TAG_F_ARGS, m_fargs)
 
+	// q-net gradient message handling - expectation params (optional, same defaults as
+	// expectation message)
+	m_st_idx = -1;
+	m_q_idx = 0;
+	m_q_len = -1; // whole qureg
+	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
+	if (m_type == QASM_MSG_ID_QREG_ST_GRADIENT) {
+		if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_EXSTIDX))
+			SAFE_MSG_GET_PARAM_AS_STATE_INDEX(QASM_MSG_PARAM_TAG_QREG_EXSTIDX, m_st_idx)
+		if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_EXQIDX))
+			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_EXQIDX, m_q_idx)
+		if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_EXQLEN))
+			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_EXQLEN, m_q_len)
+		if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_EXOBSOP)) {
+			int ex_obsOp;
+			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_EXOBSOP, ex_obsOp)
+			m_ex_obsOp = (QASM_EX_OBSOP_TYPE)ex_obsOp;
+		}
+	}
+
 	// final semantic check
 	SAFE_TRASFORMATION_PARAMS_CHECK()
 }
@@ -105,11 +131,16 @@ qSim_qinstruction_block_qml::qSim_qinstruction_block_qml(QASM_MSG_ID_TYPE type,
 	// qureg qml block transformation
 //	cout << "qSim_qinstruction_block_qml...m_frep: " << m_frep << endl;
 	m_valid = true;
+	m_pool = NULL;
 
 	// set attributes
 	m_fbent = fbent;
 	m_fbsubtype = fbsubtype;
 	m_fargs = fargs;
+	m_st_idx = -1;
+	m_q_idx = 0;
+	m_q_len = -1;
+	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
 
 	// semantic check
 	SAFE_TRASFORMATION_PARAMS_CHECK()
@@ -142,6 +173,11 @@ bool qSim_qinstruction_block_qml::check_params() {
 							   	"qSim_qinstruction_block_qml::check_params - feature map entanglement out of range", m_fbent)
 		}
 	}
+	// q-net gradient - q-net blocks only
+	if (m_type == QASM_MSG_ID_QREG_ST_GRADIENT) {
+		SAFE_CHECK_PARAM_VALUE((m_ftype == QASM_FBQML_TYPE_QNET), res,
+							   "qSim_qinstruction_block_qml::check_params - gradient block type not a q-net", m_ftype)
+	}
 	// ...
 
 	return res;
@@ -150,66 +186,81 @@ bool qSim_qinstruction_block_qml::check_params() {
 // -------------------------------------
 // -------------------------------------
 
-// handle caching q-instruction lists caching for performance
-int m_last_fmap_n = 0;
-int m_last_fmap_frep = 0;
-QASM_QML_ENTANG_TYPE m_last_fmap_fbent;
-int m_last_fmap_fbsubtype;
-std::list<qSim_qinstruction_core*> m_last_fmap_qinstr_list;
-
-int m_last_qnet_n = 0;
-int m_last_qnet_frep = 0;
-QASM_QML_ENTANG_TYPE m_last_qnet_fbent;
-int m_last_qnet_fbsubtype;
-std::list<qSim_qinstruction_core*> m_last_qnet_qinstr_list;
-
-bool is_qml_ftype_in_cache(QASM_F_TYPE f_type, int f_rep, QASM_QML_ENTANG_TYPE fb_ent, int fb_subtype, QREG_F_ARGS_TYPE f_args) {
-	if (f_type == QASM_FBQML_TYPE_FMAP) {
-		int n = f_args.size();
-		return ((n==m_last_fmap_n) && (f_rep==m_last_fmap_frep) && (fb_ent==m_last_fmap_fbent) && (fb_subtype==m_last_fmap_fbsubtype));
+// QML block templates cache
+
+qSim_qinstruction_block_qml_cache::qSim_qinstruction_block_qml_cache(int tot_templates) {
+	m_totTemplates = std::max(1, tot_templates);
+}
+
+qSim_qinstruction_block_qml_cache::~qSim_qinstruction_block_qml_cache() {
+	// release templates instructions - before pool chunks
+	while (!m_templates.empty()) {
+		std::list<qSim_qinstruction_core*>* qinstr_list = &m_templates.back().second;
+		for (std::list<qSim_qinstruction_core*>::iterator it = qinstr_list->begin(); it != qinstr_list->end(); ++it)
+			m_pool.release(*it);
+		m_templates.pop_back();
 	}
-	else if (f_type == QASM_FBQML_TYPE_QNET) {
-		int n = f_args.size()/(f_rep + 1);
-		return ((n==m_last_qnet_n) && (f_rep==m_last_qnet_frep) && (fb_ent==m_last_qnet_fbent) && (fb_subtype==m_last_qnet_fbsubtype));
+}
+
+std::list<qSim_qinstruction_core*>* qSim_qinstruction_block_qml_cache::find(QML_TEMPLATE_KEY_TYPE key) {
+	// linear search (few templates) - found template moved in front (lists not invalidated)
+	for (auto it = m_templates.begin(); it != m_templates.end(); ++it) {
+		if (it->first == key) {
+			m_templates.splice(m_templates.begin(), m_templates, it);
+			return &m_templates.front().second;
+		}
 	}
-	else
-		return false;
+	return NULL;
 }
 
+std::list<qSim_qinstruction_core*>* qSim_qinstruction_block_qml_cache::insert(QML_TEMPLATE_KEY_TYPE key) {
+	// evict least recently used template if full
+	if ((int)m_templates.size() >= m_totTemplates) {
+		std::list<qSim_qinstruction_core*>* qinstr_list = &m_templates.back().second;
+		for (std::list<qSim_qinstruction_core*>::iterator it = qinstr_list->begin(); it != qinstr_list->end(); ++it)
+			m_pool.release(*it);
+		m_templates.pop_back();
+	}
+	m_templates.emplace_front(key, std::list<qSim_qinstruction_core*>());
+	return &m_templates.front().second;
+}
+
+// -------------------------------------
+
 // function block decomposition into core instructions - feature map
 
-void qSim_qinstruction_block_qml::unwrap_block_fmap(std::list<qSim_qinstruction_core*>** qinstr_list,
+void qSim_qinstruction_block_qml::unwrap_block_fmap(qSim_qinstruction_block_qml_cache* qml_cache,
+													std::list<qSim_qinstruction_core*>** qinstr_list,
 											        QREG_F_ARGS_TYPE* qinstr_list_fargs, bool verbose) {
 	// feature map QML function block decomposition in core transformations
 	// based on given subtype (Pauli-Z or PAuli-ZZ)
 	if (verbose)
 		cout << "QML block - unwrap_fmap..." << endl;
 
-	// check if in cache
-	if (is_qml_ftype_in_cache(m_ftype, m_frep, m_fbent, m_fbsubtype, m_fargs)) {
+	// check if in cache - feature map width as datapoint size
+	QML_TEMPLATE_KEY_TYPE t_key(m_ftype, m_fbsubtype, m_fbent, m_frep, m_fargs.size());
+	*qinstr_list = qml_cache->find(t_key);
+	if (*qinstr_list != NULL) {
 		// take from cache
 		if (verbose)
 			cout << "QML block - q-instruction list taken from cache..." << endl;
-		*qinstr_list = &m_last_fmap_qinstr_list;
 
 		// assemble function arguments
 		feature_map_prepare_fargs(qinstr_list_fargs);
 		return;
 	}
 
-	// perform unwrap according to sub-ftype value
-	for (std::list<qSim_qinstruction_core*>::iterator it = m_last_fmap_qinstr_list.begin(); it != m_last_fmap_qinstr_list.end(); ++it) {
-		delete (*it);
-	}
-	m_last_fmap_qinstr_list.clear();
+	// perform unwrap according to sub-ftype value - into a new template
+	*qinstr_list = qml_cache->insert(t_key);
+	m_pool = qml_cache->get_pool();
 	switch (m_fbsubtype) {
 		case QASM_QML_FMAP_TYPE_PAULI_Z: {
-			feature_map_pe_pauliZ(&m_fargs, m_frep, &m_last_fmap_qinstr_list, verbose);
+			feature_map_pe_pauliZ(&m_fargs, m_frep, *qinstr_list, verbose);
 		}
 		break;
 
 		case QASM_QML_FMAP_TYPE_PAULI_ZZ: {
-			feature_map_pe_pauliZZ(&m_fargs, m_frep, m_fbent, &m_last_fmap_qinstr_list, verbose);
+			feature_map_pe_pauliZZ(&m_fargs, m_frep, m_fbent, *qinstr_list, verbose);
 		}
 		break;
 
@@ -219,17 +270,11 @@ void qSim_qinstruction_block_qml::unwrap_block_fmap(std::list<qSim_qinstruction_
 		}
 		break;
 	}
-	*qinstr_list = &m_last_fmap_qinstr_list;
-
-	// set other cache fields
-	m_last_fmap_frep = m_frep;
-	m_last_fmap_fbent = m_fbent;
-	m_last_fmap_fbsubtype = m_fbsubtype;
-	m_last_fmap_n = m_fargs.size();
+	m_pool = NULL;
 	if (verbose) {
-		cout << "QML block - q-instruction cache updated...m_last_fmap_qinstr_list.size: " << m_last_fmap_qinstr_list.size() << endl;
-		cout << " m_last_fmap_frep: " << m_last_fmap_frep << " m_last_fmap_fbent: " << m_last_fmap_fbent <<
-				" m_last_fmap_fbsubtype: " << m_last_fmap_fbsubtype << " 	m_last_fmap_n: " << m_last_fmap_n << endl;
+		cout << "QML block - q-instruction cache updated...qinstr_list.size: " << (*qinstr_list)->size() << endl;
+		cout << " m_frep: " << m_frep << " m_fbent: " << m_fbent << " m_fbsubtype: " << m_fbsubtype
+			 << " n: " << m_fargs.size() << " templates: " << qml_cache->get_tot_templates() << endl;
 	}
 
 	// assemble function arguments
@@ -249,7 +294,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZ(QREG_F_ARGS_TYPE* f_vec,
     // unwrap feature map into core instructions - replicating per given total blocks
     for (int b=0; b<b_rep; b++) {
         // create <n> H gates
-		qSim_qinstruction_core* qi_H = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+		qSim_qinstruction_core* qi_H = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 							m_qr_h, QASM_F_TYPE_Q1_H, fh_stn, n, 0);
 		qinstr_list->push_back(qi_H);
 
@@ -257,7 +302,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZ(QREG_F_ARGS_TYPE* f_vec,
         for (int i=0; i<n; i++) {
         	QREG_F_ARGS_TYPE fargs_i;
 			fargs_i.push_back(qSim_qreg_function_arg((*f_vec)[i]));
-    		qSim_qinstruction_core* qi_PS = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+    		qSim_qinstruction_core* qi_PS = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
     						m_qr_h, QASM_F_TYPE_Q1_PS, fps_stn, 1, i,
 							QREG_F_INDEX_RANGE_TYPE(), QREG_F_INDEX_RANGE_TYPE(), fargs_i);
     		qinstr_list->push_back(qi_PS);
@@ -279,7 +324,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
     // unwrap feature map into core instructions - replicating per given total blocks
     for (int b=0; b<b_rep; b++) {
         // create <n> H gates
-		qSim_qinstruction_core* qi_H = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+		qSim_qinstruction_core* qi_H = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 							m_qr_h, QASM_F_TYPE_Q1_H, fh_stn, n, 0);
 		qinstr_list->push_back(qi_H);
 
@@ -290,7 +335,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
         for (int i=0; i<n; i++) {
         	QREG_F_ARGS_TYPE fargs_i;
 			fargs_i.push_back(qSim_qreg_function_arg((*f_vec)[i]));
-    		qSim_qinstruction_core* qi_PS = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+    		qSim_qinstruction_core* qi_PS = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
     						m_qr_h, QASM_F_TYPE_Q1_PS, fps_stn, 1, i,
 							QREG_F_INDEX_RANGE_TYPE(), QREG_F_INDEX_RANGE_TYPE(), fargs_i);
     		qinstr_list->push_back(qi_PS);
@@ -305,18 +350,18 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
             	// add CX - PS - CX on i-th line, controlled from i-1 line (inverse form)
             	QREG_F_INDEX_RANGE_TYPE fcrng(i-1, i-1);
             	QREG_F_INDEX_RANGE_TYPE ftrng(i, i);
-        		qSim_qinstruction_core* qi_CX1 = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+        		qSim_qinstruction_core* qi_CX1 = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
         						m_qr_h, QASM_F_TYPE_Q2_CX, fcx_stn, 1, i-1, fcrng, ftrng);
         		qinstr_list->push_back(qi_CX1);
 
             	QREG_F_ARGS_TYPE fargs_i;
     			fargs_i.push_back(qSim_qreg_function_arg((*f_vec)[i]));
-        		qSim_qinstruction_core* qi_PS = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+        		qSim_qinstruction_core* qi_PS = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
         						m_qr_h, QASM_F_TYPE_Q1_PS, fps_stn, 1, i,
     							QREG_F_INDEX_RANGE_TYPE(), QREG_F_INDEX_RANGE_TYPE(), fargs_i);
         		qinstr_list->push_back(qi_PS);
 
-        		qSim_qinstruction_core* qi_CX2 = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+        		qSim_qinstruction_core* qi_CX2 = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
         						m_qr_h, QASM_F_TYPE_Q2_CX, fcx_stn, 1, i-1, fcrng, ftrng);
         		qinstr_list->push_back(qi_CX2);
             }
@@ -335,7 +380,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
 						QREG_F_INDEX_RANGE_TYPE ftrng(0, 0);
 						QREG_F_ARGS_TYPE fargs;
 						int futype=QASM_F_TYPE_Q1_X;
-						qSim_qinstruction_core* qi_CX = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+						qSim_qinstruction_core* qi_CX = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 										m_qr_h, QASM_F_TYPE_QN_MCSLRU, fcx_stn, 1, 0, fcrng, ftrng, fargs, futype);
 						qinstr_list->push_back(qi_CX);
                 	}
@@ -345,7 +390,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
             		int fcx_stn = 4; // 2 qubits CX here...
                 	QREG_F_INDEX_RANGE_TYPE fcrng(i-1, i-1);
                 	QREG_F_INDEX_RANGE_TYPE ftrng(i, i);
-            		qSim_qinstruction_core* qi_CX = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+            		qSim_qinstruction_core* qi_CX = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
             						m_qr_h, QASM_F_TYPE_Q2_CX, fcx_stn, 1, i-1, fcrng, ftrng);
             		qinstr_list->push_back(qi_CX);
             	}
@@ -353,7 +398,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
 //            # print('...adding PS - i:', i)
             	QREG_F_ARGS_TYPE fargs_i;
     			fargs_i.push_back(qSim_qreg_function_arg((*f_vec)[i]));
-        		qSim_qinstruction_core* qi_PS = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+        		qSim_qinstruction_core* qi_PS = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
         						m_qr_h, QASM_F_TYPE_Q1_PS, fps_stn, 1, i,
     							QREG_F_INDEX_RANGE_TYPE(), QREG_F_INDEX_RANGE_TYPE(), fargs_i);
         		qinstr_list->push_back(qi_PS);
@@ -367,7 +412,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
 						QREG_F_INDEX_RANGE_TYPE ftrng(0, 0);
 						QREG_F_ARGS_TYPE fargs;
 						int futype=QASM_F_TYPE_Q1_X;
-						qSim_qinstruction_core* qi_CX = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+						qSim_qinstruction_core* qi_CX = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 										m_qr_h, QASM_F_TYPE_QN_MCSLRU, fcx_stn, 1, 0, fcrng, ftrng, fargs, futype);
 						qinstr_list->push_back(qi_CX);
                 	}
@@ -377,7 +422,7 @@ void qSim_qinstruction_block_qml::feature_map_pe_pauliZZ(QREG_F_ARGS_TYPE* f_vec
             		int fcx_stn = 4; // 2 qubits CX here...
                 	QREG_F_INDEX_RANGE_TYPE fcrng(i-1, i-1);
                 	QREG_F_INDEX_RANGE_TYPE ftrng(i, i);
-            		qSim_qinstruction_core* qi_CX = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+            		qSim_qinstruction_core* qi_CX = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
             						m_qr_h, QASM_F_TYPE_Q2_CX, fcx_stn, 1, i-1, fcrng, ftrng);
             		qinstr_list->push_back(qi_CX);
             	}
@@ -421,14 +466,14 @@ void qSim_qinstruction_block_qml::feature_map_prepare_fargs(QREG_F_ARGS_TYPE* qi
 				}
 
 				// levels #1... #L-1 - only level qubit
-				if (m_last_qnet_fbent == QASM_QML_ENTANG_TYPE_LINEAR) {
+				if (m_fbent == QASM_QML_ENTANG_TYPE_LINEAR) {
 					// start from level #1 for linear entanglement
 					for (unsigned int l=1; l<m_fargs.size(); l++) {
 						QREG_F_ARG_TYPE f_arg = 2.0*(M_PI-m_fargs[l].m_d)*(M_PI-m_fargs[l-1].m_d);
 						qinstr_list_fargs->push_back(f_arg);
 					}
 				}
-				else if (m_last_qnet_fbent == QASM_QML_ENTANG_TYPE_CIRCULAR) {
+				else if (m_fbent == QASM_QML_ENTANG_TYPE_CIRCULAR) {
 					// start from level #0 (with index wrap-up) for circular entanglement
 					QREG_F_ARG_TYPE f_arg = 2.0*(M_PI-m_fargs[0].m_d)*(M_PI-m_fargs[m_fargs.size()-1].m_d);
 					qinstr_list_fargs->push_back(f_arg);
@@ -455,33 +500,33 @@ void qSim_qinstruction_block_qml::feature_map_prepare_fargs(QREG_F_ARGS_TYPE* qi
 
 // function block decomposition into core instructions - q-network
 
-void qSim_qinstruction_block_qml::unwrap_block_qnet(int n, std::list<qSim_qinstruction_core*>** qinstr_list,
+void qSim_qinstruction_block_qml::unwrap_block_qnet(qSim_qinstruction_block_qml_cache* qml_cache, int n,
+													std::list<qSim_qinstruction_core*>** qinstr_list,
                                                     QREG_F_ARGS_TYPE* qinstr_list_fargs, bool verbose) {
 	// q-network QML function block decomposition in core transformations
 	// based on given layout type (general or real amplitudes)
 	if (verbose)
 		cout << "QML block - unwrap_qnet..." << endl;
 
-	// check if in cache
-	if (is_qml_ftype_in_cache(m_ftype, m_frep, m_fbent, m_fbsubtype, m_fargs)) {
+	// check if in cache - q-net width as params per layer
+	QML_TEMPLATE_KEY_TYPE t_key(m_ftype, m_fbsubtype, m_fbent, m_frep, m_fargs.size()/(m_frep + 1));
+	*qinstr_list = qml_cache->find(t_key);
+	if (*qinstr_list != NULL) {
 		// take from cache
 		if (verbose)
 			cout << "QML block - q-instruction list taken from cache..." << endl;
-		*qinstr_list = &m_last_qnet_qinstr_list;
 
 		// assemble function arguments
 		qnetwork_prepare_fargs(qinstr_list_fargs);
 		return;
 	}
 
-	// perform unwrap according to sub-ftype value
-	for (std::list<qSim_qinstruction_core*>::iterator it = m_last_qnet_qinstr_list.begin(); it != m_last_qnet_qinstr_list.end(); ++it) {
-		delete (*it);
-	}
-	m_last_qnet_qinstr_list.clear();
+	// perform unwrap according to sub-ftype value - into a new template
+	*qinstr_list = qml_cache->insert(t_key);
+	m_pool = qml_cache->get_pool();
 	switch (m_fbsubtype) {
 		case QASM_QML_QNET_LAY_TYPE_REAL_AMPL: {
-			qnetwork_realAmplitude(n, &m_fargs, m_frep, m_fbent, &m_last_qnet_qinstr_list, verbose);
+			qnetwork_realAmplitude(n, &m_fargs, m_frep, m_fbent, *qinstr_list, verbose);
 		}
 		break;
 
@@ -491,17 +536,11 @@ void qSim_qinstruction_block_qml::unwrap_block_qnet(int n, std::list<qSim_qinstr
 		}
 		break;
 	}
-	*qinstr_list = &m_last_qnet_qinstr_list;
-
-	// set other cache fields
-	m_last_qnet_frep = m_frep;
-	m_last_qnet_fbent = m_fbent;
-	m_last_qnet_fbsubtype = m_fbsubtype;
-	m_last_qnet_n = m_fargs.size()/(m_frep + 1);
+	m_pool = NULL;
 	if (verbose) {
-		cout << "QML block - q-instruction cache updated...m_last_qnet_qinstr_list.size: " << m_last_qnet_qinstr_list.size() << endl;
-		cout << " m_last_qnet_frep: " << m_last_qnet_frep << " m_last_qnet_fbent: " << m_last_qnet_fbent <<
-				" m_last_qnet_fbsubtype: " << m_last_qnet_fbsubtype << " m_last_qnet_n: " << m_last_qnet_n << endl;
+		cout << "QML block - q-instruction cache updated...qinstr_list.size: " << (*qinstr_list)->size() << endl;
+		cout << " m_frep: " << m_frep << " m_fbent: " << m_fbent << " m_fbsubtype: " << m_fbsubtype
+			 << " n: " << m_fargs.size()/(m_frep + 1) << " templates: " << qml_cache->get_tot_templates() << endl;
 	}
 
 	// assemble function arguments
@@ -616,7 +655,7 @@ void qSim_qinstruction_block_qml::qnetwork_build_G1(QREG_F_INDEX_RANGE_TYPE para
 		double theta = (*param_vec)[param_idx_range.m_start].m_d;
 		fargs.push_back(qSim_qreg_function_arg(theta));
 		int fry_stn = 2;
-		qSim_qinstruction_core* qi_Ry = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+		qSim_qinstruction_core* qi_Ry = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 						m_qr_h, QASM_F_TYPE_Q1_Ry, fry_stn, 1, i,
 						QREG_F_INDEX_RANGE_TYPE(), QREG_F_INDEX_RANGE_TYPE(), fargs);
 		qinstr_list->push_back(qi_Ry);
@@ -643,7 +682,7 @@ void qSim_qinstruction_block_qml::qnetwork_build_CG_block(int c_idx, int t_idx,
 	QREG_F_INDEX_RANGE_TYPE ftrng(t_idx, t_idx);
 	QREG_F_ARGS_TYPE fargs;
 	int futype = QASM_F_TYPE_Q1_X;
-	qSim_qinstruction_core* qi_CX = new qSim_qinstruction_core(QASM_MSG_ID_QREG_ST_TRANSFORM,
+	qSim_qinstruction_core* qi_CX = new_qinstr(QASM_MSG_ID_QREG_ST_TRANSFORM,
 					m_qr_h, QASM_F_TYPE_QN_MCSLRU, fcx_stn, 1, i, fcrng, ftrng, fargs, futype);
 	qinstr_list->push_back(qi_CX);
 }
@@ -674,7 +713,8 @@ void qSim_qinstruction_block_qml::dump() {
 	cout << "*** qSim_qinstruction_block_qml dump ***" << endl;
 	cout << "m_type: " << m_type << endl;
 	switch (m_type) {
-		case QASM_MSG_ID_QREG_ST_TRANSFORM: {
+		case QASM_MSG_ID_QREG_ST_TRANSFORM:
+		case QASM_MSG_ID_QREG_ST_GRADIENT: {
 			cout << "m_qr_h: " << m_qr_h << endl;
 			cout << "m_ftype: " << m_ftype << endl;
 			cout << "m_frep: " << m_frep << endl;
@@ -682,6 +722,9 @@ void qSim_qinstruction_block_qml::dump() {
 			cout << "m_fbsubtype: " << m_fbsubtype << endl;
 			cout << "m_fargs.size: " << m_fargs.size()
 				 << " str: " << fargs_to_string(m_fargs) << endl;
+			if (m_type == QASM_MSG_ID_QREG_ST_GRADIENT)
+				cout << "m_st_idx: " << m_st_idx << " m_q_idx: " << m_q_idx << " m_q_len: " << m_q_len
+					 << " m_ex_obsOp: " << m_ex_obsOp << endl;
 		}
 		break;
 
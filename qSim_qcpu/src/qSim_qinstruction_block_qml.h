@@ -24,6 +24,7 @@
  * supporting:
  * - feature map blocks
  * - QVC q-net blocks
+ * - QVC q-net blocks gradient (state expectation derivatives by q-net params)
  *
  * Derived class from qSim_qinstruction_block.
  *
@@ -32,6 +33,9 @@
  *  Ver   Date       Change
  *  --------------------------------------------------------------------------
  *  1.0   Feb-2023   Module creation.
+ *  1.1   Oct-2026   Handled q-net gradient messages, with state expectation params.
+ *  1.2   Oct-2026   Handled blocks unwrapping on an LRU cache of instruction list templates
+ *                   keyed by block shape (args bound on execution), built from a pool.
  *
  *  --------------------------------------------------------------------------
  */
@@ -41,11 +45,49 @@
 
 
 #include <list>
+#include <tuple>
 using namespace std;
 
 #include "qSim_qinstruction_block.h"
 
 
+// -------------------------------------------------
+// QML block templates cache - unwrapped core instruction lists kept by block shape (type,
+// subtype, entanglement, repetitions and width), instruction args bound on execution by
+// position => one cache per qcpu lane (instructions on a lane executed sequentially)
+// -------------------------------------------------
+
+#define QML_TEMPLATE_CACHE_SIZE 8 // max templates kept - least recently used evicted
+
+typedef std::tuple<int, int, int, int, int> QML_TEMPLATE_KEY_TYPE;
+
+class qSim_qinstruction_block_qml_cache {
+
+public:
+	// constructor and destructor - templates instructions released to the pool
+	qSim_qinstruction_block_qml_cache(int tot_templates=QML_TEMPLATE_CACHE_SIZE);
+	virtual ~qSim_qinstruction_block_qml_cache();
+
+	// template lookup - most recently used on success, NULL if not found
+	std::list<qSim_qinstruction_core*>* find(QML_TEMPLATE_KEY_TYPE key);
+
+	// new empty template for given key (to be filled from the pool), least recently used
+	// one evicted if full
+	std::list<qSim_qinstruction_core*>* insert(QML_TEMPLATE_KEY_TYPE key);
+
+	// templates instructions pool
+	qSim_qinstruction_core_pool* get_pool()	{ return &m_pool; }
+
+	// diagnostics
+	int get_tot_templates()	{ return m_templates.size(); }
+
+private:
+	int m_totTemplates;
+	qSim_qinstruction_core_pool m_pool;
+	std::list<std::pair<QML_TEMPLATE_KEY_TYPE, std::list<qSim_qinstruction_core*>>> m_templates;
+};
+
+
 // -------------------------------------------------
 // QML q-instruction block class
 // -------------------------------------------------
@@ -59,6 +101,12 @@ public:
 	QASM_QML_ENTANG_TYPE m_fbent;
 	int m_fbsubtype;
 
+	// q-net gradient related - state expectation observable (as for expectation core instruction)
+	QREG_ST_INDEX_TYPE m_st_idx;
+	int m_q_idx;
+	int m_q_len;
+	QASM_EX_OBSOP_TYPE m_ex_obsOp;
+
 	// constructor and destructor
 	qSim_qinstruction_block_qml(qSim_qasm_message*);
 	virtual ~qSim_qinstruction_block_qml();
@@ -69,10 +117,13 @@ public:
 								QASM_QML_ENTANG_TYPE fbent, int fbsubtype,
 								QREG_F_ARGS_TYPE fargs=QREG_F_ARGS_TYPE());
 
-	// helper methods for specific block unwrapping into core instructions
-	void unwrap_block_fmap(std::list<qSim_qinstruction_core*>** qinstr_list,
+	// helper methods for specific block unwrapping into core instructions - instruction list
+	// template taken from (or built into) given cache, args list bound by position
+	void unwrap_block_fmap(qSim_qinstruction_block_qml_cache* qml_cache,
+						   std::list<qSim_qinstruction_core*>** qinstr_list,
 						   QREG_F_ARGS_TYPE* qinstr_list_fargs, bool verbose=false);
-	void unwrap_block_qnet(int n, std::list<qSim_qinstruction_core*>** qinstr_list,
+	void unwrap_block_qnet(qSim_qinstruction_block_qml_cache* qml_cache, int n,
+						   std::list<qSim_qinstruction_core*>** qinstr_list,
 						   QREG_F_ARGS_TYPE* qinstr_list_fargs, bool verbose=false);
 
 	// ... other blocks...
@@ -82,6 +133,14 @@ public:
 
 private:
 
+	// templates instructions pool - set while unwrapping
+	qSim_qinstruction_core_pool* m_pool;
+
+	// templates instruction creation - from the pool
+	template<typename... Args> qSim_qinstruction_core* new_qinstr(Args&&... args) {
+		return m_pool->acquire(std::forward<Args>(args)...);
+	}
+
 	// internal methods for transformation parameters semantic checks
 	bool check_params();
 
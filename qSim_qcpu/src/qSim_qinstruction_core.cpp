@@ -34,6 +34,12 @@
  *  1.0   Nov-2022   Module creation.
  *  1.1   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
+ *  1.2   Oct-2026   Handled 64-bit state index type.
+ *  1.3   Oct-2026   Handled qureg state measurement shots and random seed.
+ *  1.4   Oct-2026   Handled batched qureg allocation (samples number).
+ *  1.5   Oct-2026   Handled qureg clone and state snapshot/restore.
+ *  1.6   Oct-2026   Handled qureg state paged peek and top-k states peek.
+ *  1.7   Oct-2026   Added core instructions pool (instructions objects reused from chunks).
  *
  *  --------------------------------------------------------------------------
  */
@@ -44,6 +50,7 @@
 using namespace std;
 
 #include <string.h>
+#include <stdlib.h>
 
 #include "qSim_qinstruction_core.h"
 
@@ -75,12 +82,19 @@ qSim_qinstruction_core::qSim_qinstruction_core(qSim_qasm_message* msg) :
 		qSim_qinstruction_base(msg->get_id()) {
 	// initialise from given message
 	m_qn = 0;
+	m_sn = 1;
 	m_qr_h = 0;
+	m_qr_clH = 0;
 	m_st_array = QREG_ST_VAL_ARRAY_TYPE();
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_q_idx = 0;
 	m_q_len = 0;
 	m_rand = false;
 	m_coll = false;
+	m_shots = 0;
+	m_seed = -1;
 	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
 	m_ftype = QASM_F_TYPE_NULL;
 	m_fsize = 0;
@@ -97,14 +111,52 @@ qSim_qinstruction_core::qSim_qinstruction_core(qSim_qasm_message* msg) :
 		case QASM_MSG_ID_QREG_ALLOCATE: {
 			// qureg allocation message handling
 			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_QN, m_qn)
+
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_SN)) {
+				// batched qureg samples passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_SN, m_sn)
+			}
 		}
 		break;
 
 		case QASM_MSG_ID_QREG_RELEASE:
 		case QASM_MSG_ID_QREG_ST_RESET:
+		case QASM_MSG_ID_QREG_ST_SNAPSHOT:
+		case QASM_MSG_ID_QREG_ST_RESTORE: {
+			// qureg release or state reset or state snapshot/restore message handling
+			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_H, m_qr_h)
+		}
+		break;
+
 		case QASM_MSG_ID_QREG_ST_PEEK: {
-			// qureg release or state reset or state read message handling
+			// qureg state read message handling
 			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_H, m_qr_h)
+
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_STOFFS)) {
+				// states page first index passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_STATE_INDEX(QASM_MSG_PARAM_TAG_QREG_STOFFS, m_st_offs)
+			}
+
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_STCNT)) {
+				// states page size passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_STATE_INDEX(QASM_MSG_PARAM_TAG_QREG_STCNT, m_st_cnt)
+			}
+
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_STTOPK)) {
+				// most probable states number passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_STTOPK, m_st_topk)
+			}
+		}
+		break;
+
+		case QASM_MSG_ID_QREG_CLONE: {
+			// qureg clone message handling
+			SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_H, m_qr_h)
+
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_CLH)) {
+				// existing target qureg passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_CLH, m_qr_clH)
+			}
 		}
 		break;
 
@@ -149,6 +201,18 @@ qSim_qinstruction_core::qSim_qinstruction_core(qSim_qasm_message* msg) :
 				// measurement collapse state flag passed as argument (optional)
 				SAFE_MSG_GET_PARAM_AS_BOOL(QASM_MSG_PARAM_TAG_QREG_MCOLL, m_coll)
 			}
+
+			m_shots = 0; // single measure
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_MSHOTS)) {
+				// measurement shots passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_MSHOTS, m_shots)
+			}
+
+			m_seed = -1; // non-deterministic
+			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_MSEED)) {
+				// measurement shots random seed passed as argument (optional)
+				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_MSEED, m_seed)
+			}
 		}
 		break;
 
@@ -162,7 +226,7 @@ qSim_qinstruction_core::qSim_qinstruction_core(qSim_qasm_message* msg) :
 			m_st_idx = -1;
 			if (msg->check_param_valueByTag(QASM_MSG_PARAM_TAG_QREG_EXSTIDX)) {
 				// expectation qureg starting qubit passed as argument (optional)
-				SAFE_MSG_GET_PARAM_AS_INT(QASM_MSG_PARAM_TAG_QREG_EXSTIDX, m_st_idx)
+				SAFE_MSG_GET_PARAM_AS_STATE_INDEX(QASM_MSG_PARAM_TAG_QREG_EXSTIDX, m_st_idx)
 			}
 
 			m_q_idx = 0;
@@ -263,13 +327,14 @@ qSim_qinstruction_core::~qSim_qinstruction_core() {
 // -------------------------------------
 
 // other constructors - diagnostics
-qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h, int st_idx) :
+qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h, QREG_ST_INDEX_TYPE st_idx) :
 		qSim_qinstruction_base (type) {
 	// qureg allocate, release, reset, set (pure state), peek
 	m_type = type;
 	switch (m_type) {
 		case QASM_MSG_ID_QREG_ALLOCATE: {
 			m_qn = qr_h;
+			m_sn = 1;
 		}
 		break;
 
@@ -287,6 +352,7 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 			cerr << "qSim_qinstruction constructor for qreg allocate/reset/set/peek - unhandled qasm message type "
 				 << m_type << "!!" << endl;
 			m_qn = 0;
+			m_sn = 1;
 			m_qr_h = 0;
 		}
 	}
@@ -295,12 +361,18 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 	m_q_len = 0;
 	m_rand = false;
 	m_coll = false;
+	m_shots = 0;
+	m_seed = -1;
 	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
 	m_ftype = QASM_F_TYPE_NULL;
 	m_fsize = 0;
 	m_frep = 0;
 	m_flsq = 0;
 	m_futype = QASM_F_TYPE_NULL;
+	m_qr_clH = 0;
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_valid = true;
 }
 
@@ -321,6 +393,7 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 			cerr << "qSim_qinstruction constructor for qreg allocate/reset/set/peek - unhandled qasm message type "
 				 << m_type << "!!" << endl;
 			m_qn = 0;
+			m_sn = 1;
 			m_qr_h = 0;
 		}
 	}
@@ -330,17 +403,24 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 	m_st_idx = 0;
 	m_rand = false;
 	m_coll = false;
+	m_shots = 0;
+	m_seed = -1;
 	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
 	m_ftype = QASM_F_TYPE_NULL;
 	m_fsize = 0;
 	m_frep = 0;
 	m_flsq = 0;
 	m_futype = QASM_F_TYPE_NULL;
+	m_qr_clH = 0;
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_valid = true;
 }
 
 qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
-						 int q_idx, int q_len, bool rand, bool coll) : qSim_qinstruction_base (type) {
+						 int q_idx, int q_len, bool rand, bool coll,
+						 int shots, int seed) : qSim_qinstruction_base (type) {
 	// qureg measure
 	m_type = type;
 	switch (m_type) {
@@ -350,6 +430,8 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 			m_q_len = q_len;
 			m_rand = rand;
 			m_coll = coll;
+			m_shots = shots;
+			m_seed = seed;
 		}
 		break;
 
@@ -362,10 +444,13 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 			m_q_len = 0;
 			m_rand = false;
 			m_coll = false;
+			m_shots = 0;
+			m_seed = -1;
 		}
 	}
 
 	m_qn = 0;
+	m_sn = 1;
 	m_st_idx = 0;
 	m_st_array = QREG_ST_VAL_ARRAY_TYPE();
 	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
@@ -374,10 +459,14 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 	m_frep = 0;
 	m_flsq = 0;
 	m_futype = QASM_F_TYPE_NULL;
+	m_qr_clH = 0;
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_valid = true;
 }
 
-qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h, int st_idx,
+qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h, QREG_ST_INDEX_TYPE st_idx,
 						 int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_obsOp) : qSim_qinstruction_base (type) {
 	// qureg expectation
 	m_type = type;
@@ -404,14 +493,21 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 	}
 
 	m_qn = 0;
+	m_sn = 1;
 	m_rand = false;
 	m_coll = false;
+	m_shots = 0;
+	m_seed = -1;
 	m_st_array = QREG_ST_VAL_ARRAY_TYPE();
 	m_ftype = QASM_F_TYPE_NULL;
 	m_fsize = 0;
 	m_frep = 0;
 	m_flsq = 0;
 	m_futype = QASM_F_TYPE_NULL;
+	m_qr_clH = 0;
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_valid = true;
 }
 
@@ -423,13 +519,20 @@ qSim_qinstruction_core::qSim_qinstruction_core(QASM_MSG_ID_TYPE type, int qr_h,
 											   QREG_F_ARGS_TYPE fuargs) : qSim_qinstruction_base (type) {
 	// qureg state transformation
 	m_qn = 0;
+	m_sn = 1;
 	m_st_idx = 0;
 	m_st_array = QREG_ST_VAL_ARRAY_TYPE();
 	m_q_idx = 0;
 	m_q_len = 0;
 	m_rand = false;
 	m_coll = false;
+	m_shots = 0;
+	m_seed = -1;
 	m_ex_obsOp = QASM_EX_OBSOP_TYPE_COMP;
+	m_qr_clH = 0;
+	m_st_offs = 0;
+	m_st_cnt = 0;
+	m_st_topk = 0;
 	m_valid = true;
 	m_type = type;
 	switch (m_type) {
@@ -671,13 +774,29 @@ void qSim_qinstruction_core::dump() {
 	switch (m_type) {
 		case QASM_MSG_ID_QREG_ALLOCATE: {
 			cout << "m_qn: " << m_qn << endl;
+			cout << "m_sn: " << m_sn << endl;
 		}
 		break;
 
 		case QASM_MSG_ID_QREG_RELEASE:
 		case QASM_MSG_ID_QREG_ST_RESET:
+		case QASM_MSG_ID_QREG_ST_SNAPSHOT:
+		case QASM_MSG_ID_QREG_ST_RESTORE: {
+			cout << "m_qr_h: " << m_qr_h << endl;
+		}
+		break;
+
 		case QASM_MSG_ID_QREG_ST_PEEK: {
 			cout << "m_qr_h: " << m_qr_h << endl;
+			cout << "m_st_offs: " << m_st_offs << endl;
+			cout << "m_st_cnt: " << m_st_cnt << endl;
+			cout << "m_st_topk: " << m_st_topk << endl;
+		}
+		break;
+
+		case QASM_MSG_ID_QREG_CLONE: {
+			cout << "m_qr_h: " << m_qr_h << endl;
+			cout << "m_qr_clH: " << m_qr_clH << endl;
 		}
 		break;
 
@@ -694,6 +813,8 @@ void qSim_qinstruction_core::dump() {
 			cout << "m_q_len: " << m_q_len << endl;
 			cout << "m_rand: " << m_rand << endl;
 			cout << "m_coll: " << m_coll << endl;
+			cout << "m_shots: " << m_shots << endl;
+			cout << "m_seed: " << m_seed << endl;
 		}
 		break;
 
@@ -735,3 +856,35 @@ void qSim_qinstruction_core::dump() {
 	cout << endl;
 }
 
+
+/////////////////////////////////////////////////////////////////////////
+// core instructions pool class
+
+qSim_qinstruction_core_pool::qSim_qinstruction_core_pool() {
+	// no chunks - allocated on first use
+}
+
+qSim_qinstruction_core_pool::~qSim_qinstruction_core_pool() {
+	// release chunks
+	for (size_t c=0; c<m_chunks.size(); c++)
+		free(m_chunks[c]);
+}
+
+void* qSim_qinstruction_core_pool::get_slot() {
+	// take a free slot - new chunk slots added to the free list if none
+	if (m_free.empty()) {
+		char* chunk = (char*)malloc(QINSTR_POOL_CHUNK_SIZE * sizeof(qSim_qinstruction_core));
+		m_chunks.push_back(chunk);
+		for (int s=QINSTR_POOL_CHUNK_SIZE-1; s>=0; s--)
+			m_free.push_back(chunk + s*sizeof(qSim_qinstruction_core));
+	}
+	void* slot = m_free.back();
+	m_free.pop_back();
+	return slot;
+}
+
+void qSim_qinstruction_core_pool::release(qSim_qinstruction_core* qi) {
+	// destroy instruction in place and free its slot
+	qi->~qSim_qinstruction_core();
+	m_free.push_back(qi);
+}
@@ -35,6 +35,12 @@
  *  1.1   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
  *                   Handled QML function blocks (feature map and q-net).
+ *  1.2   Oct-2026   Handled 64-bit state index type.
+ *  1.3   Oct-2026   Handled qureg state measurement shots and random seed.
+ *  1.4   Oct-2026   Handled batched qureg allocation (samples number).
+ *  1.5   Oct-2026   Handled qureg clone and state snapshot/restore.
+ *  1.6   Oct-2026   Handled qureg state paged peek and top-k states peek.
+ *  1.7   Oct-2026   Added core instructions pool (instructions objects reused from chunks).
  *
  *  --------------------------------------------------------------------------
  */
@@ -43,6 +49,10 @@
 #define QSIM_QINSTRUCTION_CORE_H_
 
 
+#include <vector>
+#include <utility>
+#include <new>
+
 #include "qSim_qinstruction_base.h"
 
 
@@ -60,15 +70,24 @@ public:
 
 	// qureg handling related
 	int m_qn;
+	int m_sn;	// batched qureg samples (1 if not batched)
 	int m_qr_h;
-	int m_st_idx;
+	int m_qr_clH;	// clone target qureg (0 for a new qureg)
+	QREG_ST_INDEX_TYPE m_st_idx;
 	QREG_ST_VAL_ARRAY_TYPE m_st_array;
 
+	// qureg state peek related
+	QREG_ST_INDEX_TYPE m_st_offs;	// page first state index
+	QREG_ST_INDEX_TYPE m_st_cnt;	// page size (0 for the whole state vector)
+	int m_st_topk;					// k most probable states (0 if not requested)
+
 	// qureg state measure related
 	int m_q_idx;
 	int m_q_len;
 	bool m_rand;
 	bool m_coll;
+	int m_shots;	// sampled outcomes (0 for single measure)
+	int m_seed;		// shots random seed (-1 for non-deterministic)
 
 	// qureg state expectation related
 //	int m_q_idx;
@@ -95,10 +114,10 @@ public:
 	virtual ~qSim_qinstruction_core();
 
 	// other constructors
-	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, int st_idx=0); // allocate, reset, set (pure state), peek
+	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, QREG_ST_INDEX_TYPE st_idx=0); // allocate, reset, set (pure state), peek
 	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, QREG_ST_VAL_ARRAY_TYPE); // set (arbitrary state)
-	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, int, int, bool, bool); // measure
-	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, int, int, int, QASM_EX_OBSOP_TYPE); // expectation
+	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, int, int, bool, bool, int shots=0, int seed=-1); // measure
+	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, QREG_ST_INDEX_TYPE, int, int, QASM_EX_OBSOP_TYPE); // expectation
 	qSim_qinstruction_core(QASM_MSG_ID_TYPE, int qr_h, QASM_F_TYPE ftype, int fsize, int frep, int flsq,
 						   QREG_F_INDEX_RANGE_TYPE fcrng=QREG_F_INDEX_RANGE_TYPE(),
 						   QREG_F_INDEX_RANGE_TYPE ftrng=QREG_F_INDEX_RANGE_TYPE(),
@@ -133,6 +152,39 @@ private:
 
 };
 
+// -------------------------------------------------
+// core instructions pool - objects built in place on fixed size chunks slots, released
+// slots reused (no heap allocation per instruction once the chunks are there)
+// -------------------------------------------------
+
+#define QINSTR_POOL_CHUNK_SIZE 256 // instructions per chunk
+
+class qSim_qinstruction_core_pool {
+
+public:
+	// constructor and destructor - chunks freed (all instructions to be released before)
+	qSim_qinstruction_core_pool();
+	virtual ~qSim_qinstruction_core_pool();
+
+	// instruction creation on a free slot - same arguments as core instruction constructors
+	template<typename... Args> qSim_qinstruction_core* acquire(Args&&... args) {
+		return new (get_slot()) qSim_qinstruction_core(std::forward<Args>(args)...);
+	}
+
+	// instruction release - slot back to the free list
+	void release(qSim_qinstruction_core* qi);
+
+	// diagnostics
+	int get_tot_slots()	{ return m_chunks.size() * QINSTR_POOL_CHUNK_SIZE; }
+	int get_tot_free()	{ return m_free.size(); }
+
+private:
+	std::vector<void*> m_chunks;
+	std::vector<void*> m_free;
+
+	void* get_slot();
+};
+
 // ---------------------------------------------------------------
 // helper macros
 
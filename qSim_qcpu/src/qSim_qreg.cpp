@@ -48,6 +48,61 @@
  *  2.2   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
  *                   Handled QML function blocks (feature map and q-net).
+ *  2.3   Oct-2026   Handled state vector range partitioning on CPU device worker
+ *                   pool for probability and expectation reductions.
+ *  2.4   Oct-2026   Handled 64-bit state indexes and device function tables sized
+ *                   on qureg allocation (no max qureg size limit).
+ *  2.5   Oct-2026   Handled in-place mode with a single device register shared with
+ *                   host states, and host states allocated on first device->host sync.
+ *  2.6   Oct-2026   Handled gate fusion over unwrapped block instruction lists, applying
+ *                   consecutive gates within a small qubit span as dense unitaries.
+ *  2.7   Oct-2026   Supported core instruction lists execution (transformation batch).
+ *  2.8   Oct-2026   Supported state measurement shots, sampling outcomes by binary search
+ *                   on the cumulative marginal distribution calculated in a single pass.
+ *  2.9   Oct-2026   Handled state measure and expectation as single pass reductions on
+ *                   device states (no host sync), with sub-state marginals bucketed in one
+ *                   sweep and observable values taken from index bit counts (no kron vectors).
+ *  2.10  Oct-2026   Handled diagonal and permutation gates (and 1-qubit swap blocks) fast path,
+ *                   as well as fused unitaries with a single non-zero element per row, applied
+ *                   directly on device states.
+ *  2.11  Oct-2026   Handled controlled gates fast path on device bitmask engine, visiting
+ *                   only the states having all control bits set.
+ *  2.12  Oct-2026   Handled per-qureg device stream, created with the qureg and selected on
+ *                   each device call, so that transformations are enqueued with no wait and
+ *                   only state access, measure and expectation synchronise with the device.
+ *  2.13  Oct-2026   Handled state vector sharding across devices by the high-order qubits -
+ *                   gates applied on each shard as on a smaller qureg, with qubits placed on
+ *                   shard layout positions by a lazy qubits map (global qubits exchanged with
+ *                   local ones only when needed, with shard halves copied among devices), and
+ *                   reductions combined over shards.
+ *  2.14  Oct-2026   Handled state vector shards distributed on cluster nodes, with shard
+ *                   halves exchanged among nodes and node results reduced on all nodes.
+ *  2.15  Oct-2026   Handled batched quregs - samples of the same width stored contiguously
+ *                   (sample index on the high-order qubits), with shared gates applied once
+ *                   on all samples, QML blocks args given per sample (fused windows applied
+ *                   as batched dense unitaries, one matrix per sample) and measure and
+ *                   expectation returned per sample.
+ *  2.16  Oct-2026   Handled q-net gradient by the parameter-shift rule, each shifted q-net
+ *                   applied to the input state restored from a device snapshot.
+ *  2.17  Oct-2026   Handled qureg clone (device to device copy from a qureg of the same
+ *                   layout) and client state snapshot/restore, apart from the gradient one.
+ *  2.18  Oct-2026   Handled paged state peek, copying only the requested states slice from
+ *                   the device shards, and top-k states peek selected on device on each
+ *                   shard, with shard (and node) candidates merged on host.
+ *  2.19  Oct-2026   Collected device kernels statistics by gate function type (fused dense
+ *                   unitaries apart) and host/device state copies statistics.
+ *  2.20  Oct-2026   Unwrapped QML blocks on the templates cache of the qcpu lane (own cache
+ *                   if none set), in place of the single global instruction lists.
+ *  2.21  Oct-2026   Handled SWAP blocks as qubits placement changes only, swapped qubits moved
+ *                   by the following functions placing their spans and results taken in
+ *                   qubits order (layout restored before host states synchronisation).
+ *  2.22  Oct-2026   Handled controlled gates of any width on sharded (and distributed) quregs,
+ *                   placing only their target qubits on local positions and resolving the
+ *                   controls on global positions per shard (shards failing them skipped).
+ *                   Checked instruction lists as a whole before applying them (block
+ *                   transformations failing with no instruction applied).
+ *  2.23  Oct-2026   Handled device and host states allocation failures - qureg reported as
+ *                   not allocated by the constructor, host states access failing.
  *
  *  --------------------------------------------------------------------------
  */
@@ -55,15 +110,19 @@
 
 #include <algorithm>
 #include <iostream>
+#include <numeric>
 #include <complex>
+#include <cmath>
 #include <list>
 #include <vector>
+#include <new>
 using namespace std;
 
 #include <string.h>
 
 #include "qSim_qasm.h"
 #include "qSim_qreg.h"
+#include "qSim_qstats.h"
 
 #ifdef __QSIM_CPU__
 #include "qSim_qcpu_device_CPU.h"
@@ -76,22 +135,132 @@ using namespace std;
 // measure max index vector size allowed - due to performance reasons
 #define MEASURE_MAX_INDEX_VEC_SIZE 10
 
+// paged peek max states per page
+#define PEEK_MAX_PAGE_STATES (1 << 16)
+
+// measure max shots per request
+#define MEASURE_MAX_SHOTS (1 << 24)
+
+// gate fusion max width of fused unitaries - in qubits
+#define QREG_FUSION_MAX_QUBITS 4
+#if QREG_FUSION_MAX_QUBITS > QDEV_F_DENSE_MAX_QUBITS
+#error "gate fusion width exceeds device dense unitary limit"
+#endif
+
+// state vector sharding min local qubits per shard - shards number reduced down to keep
+// each shard at least this size (widest function instance applied on sharded quregs)
+#define QREG_SHARD_MIN_LOCAL_QUBITS 8
+
 /////////////////////////////////////////////////////////////////////////
 // qreg class definition
 
-qSim_qreg::qSim_qreg(int qn, qSim_qcpu_device* qcpu_dev, bool verbose) {
-	// initialise state array (raw values)
+qSim_qreg::qSim_qreg(int qn, qSim_qcpu_device* qcpu_dev, bool verbose, bool in_place, int shard_n, int dev_n,
+					 qSim_qcpu_node* qnode, int s_n) {
+	// QML block templates - own cache until a shared one is set
+	m_qmlCache = &m_qmlCacheOwn;
+
+	// batched qureg samples - sample index on the high-order qubits added to the given ones,
+	// not sharded nor distributed
+	m_totSamples = std::max(1, s_n);
+	m_sampleQubits = qn;
+	m_sampleStates = (QREG_ST_INDEX_TYPE)1 << qn;
+	if (m_totSamples > 1) {
+		if ((shard_n > 1) || ((qnode != NULL) && qnode->is_cluster()))
+			cerr << "WARNING!! qreg - batched qureg not sharded nor distributed - using a single shard" << endl;
+		shard_n = 1;
+		qnode = NULL;
+		while (((QREG_ST_INDEX_TYPE)1 << (qn - m_sampleQubits)) < (QREG_ST_INDEX_TYPE)m_totSamples)
+			qn++;
+	}
+
+	// initialise state array size
 	m_totQubits = qn;
-	m_totStates = pow(2, qn);
-	m_states_x = new QREG_ST_RAW_VAL_TYPE[m_totStates];
+	m_totStates = (QREG_ST_INDEX_TYPE)1 << qn;
 
 	// store qCpu CUDA instance
 	m_qcpu_device = qcpu_dev;
 
-	// setup device registers from class states (same initial states for both)
-	m_qcpu_device->dev_qreg_host2device(&m_devStates_x, m_states_x, m_totStates);
-	m_qcpu_device->dev_qreg_host2device(&m_devStates_y, m_states_x, m_totStates);
-	m_syncFlag = true;
+	// cluster nodes slices - highest qubits selecting the node, if each slice keeps the min
+	// local qubits (qureg replicated on all nodes otherwise)
+	int nd_n = 1;
+	int nd_qn = 0;
+	m_qnode = NULL;
+	if ((qnode != NULL) && qnode->is_cluster()) {
+		while (nd_n < qnode->get_tot_nodes()) {
+			nd_n *= 2;
+			nd_qn++;
+		}
+		if (qn - nd_qn >= QREG_SHARD_MIN_LOCAL_QUBITS)
+			m_qnode = qnode;
+		else {
+			nd_n = 1;
+			nd_qn = 0;
+		}
+	}
+
+	// state vector shards - power of 2 within the requested number, each one keeping the
+	// min local qubits, and assigned to devices round-robin (by node slice first shard)
+	int sh_n = 1;
+	int sh_qn = 0;
+	while ((2*sh_n <= shard_n) && (qn - nd_qn - sh_qn - 1 >= QREG_SHARD_MIN_LOCAL_QUBITS)) {
+		sh_n *= 2;
+		sh_qn++;
+	}
+	m_shardQubits = qn - nd_qn - sh_qn;
+	m_shardStates = (QREG_ST_INDEX_TYPE)1 << m_shardQubits;
+	m_shardBase = (m_qnode != NULL) ? m_qnode->get_rank()*sh_n : 0;
+	m_totShards = sh_n*nd_n;
+	m_shards.resize(sh_n);
+	for (int sh=0; sh<sh_n; sh++)
+		m_shards[sh].m_devId = (m_shardBase + sh) % std::max(1, dev_n);
+
+	// qubits placement - identity (each qubit on its own position)
+	m_qubitPos.resize(qn);
+	m_qubitAt.resize(qn);
+	shard_reset_layout();
+
+	// create shard device streams - default device stream used on failure
+	for (int sh=0; sh<sh_n; sh++) {
+		m_qcpu_device->dev_gpu_select(m_shards[sh].m_devId);
+		if (m_qcpu_device->dev_qreg_stream_create(&m_shards[sh].m_devStream) != QDEV_RES_OK)
+			cerr << "WARNING!! qreg - device stream creation failed - using default device stream" << endl;
+	}
+
+	// size device function tables for this qureg
+	if (m_qcpu_device->dev_qreg_function_tables_reserve(qn) != QDEV_RES_OK)
+		cerr << "ERROR!! qreg - device function tables allocation failed for qureg size: " << qn << endl;
+
+	// in-place mode - single device register, if supported by device and not sharded (shards
+	// exchanges staged on the second device register)
+	m_inPlace = in_place && m_qcpu_device->dev_qreg_inplace_supported() && (m_totShards == 1);
+	if (in_place && !m_inPlace)
+		cerr << "WARNING!! qreg - in-place mode not supported by device or sharded qureg - using double device register" << endl;
+
+	// setup device registers - host states allocated on first device->host sync, registers
+	// allocated on failure released by the destructor (failure agreed by all nodes)
+	m_states_x = NULL;
+	m_allocFlag = true;
+	for (int sh=0; sh<sh_n; sh++) {
+		qSim_qreg_shard* q_sh = &m_shards[sh];
+		q_sh->m_devStates_y = NULL;
+		if (device(sh)->dev_qreg_device_alloc(&q_sh->m_devStates_x, m_shardStates) != QDEV_RES_OK)
+			m_allocFlag = false;
+		else if (m_inPlace)
+			q_sh->m_devStates_y = q_sh->m_devStates_x;
+		else if (device(sh)->dev_qreg_device_alloc(&q_sh->m_devStates_y, m_shardStates) != QDEV_RES_OK)
+			m_allocFlag = false;
+	}
+	if (m_qnode != NULL) {
+		double alloc_err = m_allocFlag ? 0.0 : 1.0;
+		m_qnode->allreduce_sum(&alloc_err, 1);
+		m_allocFlag = (alloc_err == 0.0);
+	}
+	if (!m_allocFlag)
+		cerr << "ERROR!! qreg - device states allocation failed for qureg size: " << qn << endl;
+	m_syncFlag = false;
+	if (m_totShards > 1)
+		cout << "qreg - state vector sharded - shards: " << m_totShards << " local qubits: " << m_shardQubits
+			 << " nodes: " << nd_n << endl;
 
 	// set observable type arrays
 	m_obs_ev_map[QASM_EX_OBSOP_TYPE_COMP] = {1.0, 1.0};
@@ -100,24 +269,44 @@ qSim_qreg::qSim_qreg(int qn, qSim_qcpu_device* qcpu_dev, bool verbose) {
 	// store verbose flag setting
 	m_verbose = verbose;
 
-	// set qreg in ground state
-	resetState();
+	// gate fusion helper qureg - created on first use
+	m_fusionQreg = NULL;
+
+	// measurement shots random generator - non-deterministic default seed
+	m_rng.seed(std::random_device()());
+
+	// set qreg in ground state - if allocated
+	if (m_allocFlag)
+		resetState();
 }
 
 qSim_qreg::~qSim_qreg() {
-	// release memory on device first
-	m_qcpu_device->dev_qreg_device_release(m_devStates_x);
-	m_qcpu_device->dev_qreg_device_release(m_devStates_y);
-
-	// release memory on class
-	delete m_states_x;
+	// release gate fusion helper qureg
+	delete m_fusionQreg;
+
+	// release state snapshots - if allocated
+	snapshotRelease(&m_snap);
+	snapshotRelease(&m_gradSnap);
+
+	// release memory on class - if allocated and not shared with device
+	if ((m_states_x != NULL) && (m_states_x != m_shards[0].m_devStates_x))
+		delete[] m_states_x;
+
+	// release memory on devices and device streams - pending work completed
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		qSim_qreg_shard* q_sh = &m_shards[sh];
+		device(sh)->dev_qreg_device_release(q_sh->m_devStates_x);
+		if (q_sh->m_devStates_y != q_sh->m_devStates_x)
+			m_qcpu_device->dev_qreg_device_release(q_sh->m_devStates_y);
+		m_qcpu_device->dev_qreg_stream_release(q_sh->m_devStream);
+	}
 }
 
 // -------------------------------------
 
 bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str) {
 	// handle instruction execution based on instruction type and return response
-	// for qureg state reset / set / transform instructions
+	// for qureg state reset / set / transform / snapshot / restore instructions
 
 	bool res;
 	switch (qr_instr->m_type) {
@@ -169,6 +358,22 @@ bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::stri
 		}
 		break;
 
+		case QASM_MSG_ID_QREG_ST_SNAPSHOT: {
+			// snapshot current state (device copy)
+			res = stateSnapshot(&m_snap);
+			if (!res)
+				*res_str = "stateSnapshot generic error";
+		}
+		break;
+
+		case QASM_MSG_ID_QREG_ST_RESTORE: {
+			// restore last snapshot state (device copy) - the snapshot is kept for further restores
+			res = stateRestore(&m_snap);
+			if (!res)
+				*res_str = "stateRestore error - no snapshot taken";
+		}
+		break;
+
 		default: {
 			res = false;
 		}
@@ -219,7 +424,7 @@ bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::stri
 	switch (qr_instr->m_type) {
 		case QASM_MSG_ID_QREG_ST_EXPECT: {
 			// extract arguments
-			int st_idx = qr_instr->m_st_idx;
+			QREG_ST_INDEX_TYPE st_idx = qr_instr->m_st_idx;
 			int q_idx = qr_instr->m_q_idx;
 			int q_len = qr_instr->m_q_len;
 			QASM_EX_OBSOP_TYPE ex_opsOp = qr_instr->m_ex_obsOp;
@@ -242,18 +447,141 @@ bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::stri
 
 // -------------------------------------
 
+bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str,
+									 QREG_ST_INDEX_ARRAY_TYPE* m_counts) {
+	// handle instruction execution based on instruction type and return response
+	// for qureg state measurement shots instruction
+
+	bool res;
+	switch (qr_instr->m_type) {
+		case QASM_MSG_ID_QREG_ST_MEASURE: {
+			// extract arguments
+			int q_idx = qr_instr->m_q_idx;
+			int q_len = qr_instr->m_q_len;
+			int shots = qr_instr->m_shots;
+			int seed = qr_instr->m_seed;
+
+			// apply to qureg
+			res = stateMeasureShots(q_idx, q_len, shots, seed, m_counts);
+			if (!res)
+				*res_str = "stateMeasureShots generic error";
+		}
+		break;
+
+		default: {
+			res = false;
+		}
+	}
+
+	return res;
+}
+
+// -------------------------------------
+
+bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str,
+									 QREG_ST_INDEX_ARRAY_TYPE* m_sts, std::vector<double>* m_prs) {
+	// handle instruction execution based on instruction type and return response
+	// for batched qureg state measurement instruction
+
+	bool res;
+	switch (qr_instr->m_type) {
+		case QASM_MSG_ID_QREG_ST_MEASURE: {
+			// extract arguments
+			int q_idx = qr_instr->m_q_idx;
+			int q_len = qr_instr->m_q_len;
+			bool m_rand = qr_instr->m_rand;
+			bool m_coll = qr_instr->m_coll;
+
+			// apply to qureg
+			res = stateMeasureBatch(q_idx, q_len, m_rand, m_coll, m_sts, m_prs);
+			if (!res)
+				*res_str = "stateMeasure batched generic error";
+		}
+		break;
+
+		default: {
+			res = false;
+		}
+	}
+
+	return res;
+}
+
+// -------------------------------------
+
+bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str,
+									 std::vector<double>* m_exps) {
+	// handle instruction execution based on instruction type and return response
+	// for batched qureg state expectation instruction
+
+	bool res;
+	switch (qr_instr->m_type) {
+		case QASM_MSG_ID_QREG_ST_EXPECT: {
+			// extract arguments
+			QREG_ST_INDEX_TYPE st_idx = qr_instr->m_st_idx;
+			int q_idx = qr_instr->m_q_idx;
+			int q_len = qr_instr->m_q_len;
+			QASM_EX_OBSOP_TYPE ex_opsOp = qr_instr->m_ex_obsOp;
+
+			// apply to qureg
+			res = stateExpectationBatch(st_idx, q_idx, q_len, ex_opsOp, m_exps);
+			if (!res)
+				*res_str = "stateExpectation batched generic error";
+		}
+		break;
+
+		default: {
+			res = false;
+		}
+	}
+
+	return res;
+}
+
+// -------------------------------------
+
 bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str,
 		                             QREG_ST_VAL_ARRAY_TYPE* st_array) {
 	// handle instruction execution based on instruction type and return response
 	// for qureg state peek instruction
 
+	bool res;
+	switch (qr_instr->m_type) {
+		case QASM_MSG_ID_QREG_ST_PEEK: {
+			// apply to qureg - states page if page params given, whole state vector otherwise
+			if ((qr_instr->m_st_offs != 0) || (qr_instr->m_st_cnt != 0)) {
+				res = getStatesPage(qr_instr->m_st_offs, qr_instr->m_st_cnt, st_array);
+				if (!res)
+					*res_str = "peekState page error - wrong states range";
+			}
+			else {
+				res = getStates(st_array);
+				if (!res)
+					*res_str = "peekState generic error";
+			}
+		}
+		break;
+
+		default: {
+			res = false;
+		}
+	}
+
+	return res;
+}
+
+bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* res_str,
+		                             QREG_ST_VAL_ARRAY_TYPE* st_array, QREG_ST_INDEX_ARRAY_TYPE* idx_array) {
+	// handle instruction execution based on instruction type and return response
+	// for qureg top-k states peek instruction
+
 	bool res;
 	switch (qr_instr->m_type) {
 		case QASM_MSG_ID_QREG_ST_PEEK: {
 			// apply to qureg
-			res = getStates(st_array);
+			res = getStatesTopK(qr_instr->m_st_topk, idx_array, st_array);
 			if (!res)
-				*res_str = "peekState generic error";
+				*res_str = "peekState top-k error - wrong states number";
 		}
 		break;
 
@@ -270,7 +598,7 @@ bool qSim_qreg::applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::stri
 
 bool qSim_qreg::applyBlockInstruction(qSim_qinstruction_block* qr_instr, std::string* res_str) {
 	// handle block instruction execution based on instruction type and return response
-	// for qureg state reset / set / transform instructions
+	// for qureg state reset / set / transform / snapshot / restore instructions
 
 	bool res;
 	switch (qr_instr->m_type) {
@@ -280,6 +608,39 @@ bool qSim_qreg::applyBlockInstruction(qSim_qinstruction_block* qr_instr, std::st
 
 			// extract arguments
 			QASM_F_TYPE ftype = qr_instr->m_ftype;
+
+			// swap blocks - qubits placement change only (no states moved), unwrapped if out
+			// of the qureg qubits (same errors)
+			if (((ftype == QASM_FB_TYPE_Q1_SWAP) || (ftype == QASM_FB_TYPE_QN_SWAP)) && swap_block_layout(qr_instr)) {
+				res = true;
+				break;
+			}
+
+			// 1-qubit swap and c-swap blocks - fast path first, as a (controlled) swap U-gate
+			// (unsharded and not distributed state vector only, sharded ones placing the unwrapped
+			// core instructions) => block qubits placed on their own layout positions
+			if (((ftype == QASM_FB_TYPE_Q1_SWAP) || (ftype == QASM_FB_TYPE_Q1_CSWAP)) && (m_totShards == 1)) {
+				int frep = qr_instr->m_frep;
+				int fform = QASM_F_FORM_NULL;
+				int fgapn = 0;
+				if (ftype == QASM_FB_TYPE_Q1_CSWAP) {
+					frep = 1; // as per c-swap unwrap
+					fform = (qr_instr->m_fcrng.m_start > qr_instr->m_ftrng.m_stop) ? QASM_F_FORM_DIRECT : QASM_F_FORM_INVERSE;
+					if (fform == QASM_F_FORM_DIRECT)
+						fgapn = qr_instr->m_fcrng.m_start - qr_instr->m_ftrng.m_stop - 1;
+					else
+						fgapn = qr_instr->m_ftrng.m_start - qr_instr->m_fcrng.m_stop - 1;
+				}
+				int p_lsq = shard_place_span(qr_instr->m_flsq, (ftype == QASM_FB_TYPE_Q1_SWAP) ? 2*frep : (int)log2(qr_instr->m_fsize));
+				int ret = transform_fast(0, ftype, qr_instr->m_fsize, frep, p_lsq, fform, fgapn,
+										 QASM_F_TYPE_NULL, 0, QASM_F_FORM_NULL, &(qr_instr->m_fargs));
+				if (ret != QDEV_RES_NOT_APPLIED) {
+					res = (ret == QDEV_RES_OK);
+					if (!res)
+						*res_str = "block stateTransform generic error";
+					break;
+				}
+			}
 //
 			// translate into core instructions
 			std::list<qSim_qinstruction_core*> qinstr_list;
@@ -315,7 +676,7 @@ bool qSim_qreg::applyBlockInstruction(qSim_qinstruction_block* qr_instr, std::st
 				cout << "applyBlockInstruction...qinstr_list.size: " << qinstr_list.size() << endl;
 
 			// apply to qureg
-			apply_instruction_and_release(&qinstr_list, qr_instr->m_fargs, &res, res_str);
+			apply_instruction_and_release(&qinstr_list, &(qr_instr->m_fargs), &res, res_str);
 		}
 		break;
 
@@ -327,6 +688,35 @@ bool qSim_qreg::applyBlockInstruction(qSim_qinstruction_block* qr_instr, std::st
 	return res;
 }
 
+bool qSim_qreg::swap_block_layout(qSim_qinstruction_block* qr_instr) {
+	// swap block as qubits placement change - swapped qubits pairs exchanging their layout
+	// positions, moved on device by the following functions placing them (if needed)
+	// => false if the block is out of the qureg (sample) qubits
+	int flsq = qr_instr->m_flsq;
+	if (qr_instr->m_ftype == QASM_FB_TYPE_Q1_SWAP) {
+		// adjacent qubits pair on each repetition
+		int frep = qr_instr->m_frep;
+		if ((flsq < 0) || (frep < 1) || (flsq + 2*frep > m_sampleQubits))
+			return false;
+		for (int r=0; r<frep; r++)
+			shard_layout_swap(flsq + 2*r, flsq + 2*r + 1);
+	}
+	else {
+		// two adjacent sub-quregs, i-th qubits swapped (as per swap unwrap)
+		int qsw_n = log2(qr_instr->m_fsize)/2;
+		if ((flsq < 0) || (qsw_n < 1) || (flsq + 2*qsw_n > m_sampleQubits))
+			return false;
+		for (int i=0; i<qsw_n; i++)
+			shard_layout_swap(flsq + i, flsq + qsw_n + i);
+	}
+	if (m_verbose)
+		cout << "qSim_qreg::swap_block_layout - ftype: " << qr_instr->m_ftype << " flsq: " << flsq << endl;
+
+	// host states no longer in qubits order
+	m_syncFlag = false;
+	return true;
+}
+
 // -------------------------------------
 // -------------------------------------
 
@@ -347,32 +737,135 @@ bool qSim_qreg::applyBlockInstructionQml(qSim_qinstruction_block_qml* qr_instr,
 			// extract arguments
 			QASM_F_TYPE ftype = qr_instr->m_ftype;
 
-			// translate into core instructions
-			std::list<qSim_qinstruction_core*>* qinstr_list;
-			QREG_F_ARGS_TYPE qinstr_list_fargs;
-			switch (ftype) {
-				case QASM_FBQML_TYPE_FMAP: {
-					qr_instr->unwrap_block_fmap(&qinstr_list, &qinstr_list_fargs, m_verbose);
-				}
-				break;
-
-				case QASM_FBQML_TYPE_QNET: {
-					qr_instr->unwrap_block_qnet(m_totQubits, &qinstr_list, &qinstr_list_fargs, m_verbose);
-				}
+			if ((ftype != QASM_FBQML_TYPE_FMAP) && (ftype != QASM_FBQML_TYPE_QNET)) {
+				// error case
+				cerr << "qSim_qreg::applyBlockInstructionQml - unhandled function block type ["
+					 << ftype << "]!!" << endl;
+				res = false;
+				*res_str = "block stateTransform generic error";
 				break;
+			}
 
-				default: {
-					// error case
-					cerr << "qSim_qreg::applyBlockInstructionQml - unhandled function block type ["
-						 << ftype << "]!!" << endl;
+			// batched qureg - block args as a samples x params matrix (sample-major), each
+			// sample row unwrapped on its own (same instruction list, taken from cache) giving
+			// the per-sample instruction list args
+			int s_n = (m_totSamples > 1) ? m_totSamples : 0;
+			std::vector<QREG_F_ARGS_TYPE> s_fargs(s_n);
+			QREG_F_ARGS_TYPE b_fargs;
+			if (s_n > 0) {
+				if ((qr_instr->m_fargs.size() % s_n) != 0) {
+					cerr << "qSim_qreg::applyBlockInstructionQml - block args [" << qr_instr->m_fargs.size()
+						 << "] not matching batched qureg samples [" << s_n << "]!!" << endl;
 					res = false;
+					*res_str = "block args not matching batched qureg samples";
+					break;
 				}
+				b_fargs.swap(qr_instr->m_fargs);
+			}
+			size_t p_n = b_fargs.size() / std::max(1, s_n);
+
+			// translate into core instructions
+			std::list<qSim_qinstruction_core*>* qinstr_list = NULL;
+			QREG_F_ARGS_TYPE qinstr_list_fargs;
+			for (int k=0; k<std::max(1, s_n); k++) {
+				if (s_n > 0)
+					qr_instr->m_fargs.assign(b_fargs.begin() + k*p_n, b_fargs.begin() + (k+1)*p_n);
+				if (ftype == QASM_FBQML_TYPE_FMAP)
+					qr_instr->unwrap_block_fmap(m_qmlCache, &qinstr_list, &qinstr_list_fargs, m_verbose);
+				else
+					qr_instr->unwrap_block_qnet(m_qmlCache, m_sampleQubits, &qinstr_list, &qinstr_list_fargs, m_verbose);
+				if (s_n > 0)
+					s_fargs[k].swap(qinstr_list_fargs);
 			}
+			if (s_n > 0)
+				qr_instr->m_fargs.swap(b_fargs);
 			if (m_verbose)
 				cout << "applyBlockInstruction...qinstr_list.size: " << qinstr_list->size() << endl;
 
 			// apply to qureg - no release (caching applied)!
-			apply_instruction_and_release(qinstr_list, qinstr_list_fargs, &res, res_str, false);
+			if (s_n > 0)
+				apply_instruction_and_release(qinstr_list, &s_fargs[0], &res, res_str, false, &s_fargs);
+			else
+				apply_instruction_and_release(qinstr_list, &qinstr_list_fargs, &res, res_str, false);
+		}
+		break;
+
+		default: {
+			res = false;
+		}
+	}
+
+	return res;
+}
+
+// -------------------------------------
+
+bool qSim_qreg::applyBlockInstructionQml(qSim_qinstruction_block_qml* qr_instr, std::string* res_str,
+										 double* m_exp, std::vector<double>* m_grad) {
+	// handle QML block instruction execution based on instruction type and return response
+	// for q-net gradient instruction
+	// => parameter-shift rule - each q-net param used by a single rotation gate, its derivative
+	//    being half the difference of the expectations with the param shifted by +/- pi/2
+	// => shifted q-nets applied to the input state restored from a device snapshot, the
+	//    qureg left in the q-net output state (not shifted params) as for a q-net block
+
+	bool res;
+	switch (qr_instr->m_type) {
+		case QASM_MSG_ID_QREG_ST_GRADIENT: {
+			// extract arguments
+			QREG_ST_INDEX_TYPE st_idx = qr_instr->m_st_idx;
+			int q_idx = qr_instr->m_q_idx;
+			int q_len = qr_instr->m_q_len;
+			QASM_EX_OBSOP_TYPE ex_opsOp = qr_instr->m_ex_obsOp;
+
+			// sanity checks - single sample qureg, one param per q-net rotation gate
+			if (m_totSamples > 1) {
+				cerr << "qSim_qreg::applyBlockInstructionQml - gradient not supported on batched quregs!!" << endl;
+				res = false;
+				*res_str = "gradient not supported on batched quregs";
+				break;
+			}
+			if (qr_instr->m_fargs.size() != m_totQubits*(qr_instr->m_frep + 1)) {
+				cerr << "qSim_qreg::applyBlockInstructionQml - q-net params [" << qr_instr->m_fargs.size()
+					 << "] not matching qureg size and repetitions!!" << endl;
+				res = false;
+				*res_str = "q-net params not matching qureg size";
+				break;
+			}
+
+			// translate into core instructions
+			std::list<qSim_qinstruction_core*>* qinstr_list = NULL;
+			QREG_F_ARGS_TYPE qinstr_list_fargs;
+			qr_instr->unwrap_block_qnet(m_qmlCache, m_totQubits, &qinstr_list, &qinstr_list_fargs, m_verbose);
+
+			// input state snapshot and shifted q-nets expectations
+			size_t p_n = qinstr_list_fargs.size();
+			m_grad->assign(p_n, 0.0);
+			res = stateSnapshot(&m_gradSnap);
+			QREG_F_ARGS_TYPE s_fargs = qinstr_list_fargs;
+			for (size_t p=0; (p<p_n) && res; p++) {
+				double s_exp[2] = {0.0, 0.0};
+				for (int s=0; (s<2) && res; s++) {
+					s_fargs[p].m_d = qinstr_list_fargs[p].m_d + ((s == 0) ? M_PI_2 : -M_PI_2);
+					res = stateRestore(&m_gradSnap);
+					if (res)
+						apply_instruction_and_release(qinstr_list, &s_fargs, &res, res_str, false);
+					if (res)
+						res = stateExpectation(st_idx, q_idx, q_len, ex_opsOp, &s_exp[s]);
+				}
+				s_fargs[p] = qinstr_list_fargs[p];
+				(*m_grad)[p] = (s_exp[0] - s_exp[1]) / 2.0;
+			}
+
+			// q-net on the input state - no release (caching applied)!
+			if (res)
+				res = stateRestore(&m_gradSnap);
+			if (res)
+				apply_instruction_and_release(qinstr_list, &qinstr_list_fargs, &res, res_str, false);
+			if (res)
+				res = stateExpectation(st_idx, q_idx, q_len, ex_opsOp, m_exp);
+			if (!res)
+				*res_str = "q-net gradient generic error";
 		}
 		break;
 
@@ -387,35 +880,211 @@ bool qSim_qreg::applyBlockInstructionQml(qSim_qinstruction_block_qml* qr_instr,
 // -------------------------------------
 // -------------------------------------
 
+bool qSim_qreg::applyCoreInstructionList(std::list<qSim_qinstruction_core*>* qr_instr_list, std::string* res_str) {
+	// handle core transformation instruction list execution (batch case) - instruction own fargs
+	// used and no release (objects owned by caller)
+	bool res;
+	apply_instruction_and_release(qr_instr_list, NULL, &res, res_str, false);
+	if (!res)
+		*res_str = "core instruction list stateTransform generic error";
+	return res;
+}
+
+// -------------------------------------
+// -------------------------------------
+
 void qSim_qreg::apply_instruction_and_release(std::list<qSim_qinstruction_core*>* qinstr_list,
-		QREG_F_ARGS_TYPE fargs, bool* res, std::string* res_str, bool do_release) {
+		QREG_F_ARGS_TYPE* fargs, bool* res, std::string* res_str, bool do_release,
+		std::vector<QREG_F_ARGS_TYPE>* s_fargs) {
 	// apply to qureg using given fargs - overriding those used for q-instruction creation
+	// (instruction own fargs used if none given)
+	// => gate repetitions split into single items and consecutive items spanning up to
+	//    QREG_FUSION_MAX_QUBITS contiguous qubits fused into a single dense unitary
+	// => batched qureg per-sample fargs (if given, same layout as fargs) - fused windows
+	//    having items with args applied as one dense unitary per sample
+	std::vector<qSim_qreg_fusion_item> items;
 	int i = 0;
 	for (std::list<qSim_qinstruction_core*>::iterator it = qinstr_list->begin(); it != qinstr_list->end(); ++it) {
 //		cout << "apply...f_type: " << (*it)->m_ftype << endl;
 //		DUMP_FARGS((*it));
-    	QREG_F_ARGS_TYPE fargs_i;
-    	if ((*it)->m_fargs.size() > 0) {
-    		fargs_i.push_back(fargs[i]);
-    		i++;
-    	}
-		(*res) = transform((*it)->m_ftype, (*it)->m_fsize, (*it)->m_frep, (*it)->m_flsq,
-				        (*it)->m_fcrng, (*it)->m_ftrng, fargs_i,
-						(*it)->m_futype, (*it)->m_fucrng, (*it)->m_futrng, (*it)->m_fuargs);
-		if (!(*res)) {
-			*res_str = "block stateTransform generic error";
-			break;
+		QREG_F_ARGS_TYPE fargs_i;
+		int fidx = -1;
+		if (fargs == NULL)
+			fargs_i = (*it)->m_fargs;
+		else if ((*it)->m_fargs.size() > 0) {
+			fargs_i.push_back((*fargs)[i]);
+			fidx = i;
+			i++;
+		}
+
+		QASM_F_TYPE ftype = (*it)->m_ftype;
+		int fn = log2((*it)->m_fsize);
+		bool fusable = (QASM_F_TYPE_IS_GATE_1QUBIT(ftype) || QASM_F_TYPE_IS_GATE_2QUBIT(ftype) ||
+				        QASM_F_TYPE_IS_GATE_NQUBIT(ftype)) &&
+					   (fn <= QREG_FUSION_MAX_QUBITS) && ((*it)->m_frep > 0) && ((*it)->m_flsq >= 0) &&
+					   ((*it)->m_flsq + fn*(*it)->m_frep <= m_sampleQubits);
+		if (fusable) {
+			for (int r=0; r<(*it)->m_frep; r++)
+				items.push_back({*it, fargs_i, (*it)->m_flsq + fn*r, fn, fidx});
+		}
+		else
+			items.push_back({*it, fargs_i, (*it)->m_flsq, 0, fidx});
+	}
+
+	// check all items first - none applied if any of them cannot be, so that the instruction
+	// list (block) transformation fails as a whole
+	(*res) = true;
+	for (unsigned int k=0; (k<items.size()) && (*res); k++) {
+		qSim_qreg_fusion_item* item = &items[k];
+		qSim_qinstruction_core* qi = item->m_instr;
+		(*res) = transform_check(qi->m_ftype, qi->m_fsize, (item->m_fn > 0) ? 1 : qi->m_frep, item->m_flsq);
+		if ((*res) && (s_fargs != NULL) && (item->m_fn == 0) && (item->m_fidx >= 0)) {
+			// not fusable with per-sample args - not supported on batched quregs
+			cerr << "qSim_qreg::apply_instruction - per-sample args on not fusable instruction [ftype: "
+				 << qi->m_ftype << "]!!" << endl;
+			(*res) = false;
+		}
+	}
+
+	// apply items - collecting fusion windows
+	std::vector<qSim_qreg_fusion_item> w_items;
+	int w_lo = 0;
+	int w_hi = -1;
+	for (unsigned int k=0; (k<items.size()) && (*res); k++) {
+		qSim_qreg_fusion_item* item = &items[k];
+		if ((item->m_fn > 0) && (w_items.size() > 0)) {
+			// try extending current window
+			int lo = std::min(w_lo, item->m_flsq);
+			int hi = std::max(w_hi, item->m_flsq + item->m_fn - 1);
+			if (hi - lo + 1 <= QREG_FUSION_MAX_QUBITS) {
+				w_items.push_back(*item);
+				w_lo = lo;
+				w_hi = hi;
+				continue;
+			}
+		}
+
+		// flush current window
+		if (w_items.size() > 0) {
+			(*res) = (s_fargs != NULL) ? apply_fusion_window_batch(&w_items, w_lo, w_hi - w_lo + 1, s_fargs)
+									   : apply_fusion_window(&w_items, w_lo, w_hi - w_lo + 1);
+			w_items.clear();
+			if (!(*res))
+				break;
+		}
+
+		if (item->m_fn > 0) {
+			// open new window
+			w_items.push_back(*item);
+			w_lo = item->m_flsq;
+			w_hi = item->m_flsq + item->m_fn - 1;
 		}
+		else {
+			// not fusable - whole instruction applied
+			qSim_qinstruction_core* qi = item->m_instr;
+			(*res) = transform(qi->m_ftype, qi->m_fsize, qi->m_frep, qi->m_flsq,
+			                   qi->m_fcrng, qi->m_ftrng, item->m_fargs,
+							   qi->m_futype, qi->m_fucrng, qi->m_futrng, qi->m_fuargs);
+		}
+	}
+	if ((*res) && (w_items.size() > 0))
+		(*res) = (s_fargs != NULL) ? apply_fusion_window_batch(&w_items, w_lo, w_hi - w_lo + 1, s_fargs)
+								   : apply_fusion_window(&w_items, w_lo, w_hi - w_lo + 1);
+
+	if (!(*res))
+		*res_str = "block stateTransform generic error";
 
-		// release instruction object - if enabled
-		if (do_release)
+	// release instruction objects - if enabled
+	if (do_release) {
+		for (std::list<qSim_qinstruction_core*>::iterator it = qinstr_list->begin(); it != qinstr_list->end(); ++it)
 			delete *it;
 	}
+}
+
+bool qSim_qreg::apply_fusion_window(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n) {
+	// apply given window items - a single item through a regular transformation
+	if (w_items->size() == 1) {
+		qSim_qreg_fusion_item* item = &(*w_items)[0];
+		qSim_qinstruction_core* qi = item->m_instr;
+		return transform(qi->m_ftype, qi->m_fsize, 1, item->m_flsq,
+		                 qi->m_fcrng, qi->m_ftrng, item->m_fargs,
+						 qi->m_futype, qi->m_fucrng, qi->m_futrng, qi->m_fuargs);
+	}
+
+	// fused items case - calculate window unitary and apply it
+	if (m_verbose)
+		cout << "qSim_qreg::apply_fusion_window - fusing " << w_items->size() << " items - w_lo: " << w_lo
+		     << " w_n: " << w_n << endl;
+	std::vector<QREG_ST_RAW_VAL_TYPE> f_mtx((size_t)1 << 2*w_n);
+	if (!fusion_window_unitary(w_items, w_lo, w_n, f_mtx.data()))
+		return false;
+	return transformDense(w_lo, w_n, f_mtx.data());
+}
+
+bool qSim_qreg::fusion_window_unitary(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n,
+		                              QREG_ST_RAW_VAL_TYPE* f_mtx) {
+	// calculate window unitary (row-major) by applying window items on a helper qureg, set with
+	// column index j on the upper half qubits and basis state j on the lower half ones
+	// => U[i][j] found on state i + j*2^KMAX (control/target ranges used as relative only)
+	int kq = QREG_FUSION_MAX_QUBITS;
+	if (m_fusionQreg == NULL)
+		m_fusionQreg = new qSim_qreg(2*kq, m_qcpu_device, false);
+
+	QREG_ST_INDEX_TYPE w_size = (QREG_ST_INDEX_TYPE)1 << w_n;
+	QREG_ST_VAL_ARRAY_TYPE st_array(m_fusionQreg->m_totStates, QREG_ST_VAL_TYPE(0.0, 0.0));
+	for (QREG_ST_INDEX_TYPE j=0; j<w_size; j++)
+		st_array[j + (j << kq)] = QREG_ST_VAL_TYPE(1.0, 0.0);
+	if (!m_fusionQreg->setState(&st_array))
+		return false;
+
+	for (unsigned int k=0; k<w_items->size(); k++) {
+		qSim_qreg_fusion_item* item = &(*w_items)[k];
+		qSim_qinstruction_core* qi = item->m_instr;
+		if (!m_fusionQreg->transform(qi->m_ftype, qi->m_fsize, 1, item->m_flsq - w_lo,
+		                             qi->m_fcrng, qi->m_ftrng, item->m_fargs,
+									 qi->m_futype, qi->m_fucrng, qi->m_futrng, qi->m_fuargs))
+			return false;
+	}
+
+	if (!m_fusionQreg->synchDevStates())
+		return false;
+	for (QREG_ST_INDEX_TYPE i=0; i<w_size; i++)
+		for (QREG_ST_INDEX_TYPE j=0; j<w_size; j++)
+			f_mtx[i*w_size + j] = m_fusionQreg->m_states_x[i + (j << kq)];
+	return true;
+}
+
+bool qSim_qreg::apply_fusion_window_batch(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n,
+										  std::vector<QREG_F_ARGS_TYPE>* s_fargs) {
+	// apply given window items on a batched qureg - windows with no items args shared by all
+	// samples, one window unitary per sample otherwise (items args taken from the sample
+	// fargs), applied on all samples at once
+	bool s_args = false;
+	for (unsigned int k=0; (k<w_items->size()) && !s_args; k++)
+		s_args = ((*w_items)[k].m_fidx >= 0);
+	if (!s_args)
+		return apply_fusion_window(w_items, w_lo, w_n);
+
+	if (m_verbose)
+		cout << "qSim_qreg::apply_fusion_window_batch - " << w_items->size() << " items - w_lo: " << w_lo
+		     << " w_n: " << w_n << " samples: " << m_totSamples << endl;
+	std::vector<qSim_qreg_fusion_item> s_items(*w_items);
+	size_t m_size = (size_t)1 << 2*w_n;
+	QREG_ST_INDEX_TYPE tot_s = m_totStates / m_sampleStates;
+	std::vector<QREG_ST_RAW_VAL_TYPE> f_mtx(tot_s*m_size);
+	for (int s=0; s<m_totSamples; s++) {
+		for (unsigned int k=0; k<s_items.size(); k++)
+			if (s_items[k].m_fidx >= 0)
+				s_items[k].m_fargs.assign(1, (*s_fargs)[s][s_items[k].m_fidx]);
+		if (!fusion_window_unitary(&s_items, w_lo, w_n, f_mtx.data() + s*m_size))
+			return false;
+	}
 
-//	// release list
-//	for (std::list<qSim_qinstruction_core*>::iterator it = qinstr_list->begin(); it != qinstr_list->end(); ++it) {
-//		delete *it;
-//	}
+	// padding samples (null states) - last sample unitary taken
+	for (QREG_ST_INDEX_TYPE s=m_totSamples; s<tot_s; s++)
+		std::copy(f_mtx.begin() + (m_totSamples-1)*m_size, f_mtx.begin() + m_totSamples*m_size,
+				  f_mtx.begin() + s*m_size);
+	return transformDenseBatch(w_lo, w_n, f_mtx.data());
 }
 
 // -------------------------------------
@@ -423,33 +1092,51 @@ void qSim_qreg::apply_instruction_and_release(std::list<qSim_qinstruction_core*>
 
 // state control and access
 bool qSim_qreg::resetState() {
-	// set qureg in ground state - call device function
-	m_qcpu_device->dev_qreg_set_state(m_devStates_x, m_totStates, 0, m_verbose);
-
-	// force an host-device sync
+	// set qureg in ground state - call device function (all other shards reset)
+	if (m_totSamples > 1)
+		return setSamplesState(0);
+	shard_reset_layout();
+	for (unsigned int sh=0; sh<m_shards.size(); sh++)
+		device(sh)->dev_qreg_set_state(m_shards[sh].m_devStates_x, m_shardStates,
+									   (m_shardBase+sh == 0) ? 0 : m_shardStates, m_verbose);
+
+	// host states to be synchronised on next access
 	m_syncFlag = false;
-	synchDevStates();
 	return true;
 }
 
-bool qSim_qreg::setState(unsigned st_idx) {
+bool qSim_qreg::setState(QREG_ST_INDEX_TYPE st_idx) {
 	// set qureg with given arbitrary pure state and align device register
 	if (m_verbose)
 		cout << "qreg::setState - pure state setup - st_idx: " << st_idx << endl;
 
 	// perform sanity checks on given state array
-	if (st_idx > m_totStates-1) {
+	if ((st_idx < 0) || (st_idx > m_totStates-1)) {
 		cerr << "ERROR!! qreg::set - incorrect pure state index passed - state not set!!" << endl;
 		cerr << "state index: " << st_idx << " - qreg totStates: " << m_totStates << endl;
 		return false;
 	}
 
-	// pure state to set - call device function
-	m_qcpu_device->dev_qreg_set_state(m_devStates_x, m_totStates, st_idx, m_verbose);
+	// batched qureg - same pure state on all samples
+	if (m_totSamples > 1) {
+		if (st_idx > m_sampleStates-1) {
+			cerr << "ERROR!! qreg::set - incorrect pure state index passed - state not set!!" << endl;
+			cerr << "state index: " << st_idx << " - qreg sample states: " << m_sampleStates << endl;
+			return false;
+		}
+		return setSamplesState(st_idx);
+	}
+
+	// pure state to set - call device function (all other shards reset)
+	shard_reset_layout();
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		bool st_sh = ((st_idx >> m_shardQubits) == (QREG_ST_INDEX_TYPE)(m_shardBase+sh));
+		device(sh)->dev_qreg_set_state(m_shards[sh].m_devStates_x, m_shardStates,
+									   st_sh ? (st_idx & (m_shardStates-1)) : m_shardStates, m_verbose);
+	}
 
-	// synchronise host with device register data
+	// host states to be synchronised on next access
 	m_syncFlag = false;
-	synchDevStates();
 	return true;
 }
 
@@ -464,103 +1151,395 @@ bool qSim_qreg::setState(QREG_ST_VAL_ARRAY_TYPE* st_array) {
 		return false;
 	}
 
-	if (st_array->size() != m_totStates) {
+	// batched qureg - all samples states (sample-major), padding samples optional
+	QREG_ST_INDEX_TYPE st_n = st_array->size();
+	if ((st_n != m_totStates) && ((m_totSamples == 1) || (st_n != m_totSamples*m_sampleStates))) {
 		cerr << "ERROR!! qreg::set - state vector of incorrect size passed - state not set!!" << endl;
 		cerr << "st_array size: " << st_array->size() << " - qreg totStates: " << m_totStates << endl;
 		return false;
 	}
 
-	// set qureg state using custom data
-	// update host array first and align device afterwards
-	for (unsigned int i=0; i<m_totStates; i++) {
-		double st_r = (*st_array)[i].real();
-		double st_i = (*st_array)[i].imag();
-		m_states_x[i] = QREG_ST_MAKE_VAL(st_r, st_i);
+	// set qureg state using custom data - batched qureg padding samples kept null if not given
+	// update host array first (node slice only) and align device afterwards
+	if (!allocHostStates())
+		return false;
+	QREG_ST_INDEX_TYPE st_off = m_shardBase*m_shardStates;
+	for (QREG_ST_INDEX_TYPE i=0; i<(QREG_ST_INDEX_TYPE)m_shards.size()*m_shardStates; i++) {
+		QREG_ST_VAL_TYPE st_val = (st_off+i < st_n) ? (*st_array)[st_off+i] : QREG_ST_VAL_TYPE(0.0, 0.0);
+		m_states_x[i] = QREG_ST_MAKE_VAL(st_val.real(), st_val.imag());
 	}
-	m_qcpu_device->dev_qreg_host2device_align(m_devStates_x, m_states_x, m_totStates);
+	alignDevStates();
 
 	// no sync needed - arrays aligned in this case
 	m_syncFlag = true;
 	return true;
 }
 
-// -------------------------------------
+bool qSim_qreg::setSamplesState(QREG_ST_INDEX_TYPE st_idx) {
+	// set each batched qureg sample with given pure state - call device function on each
+	// sample states (padding samples reset)
+	shard_reset_layout();
+	QREG_ST_INDEX_TYPE tot_s = m_totStates / m_sampleStates;
+	for (QREG_ST_INDEX_TYPE s=0; s<tot_s; s++)
+		device()->dev_qreg_set_state(m_shards[0].m_devStates_x + s*m_sampleStates, m_sampleStates,
+									 (s < m_totSamples) ? st_idx : m_sampleStates, m_verbose);
 
-bool qSim_qreg::transform(QASM_F_TYPE ftype, int fsize, int frep, int flsq,
-		                  QREG_F_INDEX_RANGE_TYPE fcrng, QREG_F_INDEX_RANGE_TYPE ftrng, QREG_F_ARGS_TYPE fargs,
-						  int futype, QREG_F_INDEX_RANGE_TYPE fucrng, QREG_F_INDEX_RANGE_TYPE futrng, QREG_F_ARGS_TYPE fuargs) {
-	// transform qureg - call proper CUDA function
-	if (m_verbose)
-		cout << "qSim_qreg::transform - function...ftype: " << ftype
-		     << " fsize: " << fsize << " frep: " << frep << " flsq: " << flsq
-			 << " fcrng: " << fcrng.to_string() << " ftrng: " << ftrng.to_string() << " fargs size: " << fargs.size()
-			 << " futype: " << futype << " fucrng: " << fucrng.to_string() << " futrng: " << futrng.to_string()
-			 << " fuargs size: " << fuargs.size() << endl;
+	// host states to be synchronised on next access
+	m_syncFlag = false;
+	return true;
+}
 
-	int ret = QDEV_RES_OK;
+bool qSim_qreg::stateSnapshot(qSim_qreg_snapshot* snap) {
+	// copy device states of each shard into its snapshot register (allocated on first use, on
+	// the shard device - released on failure, no snapshot taken), keeping the current qubits
+	// placement
+	if (snap->m_devStates.size() == 0) {
+		snap->m_devStates.resize(m_shards.size(), NULL);
+		for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+			if (device(sh)->dev_qreg_device_alloc(&snap->m_devStates[sh], m_shardStates) != QDEV_RES_OK) {
+				cerr << "qSim_qreg::stateSnapshot - snapshot register not allocated - ERROR!!" << endl;
+				snapshotRelease(snap);
+				return false;
+			}
+		}
+	}
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		device(sh)->dev_qreg_device_copy(snap->m_devStates[sh], m_shards[sh].m_devId,
+										 m_shards[sh].m_devStates_x, m_shards[sh].m_devId, m_shardStates);
+	}
+	snap->m_qubitPos = m_qubitPos;
+	snap->m_qubitAt = m_qubitAt;
+	return true;
+}
 
-	// final check before execution: LSQ and repetitions consistent with function and qureg size
-	if (powf(fsize, frep) > m_totStates) {
-		cout << "!!!ERROR - function repetitions exceeds qureg size!!" << endl;
+bool qSim_qreg::stateRestore(qSim_qreg_snapshot* snap) {
+	// copy snapshot registers back into device states of each shard, with the qubits placement
+	// at snapshot time
+	if (snap->m_devStates.size() == 0) {
+		cerr << "qSim_qreg::stateRestore - no state snapshot taken - ERROR!!" << endl;
 		return false;
 	}
-	else if (powf(fsize, frep) + powf(2, flsq) - 1 > m_totStates) {
-		cout << "!!!ERROR - inconsistent LSQ value found [" << flsq << "]" << endl;
+	for (unsigned int sh=0; sh<m_shards.size(); sh++)
+		device(sh)->dev_qreg_device_copy(m_shards[sh].m_devStates_x, m_shards[sh].m_devId,
+										 snap->m_devStates[sh], m_shards[sh].m_devId, m_shardStates);
+	m_qubitPos = snap->m_qubitPos;
+	m_qubitAt = snap->m_qubitAt;
+
+	// host states to be synchronised on next access
+	m_syncFlag = false;
+	return true;
+}
+
+void qSim_qreg::snapshotRelease(qSim_qreg_snapshot* snap) {
+	// release snapshot registers - if allocated
+	for (unsigned int sh=0; sh<snap->m_devStates.size(); sh++)
+		device(sh)->dev_qreg_device_release(snap->m_devStates[sh]);
+	snap->m_devStates.clear();
+}
+
+bool qSim_qreg::copyState(qSim_qreg* qr_src) {
+	// copy device states of each shard of the source qureg into this qureg shards, with the
+	// source qubits placement - same qureg size and shards layout (same node slice if
+	// distributed) required
+	if (qr_src == this)
+		return true;
+
+	if ((qr_src->m_totQubits != m_totQubits) || (qr_src->m_totSamples != m_totSamples) ||
+		(qr_src->m_shards.size() != m_shards.size()) || (qr_src->m_shardBase != m_shardBase)) {
+		cerr << "qSim_qreg::copyState - source qureg of different size or layout - ERROR!!" << endl;
 		return false;
 	}
 
-	// call CUDA function - based on function type class
-	if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype)) {
-		// 1-qubit gate case found
-		ret = m_qcpu_device->dev_qreg_apply_function_gate_1qubit(m_devStates_x, m_devStates_y, m_totStates,
-												                 ftype, frep, flsq, &fargs, m_verbose);
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		// pending transformations of this shard completed, then copy enqueued on the source
+		// shard stream (after its pending transformations), completed before returning as the
+		// two quregs streams are not ordered with each other
+		device(sh)->dev_qreg_stream_sync();
+		qr_src->device(sh)->dev_qreg_device_copy(m_shards[sh].m_devStates_x, m_shards[sh].m_devId,
+												 qr_src->m_shards[sh].m_devStates_x,
+												 qr_src->m_shards[sh].m_devId, m_shardStates);
+		qr_src->device(sh)->dev_qreg_stream_sync();
 	}
-	else if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype)) {
-		// 2-qubit gate case found
-		int fform = qSim_qinstruction_core::ctrange_2_form(fcrng, ftrng);
-		ret = m_qcpu_device->dev_qreg_apply_function_gate_2qubit(m_devStates_x, m_devStates_y, m_totStates,
-												                 ftype, frep, flsq, fform, futype, &fuargs,
-																 m_verbose);
+	m_qubitPos = qr_src->m_qubitPos;
+	m_qubitAt = qr_src->m_qubitAt;
+
+	// host states to be synchronised on next access
+	m_syncFlag = false;
+	return true;
+}
+
+// -------------------------------------
+
+bool qSim_qreg::transform(QASM_F_TYPE ftype, int fsize, int frep, int flsq,
+		                  QREG_F_INDEX_RANGE_TYPE fcrng, QREG_F_INDEX_RANGE_TYPE ftrng, QREG_F_ARGS_TYPE fargs,
+						  int futype, QREG_F_INDEX_RANGE_TYPE fucrng, QREG_F_INDEX_RANGE_TYPE futrng, QREG_F_ARGS_TYPE fuargs) {
+	// transform qureg - call proper CUDA function
+	if (m_verbose)
+		cout << "qSim_qreg::transform - function...ftype: " << ftype
+		     << " fsize: " << fsize << " frep: " << frep << " flsq: " << flsq
+			 << " fcrng: " << fcrng.to_string() << " ftrng: " << ftrng.to_string() << " fargs size: " << fargs.size()
+			 << " futype: " << futype << " fucrng: " << fucrng.to_string() << " futrng: " << futrng.to_string()
+			 << " fuargs size: " << fuargs.size() << endl;
+
+	// final check before execution
+	if (!transform_check(ftype, fsize, frep, flsq))
+		return false;
+
+	// resolve function form and gaps (controlled gates)
+	int fform = QASM_F_FORM_NULL;
+	int fgapn = 0;
+	int fun = 0;
+	int fuform = QASM_F_FORM_NULL;
+	if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype)) {
+		fform = qSim_qinstruction_core::ctrange_2_form(fcrng, ftrng);
+		fun = 1;
 	}
 	else if (QASM_F_TYPE_IS_GATE_NQUBIT(ftype)) {
-		// n-qubit gate case found
-		int fform = qSim_qinstruction_core::ctrange_2_form(fcrng, ftrng);
-		int fgapn;
+		fform = qSim_qinstruction_core::ctrange_2_form(fcrng, ftrng);
 		if (fform == QASM_F_FORM_DIRECT)
 			fgapn = fcrng.m_start - ftrng.m_stop - 1;
 		else
 			fgapn = ftrng.m_start - fcrng.m_stop - 1;
-		int fun;
 		if (QASM_F_TYPE_IS_GATE_1QUBIT(futype))
 			fun = 1;
 		else
 			fun = 2;
-		int fuform = qSim_qinstruction_core::ctrange_2_form(fucrng, futrng);
-		ret = m_qcpu_device->dev_qreg_apply_function_controlled_gate_nqubit(m_devStates_x, m_devStates_y, m_totStates,
-												                            ftype, fsize, frep, flsq, fform, fgapn,
-																			futype, fun, fuform, &fuargs, m_verbose);
+		fuform = qSim_qinstruction_core::ctrange_2_form(fucrng, futrng);
 	}
-	else {
+
+	// sharded qureg - controlled gates placing their target qubits only (any function width)
+	if ((m_totShards > 1) && !QASM_F_TYPE_IS_GATE_1QUBIT(ftype)) {
+		int ret = transform_shards_controlled(ftype, fsize, frep, flsq, fform, fgapn, futype, fun, fuform, &fuargs);
+		if (ret != QDEV_RES_NOT_APPLIED)
+			return (ret == QDEV_RES_OK);
+	}
+
+	// apply function repetitions in chunks within the shard local qubits, each chunk placed on
+	// shard layout positions (single chunk on unchanged positions if not sharded)
+	int fw = (ftype == QASM_F_TYPE_Q3_CCX) ? 3 : (int)log2(fsize);
+	if (fw > m_shardQubits) {
+		cout << "!!!ERROR - function size [" << fw << "] exceeds qureg shard local qubits [" << m_shardQubits << "]!!" << endl;
+		return false;
+	}
+	int c_rep = m_shardQubits / fw;
+	int r = 0;
+	do {
+		int n_rep = std::min(c_rep, frep-r);
+		int p_lsq = shard_place_span(flsq + r*fw, fw*n_rep);
+		if (!transform_shards(ftype, fsize, n_rep, p_lsq, fform, fgapn, &fargs, futype, fun, fuform, &fuargs))
+			return false;
+		r += c_rep;
+	} while (r < frep);
+	return true;
+}
+
+bool qSim_qreg::transform_check(QASM_F_TYPE ftype, int fsize, int frep, int flsq) {
+	// check function type and limits - no qureg change, so that instruction lists are checked
+	// as a whole before applying any of them
+	// => LSQ and repetitions consistent with function and qureg size, on qubit counts first, to
+	//    avoid overflows on 64-bit state sizes
+	int fn = log2(fsize);
+	if ((fn*frep > (int)m_totQubits) || (flsq < 0) || (flsq > (int)m_totQubits)) {
+		cout << "!!!ERROR - function repetitions exceeds qureg size!!" << endl;
+		return false;
+	}
+	else if (((QREG_ST_INDEX_TYPE)1 << (fn*frep)) + ((QREG_ST_INDEX_TYPE)1 << flsq) - 1 > m_totStates) {
+		cout << "!!!ERROR - inconsistent LSQ value found [" << flsq << "]" << endl;
+		return false;
+	}
+	if (!QASM_F_TYPE_IS_GATE_1QUBIT(ftype) && !QASM_F_TYPE_IS_GATE_2QUBIT(ftype) && !QASM_F_TYPE_IS_GATE_NQUBIT(ftype)) {
 		cout << "!!!ERROR - unhandled function transformation type:" << ftype << endl;
 		return false;
 	}
 
+	// function width within the shard local qubits - controlled gates on sharded quregs placing
+	// their target qubits only
+	int fw = (ftype == QASM_F_TYPE_Q3_CCX) ? 3 : fn;
+	if ((fw < 1) || ((fw > m_shardQubits) && ((m_totShards == 1) || QASM_F_TYPE_IS_GATE_1QUBIT(ftype)))) {
+		cout << "!!!ERROR - function size [" << fw << "] exceeds qureg shard local qubits [" << m_shardQubits << "]!!" << endl;
+		return false;
+	}
+
+	// batched qureg - function within the sample qubits (applied on all samples at once)
+	if ((m_totSamples > 1) && (flsq + fw*frep > m_sampleQubits)) {
+		cout << "!!!ERROR - function repetitions exceeds batched qureg sample qubits [" << m_sampleQubits << "]!!" << endl;
+		return false;
+	}
+	return true;
+}
+
+bool qSim_qreg::transform_shards(QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+								 QREG_F_ARGS_TYPE* fargs, int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs) {
+	// transform each qureg shard as a qureg of the shard local qubits - functions on local positions
+	int ret = QDEV_RES_OK;
+	for (unsigned int sh=0; (sh<m_shards.size()) && (ret == QDEV_RES_OK); sh++) {
+		qSim_qreg_shard* q_sh = &m_shards[sh];
+
+		// fast path first - diagonal, permutation and controlled gates applied directly on device states
+		device(sh)->dev_qreg_stats_start();
+		ret = transform_fast(sh, ftype, fsize, frep, flsq, fform, fgapn, futype, fun, fuform,
+							 QASM_F_TYPE_IS_GATE_1QUBIT(ftype) ? fargs : fuargs);
+		if (ret != QDEV_RES_NOT_APPLIED) {
+			m_qcpu_device->dev_qreg_stats_stop(ftype);
+			continue;
+		}
+
+		// call CUDA function - based on function type class
+		if (QASM_F_TYPE_IS_GATE_1QUBIT(ftype)) {
+			// 1-qubit gate case found
+			ret = device(sh)->dev_qreg_apply_function_gate_1qubit(q_sh->m_devStates_x, q_sh->m_devStates_y, m_shardStates,
+																  ftype, frep, flsq, fargs, m_verbose);
+		}
+		else if (QASM_F_TYPE_IS_GATE_2QUBIT(ftype)) {
+			// 2-qubit gate case found
+			ret = device(sh)->dev_qreg_apply_function_gate_2qubit(q_sh->m_devStates_x, q_sh->m_devStates_y, m_shardStates,
+																  ftype, frep, flsq, fform, futype, fuargs,
+																  m_verbose);
+		}
+		else {
+			// n-qubit gate case found
+			ret = device(sh)->dev_qreg_apply_function_controlled_gate_nqubit(q_sh->m_devStates_x, q_sh->m_devStates_y,
+																			 m_shardStates, ftype, fsize, frep, flsq,
+																			 fform, fgapn, futype, fun, fuform, fuargs,
+																			 m_verbose);
+		}
+		m_qcpu_device->dev_qreg_stats_stop(ftype);
+
+		if (m_verbose)
+			cout << "qSim_qreg::transform - function applied on GPU! - result:" << ret << endl;
+
+		if (ret == QDEV_RES_OK) {
+			// swap device pointers - same pointers in in-place mode
+			QREG_ST_RAW_VAL_TYPE* app = q_sh->m_devStates_x;
+			q_sh->m_devStates_x = q_sh->m_devStates_y;
+			q_sh->m_devStates_y = app;
+		}
+	}
+
+	// unset sync flag
+	if (ret == QDEV_RES_OK)
+		m_syncFlag = false;
+	return (ret == QDEV_RES_OK);
+}
+
+int qSim_qreg::transform_shards_controlled(QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+											int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs) {
+	// transform sharded qureg by controlled gate - each repetition as a U-gate on its target
+	// qubits, only these placed on local positions, with controls on local positions in the
+	// device bitmask engine control mask and controls on global positions resolved per shard
+	// (shards not having them all set skipped, the other ones dropping them)
+	// => QDEV_RES_NOT_APPLIED returned for non-controlled gates (nothing applied)
+	QDEV_ST_INDEX_TYPE c_mask;
+	int tn;
+	int t_idx[QDEV_F_CTRL_U_MAX_QUBITS];
+	QREG_ST_RAW_VAL_TYPE u_mtx[1 << 2*QDEV_F_CTRL_U_MAX_QUBITS];
+	int ret = m_qcpu_device->dev_qreg_function_controls(ftype, fsize, flsq, fform, fgapn, futype, fun, fuform, fuargs,
+														&c_mask, &tn, t_idx, u_mtx);
+	if (ret != QDEV_RES_OK)
+		return ret;
+
+	int fw = (ftype == QASM_F_TYPE_Q3_CCX) ? 3 : (int)log2(fsize);
+	for (int r=0; (r<frep) && (ret == QDEV_RES_OK); r++) {
+		// repetition target qubits placed first, then controls split by positions
+		int q_idx[QDEV_F_CTRL_U_MAX_QUBITS];
+		int p_idx[QDEV_F_CTRL_U_MAX_QUBITS];
+		for (int b=0; b<tn; b++)
+			q_idx[b] = t_idx[b] + r*fw;
+		shard_place_qubits(tn, q_idx, p_idx);
+		QREG_ST_INDEX_TYPE p_mask = shard_layout_mask(c_mask << (r*fw));
+		QREG_ST_INDEX_TYPE l_mask = p_mask & (m_shardStates-1);
+		QREG_ST_INDEX_TYPE g_mask = p_mask >> m_shardQubits;
+		if (m_verbose)
+			cout << "qSim_qreg::transform_shards_controlled - ftype: " << ftype << " rep: " << r
+				 << " local controls: " << l_mask << " global controls: " << g_mask << endl;
+
+		for (unsigned int sh=0; (sh<m_shards.size()) && (ret == QDEV_RES_OK); sh++) {
+			if ((((QREG_ST_INDEX_TYPE)(m_shardBase + sh)) & g_mask) != g_mask)
+				continue;
+			device(sh)->dev_qreg_stats_start();
+			ret = m_qcpu_device->dev_qreg_apply_function_controlled(m_shards[sh].m_devStates_x, m_shardStates, l_mask,
+																	tn, p_idx, u_mtx, m_verbose);
+			m_qcpu_device->dev_qreg_stats_stop(ftype);
+		}
+	}
+
+	// unset sync flag
+	if (ret == QDEV_RES_OK)
+		m_syncFlag = false;
+	return (ret == QDEV_RES_OK) ? QDEV_RES_OK : QDEV_RES_ERROR;
+}
+
+int qSim_qreg::transform_fast(int sh, QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+							  int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs) {
+	// transform qureg shard by fast path device function - diagonal, permutation and controlled gates
+	// applied directly on device states (no device pointers swap), QDEV_RES_NOT_APPLIED otherwise
+	int ret = device(sh)->dev_qreg_apply_function_fast(m_shards[sh].m_devStates_x, m_shardStates, ftype, fsize, frep,
+													   flsq, fform, fgapn, futype, fun, fuform, fargs, m_verbose);
+	if (ret == QDEV_RES_OK) {
+		if (m_verbose)
+			cout << "qSim_qreg::transform_fast - function applied on fast path!" << endl;
+
+		// unset sync flag
+		m_syncFlag = false;
+	}
+	return ret;
+}
+
+bool qSim_qreg::transformDense(int flsq, int fn, QREG_ST_RAW_VAL_TYPE* f_mtx) {
+	// transform qureg with given dense unitary (row-major) on fn qubits from flsq - call device function
 	if (m_verbose)
-		cout << "qSim_qreg::transform - function applied on GPU! - result:" << ret << endl;
+		cout << "qSim_qreg::transformDense - flsq: " << flsq << " fn: " << fn << endl;
+
+	// unitary qubits placed on shard layout positions, applied on each shard
+	int p_lsq = shard_place_span(flsq, fn);
+	int ret = QDEV_RES_OK;
+	for (unsigned int sh=0; (sh<m_shards.size()) && (ret == QDEV_RES_OK); sh++) {
+		qSim_qreg_shard* q_sh = &m_shards[sh];
+
+		// fast path first - single non-zero element per row unitaries applied directly on device states
+		device(sh)->dev_qreg_stats_start();
+		ret = m_qcpu_device->dev_qreg_apply_function_dense_fast(q_sh->m_devStates_x, m_shardStates, p_lsq, fn, f_mtx,
+																m_verbose);
+		if (ret != QDEV_RES_NOT_APPLIED) {
+			m_qcpu_device->dev_qreg_stats_stop(QSTATS_KEY_DENSE);
+			continue;
+		}
+
+		ret = m_qcpu_device->dev_qreg_apply_function_dense(q_sh->m_devStates_x, q_sh->m_devStates_y, m_shardStates,
+														   p_lsq, fn, f_mtx, m_verbose);
+		m_qcpu_device->dev_qreg_stats_stop(QSTATS_KEY_DENSE);
+		if (ret == QDEV_RES_OK) {
+			// swap device pointers - same pointers in in-place mode
+			QREG_ST_RAW_VAL_TYPE* app = q_sh->m_devStates_x;
+			q_sh->m_devStates_x = q_sh->m_devStates_y;
+			q_sh->m_devStates_y = app;
+		}
+	}
 
+	// unset sync flag
+	if (ret == QDEV_RES_OK)
+		m_syncFlag = false;
+	return (ret == QDEV_RES_OK);
+}
+
+bool qSim_qreg::transformDenseBatch(int flsq, int fn, QREG_ST_RAW_VAL_TYPE* f_mtx) {
+	// transform batched qureg with given dense unitaries on fn qubits from flsq, one per sample
+	// (padding ones included) - single device function call on all samples (single shard)
+	if (m_verbose)
+		cout << "qSim_qreg::transformDenseBatch - flsq: " << flsq << " fn: " << fn << endl;
+
+	// unitaries qubits placed on layout positions (within the sample qubits)
+	int p_lsq = shard_place_span(flsq, fn);
+	qSim_qreg_shard* q_sh = &m_shards[0];
+	device()->dev_qreg_stats_start();
+	int ret = m_qcpu_device->dev_qreg_apply_function_dense_batch(q_sh->m_devStates_x, q_sh->m_devStates_y, m_shardStates,
+																 p_lsq, fn, f_mtx, m_sampleQubits, m_verbose);
+	m_qcpu_device->dev_qreg_stats_stop(QSTATS_KEY_DENSE);
 	if (ret == QDEV_RES_OK) {
-		// swap device pointers
-		QREG_ST_RAW_VAL_TYPE* app = m_devStates_x;
-		m_devStates_x = m_devStates_y;
-		m_devStates_y = app;
-
-//		cout << "qureg states..." << endl;
-//		for (unsigned int k=0; k<m_totStates; k++)
-//	#ifndef __QSIM_CPU__
-//			cout << "#" << k << " " << m_devStates_x[k].x << "  " << m_devStates_x[k].y << endl;
-//	#else
-//			cout << "#" << k << " " << m_devStates_x[k].real() << "  " << m_devStates_x[k].imag() << endl;
-//	#endif
+		// swap device pointers - same pointers in in-place mode
+		QREG_ST_RAW_VAL_TYPE* app = q_sh->m_devStates_x;
+		q_sh->m_devStates_x = q_sh->m_devStates_y;
+		q_sh->m_devStates_y = app;
 
 		// unset sync flag
 		m_syncFlag = false;
@@ -577,29 +1556,167 @@ bool qSim_qreg::getStates(QREG_ST_VAL_ARRAY_TYPE* stArray) {
 		return false;
 	}
 
-	// synchronise host with device
-	synchDevStates();
+	// synchronise host with device - node slices gathered on root node if distributed
+	if (!synchDevStates())
+		return false;
+	QREG_ST_RAW_VAL_TYPE* st_vals = m_states_x;
+	std::vector<QREG_ST_RAW_VAL_TYPE> g_vals;
+	if (m_qnode != NULL) {
+		g_vals.resize(m_totStates);
+		m_qnode->gather(m_states_x, m_shards.size()*m_shardStates*sizeof(QREG_ST_RAW_VAL_TYPE), g_vals.data());
+		st_vals = g_vals.data();
+	}
 
 	// convert to array and return
 //	*stArray = QREG_ST_VAL_ARRAY_TYPE(m_totStates);
 	stArray->clear();
-	for (unsigned int i=0; i<m_totStates; i++) {
+	for (QREG_ST_INDEX_TYPE i=0; i<m_totStates; i++) {
 #ifndef __QSIM_CPU__
-		double st_r = m_states_x[i].x;
-		double st_i = m_states_x[i].y;
+		double st_r = st_vals[i].x;
+		double st_i = st_vals[i].y;
 #else
-		double st_r = m_states_x[i].real();
-		double st_i = m_states_x[i].imag();
+		double st_r = st_vals[i].real();
+		double st_i = st_vals[i].imag();
 #endif
 		stArray->push_back(QREG_ST_VAL_TYPE(st_r, st_i));
 	}
 	return true;
 }
 
-unsigned int qSim_qreg::getTotStates() {
+// top-k states peek candidate - POD, gathered as raw bytes from cluster nodes
+struct qSim_qreg_topk_item {
+	double m_pr;
+	double m_re;
+	double m_im;
+	QREG_ST_INDEX_TYPE m_idx;
+};
+
+static bool topk_item_before(const qSim_qreg_topk_item& a, const qSim_qreg_topk_item& b) {
+	// decreasing probability, lower index first on ties
+	return ((a.m_pr > b.m_pr) || ((a.m_pr == b.m_pr) && (a.m_idx < b.m_idx)));
+}
+
+bool qSim_qreg::getStatesPage(QREG_ST_INDEX_TYPE st_offs, QREG_ST_INDEX_TYPE st_cnt, QREG_ST_VAL_ARRAY_TYPE* stArray) {
+	// check page range - page size up to the max page size (whole page if not given), truncated
+	// to the last state
+	if (st_cnt == 0)
+		st_cnt = PEEK_MAX_PAGE_STATES;
+	if ((st_offs < 0) || (st_offs >= m_totStates) || (st_cnt < 0) || (st_cnt > PEEK_MAX_PAGE_STATES)) {
+		cerr << "qSim_qreg::getStatesPage - wrong states page [" << st_offs << ", " << st_cnt
+			 << "] - no values returned!!" << endl;
+		return false;
+	}
+	st_cnt = std::min(st_cnt, m_totStates - st_offs);
+
+	// qubits moved back on their own positions (as for host synch), then only the page slice
+	// of each shard copied from device - node slices summed up on all nodes if distributed
+	// (null values out of each node slice)
+	shard_restore_layout();
+	std::vector<QREG_ST_RAW_VAL_TYPE> p_vals(st_cnt);
+	QREG_ST_INDEX_TYPE n_start = (QREG_ST_INDEX_TYPE)m_shardBase*m_shardStates;
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		QREG_ST_INDEX_TYPE sh_start = n_start + sh*m_shardStates;
+		QREG_ST_INDEX_TYPE p_start = std::max(st_offs, sh_start);
+		QREG_ST_INDEX_TYPE p_stop = std::min(st_offs + st_cnt, sh_start + m_shardStates);
+		if (p_start < p_stop)
+			device(sh)->dev_qreg_device2host(p_vals.data() + (p_start - st_offs),
+											 m_shards[sh].m_devStates_x + (p_start - sh_start), p_stop - p_start);
+	}
+
+	// convert to array and return
+	stArray->clear();
+	for (QREG_ST_INDEX_TYPE i=0; i<st_cnt; i++) {
+#ifndef __QSIM_CPU__
+		stArray->push_back(QREG_ST_VAL_TYPE(p_vals[i].x, p_vals[i].y));
+#else
+		stArray->push_back(QREG_ST_VAL_TYPE(p_vals[i].real(), p_vals[i].imag()));
+#endif
+	}
+	if (m_qnode != NULL)
+		m_qnode->allreduce_sum((double*)stArray->data(), 2*st_cnt);
+	return true;
+}
+
+bool qSim_qreg::getStatesTopK(int k, QREG_ST_INDEX_ARRAY_TYPE* idxArray, QREG_ST_VAL_ARRAY_TYPE* stArray) {
+	// check top-k size
+	if ((k <= 0) || (k > QDEV_TOPK_MAX)) {
+		cerr << "qSim_qreg::getStatesTopK - wrong states number [" << k << "] - no values returned!!" << endl;
+		return false;
+	}
+
+	// k most probable states of each shard selected on device, on their layout positions (no
+	// states moved), then mapped to qubits order indexes with their values copied from device
+	std::vector<qSim_qreg_topk_item> c_vec;
+	int s_k = (int)std::min((QREG_ST_INDEX_TYPE)k, m_shardStates);
+	std::vector<QDEV_ST_INDEX_TYPE> s_idx(s_k);
+	std::vector<double> s_pr(s_k);
+	QREG_ST_INDEX_TYPE n_start = (QREG_ST_INDEX_TYPE)m_shardBase*m_shardStates;
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		if (device(sh)->dev_qreg_topk(m_shards[sh].m_devStates_x, m_shardStates, s_k, s_idx.data(), s_pr.data(),
+									  m_verbose) != QDEV_RES_OK) {
+			cerr << "qSim_qreg::getStatesTopK - device reduction error!!" << endl;
+			return false;
+		}
+		for (int j=0; j<s_k; j++) {
+			QREG_ST_RAW_VAL_TYPE v;
+			device(sh)->dev_qreg_device2host(&v, m_shards[sh].m_devStates_x + s_idx[j], 1);
+			qSim_qreg_topk_item c_item;
+			c_item.m_pr = s_pr[j];
+#ifndef __QSIM_CPU__
+			c_item.m_re = v.x;
+			c_item.m_im = v.y;
+#else
+			c_item.m_re = v.real();
+			c_item.m_im = v.imag();
+#endif
+			c_item.m_idx = shard_layout_index(n_start + sh*m_shardStates + s_idx[j]);
+			c_vec.push_back(c_item);
+		}
+	}
+
+	// shard candidates merged - k items (unused ones last, with negative probability), node
+	// candidates gathered and merged on root node if distributed
+	std::sort(c_vec.begin(), c_vec.end(), topk_item_before);
+	qSim_qreg_topk_item n_item = {-1.0, 0.0, 0.0, -1};
+	c_vec.resize(k, n_item);
+	if (m_qnode != NULL) {
+		std::vector<qSim_qreg_topk_item> g_vec(k*m_qnode->get_tot_nodes(), n_item);
+		m_qnode->gather(c_vec.data(), k*sizeof(qSim_qreg_topk_item), g_vec.data());
+		std::sort(g_vec.begin(), g_vec.end(), topk_item_before);
+		g_vec.resize(k);
+		c_vec.swap(g_vec);
+	}
+
+	// convert to arrays and return - unused items dropped (k above the qureg states)
+	idxArray->clear();
+	stArray->clear();
+	for (int j=0; (j<k) && (c_vec[j].m_idx >= 0); j++) {
+		idxArray->push_back(c_vec[j].m_idx);
+		stArray->push_back(QREG_ST_VAL_TYPE(c_vec[j].m_re, c_vec[j].m_im));
+	}
+	return true;
+}
+
+bool qSim_qreg::isAllocated() {
+	return m_allocFlag;
+}
+
+QREG_ST_INDEX_TYPE qSim_qreg::getTotStates() {
 	return m_totStates;
 }
 
+int qSim_qreg::getTotSamples() {
+	return m_totSamples;
+}
+
+int qSim_qreg::getSampleQubits() {
+	return m_sampleQubits;
+}
+
+void qSim_qreg::setQmlCache(qSim_qinstruction_block_qml_cache* qml_cache) {
+	m_qmlCache = (qml_cache != NULL) ? qml_cache : &m_qmlCacheOwn;
+}
+
 // -------------------------------------
 
 // type of measurements
@@ -635,13 +1752,11 @@ bool qSim_qreg::stateMeasure(int q_idx, int q_len, bool m_rand, bool m_coll,
 		return false;
 	}
 
-	bool d_vals = (this->m_totQubits-q_len <= MEASURE_MAX_INDEX_VEC_SIZE);
+	int m_len = (q_idx < 0) ? (int)this->m_totQubits : q_len;
+	bool d_vals = (this->m_totQubits-m_len <= MEASURE_MAX_INDEX_VEC_SIZE);
 	if (!d_vals)
 		cerr << "qSim_qreg::stateMeasure - measure max index vector size exceeded - no indeces returned!!" << endl;
 
-	// synchronise host with device
-	synchDevStates();
-
 	// perform the requested measure
 	bool res = false;
 	if (m_coll) {
@@ -682,17 +1797,129 @@ bool qSim_qreg::do_state_measure(int q_idx, int q_len, bool do_rnd, bool collaps
         q_len = this->m_totQubits;
     }
 
-    // calculate sub-states expectations
-    int q_stn = powf(2, q_len); // total number of sub-states for the measured qubits
+    // calculate sub-states probabilities - single pass on device states
     std::vector<double> pr_vec;
+    get_state_marginals(q_idx, q_len, &pr_vec);
 
-	// take all expectations for selected qureg
-    for (int i=0; i<q_stn; i++) {
-        double pr = get_state_probability(i, q_idx, q_len);
-        pr_vec.push_back(pr);
+    // handle measure state index calculation
+    select_measure_state(&pr_vec, do_rnd, m_st, m_pr);
+
+    // root node outcome taken by all nodes - if distributed
+    if (m_qnode != NULL) {
+    	m_qnode->bcast(m_st, sizeof(QREG_ST_INDEX_TYPE));
+    	m_qnode->bcast(m_pr, sizeof(double));
     }
 
-    // handle measure state index calculation
+    // handle qureg state collapsing after measure
+    if (collapse_st) {
+    	// collapse states on device - host states to be synchronised on next access
+    	// => qubits on their own positions (marginals), measured qubits beyond the shard local
+    	//    ones selecting the kept shards (all others reset)
+    	int l_len = std::max(0, std::min(q_idx+q_len, m_shardQubits) - q_idx);
+    	int l_idx = (l_len > 0) ? q_idx : 0;
+    	int g_off = std::max(q_idx, m_shardQubits) - m_shardQubits;
+    	QREG_ST_INDEX_TYPE g_mask = ((QREG_ST_INDEX_TYPE)1 << (q_len - l_len)) - 1;
+    	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+    		if ((((QREG_ST_INDEX_TYPE)(m_shardBase+sh) >> g_off) & g_mask) == (*m_st >> l_len))
+    			device(sh)->dev_qreg_collapse(m_shards[sh].m_devStates_x, m_shardStates, l_idx, l_len,
+    										  *m_st & (((QREG_ST_INDEX_TYPE)1 << l_len) - 1), *m_pr, m_verbose);
+    		else
+    			device(sh)->dev_qreg_set_state(m_shards[sh].m_devStates_x, m_shardStates, m_shardStates, m_verbose);
+    	}
+    	m_syncFlag = false;
+
+    	// taken state indexes - all values of the qubits outside the measured sub-qureg,
+    	// in increasing order (if not exceeding the max index vector size)
+    	if (d_vals) {
+    		QREG_ST_INDEX_TYPE r_stn = m_totStates >> q_len;
+    		QREG_ST_INDEX_TYPE lo_mask = ((QREG_ST_INDEX_TYPE)1 << q_idx) - 1;
+    		m_vec->reserve(r_stn);
+    		for (QREG_ST_INDEX_TYPE r=0; r<r_stn; r++)
+    			m_vec->push_back((r & lo_mask) | (*m_st << q_idx) | ((r & ~lo_mask) << q_len));
+    	}
+    }
+
+	return res;
+}
+
+bool qSim_qreg::stateMeasureShots(int q_idx, int q_len, int shots, int seed, QREG_ST_INDEX_ARRAY_TYPE* m_counts) {
+	// perform repeated simulated measures on qureg (no state collapse), sampling the given
+	// number of outcomes from the measured sub-qureg marginal distribution
+	//
+	// inputs:
+	// - q_idx: measured sub-qureg start index position, in range [0...(n-1])], with LSB=0 and MSB = n-1.
+	//          value -1 is for complete state measure (i.e. same as q_idx=0 and q_len=n)
+	// - q_len: measured sub-qureg len, in range [1...n-q_idx-1]
+	// - shots: number of sampled outcomes, in range [1...MEASURE_MAX_SHOTS]
+	// - seed: random generator seed for reproducible sampling (-1 for non-deterministic)
+	// - m_counts: sampled outcome counts as (state index, count) pairs, in increasing state index order
+	//
+
+	// sanity checks in input arguments
+	if (q_idx > (int)this->m_totQubits-1) {
+		cerr << "qSim_qreg::stateMeasureShots - q_idx parameter [" << q_idx << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
+
+	if (q_idx < 0) {
+		q_idx = 0;
+		q_len = this->m_totQubits;
+	}
+
+	if ((q_len < 1) || (q_len > (int)this->m_totQubits-q_idx)) {
+		cerr << "qSim_qreg::stateMeasureShots - q_len parameter [" << q_len << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
+
+	if (m_totSamples > 1) {
+		cerr << "qSim_qreg::stateMeasureShots - measurement shots not supported on batched quregs - ERROR!!" << endl;
+		return false;
+	}
+
+	if ((shots < 1) || (shots > MEASURE_MAX_SHOTS)) {
+		cerr << "qSim_qreg::stateMeasureShots - shots parameter [" << shots << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
+
+	if (m_verbose)
+		cout << "stateMeasureShots...q_idx: " << q_idx << " q_len: " << q_len << " shots: " << shots
+			 << " seed: " << seed << endl;
+
+	// marginal distribution in a single pass, turned into cumulative table
+	std::vector<double> cdf_vec;
+	get_state_marginals(q_idx, q_len, &cdf_vec);
+	std::partial_sum(cdf_vec.begin(), cdf_vec.end(), cdf_vec.begin());
+	double pr_tot = cdf_vec.back();
+	if (pr_tot <= 0.0) {
+		cerr << "qSim_qreg::stateMeasureShots - null qureg state norm - ERROR!!" << endl;
+		return false;
+	}
+
+	// draw samples - uniform value in [0, pr_tot) located by binary search
+	// (rounding on total probability absorbed by scaling on cumulative table last value)
+	if (seed >= 0)
+		m_rng.seed(seed);
+	std::uniform_real_distribution<double> pr_dist(0.0, pr_tot);
+	std::map<QREG_ST_INDEX_TYPE, QREG_ST_INDEX_TYPE> cnt_map;
+	for (int s=0; s<shots; s++) {
+		std::vector<double>::iterator it = std::upper_bound(cdf_vec.begin(), cdf_vec.end(), pr_dist(m_rng));
+		if (it == cdf_vec.end())
+			--it;
+		cnt_map[it - cdf_vec.begin()]++;
+	}
+
+	// compact counts - observed outcomes only
+	m_counts->clear();
+	for (std::map<QREG_ST_INDEX_TYPE, QREG_ST_INDEX_TYPE>::iterator it = cnt_map.begin(); it != cnt_map.end(); ++it) {
+		m_counts->push_back(it->first);
+		m_counts->push_back(it->second);
+	}
+	return true;
+}
+
+void qSim_qreg::select_measure_state(std::vector<double>* pr_vec, bool do_rnd, QREG_ST_INDEX_TYPE* m_st, double* m_pr) {
+	// select the measured sub-state from the given sub-state probabilities
+	QREG_ST_INDEX_TYPE q_stn = pr_vec->size();
     if (do_rnd) {
 		// get random index using expectations
     	// calculating a random probability and selecting
@@ -700,10 +1927,10 @@ bool qSim_qreg::do_state_measure(int q_idx, int q_len, bool do_rnd, bool collaps
 
     	double pr_rnd = std::rand()/RAND_MAX;
     	*m_st = 0;
-    	*m_pr = pr_vec[*m_st];
-    	for (int i=1; i<q_stn; i++) {
-    		if ((pr_vec[i] >= pr_rnd) && (pr_vec[i] < *m_pr)) {
-    			*m_pr = pr_vec[i];
+    	*m_pr = (*pr_vec)[*m_st];
+    	for (QREG_ST_INDEX_TYPE i=1; i<q_stn; i++) {
+    		if (((*pr_vec)[i] >= pr_rnd) && ((*pr_vec)[i] < *m_pr)) {
+    			*m_pr = (*pr_vec)[i];
     			*m_st = i;
     		}
     	}
@@ -711,114 +1938,113 @@ bool qSim_qreg::do_state_measure(int q_idx, int q_len, bool do_rnd, bool collaps
     else {
     	// get highest probability value directly
     	*m_st = 0;
-    	*m_pr = pr_vec[*m_st];
-    	for (int i=1; i<q_stn; i++) {
-    		if (pr_vec[i] > *m_pr) {
-    			*m_pr = pr_vec[i];
+    	*m_pr = (*pr_vec)[*m_st];
+    	for (QREG_ST_INDEX_TYPE i=1; i<q_stn; i++) {
+    		if ((*pr_vec)[i] > *m_pr) {
+    			*m_pr = (*pr_vec)[i];
     			*m_st = i;
     		}
     	}
     }
-
-    // handle qureg state collapsing after measure
-    if (collapse_st) {
-    	// collapse states
-    	for (int i=0; i<(int)this->m_totStates; i++) {
-    		unsigned int val_i = get_state_bitval(i, q_idx, q_len);
-    	    if (val_i == *m_st) {
-                // state taken
-#ifndef __QSIM_CPU__
-    	        this->m_states_x[i] = cuCdiv(this->m_states_x[i], QREG_ST_MAKE_VAL(sqrt(*m_pr), 0.0));
-#else
-    	        this->m_states_x[i] /= QREG_ST_MAKE_VAL(sqrt(*m_pr), 0.0);
-#endif
-    	        m_vec->push_back(i);
-    	    }
-    	    else {
-    	        // state not taken - reset
-    	    	this->m_states_x[i] = QREG_ST_MAKE_VAL(0.0, 0.0);
-    	    }
-    	}
-    	
-    	// apply to device
-    	m_qcpu_device->dev_qreg_host2device_align(m_devStates_x, m_states_x, m_totStates);
-    }
-
-	return res;
 }
 
-double qSim_qreg::get_state_probability(int st_idx, int q_idx, int q_len) {
-	// calculate the state probability (i.e. partial or total probability) at given index
-	// for the given measured sub-qureg taking values from state coefficient(s)
-
-//	cout << "get_state_probability...st_idx: " << st_idx << " q_idx: " << q_idx << "  q_len: " << q_len << endl;
-
+bool qSim_qreg::stateMeasureBatch(int q_idx, int q_len, bool m_rand, bool m_coll,
+								  QREG_ST_INDEX_ARRAY_TYPE* m_sts, std::vector<double>* m_prs) {
+	// perform measure on each batched qureg sample, as per stateMeasure (no collapsed state
+	// index vector returned)
+	//
 	// inputs:
-	// - st_idx: probability state index (>=0!)
-	// - q_idx: measured sub-qureg start index (-1 for whole qureg or [0, ..., n-1] for full qureg/partial sub-qureg)
-	// - q_len: measured sub-qureg length (0 for whole qureg or [1, ..., n] for full qureg/partial sub-qureg
+	// - q_idx: measured sub-qureg start index position within the sample qubits (-1 for
+	//          complete sample state measure)
+	// - q_len: measured sub-qureg len
+	// - m_rand: use random expectation selection or deterministic max probability selection
+	// - m_coll: perform state collapsing on each measured sample
+	// - m_sts: measured state index of each sample
+	// - m_prs: measured state probability of each sample
 	//
-	double m_pr;
-	// check qureg specs
-    if ((q_idx < 0) || ((q_idx == 0) && ((unsigned int)q_len == this->m_totQubits))) {
-    	// complete qureg state probability
+	if (q_idx < 0) {
+		q_idx = 0;
+		q_len = m_sampleQubits;
+	}
 
-    	// probability of the state taken - abs() get the absolute value of a complex number
-#ifndef __QSIM_CPU__
-//    	m_pr = cuCmul(this->m_states_x[st_idx], cuConj(this->m_states_x[st_idx])).x;
-    	m_pr = powf(cuCabs(this->m_states_x[st_idx]), 2.0);
-#else
-    	m_pr = std::norm(this->m_states_x[st_idx]);
-#endif
+	// sanity checks in input arguments
+	if (q_idx > m_sampleQubits-1) {
+		cerr << "qSim_qreg::stateMeasureBatch - q_idx parameter [" << q_idx << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
 
-//    	cout << "get_state_probability...st_idx: " << st_idx << " --> st_ampl: " << this->m_states_x[st_idx].x << "," << this->m_states_x[st_idx].y << endl;
-//    	cout << "st_ampl-conj: " << cuConj(this->m_states_x[st_idx]).x << "," << cuConj(this->m_states_x[st_idx]).y << endl;
-//    	cout << "pr: " << cuCmul(this->m_states_x[st_idx], cuConj(this->m_states_x[st_idx])).x << "," << cuCmul(this->m_states_x[st_idx], cuConj(this->m_states_x[st_idx])).y << endl;
-//    	cout << "pr2: " << powf(cuCabs(this->m_states_x[st_idx]), 2.0) << endl;
+	if ((q_len < 1) || (q_len > m_sampleQubits-q_idx)) {
+		cerr << "qSim_qreg::stateMeasureBatch - q_len parameter [" << q_len << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
 
-    }
-    else {
-    	// give partial qureg state probability
-    	// look at all partial state occurrences
-    	m_pr = 0.0;
-    	for (int i=0; i<(int)this->m_totStates; i++) {
-    		// extract given qubit partial state (index-length) from i-th state
-			int val_i = get_state_bitval(i, q_idx, q_len);
-
-			// check it with given sub-state
-	        if (st_idx == val_i) {
-	        	// probability of the state taken - abs() get the absolute value of a complex number
-#ifndef __QSIM_CPU__
-//	        	m_pr += cuCmul(this->m_states_x[i], cuConj(this->m_states_x[i])).x;
-	        	m_pr += powf(cuCabs(this->m_states_x[i]), 2.0);
-#else
-	        	m_pr += std::norm(this->m_states_x[i]);
-#endif
-			}
-		}
+	if (m_verbose)
+		cout << "stateMeasureBatch...q_idx: " << q_idx << " q_len: " << q_len << " m_rand: " << m_rand
+			 << " m_coll: " << m_coll << " samples: " << m_totSamples << endl;
+
+	// sub-states probabilities and measure of each sample, on the sample device states
+	shard_restore_layout();
+	std::vector<double> pr_vec((QREG_ST_INDEX_TYPE)1 << q_len);
+	m_sts->assign(m_totSamples, 0);
+	m_prs->assign(m_totSamples, 0.0);
+	for (int s=0; s<m_totSamples; s++) {
+		QREG_ST_RAW_VAL_TYPE* x_s = m_shards[0].m_devStates_x + s*m_sampleStates;
+		device()->dev_qreg_marginals(x_s, m_sampleStates, q_idx, q_len, pr_vec.data(), m_verbose);
+		select_measure_state(&pr_vec, m_rand, &(*m_sts)[s], &(*m_prs)[s]);
+		if (m_coll)
+			device()->dev_qreg_collapse(x_s, m_sampleStates, q_idx, q_len, (*m_sts)[s], (*m_prs)[s], m_verbose);
 	}
-	return m_pr;
+	if (m_coll)
+		m_syncFlag = false;
+	return true;
 }
 
-int qSim_qreg::get_state_bitval(int val, int b_idx, int b_len) {
-    int b = 0;
-    for (int i=0; i<b_len; i++) {
-        b += int(powf(2, i))*((val & int((powf(2, (b_idx+i))))) >> (b_idx+i));
-    }
-    return b;
+void qSim_qreg::get_state_marginals(int q_idx, int q_len, std::vector<double>* pr_vec) {
+	// calculate the probabilities of all sub-states of the given measured sub-qureg
+	// in a single pass on the device states
+	//
+	// inputs:
+	// - q_idx: measured sub-qureg start index, in range [0, ..., n-1]
+	// - q_len: measured sub-qureg length, in range [1, ..., n-q_idx]
+	// - pr_vec: sub-state probabilities, indexed by sub-state value
+	//
+	// => qubits on their own positions, shard marginals on the measured local qubits added to
+	//    the sub-states selected by the shard measured global qubits (if any), and summed on
+	//    all nodes if distributed
+	pr_vec->assign((QREG_ST_INDEX_TYPE)1 << q_len, 0.0);
+	shard_restore_layout();
+	int l_len = std::max(0, std::min(q_idx+q_len, m_shardQubits) - q_idx);
+	int l_idx = (l_len > 0) ? q_idx : 0;
+	int g_off = std::max(q_idx, m_shardQubits) - m_shardQubits;
+	QREG_ST_INDEX_TYPE g_mask = ((QREG_ST_INDEX_TYPE)1 << (q_len - l_len)) - 1;
+	QREG_ST_INDEX_TYPE l_stn = (QREG_ST_INDEX_TYPE)1 << l_len;
+	std::vector<double> sh_vec(l_stn);
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		device(sh)->dev_qreg_marginals(m_shards[sh].m_devStates_x, m_shardStates, l_idx, l_len, sh_vec.data(), m_verbose);
+		double* pr_sh = pr_vec->data() + ((((QREG_ST_INDEX_TYPE)(m_shardBase+sh) >> g_off) & g_mask) << l_len);
+		for (QREG_ST_INDEX_TYPE j=0; j<l_stn; j++)
+			pr_sh[j] += sh_vec[j];
+	}
+	if (m_qnode != NULL)
+		m_qnode->allreduce_sum(pr_vec->data(), pr_vec->size());
+}
+
+QREG_ST_INDEX_TYPE qSim_qreg::get_state_bitval(QREG_ST_INDEX_TYPE val, int b_idx, int b_len) {
+	// extract the b_len bits sub-state starting at bit b_idx
+    return (val >> b_idx) & (((QREG_ST_INDEX_TYPE)1 << b_len) - 1);
 }
 
 // -------------------------------------
 // -------------------------------------
 
-bool qSim_qreg::stateExpectation(int st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp, double* m_exp) {
+bool qSim_qreg::stateExpectation(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp, double* m_exp) {
 	// - st_idx: state index for expectation (-1 for all qureg states and a value for specific state)
 	// - q_idx: qubit start index for partial qureg expectation or -1 for complete qureg (st_idx >= 0 case only)
 	// - q_len: qubit length for partial qureg expectation (q_idx >= 0 case only)
 	// - obs_op: observable operator
 
 	// sanity checks in input arguments
-	if (st_idx > (int)this->m_totStates-1) {
+	if (st_idx > this->m_totStates-1) {
 		cerr << "qSim_qreg::stateExpectation - st_idx parameter [" << st_idx << "] outside allowed range - ERROR!!" << endl;
 		return false;
 	}
@@ -841,117 +2067,125 @@ bool qSim_qreg::stateExpectation(int st_idx, int q_idx, int q_len, QASM_EX_OBSOP
 		cout << "stateExpectation -> st_idx: " << st_idx << " q_idx: " << q_idx
 			 << " q_len: " << q_len << " ex_opsOp: " << ex_opsOp << endl;
 
-	// synchronise host with device
-	synchDevStates();
-
-	// take value from state coefficient(s)
-	if (st_idx < 0) {
-		// handle complete qureg states
-		if (m_verbose)
-			cout << "all states - complete ==> st_idx: -1" << endl;
+	// select states and observable qubits for the device reduction
+	QREG_ST_INDEX_TYPE sel_mask, sel_val, obs_mask;
+	get_state_expectation_masks(st_idx, q_idx, q_len, m_totQubits, &sel_mask, &sel_val, &obs_mask);
+
+	// observable weights - by number of set observable bits
+	std::vector<double> w_vec;
+	get_state_expectation_weights(obs_mask, ex_opsOp, &w_vec);
+
+	// expectation in a single pass on device states - masks on shard layout positions, each
+	// shard selected and its weights offset by its own global qubits (if any), and summed on
+	// all nodes if distributed
+	QREG_ST_INDEX_TYPE p_sel_mask = shard_layout_mask(sel_mask);
+	QREG_ST_INDEX_TYPE p_sel_val = shard_layout_mask(sel_val);
+	QREG_ST_INDEX_TYPE p_obs_mask = shard_layout_mask(obs_mask);
+	QREG_ST_INDEX_TYPE l_mask = m_shardStates - 1;
+	int ret = QDEV_RES_OK;
+	*m_exp = 0.0;
+	for (unsigned int sh=0; (sh<m_shards.size()) && (ret == QDEV_RES_OK); sh++) {
+		QREG_ST_INDEX_TYPE g_idx = (QREG_ST_INDEX_TYPE)(m_shardBase+sh) << m_shardQubits;
+		if ((g_idx & p_sel_mask) != (p_sel_val & ~l_mask))
+			continue;
+		int k_sh = __builtin_popcountll(g_idx & p_obs_mask);
+		double sh_exp = 0.0;
+		ret = device(sh)->dev_qreg_expectation(m_shards[sh].m_devStates_x, m_shardStates, p_sel_mask & l_mask,
+											   p_sel_val & l_mask, p_obs_mask & l_mask, w_vec.data() + k_sh,
+											   &sh_exp, m_verbose);
+		*m_exp += sh_exp;
+	}
+	if (m_qnode != NULL)
+		m_qnode->allreduce_sum(m_exp, 1);
+	if (m_verbose)
+		cout << "tot exp: " << (*m_exp) << endl;
 
-		// get observable expectation values
-		std::vector<double> ex_obsOp_vec;
-		get_state_expectations(-1, 0, ex_opsOp, &ex_obsOp_vec);
+	return (ret == QDEV_RES_OK);
+}
 
-		// get state probability values
-		std::vector<double> pr_vec;
-		get_state_probabilities(&pr_vec);
+bool qSim_qreg::stateExpectationBatch(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp,
+									  std::vector<double>* m_exps) {
+	// calculate state expectation of each batched qureg sample, as per stateExpectation
+	// (state index and sub-qureg within the sample qubits) - m_exps: expectation of each sample
 
-		// sum of the expectations of all qubit states
-		(*m_exp) = 0.0;
-		for (unsigned int i=0; i<m_totStates; i++) {
-			(*m_exp) += ex_obsOp_vec[i]*pr_vec[i];
-			if (m_verbose)
-				cout << "i: " << i << " pr_i: " << pr_vec[i] << " exp_i: " << ex_obsOp_vec[i]*pr_vec[i] << endl;
-		}
-		if (m_verbose)
-			cout << "tot exp: " << (*m_exp) << endl;
+	// sanity checks in input arguments
+	if (st_idx > m_sampleStates-1) {
+		cerr << "qSim_qreg::stateExpectationBatch - st_idx parameter [" << st_idx << "] outside allowed range - ERROR!!" << endl;
+		return false;
 	}
-	else {
-		// specific state given
-		if (m_verbose)
-			cout << "specific state - complete => st_idx:" << st_idx << endl;
 
-		// get observable expectation values
-		std::vector<double> ex_obsOp_vec;
-		get_state_expectations(q_idx, q_len, ex_opsOp, &ex_obsOp_vec);
+	if (q_idx > m_sampleQubits-1) {
+		cerr << "qSim_qreg::stateExpectationBatch - q_idx parameter [" << q_idx << "] outside allowed range - ERROR!!" << endl;
+		return false;
+	}
 
-		// expectation of the given qureg state
-		if (q_idx < 0) {
-			// full qureg
-			double pr = get_state_probability(st_idx, -1, 0);
-			(*m_exp) = ex_obsOp_vec[st_idx]*pr;
-//			cout << "...pr: " << pr << "  st_exp: " << ex_obsOp_vec[st_idx] << "  exp: " << (*m_exp) << endl;
-		}
-		else {
-			// specific sub-qureg - spanning over all states
-			(*m_exp) = 0.0;
-			std::vector<double> pr_vec;
-			get_state_probabilities(&pr_vec);
-			for (unsigned int i=0; i<m_totStates; i++) {
-				int val_i = get_state_bitval(i, q_idx, q_len);
-				if (val_i == st_idx) {
-					// state taken - update expectation
-					(*m_exp) += ex_obsOp_vec[i ]* pr_vec[i];
-				}
-				else {
-					// state not taken - skip it
-					;
-				}
-			}
-		}
+	if ((q_len < 0) || (q_len > m_sampleQubits-q_idx)) {
+		cerr << "qSim_qreg::stateExpectationBatch - q_len parameter [" << q_len << "] outside allowed range - ERROR!!" << endl;
+		return false;
 	}
 
-	return true;
+	if (m_verbose)
+		cout << "stateExpectationBatch -> st_idx: " << st_idx << " q_idx: " << q_idx
+			 << " q_len: " << q_len << " ex_opsOp: " << ex_opsOp << " samples: " << m_totSamples << endl;
+
+	// select states and observable qubits on the sample qubits, with observable weights
+	QREG_ST_INDEX_TYPE sel_mask, sel_val, obs_mask;
+	get_state_expectation_masks(st_idx, q_idx, q_len, m_sampleQubits, &sel_mask, &sel_val, &obs_mask);
+	std::vector<double> w_vec;
+	get_state_expectation_weights(obs_mask, ex_opsOp, &w_vec);
+
+	// expectation of each sample in a single pass on the sample device states (single shard,
+	// qubits on their own positions)
+	shard_restore_layout();
+	int ret = QDEV_RES_OK;
+	m_exps->assign(m_totSamples, 0.0);
+	for (int s=0; (s<m_totSamples) && (ret == QDEV_RES_OK); s++)
+		ret = device()->dev_qreg_expectation(m_shards[0].m_devStates_x + s*m_sampleStates, m_sampleStates,
+											 sel_mask, sel_val, obs_mask, w_vec.data(), &(*m_exps)[s], m_verbose);
+	return (ret == QDEV_RES_OK);
 }
 
-void qSim_qreg::get_state_probabilities(std::vector<double>* pr_vec) {
-	// get qureg state probability array
-//	QREG_ST_VAL_ARRAY_TYPE st_vec;
-//	getStates(&st_vec);
-	pr_vec->clear();
-//	for (unsigned int i=0; i<st_vec.size(); i++) {
-//		pr_vec->push_back(std::norm(st_vec[i]));
-//	}
-	for (unsigned int i=0; i<m_totStates; i++) {
-#ifndef __QSIM_CPU__
-		double st_r = m_states_x[i].x;
-		double st_i = m_states_x[i].y;
-#else
-		double st_r = m_states_x[i].real();
-		double st_i = m_states_x[i].imag();
-#endif
-		pr_vec->push_back(std::norm(std::complex<double>(st_r, st_i)));
+void qSim_qreg::get_state_expectation_masks(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, int qn,
+											QREG_ST_INDEX_TYPE* sel_mask, QREG_ST_INDEX_TYPE* sel_val,
+											QREG_ST_INDEX_TYPE* obs_mask) {
+	// get selected states and observable qubits masks, for the given expectation args on a
+	// qn qubits state vector
+	// => observable expval vector as tensor product of the 1-qubit obs_op replicas
+	//    (identity fillers outside given sub-qureg), first built replica on MSQ
+	QREG_ST_INDEX_TYPE all_mask = ((QREG_ST_INDEX_TYPE)1 << qn) - 1;
+	if (st_idx < 0) {
+		// handle complete qureg states
+		if (m_verbose)
+			cout << "all states - complete ==> st_idx: -1" << endl;
+		*sel_mask = 0;
+		*sel_val = 0;
+		*obs_mask = all_mask;
 	}
-
-	if (m_verbose) {
-		cout << "pr_vec: ";
-		for (unsigned int i=0; i<pr_vec->size(); i++)
-			cout << (*pr_vec)[i] << " ";
-		cout << endl;
+	else if (q_idx < 0) {
+		// specific state given - full qureg
+		if (m_verbose)
+			cout << "specific state - complete => st_idx:" << st_idx << endl;
+		*sel_mask = all_mask;
+		*sel_val = st_idx;
+		*obs_mask = all_mask;
 	}
-
-}
-
-void qSim_qreg::kron_product(std::vector<double>* v1, std::vector<double>* v2, std::vector<double>* v3) {
-	// perform kroneker product between two vectors
-	std::vector<double> v_aux;
-	for (unsigned int i=0; i<v1->size(); i++) {
-		for (unsigned int j=0; j<v2->size(); j++) {
-			v_aux.push_back((*v1)[i]*(*v2)[j]);
-		}
+	else {
+		// specific state given - sub-qureg, spanning over all states
+		if (m_verbose)
+			cout << "specific state - sub-qureg => st_idx:" << st_idx << endl;
+		QREG_ST_INDEX_TYPE q_mask = ((QREG_ST_INDEX_TYPE)1 << q_len) - 1;
+		*sel_mask = q_mask << q_idx;
+		*sel_val = st_idx << q_idx;
+		*obs_mask = q_mask << (qn - q_idx - q_len);
 	}
-	(*v3) = v_aux;
 }
 
-void qSim_qreg::get_state_expectations(int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_obsOp,
-									   std::vector<double>* ex_obsOp_vec) {
-	// get observable expectations for current qureg start index and size
-	// applying ones vectors as LSQ and MSQ via tensor products
-
-	// - q_idx: qubit start index for partial qureg expectation or -1 for complete qureg
-	// - q_len: qubit length for partial qureg expectation (q_idx >= 0 case only)
+void qSim_qreg::get_state_expectation_weights(QREG_ST_INDEX_TYPE obs_mask, QASM_EX_OBSOP_TYPE ex_obsOp,
+											  std::vector<double>* w_vec) {
+	// get observable expectation values for observable qubits mask, as products of the
+	// 1-qubit obs_op eigenvalues indexed by the number of qubits in state |1>
+	//
+	// - obs_mask: observable qubits mask
 	// - obs_op: observable operator
 
 	// retrieve operator vector for given observable
@@ -964,84 +2198,309 @@ void qSim_qreg::get_state_expectations(int q_idx, int q_len, QASM_EX_OBSOP_TYPE
 		cout << endl;
 	}
 
-	if (q_idx < 0) {
-    	// whole qureg - apply 1-qubit obs_op replicas for all qubits
-		(*ex_obsOp_vec) = obs_ev_1q_vec;
-		for (unsigned int i=0; i<m_totQubits-1; i++) {
-			kron_product(ex_obsOp_vec, &obs_ev_1q_vec, ex_obsOp_vec);
-		}
+	// w[k] = ev_0^(m-k) * ev_1^k - with m observable qubits
+	int m = 0;
+	for (QREG_ST_INDEX_TYPE b=obs_mask; b!=0; b&=b-1)
+		m++;
+	w_vec->assign(m+1, 0.0);
+	for (int k=0; k<=m; k++) {
+		double w = 1.0;
+		for (int i=0; i<m; i++)
+			w *= (i < k) ? obs_ev_1q_vec[1] : obs_ev_1q_vec[0];
+		(*w_vec)[k] = w;
 	}
-	else {
-		// specified sub-qureg - apply 1-qubit obs_op used for given qubit range only
-		// and 1-qubit identity_op LSQ and MSQ fillers for the rest
-		std::vector<double> ones_vec = {1.0, 1.0};
-
-		// handle LSQ identities + first 1-qubit obs_op replica
-		if (q_idx > 0) {
-			(*ex_obsOp_vec) = ones_vec;
-			for (int i=0; i<q_idx-1; i++) {
-				kron_product(ex_obsOp_vec, &ones_vec, ex_obsOp_vec);
-			}
-			kron_product(ex_obsOp_vec, &obs_ev_1q_vec, ex_obsOp_vec);
-		}
-		else {
-			(*ex_obsOp_vec) = obs_ev_1q_vec;
-		}
 
-		// add other 1-qubit obs_op replicas - if needed
-		for (int i=0; i<q_len-1; i++) {
-			kron_product(ex_obsOp_vec, &obs_ev_1q_vec, ex_obsOp_vec);
-		}
+	if (m_verbose) {
+		cout << "obs_mask: " << obs_mask << " --> w_vec: ";
+		for (size_t k=0; k<w_vec->size(); k++)
+			cout << (*w_vec)[k] << " ";
+		cout << endl;
+	}
+}
 
-		// add MSQ replicas - if needed
-		for (unsigned int i=q_idx+q_len; i<m_totQubits; i++) {
-			kron_product(ex_obsOp_vec, &ones_vec, ex_obsOp_vec);
-		}
+// -------------------------------------
+// -------------------------------------
+
+int qSim_qreg::shard_place_span(int q_lo, int q_len) {
+	// place the given qubits span on consecutive local shard layout positions, in the same
+	// order, and return the span first position - qubits left where placed afterwards, so
+	// that following functions on the same qubits need no further exchanges
+	// => span out of qureg limits left unchanged (function limits checked by device)
+	if ((q_lo < 0) || (q_len < 1) || (q_len > m_shardQubits) || (q_lo+q_len > (int)m_totQubits))
+		return q_lo;
+
+	bool placed = (m_qubitPos[q_lo]+q_len <= m_shardQubits);
+	for (int i=1; placed && (i<q_len); i++)
+		placed = (m_qubitPos[q_lo+i] == m_qubitPos[q_lo]+i);
+	if (placed)
+		return m_qubitPos[q_lo];
+
+	// span moved on its own positions, or on the highest local ones if crossing the local
+	// qubits limit
+	int p_lo = std::min(q_lo, m_shardQubits-q_len);
+	for (int i=0; i<q_len; i++)
+		if (m_qubitPos[q_lo+i] != p_lo+i)
+			shard_swap_qubits(m_qubitPos[q_lo+i], p_lo+i);
+	return p_lo;
+}
+
+void qSim_qreg::shard_place_qubits(int q_n, const int* q_idx, int* p_idx) {
+	// place the given qubits on local shard layout positions, in any order, and return their
+	// positions - qubits on global positions moved on the highest local position not holding
+	// any of them (a single shards exchange for the highest local one), the other ones left
+	// where placed
+	for (int i=0; i<q_n; i++) {
+		if (m_qubitPos[q_idx[i]] < m_shardQubits)
+			continue;
+		int p = m_shardQubits - 1;
+		while (std::find(q_idx, q_idx + q_n, m_qubitAt[p]) != q_idx + q_n)
+			p--;
+		shard_swap_qubits(m_qubitPos[q_idx[i]], p);
 	}
+	for (int i=0; i<q_n; i++)
+		p_idx[i] = m_qubitPos[q_idx[i]];
+}
+
+void qSim_qreg::shard_restore_layout() {
+	// move each qubit back on its own position (i.e. state vector in qubits order)
+	for (unsigned int q=0; q<m_totQubits; q++)
+		if (m_qubitPos[q] != (int)q)
+			shard_swap_qubits(m_qubitPos[q], q);
+}
 
-	// return overall observable expval vector - spanning the full qureg!
+void qSim_qreg::shard_reset_layout() {
+	// each qubit on its own position - no states moved (states to be overwritten)
+	for (unsigned int q=0; q<m_totQubits; q++) {
+		m_qubitPos[q] = q;
+		m_qubitAt[q] = q;
+	}
+}
+
+void qSim_qreg::shard_swap_qubits(int p_a, int p_b) {
+	// swap the qubits on given positions - states moved and qubits placement updated
 	if (m_verbose)
-    	cout << "q_idx: " << q_idx << " --> obs_ev_vec: " << ex_obsOp_vec->size() << endl;
+		cout << "qSim_qreg::shard_swap_qubits - positions: " << p_a << " <-> " << p_b << endl;
+	shard_swap_positions(p_a, p_b);
+	int q_a = m_qubitAt[p_a];
+	int q_b = m_qubitAt[p_b];
+	m_qubitAt[p_a] = q_b;
+	m_qubitAt[p_b] = q_a;
+	m_qubitPos[q_a] = p_b;
+	m_qubitPos[q_b] = p_a;
+}
 
-	if (m_verbose) {
-		cout << "ex_obsOp_vec: ";
-		for (unsigned int i=0; i<ex_obsOp_vec->size(); i++)
-			cout << (*ex_obsOp_vec)[i] << " ";
-		cout << endl;
+void qSim_qreg::shard_layout_swap(int q_a, int q_b) {
+	// swap the given qubits layout positions - no states moved (i.e. qubits values swapped)
+	int p_a = m_qubitPos[q_a];
+	int p_b = m_qubitPos[q_b];
+	m_qubitPos[q_a] = p_b;
+	m_qubitPos[q_b] = p_a;
+	m_qubitAt[p_b] = q_a;
+	m_qubitAt[p_a] = q_b;
+}
+
+void qSim_qreg::shard_swap_positions(int p_a, int p_b) {
+	// swap states on given positions - local positions swapped within each shard, global
+	// positions exchanged with the highest local one (any other local or global position
+	// swapped through it, as swaps conjugation)
+	if (p_a > p_b)
+		std::swap(p_a, p_b);
+	int p_hi = m_shardQubits - 1;
+	if (p_b < m_shardQubits)
+		shard_swap_local(p_a, p_b);
+	else if (p_a == p_hi)
+		shard_exchange_global(p_b);
+	else if (p_a < m_shardQubits) {
+		shard_swap_local(p_a, p_hi);
+		shard_exchange_global(p_b);
+		shard_swap_local(p_a, p_hi);
+	}
+	else {
+		shard_swap_positions(p_hi, p_a);
+		shard_swap_positions(p_hi, p_b);
+		shard_swap_positions(p_hi, p_a);
+	}
+}
+
+void qSim_qreg::shard_swap_local(int p_a, int p_b) {
+	// local positions swap on each shard - SWAP gate on device controlled gates engine
+	const QREG_ST_RAW_VAL_TYPE v0 = QREG_ST_MAKE_VAL(0.0, 0.0);
+	const QREG_ST_RAW_VAL_TYPE v1 = QREG_ST_MAKE_VAL(1.0, 0.0);
+	const QREG_ST_RAW_VAL_TYPE swap_mtx[16] = {v1, v0, v0, v0,
+											   v0, v0, v1, v0,
+											   v0, v1, v0, v0,
+											   v0, v0, v0, v1};
+	const int t_idx[2] = {p_a, p_b};
+	for (unsigned int sh=0; sh<m_shards.size(); sh++)
+		device(sh)->dev_qreg_apply_function_controlled(m_shards[sh].m_devStates_x, m_shardStates, 0, 2, t_idx,
+													   swap_mtx, m_verbose);
+}
+
+void qSim_qreg::shard_exchange_global(int p_g) {
+	// global position exchange with the highest local one - on each shards pair differing
+	// by the global position bit only, the upper half of the first shard swapped with the
+	// lower half of the second one, staged on the second shard device register
+	QREG_ST_INDEX_TYPE g_bit = (QREG_ST_INDEX_TYPE)1 << (p_g - m_shardQubits);
+	QREG_ST_INDEX_TYPE h_stn = m_shardStates / 2;
+	if (g_bit >= (QREG_ST_INDEX_TYPE)m_shards.size()) {
+		// shards pairs on different nodes
+		shard_exchange_node(p_g);
+		return;
+	}
+
+	// pending work on all shards completed before any exchange
+	for (unsigned int sh=0; sh<m_shards.size(); sh++)
+		device(sh)->dev_qreg_stream_sync();
+
+	// copies enqueued on second shard stream
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		if (sh & g_bit)
+			continue;
+		qSim_qreg_shard* sh_a = &m_shards[sh];
+		qSim_qreg_shard* sh_b = &m_shards[sh | g_bit];
+		qSim_qcpu_device* q_dev = device(sh | g_bit);
+		q_dev->dev_qreg_device_copy(sh_b->m_devStates_y, sh_b->m_devId, sh_a->m_devStates_x + h_stn, sh_a->m_devId, h_stn);
+		q_dev->dev_qreg_device_copy(sh_a->m_devStates_x + h_stn, sh_a->m_devId, sh_b->m_devStates_x, sh_b->m_devId, h_stn);
+		q_dev->dev_qreg_device_copy(sh_b->m_devStates_x, sh_b->m_devId, sh_b->m_devStates_y, sh_b->m_devId, h_stn);
 	}
 
+	// exchanges completed before following work on first shards
+	for (unsigned int sh=0; sh<m_shards.size(); sh++)
+		if (sh & g_bit)
+			device(sh)->dev_qreg_stream_sync();
+}
+
+void qSim_qreg::shard_exchange_node(int p_g) {
+	// global position exchange with the highest local one, on node slice pairs differing by the
+	// global position bit only - each local shard half swapped with the same local shard of the
+	// peer node (upper half on the first node, lower half on the second one)
+	QREG_ST_INDEX_TYPE g_bit = (QREG_ST_INDEX_TYPE)1 << (p_g - m_shardQubits);
+	QREG_ST_INDEX_TYPE h_stn = m_shardStates / 2;
+	int peer = m_qnode->get_rank() ^ (int)(g_bit / m_shards.size());
+	bool lo_node = ((m_shardBase & g_bit) == 0);
+#ifndef __QSIM_CPU__
+	// device states staged on host buffer
+	std::vector<QREG_ST_RAW_VAL_TYPE> h_buf(h_stn);
+#endif
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		QREG_ST_RAW_VAL_TYPE* d_half = m_shards[sh].m_devStates_x + (lo_node ? h_stn : 0);
+#ifndef __QSIM_CPU__
+		device(sh)->dev_qreg_device2host(h_buf.data(), d_half, h_stn);
+		m_qnode->exchange(h_buf.data(), h_stn*sizeof(QREG_ST_RAW_VAL_TYPE), peer);
+		device(sh)->dev_qreg_host2device_align(d_half, h_buf.data(), h_stn);
+#else
+		device(sh)->dev_qreg_stream_sync();
+		m_qnode->exchange(d_half, h_stn*sizeof(QREG_ST_RAW_VAL_TYPE), peer);
+#endif
+	}
+}
+
+QREG_ST_INDEX_TYPE qSim_qreg::shard_layout_mask(QREG_ST_INDEX_TYPE q_mask) {
+	// qubits mask (or value) bits moved on qubits shard layout positions
+	QREG_ST_INDEX_TYPE p_mask = 0;
+	for (unsigned int q=0; q<m_totQubits; q++)
+		if ((q_mask >> q) & 1)
+			p_mask |= (QREG_ST_INDEX_TYPE)1 << m_qubitPos[q];
+	return p_mask;
+}
+
+QREG_ST_INDEX_TYPE qSim_qreg::shard_layout_index(QREG_ST_INDEX_TYPE p_idx) {
+	// shard layout positions index bits moved back on their qubits (i.e. state index in
+	// qubits order)
+	QREG_ST_INDEX_TYPE st_idx = 0;
+	for (unsigned int p=0; p<m_totQubits; p++)
+		if ((p_idx >> p) & 1)
+			st_idx |= (QREG_ST_INDEX_TYPE)1 << m_qubitAt[p];
+	return st_idx;
 }
 
-// -------------------------------------
 // -------------------------------------
 
-void qSim_qreg::synchDevStates() {
-	// synchronise qreg content with device array, if needed
+qSim_qcpu_device* qSim_qreg::device(int sh) {
+	// select qureg shard device and stream for the following device calls - device shared
+	// by all qregs of the Q-CPU, each one enqueuing its work on its own streams
+	m_qcpu_device->dev_gpu_select(m_shards[sh].m_devId);
+	m_qcpu_device->dev_qreg_stream_select(m_shards[sh].m_devStream);
+	return m_qcpu_device;
+}
+
+bool qSim_qreg::synchDevStates() {
+	// synchronise qreg content with device array, if needed - false if host states not
+	// allocated
 	if (m_verbose)
 		cout << "qSim_qreg::synchDevStates - synch_flag: " << m_syncFlag << endl;
 
 	if (!m_syncFlag) {
-		// qureg host & device not in sync - perform alignment
-		m_qcpu_device->dev_qreg_device2host(m_states_x, m_devStates_x, m_totStates);
+		// qureg host & device not in sync - perform alignment (not needed if shared), with
+		// qubits on their own positions (also if shared) and shards in global qubits order
+		if (!allocHostStates())
+			return false;
+		shard_restore_layout();
+		if (m_states_x != m_shards[0].m_devStates_x) {
+			uint64_t t_sync = qSim_qstats::now_ns();
+			for (unsigned int sh=0; sh<m_shards.size(); sh++)
+				device(sh)->dev_qreg_device2host(m_states_x + sh*m_shardStates, m_shards[sh].m_devStates_x,
+												 m_shardStates);
+			qSim_qstats::record(QSTATS_STAGE_SYNC, QSTATS_KEY_SYNC_D2H, t_sync,
+								m_shards.size()*m_shardStates*sizeof(QREG_ST_RAW_VAL_TYPE));
+		}
 		m_syncFlag = true;
 	}
+	return true;
+}
+
+void qSim_qreg::alignDevStates() {
+	// align device register with host states (not needed if shared) - qubits on their own
+	// positions and shards in global qubits order
+	shard_reset_layout();
+	if (m_states_x != m_shards[0].m_devStates_x) {
+		uint64_t t_sync = qSim_qstats::now_ns();
+		for (unsigned int sh=0; sh<m_shards.size(); sh++)
+			device(sh)->dev_qreg_host2device_align(m_shards[sh].m_devStates_x, m_states_x + sh*m_shardStates,
+												   m_shardStates);
+		qSim_qstats::record(QSTATS_STAGE_SYNC, QSTATS_KEY_SYNC_H2D, t_sync,
+							m_shards.size()*m_shardStates*sizeof(QREG_ST_RAW_VAL_TYPE));
+	}
+}
+
+bool qSim_qreg::allocHostStates() {
+	// allocate host states on first use (node slice only if distributed) - in in-place mode
+	// the device register is host accessible and directly shared
+	if (m_states_x == NULL) {
+		if (m_inPlace)
+			m_states_x = m_shards[0].m_devStates_x;
+		else
+			m_states_x = new (std::nothrow) QREG_ST_RAW_VAL_TYPE[m_shards.size()*m_shardStates];
+		if (m_states_x == NULL) {
+			cerr << "ERROR!! qreg - host states allocation failed for qureg size: " << m_totQubits << endl;
+			return false;
+		}
+	}
+	return true;
 }
 
 // -------------------------------------
 
 void qSim_qreg::dump(unsigned max_st) {
 	cout << "*** qSim_qreg dump ***" << endl << endl;
-	cout << " m_devStates_x: " << m_devStates_x << endl;
-	cout << " m_devStates_y: " << m_devStates_y << endl;
+	for (unsigned int sh=0; sh<m_shards.size(); sh++) {
+		cout << " shard #" << sh << " - device: " << m_shards[sh].m_devId << endl;
+		cout << "  m_devStates_x: " << m_shards[sh].m_devStates_x << endl;
+		cout << "  m_devStates_y: " << m_shards[sh].m_devStates_y << endl;
+	}
 	cout << " m_totStates:   " << m_totStates << endl;
-	unsigned int tot_st = std::min(m_totStates, max_st);
-	for (unsigned int k=0; k<tot_st; k++)
+	cout << " m_shardStates: " << m_shardStates << endl;
+	cout << " m_shardBase:   " << m_shardBase << " of " << m_totShards << endl;
+	cout << " m_inPlace:     " << m_inPlace << endl;
+	QREG_ST_INDEX_TYPE node_st = (QREG_ST_INDEX_TYPE)m_shards.size()*m_shardStates;
+	QREG_ST_INDEX_TYPE tot_st = (m_states_x != NULL) ? std::min(node_st, (QREG_ST_INDEX_TYPE)max_st) : 0;
+	for (QREG_ST_INDEX_TYPE k=0; k<tot_st; k++)
 #ifndef __QSIM_CPU__
 		cout << "#" << k << " " << m_states_x[k].x << "  " << m_states_x[k].y << endl;
 #else
 		cout << "#" << k << " " << m_states_x[k].real() << "  " << m_states_x[k].imag() << endl;
 #endif
-	if (tot_st < m_totStates)
+	if (tot_st < node_st)
 		cout << "...";
 	cout << endl;
 }
@@ -46,6 +46,36 @@
  *  2.2   Feb-2023   Supported qureg state expectation calculation and fixed
  *                   terminology for state probability measure.
  *                   Handled QML function blocks (feature map and q-net).
+ *  2.3   Oct-2026   Handled state vector range partitioning on CPU device worker
+ *                   pool for probability and expectation reductions.
+ *  2.4   Oct-2026   Handled 64-bit state indexes and device function tables sized
+ *                   on qureg allocation (no max qureg size limit).
+ *  2.5   Oct-2026   Handled in-place mode with a single device register shared with
+ *                   host states, and host states allocated on first device->host sync.
+ *  2.6   Oct-2026   Handled gate fusion over unwrapped block instruction lists, applying
+ *                   consecutive gates within a small qubit span as dense unitaries.
+ *  2.7   Oct-2026   Supported core instruction lists execution (transformation batch).
+ *  2.8   Oct-2026   Supported state measurement shots, sampling outcomes from the
+ *                   cumulative marginal distribution calculated in a single pass.
+ *  2.9   Oct-2026   Handled state measure and expectation as device reductions (no host sync).
+ *  2.10  Oct-2026   Handled diagonal and permutation gates fast path (no device pointers swap).
+ *  2.11  Oct-2026   Handled controlled gates fast path (device bitmask engine).
+ *  2.12  Oct-2026   Handled per-qureg device stream, selected on each device call.
+ *  2.13  Oct-2026   Handled state vector sharding across devices by high-order qubits,
+ *                   with qubits placement on shard layout positions.
+ *  2.14  Oct-2026   Handled state vector shards distributed on cluster nodes, with shard
+ *                   halves exchanged among nodes and node results reduced on all nodes.
+ *  2.15  Oct-2026   Handled batched quregs - samples of the same width stored contiguously,
+ *                   with per-sample QML block args and per-sample measure and expectation.
+ *  2.16  Oct-2026   Handled q-net gradient (parameter-shift rule) on device state snapshots.
+ *  2.17  Oct-2026   Handled qureg clone and client state snapshot/restore (device copies).
+ *  2.18  Oct-2026   Handled paged state peek (device slice copy) and top-k states peek
+ *                   (device reduction).
+ *  2.19  Oct-2026   Handled QML block templates cache, shared by the qcpu lane quregs.
+ *  2.20  Oct-2026   Handled SWAP blocks as qubits placement changes (no states moved).
+ *  2.21  Oct-2026   Handled controlled gates of any width on sharded quregs (target qubits
+ *                   placed only) and instruction lists checked before applying them.
+ *  2.22  Oct-2026   Handled device and host states allocation failures (qureg not allocated).
  *
  *  --------------------------------------------------------------------------
  */
@@ -57,6 +87,7 @@
 #include <vector>
 #include <complex>
 #include <map>
+#include <random>
 
 #ifndef __QSIM_CPU__
 #include "qSim_qcpu_device_GPU_CUDA.h"
@@ -67,45 +98,143 @@
 #include "qSim_qinstruction_core.h"
 #include "qSim_qinstruction_block.h"
 #include "qSim_qinstruction_block_qml.h"
+#include "qSim_qcpu_node.h"
+
+
+// state vector shard - amplitudes having the same high-order (global) qubits value, held
+// on a single device with its own stream
+struct qSim_qreg_shard {
+	QREG_ST_RAW_VAL_TYPE* m_devStates_x;
+	QREG_ST_RAW_VAL_TYPE* m_devStates_y;
+	QDEV_STREAM_TYPE m_devStream;
+	int m_devId;
+};
+
+// state snapshot - device states copy of each shard (same device, allocated on first use),
+// with the qubits placement at snapshot time
+struct qSim_qreg_snapshot {
+	std::vector<QREG_ST_RAW_VAL_TYPE*> m_devStates;
+	std::vector<int> m_qubitPos;
+	std::vector<int> m_qubitAt;
+};
+
+// gate fusion item - core instruction single repetition, with resolved function args
+struct qSim_qreg_fusion_item {
+	qSim_qinstruction_core* m_instr;
+	QREG_F_ARGS_TYPE m_fargs;
+	int m_flsq;
+	int m_fn;	// item width in qubits - 0 if not fusable (whole instruction applied)
+	int m_fidx;	// item args index in the instruction list args - -1 if none
+};
 
 
 class qSim_qreg {
 
 	// internal attribute: state vectors
 	QREG_ST_RAW_VAL_TYPE* m_states_x;
-	QREG_ST_RAW_VAL_TYPE* m_devStates_x;
-	QREG_ST_RAW_VAL_TYPE* m_devStates_y;
-	unsigned int m_totStates;
+	QREG_ST_INDEX_TYPE m_totStates;
 	unsigned int m_totQubits;
 
 	// reference to qCUP CUDA instance
 	qSim_qcpu_device* m_qcpu_device;
 
+	// device state vector shards - split by the high-order qubits (single shard if not
+	// sharded), each one on its own device stream, with qureg transformations enqueued
+	// asynchronously and synchronised by the device only when results are accessed
+	std::vector<qSim_qreg_shard> m_shards;
+	QREG_ST_INDEX_TYPE m_shardStates;
+	int m_shardQubits;
+
+	// cluster node holding the local shards (NULL if not distributed) - local shards on the
+	// node slice of all shards, from the given first shard index
+	qSim_qcpu_node* m_qnode;
+	int m_shardBase;
+	int m_totShards;
+
+	// batched qureg samples - state vectors of the sample qubits stored contiguously, with the
+	// sample index on the high-order qubits (padded to a power of 2, padding samples kept null),
+	// single shard only (1 sample if not batched)
+	int m_totSamples;
+	int m_sampleQubits;
+	QREG_ST_INDEX_TYPE m_sampleStates;
+
+	// qubits placement - shard layout position of each qubit (low positions local to each
+	// shard, high ones selecting the shard) and qubit at each position, also changed by SWAP
+	// blocks (qubits moved lazily, on the functions using them)
+	std::vector<int> m_qubitPos;
+	std::vector<int> m_qubitAt;
+
+	// state snapshots - client one (snapshot/restore instructions) and q-net gradient input
+	// state one, kept apart not to overwrite the client snapshot
+	qSim_qreg_snapshot m_snap;
+	qSim_qreg_snapshot m_gradSnap;
+
 	// device->host synch flag
 	bool m_syncFlag;
 
+	// states allocation flag - device registers allocated (on all nodes if distributed)
+	bool m_allocFlag;
+
+	// in-place mode flag - single device register, shared with host states
+	bool m_inPlace;
+
 	// verbose flag
 	bool m_verbose;
 
+	// helper qureg for fused gates unitary calculation - created on first use
+	qSim_qreg* m_fusionQreg;
+
+	// random generator for measurement shots sampling
+	std::mt19937_64 m_rng;
+
+	// QML block templates cache - qcpu lane one if set, own one otherwise
+	qSim_qinstruction_block_qml_cache* m_qmlCache;
+	qSim_qinstruction_block_qml_cache m_qmlCacheOwn;
+
 	public:
 		// constructor and destructor
-		qSim_qreg(int q_n, qSim_qcpu_device* qcpu_dev, bool verbose);
+		qSim_qreg(int q_n, qSim_qcpu_device* qcpu_dev, bool verbose, bool in_place=false,
+				  int shard_n=1, int dev_n=1, qSim_qcpu_node* qnode=NULL, int s_n=1);
 		virtual ~qSim_qreg();
 
 		// qureg control & transformation
 		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result);
 		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
 								  QREG_ST_VAL_ARRAY_TYPE* stArray);
+		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
+								  QREG_ST_VAL_ARRAY_TYPE* stArray, QREG_ST_INDEX_ARRAY_TYPE* idxArray);
 		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
 				                  QREG_ST_INDEX_TYPE* m_st, double* m_pr, QREG_ST_INDEX_ARRAY_TYPE* m_vec);
 		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
 				                  double* m_exp);
+		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
+				                  QREG_ST_INDEX_ARRAY_TYPE* m_counts);
+
+		// batched qureg measure and expectation - one result per sample
+		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
+				                  QREG_ST_INDEX_ARRAY_TYPE* m_sts, std::vector<double>* m_prs);
+		bool applyCoreInstruction(qSim_qinstruction_core* qr_instr, std::string* result,
+				                  std::vector<double>* m_exps);
 
 		bool applyBlockInstruction(qSim_qinstruction_block* qr_instr, std::string* result);
 		bool applyBlockInstructionQml(qSim_qinstruction_block_qml* qr_instr, std::string* result);
 
+		// q-net gradient - state expectation and its derivatives by the q-net params
+		bool applyBlockInstructionQml(qSim_qinstruction_block_qml* qr_instr, std::string* result,
+									  double* m_exp, std::vector<double>* m_grad);
+
+		bool applyCoreInstructionList(std::list<qSim_qinstruction_core*>* qr_instr_list, std::string* result);
+
+		// qureg clone - device states (and qubits placement) copied from given qureg, having the
+		// same size and shards layout
+		bool copyState(qSim_qreg* qr_src);
+
 		// accessors
-		unsigned int getTotStates();
+		bool isAllocated();
+		QREG_ST_INDEX_TYPE getTotStates();
+		int getTotSamples();
+		int getSampleQubits();
+		void setQmlCache(qSim_qinstruction_block_qml_cache* qml_cache);
 
 		// diagnostics
 		void dump(unsigned max_st=10u);
@@ -113,37 +242,97 @@ class qSim_qreg {
 	private:
 		// state control and access
 		bool resetState();
-		bool setState(unsigned st_idx);
+		bool setState(QREG_ST_INDEX_TYPE st_idx);
 		bool setState(QREG_ST_VAL_ARRAY_TYPE* stArray);
+		bool setSamplesState(QREG_ST_INDEX_TYPE st_idx);
+
+		bool stateSnapshot(qSim_qreg_snapshot* snap);
+		bool stateRestore(qSim_qreg_snapshot* snap);
+		void snapshotRelease(qSim_qreg_snapshot* snap);
 
 		bool transform(QASM_F_TYPE ftype, int fsize, int frep, int flsq,
 				       QREG_F_INDEX_RANGE_TYPE fcrng, QREG_F_INDEX_RANGE_TYPE ftrng, QREG_F_ARGS_TYPE fargs,
 				       int futype, QREG_F_INDEX_RANGE_TYPE fucrng, QREG_F_INDEX_RANGE_TYPE futrng, QREG_F_ARGS_TYPE fuargs);
 
+		bool transform_check(QASM_F_TYPE ftype, int fsize, int frep, int flsq);
+
+		bool transform_shards(QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+							  QREG_F_ARGS_TYPE* fargs, int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs);
+
+		int transform_shards_controlled(QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+										int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fuargs);
+
+		int transform_fast(int sh, QASM_F_TYPE ftype, int fsize, int frep, int flsq, int fform, int fgapn,
+						   int futype, int fun, int fuform, QREG_F_ARGS_TYPE* fargs);
+
+		bool transformDense(int flsq, int fn, QREG_ST_RAW_VAL_TYPE* f_mtx);
+		bool transformDenseBatch(int flsq, int fn, QREG_ST_RAW_VAL_TYPE* f_mtx);
+
 		bool getStates(QREG_ST_VAL_ARRAY_TYPE* stArray);
+		bool getStatesPage(QREG_ST_INDEX_TYPE st_offs, QREG_ST_INDEX_TYPE st_cnt, QREG_ST_VAL_ARRAY_TYPE* stArray);
+		bool getStatesTopK(int k, QREG_ST_INDEX_ARRAY_TYPE* idxArray, QREG_ST_VAL_ARRAY_TYPE* stArray);
 
 		bool stateMeasure(int q_idx, int q_len, bool m_rand, bool m_coll,
 						  QREG_ST_INDEX_TYPE* m_st, double* m_pr, QREG_ST_INDEX_ARRAY_TYPE* m_vec);
-		bool stateExpectation(int st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp, double* m_exp);
+		bool stateMeasureShots(int q_idx, int q_len, int shots, int seed, QREG_ST_INDEX_ARRAY_TYPE* m_counts);
+		bool stateExpectation(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp, double* m_exp);
+
+		bool stateMeasureBatch(int q_idx, int q_len, bool m_rand, bool m_coll,
+							   QREG_ST_INDEX_ARRAY_TYPE* m_sts, std::vector<double>* m_prs);
+		bool stateExpectationBatch(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp,
+								   std::vector<double>* m_exps);
 
 		// CUDA device interface control (used by qCpu class)
-		void synchDevStates();
+		qSim_qcpu_device* device(int sh=0);
+		bool synchDevStates();
+		void alignDevStates();
+		bool allocHostStates();
 
 		// support methods for qureg state measurement handling
 		bool do_state_measure(int q_idx, int q_len,  bool do_rnd, bool collapse_st,
 				              QREG_ST_INDEX_TYPE* m_st, double* m_exp, QREG_ST_INDEX_ARRAY_TYPE* m_vec, bool d_vals);
-		double get_state_probability(int st_idx, int q_idx, int q_len);
 
-		int get_state_bitval(int st_idx, int q_idx, int q_len);
+		void get_state_marginals(int q_idx, int q_len, std::vector<double>* pr_vec);
+
+		void select_measure_state(std::vector<double>* pr_vec, bool do_rnd, QREG_ST_INDEX_TYPE* m_st, double* m_pr);
+
+		QREG_ST_INDEX_TYPE get_state_bitval(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len);
 
 		// support methods for qureg state expectation handling
-		void get_state_expectations(int q_idx, int q_len, QASM_EX_OBSOP_TYPE ex_opsOp, std::vector<double>* ex_obsOp_vec);
-		void get_state_probabilities(std::vector<double>* pr_vec);
+		void get_state_expectation_masks(QREG_ST_INDEX_TYPE st_idx, int q_idx, int q_len, int qn,
+										 QREG_ST_INDEX_TYPE* sel_mask, QREG_ST_INDEX_TYPE* sel_val,
+										 QREG_ST_INDEX_TYPE* obs_mask);
+		void get_state_expectation_weights(QREG_ST_INDEX_TYPE obs_mask, QASM_EX_OBSOP_TYPE ex_opsOp,
+				                           std::vector<double>* w_vec);
+
+		void apply_instruction_and_release(std::list<qSim_qinstruction_core*>* qinstr_list, QREG_F_ARGS_TYPE* fargs,
+				                           bool* res, std::string* res_str, bool do_release=true,
+										   std::vector<QREG_F_ARGS_TYPE>* s_fargs=NULL);
+
+		// SWAP blocks on qubits placement
+		bool swap_block_layout(qSim_qinstruction_block* qr_instr);
 
-		void kron_product(std::vector<double>* v1, std::vector<double>* v2, std::vector<double>* v3);
+		// support methods for state vector shards - qubits placed on shard layout positions,
+		// exchanging amplitudes among shards for qubits moved across the local ones limit
+		int shard_place_span(int q_lo, int q_len);
+		void shard_place_qubits(int q_n, const int* q_idx, int* p_idx);
+		void shard_restore_layout();
+		void shard_reset_layout();
+		void shard_swap_qubits(int p_a, int p_b);
+		void shard_layout_swap(int q_a, int q_b);
+		void shard_swap_positions(int p_a, int p_b);
+		void shard_swap_local(int p_a, int p_b);
+		void shard_exchange_global(int p_g);
+		void shard_exchange_node(int p_g);
+		QREG_ST_INDEX_TYPE shard_layout_mask(QREG_ST_INDEX_TYPE q_mask);
+		QREG_ST_INDEX_TYPE shard_layout_index(QREG_ST_INDEX_TYPE p_idx);
 
-		void apply_instruction_and_release(std::list<qSim_qinstruction_core*>* qinstr_list, QREG_F_ARGS_TYPE fargs,
-				                           bool* res, std::string* res_str, bool do_release=true);
+		// support methods for gate fusion over unwrapped instruction lists
+		bool apply_fusion_window(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n);
+		bool fusion_window_unitary(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n,
+				                   QREG_ST_RAW_VAL_TYPE* f_mtx);
+		bool apply_fusion_window_batch(std::vector<qSim_qreg_fusion_item>* w_items, int w_lo, int w_n,
+									   std::vector<QREG_F_ARGS_TYPE>* s_fargs);
 
 		map<QASM_EX_OBSOP_TYPE, std::vector<double>> m_obs_ev_map;
 
@@ -31,6 +31,19 @@
  *  1.0   May-2022   Module creation.
  *  1.1   Nov-2022   Updated to align to changes in QASM module.
  *  1.2   Feb-2023   Handled socket polling timeout passage as init argument.
+ *  1.3   Oct-2026   Added blocking in-queue pop and out-queue push socket loop wake-up.
+ *  1.4   Oct-2026   Handled binary message encoding negotiation at client registration
+ *                   and responses encoded as the relevant requests.
+ *  1.5   Oct-2026   Handled concurrent client sessions (one per socket connection), with own
+ *                   in/out message queues and access token valid on its session only.
+ *                   Built unique tokens (registration counter appended).
+ *  1.6   Oct-2026   Handled session in/out queues as single-producer/single-consumer rings,
+ *                   with control and error responses queued apart by socket loop, and
+ *                   processed instruction messages recycled through a free-queue.
+ *  1.7   Oct-2026   Handled server statistics control message, and collected message decoding
+ *                   and encoding statistics.
+ *  1.8   Oct-2026   Handled sent instruction responses recycled back to the session loop
+ *                   through a response free-queue (no allocation per response when recycled).
  *
  *  --------------------------------------------------------------------------
  */
@@ -42,15 +55,36 @@ using namespace std;
 
 #include "qSim_qio.h"
 #include "qSim_qasm.h"
+#include "qSim_qstats.h"
 
 
 // thread loop timeout
 #define LOOP_TIMEOUT_MSEC 100
 
 
+// release given queue content
+static void release_queue(qSim_qio_queue* queue) {
+	qSim_qasm_message* msg;
+	while ((msg = queue->pop()) != NULL)
+		delete msg;
+}
+
+// release given session and queues content
+static void release_session(qSim_qio_session* qio_s) {
+	release_queue(&(qio_s->m_msgIn_queue));
+	release_queue(&(qio_s->m_msgOut_queue));
+	release_queue(&(qio_s->m_msgFree_queue));
+	release_queue(&(qio_s->m_msgRespFree_queue));
+	for (size_t i=0; i<qio_s->m_msgCtrl_queue.size(); i++)
+		delete qio_s->m_msgCtrl_queue[i];
+	delete qio_s;
+}
+
 // constructor
 qSim_qio::qSim_qio(bool verbose) {
 	m_qsockSrv = new qSim_qio_socket_server(verbose);
+	m_session_cb = NULL;
+	m_clnTokenCounter = 0;
 	m_verbose = verbose;
 }
 
@@ -60,18 +94,12 @@ qSim_qio::~qSim_qio() {
 	m_qsockSrv->stopLoop();
 	delete m_qsockSrv;
 
-	// release queues content
-	qSim_qasm_message* msg;
-
-	while ((msg = m_msgIn_queue.peek()) != NULL) {
-		delete msg;
-		m_msgIn_queue.pop();
-	}
-
-	while ((msg = m_msgOut_queue.peek()) != NULL) {
-		delete msg;
-		m_msgOut_queue.pop();
-	}
+	// release sessions and queues content
+	std::lock_guard<std::mutex> lock(m_sessionsMutex);
+	std::map<int, qSim_qio_session*>::iterator it;
+	for (it=m_sessions.begin(); it!=m_sessions.end(); it++)
+		release_session(it->second);
+	m_sessions.clear();
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -90,31 +118,152 @@ int qSim_qio::init(std::string ipAddr, int port, int sock_timeout) {
 	return ret;
 }
 
+void qSim_qio::set_session_callback(qSim_qio_session_cb* cb) {
+	m_session_cb = cb;
+}
+
 ///////////////////////////////////////////////////////////////////
 
-qSim_qasm_message* qSim_qio::pop_msgIn_queue() {
-	qSim_qasm_message* qasm_msg = m_msgIn_queue.peek();
-	m_msgIn_queue.pop();
-	return qasm_msg;
+// => session queues accessed by the session owner only (socket client loop and qSim session
+//    loop), session released after both are done with it
+// => out and free queues pushed by one thread at a time (session loop, or qCpu lanes in turn),
+//    response free-queue popped by the session loop only
+
+int qSim_qio::get_msgIn_queue_size(int s_id) {
+	qSim_qio_session* qio_s = get_session(s_id);
+	return (qio_s != NULL) ? qio_s->m_msgIn_queue.size() : 0;
 }
 
-void qSim_qio::push_msgOut_queue(qSim_qasm_message* qasm_msg) {
-	m_msgOut_queue.push(qasm_msg);
+int qSim_qio::get_msgOut_queue_size(int s_id) {
+	qSim_qio_session* qio_s = get_session(s_id);
+	return (qio_s != NULL) ? qio_s->m_msgOut_queue.size() : 0;
+}
+
+qSim_qasm_message* qSim_qio::pop_msgIn_queue(int s_id) {
+	qSim_qio_session* qio_s = get_session(s_id);
+	return (qio_s != NULL) ? qio_s->m_msgIn_queue.pop() : NULL;
+}
+
+qSim_qasm_message* qSim_qio::pop_msgIn_queue_wait(int s_id, int timeout_usec) {
+	qSim_qio_session* qio_s = get_session(s_id);
+	return (qio_s != NULL) ? qio_s->m_msgIn_queue.pop_wait(timeout_usec) : NULL;
+}
+
+void qSim_qio::push_msgOut_queue(int s_id, qSim_qasm_message* qasm_msg) {
+	// push and wake-up socket client loop for sending
+	qSim_qio_session* qio_s = get_session(s_id);
+	if (qio_s == NULL) {
+		// session closed meanwhile - message discarded
+		delete qasm_msg;
+		return;
+	}
+	qio_s->m_msgOut_queue.push(qasm_msg);
+	m_qsockSrv->notify_out_message(s_id);
+}
+
+void qSim_qio::release_msgIn(int s_id, qSim_qasm_message* qasm_msg) {
+	// recycle message - released if session closed meanwhile or free-queue full
+	qSim_qio_session* qio_s = get_session(s_id);
+	if ((qio_s == NULL) || !qio_s->m_msgFree_queue.try_push(qasm_msg))
+		delete qasm_msg;
+}
+
+qSim_qasm_message* qSim_qio::alloc_msgOut(int s_id) {
+	// recycled response - new one if none sent back yet or session closed meanwhile
+	qSim_qio_session* qio_s = get_session(s_id);
+	qSim_qasm_message* qasm_msg = (qio_s != NULL) ? qio_s->m_msgRespFree_queue.pop() : NULL;
+	if (qasm_msg != NULL)
+		qasm_msg->reset();
+	else
+		qasm_msg = new qSim_qasm_message();
+	return qasm_msg;
 }
 
 // *********************************************************
 // support methods
 // *********************************************************
 
+qSim_qio_session* qSim_qio::get_session(int s_id) {
+	std::lock_guard<std::mutex> lock(m_sessionsMutex);
+	std::map<int, qSim_qio_session*>::iterator it = m_sessions.find(s_id);
+	return (it != m_sessions.end()) ? it->second : NULL;
+}
+
+// client connection callbacks for socket server - a session for each connection
+
+void qSim_qio::client_open_cb(int cln_id) {
+	// create session and notify its opening
+	qSim_qio_session* qio_s = new qSim_qio_session;
+	qio_s->m_id = cln_id;
+	{
+		std::lock_guard<std::mutex> lock(m_sessionsMutex);
+		m_sessions[cln_id] = qio_s;
+	}
+	if (m_verbose)
+		cout << "qSim_qio::client_open_cb - session: " << cln_id << endl;
+	if (m_session_cb != NULL)
+		m_session_cb->session_open_cb(cln_id);
+}
+
+void qSim_qio::client_close_cb(int cln_id) {
+	// notify session closing first - session loop done with its queues on return
+	if (m_verbose)
+		cout << "qSim_qio::client_close_cb - session: " << cln_id << endl;
+	if (m_session_cb != NULL)
+		m_session_cb->session_close_cb(cln_id);
+
+	// disable session tokens
+	{
+		std::lock_guard<std::mutex> lock(m_clnRegistryMutex);
+		QIO_CLIENT_ACCESS_REGISTRY::iterator it = m_cln_registry.begin();
+		while (it != m_cln_registry.end()) {
+			if (it->second.m_sessionId == cln_id)
+				it = m_cln_registry.erase(it);
+			else
+				it++;
+		}
+	}
+
+	// release session and queues content
+	qSim_qio_session* qio_s = NULL;
+	{
+		std::lock_guard<std::mutex> lock(m_sessionsMutex);
+		std::map<int, qSim_qio_session*>::iterator it = m_sessions.find(cln_id);
+		if (it != m_sessions.end()) {
+			qio_s = it->second;
+			m_sessions.erase(it);
+		}
+	}
+	if (qio_s != NULL)
+		release_session(qio_s);
+}
+
 // in/out message handling callbacks for socket server
 
-void qSim_qio::in_message_cb(qio_raw_msg* msg) {
-	// create qasm object from given raw message
-	qSim_qasm_message* qasm_msg = new qSim_qasm_message();
+void qSim_qio::in_message_cb(int cln_id, qio_raw_msg* msg) {
+	// get client session
+	qSim_qio_session* qio_s = get_session(cln_id);
+	if (qio_s == NULL) {
+		cerr << "qSim_qio::in_message_cb - session " << cln_id << " not found!! -> discarded" << endl;
+		return;
+	}
+
+	// create qasm object from given raw message - recycled one, if any
+	qSim_qasm_message* qasm_msg = qio_s->m_msgFree_queue.pop();
+	if (qasm_msg != NULL)
+		qasm_msg->reset();
+	else
+		qasm_msg = new qSim_qasm_message();
+	uint64_t t_dec = qSim_qstats::now_ns();
 	qasm_msg->from_char_array(msg->m_len, msg->m_dataBuf);
-	if (m_verbose)
-		cout << "qSim_qio::in_message_cb - m_len: " << msg->m_len
-		     << "  m_dataBuf: " << msg->m_dataBuf << endl;
+	qSim_qstats::record(QSTATS_STAGE_DECODE, qasm_msg->get_id(), t_dec, msg->m_len);
+	if (m_verbose) {
+		cout << "qSim_qio::in_message_cb - m_len: " << msg->m_len;
+		if (qasm_msg->is_binary())
+			cout << "  m_dataBuf: <binary>" << endl;
+		else
+			cout << "  m_dataBuf: " << msg->m_dataBuf << endl;
+	}
 
 	// add to input queue - correct
 	if (qasm_msg->check_syntax()) {
@@ -125,16 +274,19 @@ void qSim_qio::in_message_cb(qio_raw_msg* msg) {
 		}
 		if (qasm_msg->is_control_message()) {
 			// admin message - handle it here
-			handle_control_message(qasm_msg);
+			handle_control_message(qio_s, qasm_msg);
 			if (m_verbose)
 				cout << "qSim_qio::in_message_cb - qasm control msg processed" << endl;
+			delete qasm_msg;
 		}
 		else {
 			// instruction message - check if token is ok
 			QASM_MSG_ACCESS_TOKEN_TYPE token = qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_CLIENT_TOKEN);
-			if (check_clien_token(token)) {
-				// token recognized - push message to in-queue for qcpu
-				m_msgIn_queue.push(qasm_msg);
+			if (check_clien_token(cln_id, token)) {
+				// token recognized - push message to session in-queue for qcpu (arrival time
+				// for queue wait statistics)
+				qasm_msg->set_tstamp(t_dec);
+				qio_s->m_msgIn_queue.push(qasm_msg);
 				if (m_verbose)
 					cout << "qSim_qio::in_message_cb - qasm instruction msg syntax ok -> added to in-queue" << endl;
 			}
@@ -149,7 +301,8 @@ void qSim_qio::in_message_cb(qio_raw_msg* msg) {
 				qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_CLIENT_TOKEN, token);
 				qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK);
 				qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_ERROR, "unrecognised token");
-				m_msgOut_queue.push(qasm_err_msg);
+				qasm_err_msg->set_binary(qasm_msg->is_binary());
+				qio_s->m_msgCtrl_queue.push_back(qasm_err_msg);
 
 				delete qasm_msg;
 			}
@@ -165,27 +318,45 @@ void qSim_qio::in_message_cb(qio_raw_msg* msg) {
 		qSim_qasm_message* qasm_err_msg = new qSim_qasm_message(counter, id);
 		qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK);
 		qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_ERROR, "message syntax wrong");
-		m_msgOut_queue.push(qasm_err_msg);
+		qasm_err_msg->set_binary(qasm_msg->is_binary());
+		qio_s->m_msgCtrl_queue.push_back(qasm_err_msg);
 
 		delete qasm_msg;
 	}
 }
 
-void qSim_qio::out_message_cb(qio_raw_msg* msg) {
-	// check for a message in the output queue
-	qSim_qasm_message* qasm_msg = m_msgOut_queue.pop();
+void qSim_qio::out_message_cb(int cln_id, qio_raw_msg* msg) {
+	// check for a message in the session control or output queue
+	qSim_qio_session* qio_s = get_session(cln_id);
+	qSim_qasm_message* qasm_msg = NULL;
+	bool ctrl_msg = false;
+	if ((qio_s != NULL) && (qio_s->m_msgCtrl_queue.size() > 0)) {
+		qasm_msg = qio_s->m_msgCtrl_queue.front();
+		qio_s->m_msgCtrl_queue.pop_front();
+		ctrl_msg = true;
+	}
+	else if (qio_s != NULL)
+		qasm_msg = qio_s->m_msgOut_queue.pop();
 
 	// return it - if found
 	if (qasm_msg != NULL) {
 		// fill-in given raw message from qasm object
+		uint64_t t_enc = qSim_qstats::now_ns();
 		qasm_msg->to_char_array(&(msg->m_len), &(msg->m_dataBuf));
+		qSim_qstats::record(QSTATS_STAGE_ENCODE, qasm_msg->get_id(), t_enc, msg->m_len);
 
-		if (m_verbose)
-			cout << "qSim_qio::out_message_cb - m_len: " << msg->m_len
-			     << "  m_dataBuf: " << msg->m_dataBuf << endl;
+		if (m_verbose) {
+			cout << "qSim_qio::out_message_cb - m_len: " << msg->m_len;
+			if (qasm_msg->is_binary())
+				cout << "  m_dataBuf: <binary>" << endl;
+			else
+				cout << "  m_dataBuf: " << msg->m_dataBuf << endl;
+		}
 
-		// release message from queue
-		delete qasm_msg;
+		// release message from queue - instruction responses recycled to the session loop,
+		// released if free-queue full
+		if (ctrl_msg || !qio_s->m_msgRespFree_queue.try_push(qasm_msg))
+			delete qasm_msg;
 	}
 	else {
 		// reset raw message length (i.e. no message found)
@@ -195,36 +366,49 @@ void qSim_qio::out_message_cb(qio_raw_msg* msg) {
 
 // ------------------------------------------------------------
 
-void qSim_qio::handle_control_message(qSim_qasm_message* qasm_msg) {
+void qSim_qio::handle_control_message(qSim_qio_session* qio_s, qSim_qasm_message* qasm_msg) {
 	// handle given control message, i.e. one between
 	// - register a client
 	// - unregister a client
+	// - server statistics (registered clients only)
+	//
+	// => client credentials bound to the given session
+	std::lock_guard<std::mutex> lock(m_clnRegistryMutex);
 
 	switch (qasm_msg->get_id()) {
 		case QASM_MSG_ID_REGISTER: {
-			// new client registration - check if already registered
-			// and in case store it and provide access token back
+			// new client registration - check if already registered (on the same session -
+			// same client name allowed on concurrent sessions) and in case store it and provide
+			// access token back
 			string name = qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_CLIENT_ID);
 			QIO_CLIENT_ACCESS_REGISTRY::iterator it;
 			for (it=m_cln_registry.begin(); it!=m_cln_registry.end(); it++) {
-				if (it->second == name) {
+				if ((it->second.m_name == name) && (it->second.m_sessionId == qio_s->m_id)) {
 					// client already registered - log warning and erase entry
 					cout << "WARNING - user [" << name << "] is registering again - previous token disabled!!" << endl;
-					m_cln_registry.erase(it->first);
+					m_cln_registry.erase(it);
 					break;
 				}
 			}
 
 			// proceed and return the access token
+			qSim_qio_client cln;
+			cln.m_name = name;
+			cln.m_sessionId = qio_s->m_id;
 			QASM_MSG_ACCESS_TOKEN_TYPE token = build_client_token();
-			m_cln_registry.insert(std::make_pair(token, name));
+			m_cln_registry.insert(std::make_pair(token, cln));
 
 			QASM_MSG_COUNTER_TYPE counter = 0;
 			QASM_MSG_ID_TYPE id = QASM_MSG_ID_RESPONSE;
 			qSim_qasm_message* qasm_err_msg = new qSim_qasm_message(counter, id);
 			qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK);
 			qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_CLIENT_TOKEN, token);
-			m_msgOut_queue.push(qasm_err_msg);
+
+			// grant binary encoding if requested - client switching to it from next message
+			if (qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_ENCODING) == QASM_MSG_PARAM_VAL_ENC_BIN)
+				qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_ENCODING, QASM_MSG_PARAM_VAL_ENC_BIN);
+			qasm_err_msg->set_binary(qasm_msg->is_binary());
+			qio_s->m_msgCtrl_queue.push_back(qasm_err_msg);
 		}
 		break;
 
@@ -232,14 +416,56 @@ void qSim_qio::handle_control_message(qSim_qasm_message* qasm_msg) {
 			// client deregistration - remove credentials
 			// --------- >>>> to be done on client disconnect (CB from socket??) of after <x> minutes of inactivity
 
+			// => also done on client disconnect, for all the session tokens
 			QASM_MSG_ACCESS_TOKEN_TYPE token = qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_CLIENT_TOKEN);
-			m_cln_registry.erase(token);
+			QIO_CLIENT_ACCESS_REGISTRY::iterator it = m_cln_registry.find(token);
+			if ((it != m_cln_registry.end()) && (it->second.m_sessionId == qio_s->m_id))
+				m_cln_registry.erase(it);
 
 			QASM_MSG_COUNTER_TYPE counter = 0;
 			QASM_MSG_ID_TYPE id = QASM_MSG_ID_RESPONSE;
 			qSim_qasm_message* qasm_err_msg = new qSim_qasm_message(counter, id);
 			qasm_err_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK);
-			m_msgOut_queue.push(qasm_err_msg);
+			qasm_err_msg->set_binary(qasm_msg->is_binary());
+			qio_s->m_msgCtrl_queue.push_back(qasm_err_msg);
+		}
+		break;
+
+		case QASM_MSG_ID_STATS: {
+			// server statistics - counters since last reset (optionally reset after reading) and
+			// instruction timeline dump if requested
+			QASM_MSG_COUNTER_TYPE counter = 0;
+			QASM_MSG_ID_TYPE id = QASM_MSG_ID_RESPONSE;
+			qSim_qasm_message* qasm_res_msg = new qSim_qasm_message(counter, id);
+			qasm_res_msg->set_binary(qasm_msg->is_binary());
+			qio_s->m_msgCtrl_queue.push_back(qasm_res_msg);
+
+			QASM_MSG_ACCESS_TOKEN_TYPE token = qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_CLIENT_TOKEN);
+			QIO_CLIENT_ACCESS_REGISTRY::iterator it = m_cln_registry.find(token);
+			if ((it == m_cln_registry.end()) || (it->second.m_sessionId != qio_s->m_id)) {
+				cerr << "qSim_qio::handle_control_message - qasm token not recognised!!" << endl;
+				qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK);
+				qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_ERROR, "unrecognised token");
+				break;
+			}
+
+			if (qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_STATS_TRACE) == "1") {
+				std::string trace_file;
+				uint64_t tot_events;
+				if (!qSim_qstats::trace_dump(&trace_file, &tot_events)) {
+					qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_NOK);
+					qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_ERROR, qSim_qstats::trace_enabled() ?
+													 "timeline dump failed" : "timeline not enabled");
+					break;
+				}
+				qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_STATS_TRACEN, to_string(tot_events));
+			}
+
+			qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_RESULT, QASM_MSG_PARAM_VAL_OK);
+			qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_STATS_VALS, qSim_qstats::to_string());
+			qasm_res_msg->add_param_tagValue(QASM_MSG_PARAM_TAG_STATS_ELAPSED, to_string(qSim_qstats::elapsed_ns()));
+			if (qasm_msg->get_param_valueByTag(QASM_MSG_PARAM_TAG_STATS_RESET) == "1")
+				qSim_qstats::reset();
 		}
 		break;
 
@@ -255,13 +481,16 @@ QASM_MSG_ACCESS_TOKEN_TYPE qSim_qio::build_client_token() {
 	// get seconds from 1970
 	std::time_t tm1970 = std::time(0);
 
-	// convert to string
-	QASM_MSG_ACCESS_TOKEN_TYPE token = to_string(tm1970);
+	// convert to string - registration counter appended for clients registering at the same time
+	QASM_MSG_ACCESS_TOKEN_TYPE token = to_string(tm1970) + "-" + to_string(++m_clnTokenCounter);
 	return token;
 }
 
-bool qSim_qio::check_clien_token(QASM_MSG_ACCESS_TOKEN_TYPE token) {
-	return (m_cln_registry.count(token) > 0);
+bool qSim_qio::check_clien_token(int s_id, QASM_MSG_ACCESS_TOKEN_TYPE token) {
+	// token registered on the given session only
+	std::lock_guard<std::mutex> lock(m_clnRegistryMutex);
+	QIO_CLIENT_ACCESS_REGISTRY::iterator it = m_cln_registry.find(token);
+	return ((it != m_cln_registry.end()) && (it->second.m_sessionId == s_id));
 }
 
 // ------------------------------------------------------------
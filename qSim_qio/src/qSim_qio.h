@@ -31,6 +31,14 @@
  *  1.0   May-2022   Module creation.
  *  1.1   Dec-2022   Modified pop method to return removed element reference.
  *  1.2   Feb-2023   Handled socket polling timeout passage as init argument.
+ *  1.3   Oct-2026   Added blocking in-queue pop and out-queue push socket loop wake-up.
+ *  1.4   Oct-2026   Handled concurrent client sessions (one per socket connection), with own
+ *                   in/out message queues and access token bound to the session.
+ *  1.5   Oct-2026   Handled session in/out queues as single-producer/single-consumer rings,
+ *                   control responses queued apart (socket loop only), and processed
+ *                   instruction messages recycled.
+ *  1.6   Oct-2026   Handled server statistics control message.
+ *  1.7   Oct-2026   Handled sent responses recycled back to the session through a free-queue.
  *
  *  --------------------------------------------------------------------------
  */
@@ -41,7 +49,9 @@
 
 
 #include <map>
+#include <deque>
 #include <string>
+#include <mutex>
 
 #include "qSim_qio_socket.h"
 #include "qSim_qio_queue.h"
@@ -51,8 +61,36 @@
 #define QIO_OK    QBUS_SOCK_OK
 #define QIO_ERROR QBUS_SOCK_ERROR
 
-// client access credentials handling
-typedef std::map<QASM_MSG_ACCESS_TOKEN_TYPE, std::string> QIO_CLIENT_ACCESS_REGISTRY;
+// client access credentials handling - client name and session it is registered on
+struct qSim_qio_client {
+	std::string m_name;
+	int m_sessionId;
+};
+
+typedef std::map<QASM_MSG_ACCESS_TOKEN_TYPE, qSim_qio_client> QIO_CLIENT_ACCESS_REGISTRY;
+
+// client session - one per socket connection, with own in/out message queues
+// => in-queue: socket loop -> session loop, out-queue: session loop -> socket loop, free-queue:
+//    processed instruction messages back to socket loop for reuse (no allocation when recycled),
+//    response free-queue: sent responses back to session loop for reuse
+// => control and error responses queued by socket loop for itself
+struct qSim_qio_session {
+	int m_id;
+	qSim_qio_queue m_msgIn_queue;
+	qSim_qio_queue m_msgOut_queue;
+	qSim_qio_queue m_msgFree_queue;
+	qSim_qio_queue m_msgRespFree_queue;
+	std::deque<qSim_qasm_message*> m_msgCtrl_queue;
+};
+
+// client session open/close notification interface
+class qSim_qio_session_cb {
+public:
+	qSim_qio_session_cb() {};
+	virtual ~qSim_qio_session_cb() {};
+	virtual void session_open_cb(int s_id) = 0;
+	virtual void session_close_cb(int s_id) = 0;
+};
 
 // socket reading polling timeout - default
 #define QIO_SOCK_LOOP_TIMEOUT_USEC QIO_SOCK_CLN_MSG_LOOP_TIMEOUT_USEC
@@ -66,31 +104,49 @@ class qSim_qio : public qSim_qio_socket_server_cb {
 
 		int init(std::string ipAddr, int port, int sock_timeout=QIO_SOCK_LOOP_TIMEOUT_USEC);
 
-		// queues access
-		int get_msgIn_queue_size()  { return m_msgIn_queue.size(); }
-		int get_msgOut_queue_size() { return m_msgOut_queue.size(); }
-		qSim_qasm_message* pop_msgIn_queue();
-		void push_msgOut_queue(qSim_qasm_message* qasm_msg);
+		// client sessions open/close notification - to be set before init
+		void set_session_callback(qSim_qio_session_cb* cb);
+
+		// session queues access
+		int get_msgIn_queue_size(int s_id);
+		int get_msgOut_queue_size(int s_id);
+		qSim_qasm_message* pop_msgIn_queue(int s_id);
+		qSim_qasm_message* pop_msgIn_queue_wait(int s_id, int timeout_usec);
+		void push_msgOut_queue(int s_id, qSim_qasm_message* qasm_msg);
+
+		// processed instruction message release - recycled for next incoming messages
+		void release_msgIn(int s_id, qSim_qasm_message* qasm_msg);
+
+		// response message allocation - recycled sent one if any (empty), by the session loop
+		// thread only
+		qSim_qasm_message* alloc_msgOut(int s_id);
 
 	private:
-		// in/out message handling callbacks for socket server
-		virtual void in_message_cb(qio_raw_msg*);
-		virtual void out_message_cb(qio_raw_msg*);
+		// client connection and in/out message handling callbacks for socket server
+		virtual void client_open_cb(int cln_id);
+		virtual void client_close_cb(int cln_id);
+		virtual void in_message_cb(int cln_id, qio_raw_msg*);
+		virtual void out_message_cb(int cln_id, qio_raw_msg*);
 
-		void handle_control_message(qSim_qasm_message* qasm_msg);
+		void handle_control_message(qSim_qio_session* qio_s, qSim_qasm_message* qasm_msg);
 
 		// socket server handler
 		qSim_qio_socket_server* m_qsockSrv;
 
-		// in/out message queues
-		qSim_qio_queue m_msgIn_queue;
-		qSim_qio_queue m_msgOut_queue;
+		// client sessions - by session id (socket connection id)
+		qSim_qio_session* get_session(int s_id);
+
+		std::map<int, qSim_qio_session*> m_sessions;
+		std::mutex m_sessionsMutex;
+		qSim_qio_session_cb* m_session_cb;
 
 		// client access credentials handling
 		QASM_MSG_ACCESS_TOKEN_TYPE build_client_token();
-		bool check_clien_token(QASM_MSG_ACCESS_TOKEN_TYPE token);
+		bool check_clien_token(int s_id, QASM_MSG_ACCESS_TOKEN_TYPE token);
 
 		QIO_CLIENT_ACCESS_REGISTRY m_cln_registry;
+		std::mutex m_clnRegistryMutex;
+		unsigned long m_clnTokenCounter;
 
 		bool m_verbose;
 };
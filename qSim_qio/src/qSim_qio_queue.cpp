@@ -28,11 +28,16 @@
  *  --------------------------------------------------------------------------
  *  1.0   May-2022   Module creation.
  *  1.1   Dec-2022   Modified pop method to return removed element reference.
+ *  1.2   Oct-2026   Added blocking pop with timeout, based on condition variable signalled on push.
+ *  1.3   Oct-2026   Implemented as a bounded lock-free single-producer/single-consumer ring,
+ *                   with consumer wake-up signalled on push only while it is waiting.
  *
  *  --------------------------------------------------------------------------
  */
 
 #include <chrono>
+#include <thread>
+#include <algorithm>
 #include <iostream>
 using namespace std;
 
@@ -40,7 +45,16 @@ using namespace std;
 
 
 // constructor
-qSim_qio_queue::qSim_qio_queue() {
+qSim_qio_queue::qSim_qio_queue(int capacity) {
+	// ring sized to a power of 2
+	size_t ring_n = 1;
+	while (ring_n < (size_t)std::max(1, capacity))
+		ring_n <<= 1;
+	m_ring.assign(ring_n, NULL);
+	m_mask = ring_n - 1;
+	m_head.store(0);
+	m_tail.store(0);
+	m_waiting.store(false);
 }
 
 // destructor
@@ -49,32 +63,64 @@ qSim_qio_queue::~qSim_qio_queue() {
 
 ///////////////////////////////////////////////////////////////////
 
+// => consumer side - head index owned by consumer, tail index read to get pushed elements
+
 qSim_qasm_message* qSim_qio_queue::peek() {
-	// handle queue check using a critical section
-	qSim_qasm_message* item = NULL;
-	m_mutex.lock();
-	if (m_queue.size() > 0)
-		item = m_queue.front();
-	m_mutex.unlock();
-	return item;
+	// get first element, if any, with no removal
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_tail.load(std::memory_order_acquire))
+		return NULL;
+	return m_ring[head & m_mask];
 }
 
 qSim_qasm_message* qSim_qio_queue::pop() {
-	// handle queue top element removal using a critical section
-	qSim_qasm_message* item = NULL;
-	m_mutex.lock();
-	if (m_queue.size() > 0) {
-		item = m_queue.front();
-		m_queue.pop();
-	}
-	m_mutex.unlock();
+	// remove first element, if any - slot released to producer
+	size_t head = m_head.load(std::memory_order_relaxed);
+	if (head == m_tail.load(std::memory_order_acquire))
+		return NULL;
+	qSim_qasm_message* item = m_ring[head & m_mask];
+	m_head.store(head+1, std::memory_order_release);
 	return item;
 }
 
-void qSim_qio_queue::push(qSim_qasm_message* item) {
-	// handle queue bottom element insert using a critical section
-	m_mutex.lock();
-	m_queue.push(item);
-	m_mutex.unlock();
+qSim_qasm_message* qSim_qio_queue::pop_wait(int timeout_usec) {
+	// remove first element - waiting up to given timeout for an element to be pushed
+	qSim_qasm_message* item = pop();
+	if ((item != NULL) || (timeout_usec <= 0))
+		return item;
+
+	// waiting flag raised before checking ring again - either consumer finds the element or
+	// producer finds the flag (both sequentially consistent)
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_waiting.store(true);
+	m_cv_push.wait_for(lock, chrono::microseconds(timeout_usec),
+			           [this] { return (m_tail.load() != m_head.load(std::memory_order_relaxed)); });
+	m_waiting.store(false, std::memory_order_relaxed);
+	lock.unlock();
+	return pop();
 }
 
+// => producer side - tail index owned by producer, head index read to get released slots
+
+bool qSim_qio_queue::try_push(qSim_qasm_message* item) {
+	// add element at ring end, if not full - waiting consumer woken up
+	size_t tail = m_tail.load(std::memory_order_relaxed);
+	if (tail - m_head.load(std::memory_order_acquire) > m_mask)
+		return false;
+	m_ring[tail & m_mask] = item;
+	m_tail.store(tail+1);
+	if (m_waiting.load()) {
+		// consumer waiting (or about to) - lock taken for consumer to be in wait, not to get the
+		// wake-up lost
+		m_mutex.lock();
+		m_mutex.unlock();
+		m_cv_push.notify_one();
+	}
+	return true;
+}
+
+void qSim_qio_queue::push(qSim_qasm_message* item) {
+	// add element at ring end - backing off while full
+	while (!try_push(item))
+		std::this_thread::yield();
+}
@@ -27,6 +27,9 @@
  *  Ver   Date       Change
  *  --------------------------------------------------------------------------
  *  1.0   May-2022   Module creation.
+ *  1.1   Oct-2026   Added blocking pop with timeout, based on condition variable signalled on push.
+ *  1.2   Oct-2026   Implemented as a bounded lock-free single-producer/single-consumer ring,
+ *                   with consumer wake-up signalled on push only while it is waiting.
  *
  *  --------------------------------------------------------------------------
  */
@@ -36,27 +39,47 @@
 #define QSIM_QIO_QUEUE_H_
 
 
-#include <queue>
+#include <vector>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+
+// default ring capacity (messages) - rounded up to a power of 2
+#define QIO_QUEUE_CAPACITY 1024
 
 class qSim_qasm_message;
 
+// => single producer and single consumer threads at a time - producer blocked while the ring
+//    is full, consumer waiting on an empty ring woken up by the next push
 class qSim_qio_queue {
 
 	public:
 		// constructor and destructor
-		qSim_qio_queue();
+		qSim_qio_queue(int capacity=QIO_QUEUE_CAPACITY);
 		virtual ~qSim_qio_queue();
 
+		// consumer side
 		qSim_qasm_message* peek();
 		qSim_qasm_message* pop();
+		qSim_qasm_message* pop_wait(int timeout_usec);
+
+		// producer side
 		void push(qSim_qasm_message*);
+		bool try_push(qSim_qasm_message*);
 
-		int size() { return m_queue.size(); }
+		int size() { return (int)(m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire)); }
 
 	private:
-		std::queue<qSim_qasm_message*> m_queue;
+		// ring slots and indexes - free running, slot given by index & mask
+		std::vector<qSim_qasm_message*> m_ring;
+		size_t m_mask;
+		alignas(64) std::atomic<size_t> m_head;	// consumer index
+		alignas(64) std::atomic<size_t> m_tail;	// producer index
+
+		// consumer wake-up - signalled only while consumer waiting on empty ring
+		alignas(64) std::atomic<bool> m_waiting;
 		std::mutex m_mutex;
+		std::condition_variable m_cv_push;
 
 	};
 
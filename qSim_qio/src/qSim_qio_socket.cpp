@@ -32,6 +32,15 @@
  *  1.1   Dec-2022   Performed message length check vs. maximum value, to detect
  *                   and handle communication sync loss with clients.
  *  1.2   Feb-2023   Handled socket client polling timeout passage as init argument.
+ *  1.3   Oct-2026   Handled event-driven client loops (poll on listening/client socket and
+ *                   outgoing message wake-up pipe) replacing sleep-polling, and released
+ *                   raw message buffers after use.
+ *  1.4   Oct-2026   Raised maximum message length for binary state payloads.
+ *  1.5   Oct-2026   Handled concurrent clients - each accepted connection served by its own
+ *                   loop thread, with own socket and wake-up pipe, and identified by a
+ *                   connection id on open/close and message callbacks.
+ *  1.6   Oct-2026   Reused client receive buffer (grown on demand) and coalesced pending
+ *                   wake-ups, writing the wake-up pipe once until the client loop drains it.
  *
  *  --------------------------------------------------------------------------
  */
@@ -44,6 +53,10 @@
 #include <iostream>
 using namespace std;
 
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "qSim_qio_socket.h"
 
 // ==> handshake protocol with client:
@@ -51,22 +64,28 @@ using namespace std;
 // (2) the server read the message and add to qIo IN queue
 // (3) the server get an answer from the qIo OUT queue and send it -> result code + data (optional)
 // (4) the client read the answer to the initial message
+//
+// => client loop waits on both client socket and wake-up pipe (written on each qIo OUT queue
+//    push), so that (2) and (3) are handled as soon as data are available
+//
+// => each connected client handled by its own loop thread, with messages tagged by the
+//    connection id (qIo session)
 
 // message handshake control params
 // -> polling loop timeout (msec)
 // -> max message length (bytes)
 
-#define QIO_MSG_MAX_LEN 65536
+#define QIO_MSG_MAX_LEN (64*1024*1024) // sized for binary state payloads
 
 
 qSim_qio_socket_server::qSim_qio_socket_server(bool verbose) : qSim_qsocket_server(verbose) {
-	// nothing to do...
 	m_dataInOut_cb = NULL;
 	m_clnPollingTimeout = QIO_SOCK_CLN_MSG_LOOP_TIMEOUT_USEC;
+	m_clnIdCounter = 0;
 }
 
 qSim_qio_socket_server::~qSim_qio_socket_server(){
-	// nothing to do...
+	// connected clients released by their own loops (detached threads)
 }
 
 // --------------------------------
@@ -87,6 +106,20 @@ void qSim_qio_socket_server::set_clientPollingTimeout(int timeout) {
 	m_clnPollingTimeout = timeout;
 }
 
+void qSim_qio_socket_server::notify_out_message(int cln_id) {
+	// wake-up client loop - a full pipe means a wake-up is pending already
+	std::lock_guard<std::mutex> lock(m_clientsMutex);
+	std::map<int, qio_client_conn*>::iterator it = m_clients.find(cln_id);
+	if (it == m_clients.end())
+		return;
+
+	char c = 1;
+	if (!it->second->m_wakeupPending.test_and_set())
+		if (write(it->second->m_wakeup_fd[1], &c, 1) < 0) {
+			// nothing to do...
+		}
+}
+
 // --------------------------------
 // Support methods
 
@@ -94,10 +127,10 @@ void qSim_qio_socket_server::set_clientPollingTimeout(int timeout) {
 //    - message len first - 4 bytes fixed length
 //    - message content - <len> bytes
 
-bool qSim_qio_socket_server::receive_data(struct qio_raw_msg* msg) {
+bool qSim_qio_socket_server::receive_data(int sockfd, struct qio_raw_msg* msg, std::vector<char>* buf_msg) {
 	// read message length first
 	unsigned char buf[QIO_MSG_LEN_SIZE+1];
-	bool res = (read_raw_data(m_cln_sockfd, buf, QIO_MSG_LEN_SIZE) == QIO_MSG_LEN_SIZE);
+	bool res = (read_raw_data(sockfd, buf, QIO_MSG_LEN_SIZE) == QIO_MSG_LEN_SIZE);
 	if (res) {
 		// message length preamble read - read message content now - in a loop to handle buffer limits
 		int msg_len = 0;
@@ -114,11 +147,14 @@ bool qSim_qio_socket_server::receive_data(struct qio_raw_msg* msg) {
 		if (m_verbose)
 			cout << "server_rx len: " << msg->m_len << endl;
 
-		msg->m_dataBuf = new char[(msg->m_len+1)*sizeof(char)]; // count len+1 for adding a \0 termination
-		memset(msg->m_dataBuf, 0, (msg->m_len+1)*sizeof(char));
+		// => given receive buffer reused, grown on demand
+		if (buf_msg->size() < msg->m_len+1)
+			buf_msg->resize(msg->m_len+1); // count len+1 for adding a \0 termination
+		msg->m_dataBuf = buf_msg->data();
+		msg->m_dataBuf[msg->m_len] = 0;
 		int tot_len = 0;
 		while (tot_len < msg_len) {
-			int ret = read_raw_data(m_cln_sockfd, (unsigned char*)msg->m_dataBuf+tot_len, msg->m_len-tot_len);
+			int ret = read_raw_data(sockfd, (unsigned char*)msg->m_dataBuf+tot_len, msg->m_len-tot_len);
 			tot_len += ret;
 //			cout << " ...reading...tot_len:" << tot_len << endl;
 			if (ret < 0) {
@@ -127,8 +163,7 @@ bool qSim_qio_socket_server::receive_data(struct qio_raw_msg* msg) {
 			    break;
 			}			
 		}
-		std::string mgs_str = msg->m_dataBuf;
-//		cout << "receive_data... full message read - mgs_len: " << msg_len << " msg (20 chars): " << mgs_str.substr(0, 20) << endl;
+//		cout << "receive_data... full message read - mgs_len: " << msg_len << " msg (20 chars): " << std::string(msg->m_dataBuf).substr(0, 20) << endl;
 	}
 //	else {
 //	    cout << "receive_data error reading msg len!" << endl;
@@ -136,17 +171,17 @@ bool qSim_qio_socket_server::receive_data(struct qio_raw_msg* msg) {
 	return res;
 }
 
-bool qSim_qio_socket_server::send_data(struct qio_raw_msg* msg) {
+bool qSim_qio_socket_server::send_data(int sockfd, struct qio_raw_msg* msg) {
 	// send message length first
 	unsigned char buf[QIO_MSG_LEN_SIZE];
 	int msg_len = msg->m_len;
 	memcpy(buf, &msg_len, QIO_MSG_LEN_SIZE);
-	bool res = (write_raw_data(m_cln_sockfd, (unsigned char*)buf, QIO_MSG_LEN_SIZE) == QIO_MSG_LEN_SIZE);
+	bool res = (write_raw_data(sockfd, (unsigned char*)buf, QIO_MSG_LEN_SIZE) == QIO_MSG_LEN_SIZE);
 	if (res) {
 	    // message length preamble sent - send message content now - in a loop to handle buffer limits
   	    int tot_len = 0;
 	    while (tot_len < msg_len) {
-	        int ret = write_raw_data(m_cln_sockfd, (unsigned char*)msg->m_dataBuf+tot_len, msg->m_len-tot_len);
+	        int ret = write_raw_data(sockfd, (unsigned char*)msg->m_dataBuf+tot_len, msg->m_len-tot_len);
 		tot_len += ret;
 //		cout << " ...sending...tot_len:" << tot_len << endl;
 		if (ret < 0) {
@@ -166,99 +201,165 @@ void qSim_qio_socket_server::doLoop() {
 	// connect to client and start handling loop
 	cout << "qio-server...doLoop..." << endl;
 
-	// loop for accepting clients - this loop doesn't need to be super-responsive!
+	// loop for accepting clients - waiting for listening socket activity, with timeout for stop check
 	while (m_keepRunning.test_and_set()) {
+		struct pollfd pfd;
+		pfd.fd = m_sockfd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		int sel = poll(&pfd, 1, QIO_SOCK_CLN_ACCEPT_LOOP_TIMEOUT_USEC/1000);
+		if (sel <= 0)
+			continue;
+
 		//accept, create a new socket descriptor to handle the new connection with client
 		if (m_verbose)
 			cout << "Waiting for a client to connect..." << endl;
 		this->accept_client();
+		if (m_cln_sockfd <= 0) {
+			cerr << "qSim_qio_socket_server - client accept error - errno: " << errno << endl;
+			m_cln_sockfd = 0;
+			continue;
+		}
 		if (m_verbose)
 			cout << "qsocket-server client accepted..." << endl;
 
-		// start message handling in a separate thread - exit when client disconnect or for errors
-
-		m_clnThr_id = std::thread(&qSim_qio_socket_server::doLoop_client, this);
-		m_clnThr_id.detach();
+		// setup client connection - socket taken over from the accepting one, with its own
+		// outgoing message wake-up pipe (non blocking ends)
+		qio_client_conn* cln = new qio_client_conn;
+		cln->m_sockfd = m_cln_sockfd;
+		m_cln_sockfd = 0;
+		if (pipe(cln->m_wakeup_fd) == 0) {
+			fcntl(cln->m_wakeup_fd[0], F_SETFL, O_NONBLOCK);
+			fcntl(cln->m_wakeup_fd[1], F_SETFL, O_NONBLOCK);
+		}
+		else {
+			cerr << "qSim_qio_socket_server - wake-up pipe creation error - errno: " << errno << endl;
+			close(cln->m_sockfd);
+			delete cln;
+			continue;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_clientsMutex);
+			cln->m_id = ++m_clnIdCounter;
+			m_clients[cln->m_id] = cln;
+		}
 
-		// sleep a while
-		this_thread::sleep_for(chrono::microseconds(QIO_SOCK_CLN_ACCEPT_LOOP_TIMEOUT_USEC)); // a fixed polling timeout can work here...
+		// start message handling in a separate thread - exit when client disconnect or for errors
+		std::thread cln_thr(&qSim_qio_socket_server::doLoop_client, this, cln);
+		cln_thr.detach();
 	}
 	cout << "qSim_qio_socket_server::doLoop done." << endl;
 }
 
-void qSim_qio_socket_server::doLoop_client() {
+void qSim_qio_socket_server::doLoop_client(qio_client_conn* cln) {
 	// handle exchange with client
-	cout << "qio-server...doLoop_client...m_clnPollingTimeout: " << m_clnPollingTimeout << endl;
+	cout << "qio-server...doLoop_client...id: " << cln->m_id << " m_clnPollingTimeout: " << m_clnPollingTimeout << endl;
 
-	// setup message structure
+	// open client session
+	if (m_dataInOut_cb != NULL)
+		m_dataInOut_cb->client_open_cb(cln->m_id);
+
+	// setup message structure - on reused receive buffer
 	struct qio_raw_msg msg_in;
-	struct qio_raw_msg msg_out;
+	msg_in.m_len = 0;
+	msg_in.m_dataBuf = NULL;
+	std::vector<char> buf_in;
+
+	// wait on client socket (incoming messages) and wake-up pipe (outgoing messages) - polling
+	// timeout (rounded up to msec) only bounds the idle wake-up
+	struct pollfd pfd[2];
+	pfd[0].fd = cln->m_sockfd;
+	pfd[0].events = POLLIN;
+	pfd[1].fd = cln->m_wakeup_fd[0];
+	pfd[1].events = POLLIN;
+	int poll_tm = (m_clnPollingTimeout+999)/1000;
 
 	// loop for exchanging messages with a client - this is a performance critical part!
 	bool loop = true;
 	while (loop) {
-		// check client activity flag - for read
-		int sel = this->check_client(QSOCK_CK_RD);
-//			cout << "qsocket server - check_client RD...sel:" << sel << endl;
+		pfd[0].revents = 0;
+		pfd[1].revents = 0;
+		int sel = poll(pfd, 2, poll_tm);
+		if (sel < 0) {
+			if (errno == EINTR)
+				continue;
+			// poll error - client disconnected.
+			cerr << "poll error - client disconnected..." << endl;
+			break;
+		}
 
-		if (sel > 0) {
+		if (pfd[0].revents & (POLLIN | POLLHUP | POLLERR)) {
 			// client has performed some activity (sent data or disconnected)
 
 			// check for message to receive
-			if (this->receive_data(&msg_in)) {
+			if (this->receive_data(cln->m_sockfd, &msg_in, &buf_in)) {
 				// call CB to pass message to qIo class
 				if (m_dataInOut_cb != NULL)
-					m_dataInOut_cb->in_message_cb(&msg_in);
+					m_dataInOut_cb->in_message_cb(cln->m_id, &msg_in);
 				if (m_verbose)
 					cout << "qsocket server - message received ==> len: " << msg_in.m_len
 						 << "  m_dataBuf: " << msg_in.m_dataBuf << endl;
+				msg_in.m_dataBuf = NULL;
+				msg_in.m_len = 0;
 			}
 			else {
 				 // read 0 bytes or error - client disconnected
+				 msg_in.m_dataBuf = NULL;
+				 msg_in.m_len = 0;
 				 cout << "errno: " << errno << endl;
 				 cout << "read 0-bytes or error - client disconnected..." << endl;
-//				 loop = false;
 				 break;
 			}
 		}
 
-		// check client activity flag - for write
-		sel = this->check_client(QSOCK_CK_WR);
-//			cout << "qsocket server - check_client WR...sel:" << sel << endl;
-		if (sel >= 0) {
-			// no errors - check out outgoing messages
-
-			// call CB to check for message to send from qIo class
-			if (m_dataInOut_cb != NULL)
-				m_dataInOut_cb->out_message_cb(&msg_out);
-
-			if (msg_out.m_len > 0) {
-				// out message passed - send it
-				if (this->send_data(&msg_out)) {
-					if (m_verbose)
-						cout << "qsocket server - response message sent..." << endl;
-				}
-				else {
-					 // write error - client disconnected.
-					 cout << "write 0-bytes or error - client disconnected..." << endl;
-//					 loop = false;
-					 break;
-				}
-			}
+		// check out outgoing messages - on wake-up or control responses pushed by the in-message callback
+		if (!this->send_out_messages(cln)) {
+			 // write error - client disconnected.
+			 cout << "write 0-bytes or error - client disconnected..." << endl;
+			 break;
 		}
-		else {
-			// select error - client disconnected.
-			cerr << "select error - client disconnected..." << endl;
-//			loop = false;
-			break;
-		}
-
-		// sleep a while - based on given timeout
-		this_thread::sleep_for(chrono::microseconds(m_clnPollingTimeout));
 	}
 
-	// client handling completed
-    this->release_client();
-	cout << "qSim_qio_socket_server::doLoop_client done." << endl;
+	// client handling completed - close client session and release connection
+	if (m_dataInOut_cb != NULL)
+		m_dataInOut_cb->client_close_cb(cln->m_id);
+	{
+		std::lock_guard<std::mutex> lock(m_clientsMutex);
+		m_clients.erase(cln->m_id);
+	}
+	close(cln->m_sockfd);
+	close(cln->m_wakeup_fd[0]);
+	close(cln->m_wakeup_fd[1]);
+	cout << "qSim_qio_socket_server::doLoop_client done - id: " << cln->m_id << endl;
+	delete cln;
 }
 
+bool qSim_qio_socket_server::send_out_messages(qio_client_conn* cln) {
+	// drain wake-up pipe - pending flag cleared first, for a next push to wake-up again
+	char buf[64];
+	cln->m_wakeupPending.clear();
+	while (read(cln->m_wakeup_fd[0], buf, sizeof(buf)) > 0);
+
+	// send all messages available from qIo class
+	if (m_dataInOut_cb == NULL)
+		return true;
+
+	struct qio_raw_msg msg_out;
+	msg_out.m_dataBuf = NULL;
+	while (true) {
+		msg_out.m_len = 0;
+		m_dataInOut_cb->out_message_cb(cln->m_id, &msg_out);
+		if (msg_out.m_len == 0)
+			break;
+
+		// out message passed - send it
+		bool res = this->send_data(cln->m_sockfd, &msg_out);
+		delete[] msg_out.m_dataBuf;
+		msg_out.m_dataBuf = NULL;
+		if (!res)
+			return false;
+		if (m_verbose)
+			cout << "qsocket server - response message sent..." << endl;
+	}
+	return true;
+}
@@ -31,6 +31,12 @@
  *  1.0   May-2022   Module creation cloning former qreg_qsocket class.
  *  1.1   Feb-2023   Handled socket client polling timeout passage as init argument.
  *                   Code clean-up.
+ *  1.2   Oct-2026   Handled event-driven client loops (poll on listening/client socket and
+ *                   outgoing message wake-up pipe) replacing sleep-polling.
+ *  1.3   Oct-2026   Handled concurrent clients - one loop thread per client connection, with
+ *                   its own socket and wake-up pipe, and connection id passed to callbacks.
+ *  1.4   Oct-2026   Reused client receive buffer and coalesced pending wake-ups (single pipe
+ *                   write until the client loop drains it).
  *
  *  --------------------------------------------------------------------------
  */
@@ -40,6 +46,10 @@
 
 #include <thread>
 #include <functional>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <vector>
 
 #include "qSim_qsocket.h"
 
@@ -56,18 +66,30 @@ struct qio_raw_msg {
 	~qio_raw_msg() {if (m_len > 0) delete(m_dataBuf); }
 };
 
+// client connection - own socket and outgoing message wake-up pipe (read & write ends), with
+// wake-up pending flag (pipe written once until drained)
+struct qio_client_conn {
+	int m_id;
+	int m_sockfd;
+	int m_wakeup_fd[2];
+	std::atomic_flag m_wakeupPending = ATOMIC_FLAG_INIT;
+};
+
 // ----------------
 
 class qSim_qio_socket_server_cb {
 public:
 	qSim_qio_socket_server_cb() {};
 	virtual ~qSim_qio_socket_server_cb() {};
-	virtual void in_message_cb(qio_raw_msg*) = 0;
-	virtual void out_message_cb(qio_raw_msg*) = 0;
+	virtual void client_open_cb(int cln_id) = 0;
+	virtual void client_close_cb(int cln_id) = 0;
+	virtual void in_message_cb(int cln_id, qio_raw_msg*) = 0;
+	virtual void out_message_cb(int cln_id, qio_raw_msg*) = 0;
 };
 
-#define QIO_SOCK_CLN_ACCEPT_LOOP_TIMEOUT_USEC 10000
-#define QIO_SOCK_CLN_MSG_LOOP_TIMEOUT_USEC 100
+// loop timeouts - idle wake-up only, clients and messages handled as soon as available
+#define QIO_SOCK_CLN_ACCEPT_LOOP_TIMEOUT_USEC 100000
+#define QIO_SOCK_CLN_MSG_LOOP_TIMEOUT_USEC 100000
 
 
 class qSim_qio_socket_server : public qSim_qsocket_server {
@@ -78,17 +100,24 @@ class qSim_qio_socket_server : public qSim_qsocket_server {
 		void set_dataInOut_callback(qSim_qio_socket_server_cb* cb);
 		void set_clientPollingTimeout(int timeout);
 
+		// outgoing message availability notification - wakes up given client loop
+		void notify_out_message(int cln_id);
+
 	private:
 		qSim_qio_socket_server_cb* m_dataInOut_cb;
 		int m_clnPollingTimeout;
 
-		std::thread m_clnThr_id;
+		// connected clients - by connection id
+		std::map<int, qio_client_conn*> m_clients;
+		std::mutex m_clientsMutex;
+		int m_clnIdCounter;
 
 		virtual void doLoop();
-		void doLoop_client();
+		void doLoop_client(qio_client_conn* cln);
 
-		bool receive_data(struct qio_raw_msg* msg);
-		bool send_data(struct qio_raw_msg* msg);
+		bool receive_data(int sockfd, struct qio_raw_msg* msg, std::vector<char>* buf);
+		bool send_data(int sockfd, struct qio_raw_msg* msg);
+		bool send_out_messages(qio_client_conn* cln);
 
 };
 